@@ -3,12 +3,14 @@
 
 rad::Logger g_logVulkan = rad::Logger("Vulkan");
 
-void ReportError(VkResult result, const char* function, const char* file, uint32_t line)
+void ReportError(rad::LogSite& site, VkResult result, const char* function, const char* file, uint32_t line)
 {
     if (result < 0)
     {
-        LogVulkan(Error, "{} failed with VkResult={}({}, line {}).",
+#ifndef RAD_NO_LOGGING
+        g_logVulkan.Log(site, rad::LogLevel::Error, "{} failed with VkResult={}({}, line {}).",
             function, string_VkResult(result), file, line);
+#endif
         throw VulkanError(result);
     }
 }
@@ -26,7 +26,8 @@
 extern rad::Logger g_logVulkan;
 
 #ifndef RAD_NO_LOGGING
-#define LogVulkan(Level, Format, ...) g_logVulkan.Log(rad::LogLevel::Level, Format, ##__VA_ARGS__)
+#define LogVulkan(Level, Format, ...) \
+    do { static rad::LogSite _logSite; g_logVulkan.Log(_logSite, rad::LogLevel::Level, Format, ##__VA_ARGS__); } while (0)
 #else
 #define LogVulkan(Level, Format, ...)
 #endif
@@ -41,9 +42,10 @@ private:
 }; // class VulkanError
 
 // Check Vulkan return code and throw VulkanError if result < 0
-void ReportError(VkResult result, const char* function, const char* file, uint32_t line);
+// @param site: the errors are rate limited per VK_CHECK.
+void ReportError(rad::LogSite& site, VkResult result, const char* function, const char* file, uint32_t line);
 #define VK_CHECK(VulkanCall) \
-    do { const VkResult res = VulkanCall; ReportError(res, #VulkanCall, __FILE__, __LINE__); } while(0)
+    do { static rad::LogSite _logSite; const VkResult res = VulkanCall; ReportError(_logSite, res, #VulkanCall, __FILE__, __LINE__); } while(0)
 
 class VulkanVersion
 {
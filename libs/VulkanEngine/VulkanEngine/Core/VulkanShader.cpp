@@ -2,6 +2,7 @@
 #include "VulkanShader.h"
 #include "VulkanDevice.h"
 #include "rad/IO/File.h"
+#include "rad/IO/MappedFile.h"
 
 VulkanShader::VulkanShader()
 {
@@ -152,25 +153,25 @@ bool VulkanShader::LoadBinary(VkShaderStageFlagBits stage, void* binary, size_t
 
 bool VulkanShader::LoadBinaryFromFile(VkShaderStageFlagBits stage, const std::string_view fileName)
 {
-    rad::File binaryFile;
-    if (binaryFile.Open(fileName, "rb"))
+    rad::MappedFile binaryFile;
+    if (binaryFile.Open(fileName) && binaryFile.Map())
     {
-        uint64_t fileSize = binaryFile.GetSize();
-        if (fileSize % sizeof(uint32_t) != 0)
+        if (binaryFile.GetSize() % sizeof(uint32_t) != 0)
         {
             LogVulkan(Error, "VulkanShader::LoadBinaryFromFile(stage={}, fileName={}): "
                 "fileSize={} is not multiple of 4.",
-                string_VkShaderStageFlagBits(stage), fileName, fileSize);
+                string_VkShaderStageFlagBits(stage), fileName, binaryFile.GetSize());
             return false;
         }
 
-        m_binary.resize(fileSize / sizeof(uint32_t));
-        binaryFile.Read(reinterpret_cast<char*>(m_binary.data()), fileSize);
-        if (m_binary[0] != 0x07230203)
+        // The shader owns its words: one copy from the mapping, no stdio read buffer in between.
+        m_binary.resize(binaryFile.GetSize() / sizeof(uint32_t));
+        memcpy(m_binary.data(), binaryFile.GetData(), binaryFile.GetSize());
+        if (m_binary.empty() || (m_binary[0] != 0x07230203))
         {
             LogVulkan(Error, "VulkanShader::LoadBinaryFromFile(stage={}, fileName={}): "
                 "invalid magic number 0x{:8X}.",
-                string_VkShaderStageFlagBits(stage), fileName, m_binary[0]);
+                string_VkShaderStageFlagBits(stage), fileName, m_binary.empty() ? 0 : m_binary[0]);
         }
         m_stage = stage;
         m_fileName = fileName;
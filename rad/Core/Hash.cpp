@@ -0,0 +1,923 @@
+#include "Hash.h"
+#include "String.h"
+#include "rad/IO/Logging.h"
+#include <bit>
+#include <cstring>
+
+#include "cpu_features_macros.h"
+#if defined(CPU_FEATURES_ARCH_X86_64)
+#include "cpuinfo_x86.h"
+#include <immintrin.h>
+#define RAD_HASH_X86 1
+#elif defined(CPU_FEATURES_ARCH_AARCH64)
+#include <arm_neon.h>
+#define RAD_HASH_NEON 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RAD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define RAD_TARGET_AVX2
+#endif
+
+namespace rad
+{
+
+namespace
+{
+
+constexpr uint32_t Prime32_1 = 0x9E3779B1u;
+constexpr uint32_t Prime32_2 = 0x85EBCA77u;
+constexpr uint32_t Prime32_3 = 0xC2B2AE3Du;
+constexpr uint64_t Prime64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t Prime64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t Prime64_5 = 0x27D4EB2F165667C5ull;
+constexpr uint64_t PrimeMx1 = 0x165667919E3779F9ull;
+constexpr uint64_t PrimeMx2 = 0x9FB21C651E98DF25ull;
+
+constexpr size_t StripeSize = Hasher::StripeSize;
+constexpr size_t SecretSize = Hasher::SecretSize;
+// The bytes of the secret consumed by each stripe.
+constexpr size_t SecretConsumeRate = 8;
+constexpr size_t StripesPerBlock = (SecretSize - StripeSize) / SecretConsumeRate;
+constexpr size_t BlockSize = StripeSize * StripesPerBlock;
+// The inputs up to this size are hashed without the accumulators.
+constexpr size_t MidSizeMax = 240;
+constexpr size_t SecretSizeMin = 136;
+constexpr size_t MidSizeStartOffset = 3;
+constexpr size_t MidSizeLastOffset = 17;
+constexpr size_t SecretLastAccStart = 7;
+constexpr size_t SecretMergeAccsStart = 11;
+
+// The default secret of XXH3.
+alignas(64) constexpr uint8_t g_secret[SecretSize] =
+{
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+constexpr uint32_t ByteSwap32(uint32_t x)
+{
+    return ((x << 24) & 0xFF000000u) | ((x << 8) & 0x00FF0000u) |
+        ((x >> 8) & 0x0000FF00u) | ((x >> 24) & 0x000000FFu);
+}
+
+constexpr uint64_t ByteSwap64(uint64_t x)
+{
+    return (static_cast<uint64_t>(ByteSwap32(static_cast<uint32_t>(x))) << 32) |
+        ByteSwap32(static_cast<uint32_t>(x >> 32));
+}
+
+inline uint32_t ReadLE32(const uint8_t* p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        value = ByteSwap32(value);
+    }
+    return value;
+}
+
+inline uint64_t ReadLE64(const uint8_t* p)
+{
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        value = ByteSwap64(value);
+    }
+    return value;
+}
+
+inline void WriteLE64(uint8_t* p, uint64_t value)
+{
+    if constexpr (std::endian::native == std::endian::big)
+    {
+        value = ByteSwap64(value);
+    }
+    std::memcpy(p, &value, sizeof(value));
+}
+
+inline Hash128 Multiply64To128(uint64_t lhs, uint64_t rhs)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 product = static_cast<unsigned __int128>(lhs) * rhs;
+    return Hash128{ static_cast<uint64_t>(product), static_cast<uint64_t>(product >> 64) };
+#elif defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+    Hash128 product;
+    product.low = _umul128(lhs, rhs, &product.high);
+    return product;
+#else
+    const uint64_t lolo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+    const uint64_t hilo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+    const uint64_t lohi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+    const uint64_t hihi = (lhs >> 32) * (rhs >> 32);
+    const uint64_t cross = (lolo >> 32) + (hilo & 0xFFFFFFFF) + lohi;
+    return Hash128{ (cross << 32) | (lolo & 0xFFFFFFFF), (hilo >> 32) + (cross >> 32) + hihi };
+#endif
+}
+
+inline uint64_t Multiply128Fold64(uint64_t lhs, uint64_t rhs)
+{
+    const Hash128 product = Multiply64To128(lhs, rhs);
+    return product.low ^ product.high;
+}
+
+inline uint64_t XorShift64(uint64_t x, int shift)
+{
+    return x ^ (x >> shift);
+}
+
+uint64_t XXH64Avalanche(uint64_t h)
+{
+    h ^= h >> 33;
+    h *= Prime64_2;
+    h ^= h >> 29;
+    h *= Prime64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t Avalanche(uint64_t h)
+{
+    h = XorShift64(h, 37);
+    h *= PrimeMx1;
+    h = XorShift64(h, 32);
+    return h;
+}
+
+uint64_t RrmxmxAvalanche(uint64_t h, uint64_t size)
+{
+    h ^= std::rotl(h, 49) ^ std::rotl(h, 24);
+    h *= PrimeMx2;
+    h ^= (h >> 35) + size;
+    h *= PrimeMx2;
+    return XorShift64(h, 28);
+}
+
+// The short inputs are hashed with the default secret and the seed.
+
+uint64_t Hash64Size1To3(const uint8_t* input, size_t size, uint64_t seed)
+{
+    const uint32_t combined = (static_cast<uint32_t>(input[0]) << 16) |
+        (static_cast<uint32_t>(input[size >> 1]) << 24) |
+        static_cast<uint32_t>(input[size - 1]) | (static_cast<uint32_t>(size) << 8);
+    const uint64_t bitflip = (ReadLE32(g_secret) ^ ReadLE32(g_secret + 4)) + seed;
+    return XXH64Avalanche(combined ^ bitflip);
+}
+
+uint64_t Hash64Size4To8(const uint8_t* input, size_t size, uint64_t seed)
+{
+    seed ^= static_cast<uint64_t>(ByteSwap32(static_cast<uint32_t>(seed))) << 32;
+    const uint32_t input1 = ReadLE32(input);
+    const uint32_t input2 = ReadLE32(input + size - 4);
+    const uint64_t bitflip = (ReadLE64(g_secret + 8) ^ ReadLE64(g_secret + 16)) - seed;
+    const uint64_t input64 = input2 + (static_cast<uint64_t>(input1) << 32);
+    return RrmxmxAvalanche(input64 ^ bitflip, size);
+}
+
+uint64_t Hash64Size9To16(const uint8_t* input, size_t size, uint64_t seed)
+{
+    const uint64_t bitflip1 = (ReadLE64(g_secret + 24) ^ ReadLE64(g_secret + 32)) + seed;
+    const uint64_t bitflip2 = (ReadLE64(g_secret + 40) ^ ReadLE64(g_secret + 48)) - seed;
+    const uint64_t inputLow = ReadLE64(input) ^ bitflip1;
+    const uint64_t inputHigh = ReadLE64(input + size - 8) ^ bitflip2;
+    const uint64_t acc = size + ByteSwap64(inputLow) + inputHigh + Multiply128Fold64(inputLow, inputHigh);
+    return Avalanche(acc);
+}
+
+inline uint64_t Mix16(const uint8_t* input, const uint8_t* secret, uint64_t seed)
+{
+    return Multiply128Fold64(
+        ReadLE64(input) ^ (ReadLE64(secret) + seed),
+        ReadLE64(input + 8) ^ (ReadLE64(secret + 8) - seed));
+}
+
+uint64_t Hash64Size17To128(const uint8_t* input, size_t size, uint64_t seed)
+{
+    uint64_t acc = size * Prime64_1;
+    if (size > 32)
+    {
+        if (size > 64)
+        {
+            if (size > 96)
+            {
+                acc += Mix16(input + 48, g_secret + 96, seed);
+                acc += Mix16(input + size - 64, g_secret + 112, seed);
+            }
+            acc += Mix16(input + 32, g_secret + 64, seed);
+            acc += Mix16(input + size - 48, g_secret + 80, seed);
+        }
+        acc += Mix16(input + 16, g_secret + 32, seed);
+        acc += Mix16(input + size - 32, g_secret + 48, seed);
+    }
+    acc += Mix16(input, g_secret, seed);
+    acc += Mix16(input + size - 16, g_secret + 16, seed);
+    return Avalanche(acc);
+}
+
+uint64_t Hash64Size129To240(const uint8_t* input, size_t size, uint64_t seed)
+{
+    uint64_t acc = size * Prime64_1;
+    for (size_t i = 0; i < 8; ++i)
+    {
+        acc += Mix16(input + 16 * i, g_secret + 16 * i, seed);
+    }
+    uint64_t accEnd = Mix16(input + size - 16, g_secret + SecretSizeMin - MidSizeLastOffset, seed);
+    acc = Avalanche(acc);
+    const size_t roundCount = size / 16;
+    for (size_t i = 8; i < roundCount; ++i)
+    {
+        accEnd += Mix16(input + 16 * i, g_secret + 16 * (i - 8) + MidSizeStartOffset, seed);
+    }
+    return Avalanche(acc + accEnd);
+}
+
+Hash128 Hash128Size1To3(const uint8_t* input, size_t size, uint64_t seed)
+{
+    const uint32_t combinedLow = (static_cast<uint32_t>(input[0]) << 16) |
+        (static_cast<uint32_t>(input[size >> 1]) << 24) |
+        static_cast<uint32_t>(input[size - 1]) | (static_cast<uint32_t>(size) << 8);
+    const uint32_t combinedHigh = std::rotl(ByteSwap32(combinedLow), 13);
+    const uint64_t bitflipLow = (ReadLE32(g_secret) ^ ReadLE32(g_secret + 4)) + seed;
+    const uint64_t bitflipHigh = (ReadLE32(g_secret + 8) ^ ReadLE32(g_secret + 12)) - seed;
+    return Hash128{ XXH64Avalanche(combinedLow ^ bitflipLow), XXH64Avalanche(combinedHigh ^ bitflipHigh) };
+}
+
+Hash128 Hash128Size4To8(const uint8_t* input, size_t size, uint64_t seed)
+{
+    seed ^= static_cast<uint64_t>(ByteSwap32(static_cast<uint32_t>(seed))) << 32;
+    const uint32_t inputLow = ReadLE32(input);
+    const uint32_t inputHigh = ReadLE32(input + size - 4);
+    const uint64_t input64 = inputLow + (static_cast<uint64_t>(inputHigh) << 32);
+    const uint64_t bitflip = (ReadLE64(g_secret + 16) ^ ReadLE64(g_secret + 24)) + seed;
+    // Shift size to the left to ensure it is even, this avoids even multiplies.
+    Hash128 m = Multiply64To128(input64 ^ bitflip, Prime64_1 + (size << 2));
+    m.high += (m.low << 1);
+    m.low ^= (m.high >> 3);
+    m.low = XorShift64(m.low, 35);
+    m.low *= PrimeMx2;
+    m.low = XorShift64(m.low, 28);
+    m.high = Avalanche(m.high);
+    return m;
+}
+
+Hash128 Hash128Size9To16(const uint8_t* input, size_t size, uint64_t seed)
+{
+    const uint64_t bitflipLow = (ReadLE64(g_secret + 32) ^ ReadLE64(g_secret + 40)) - seed;
+    const uint64_t bitflipHigh = (ReadLE64(g_secret + 48) ^ ReadLE64(g_secret + 56)) + seed;
+    const uint64_t inputLow = ReadLE64(input);
+    uint64_t inputHigh = ReadLE64(input + size - 8);
+    Hash128 m = Multiply64To128(inputLow ^ inputHigh ^ bitflipLow, Prime64_1);
+    m.low += static_cast<uint64_t>(size - 1) << 54;
+    inputHigh ^= bitflipHigh;
+    m.high += inputHigh + static_cast<uint64_t>(static_cast<uint32_t>(inputHigh)) * (Prime32_2 - 1);
+    m.low ^= ByteSwap64(m.high);
+    Hash128 h = Multiply64To128(m.low, Prime64_2);
+    h.high += m.high * Prime64_2;
+    h.low = Avalanche(h.low);
+    h.high = Avalanche(h.high);
+    return h;
+}
+
+inline Hash128 Mix32(Hash128 acc, const uint8_t* input1, const uint8_t* input2,
+    const uint8_t* secret, uint64_t seed)
+{
+    acc.low += Mix16(input1, secret, seed);
+    acc.low ^= ReadLE64(input2) + ReadLE64(input2 + 8);
+    acc.high += Mix16(input2, secret + 16, seed);
+    acc.high ^= ReadLE64(input1) + ReadLE64(input1 + 8);
+    return acc;
+}
+
+Hash128 FinalizeMid128(Hash128 acc, size_t size, uint64_t seed)
+{
+    Hash128 h;
+    h.low = acc.low + acc.high;
+    h.high = (acc.low * Prime64_1) + (acc.high * Prime64_4) + ((size - seed) * Prime64_2);
+    h.low = Avalanche(h.low);
+    h.high = uint64_t(0) - Avalanche(h.high);
+    return h;
+}
+
+Hash128 Hash128Size17To128(const uint8_t* input, size_t size, uint64_t seed)
+{
+    Hash128 acc{ size * Prime64_1, 0 };
+    if (size > 32)
+    {
+        if (size > 64)
+        {
+            if (size > 96)
+            {
+                acc = Mix32(acc, input + 48, input + size - 64, g_secret + 96, seed);
+            }
+            acc = Mix32(acc, input + 32, input + size - 48, g_secret + 64, seed);
+        }
+        acc = Mix32(acc, input + 16, input + size - 32, g_secret + 32, seed);
+    }
+    acc = Mix32(acc, input, input + size - 16, g_secret, seed);
+    return FinalizeMid128(acc, size, seed);
+}
+
+Hash128 Hash128Size129To240(const uint8_t* input, size_t size, uint64_t seed)
+{
+    Hash128 acc{ size * Prime64_1, 0 };
+    for (size_t i = 32; i < 160; i += 32)
+    {
+        acc = Mix32(acc, input + i - 32, input + i - 16, g_secret + i - 32, seed);
+    }
+    acc.low = Avalanche(acc.low);
+    acc.high = Avalanche(acc.high);
+    for (size_t i = 160; i <= size; i += 32)
+    {
+        acc = Mix32(acc, input + i - 32, input + i - 16, g_secret + MidSizeStartOffset + i - 160, seed);
+    }
+    acc = Mix32(acc, input + size - 16, input + size - 32,
+        g_secret + SecretSizeMin - MidSizeLastOffset - 16, uint64_t(0) - seed);
+    return FinalizeMid128(acc, size, seed);
+}
+
+uint64_t HashShort64(const uint8_t* input, size_t size, uint64_t seed)
+{
+    if (size > 128)
+    {
+        return Hash64Size129To240(input, size, seed);
+    }
+    if (size > 16)
+    {
+        return Hash64Size17To128(input, size, seed);
+    }
+    if (size > 8)
+    {
+        return Hash64Size9To16(input, size, seed);
+    }
+    if (size >= 4)
+    {
+        return Hash64Size4To8(input, size, seed);
+    }
+    if (size > 0)
+    {
+        return Hash64Size1To3(input, size, seed);
+    }
+    return XXH64Avalanche(seed ^ (ReadLE64(g_secret + 56) ^ ReadLE64(g_secret + 64)));
+}
+
+Hash128 HashShort128(const uint8_t* input, size_t size, uint64_t seed)
+{
+    if (size > 128)
+    {
+        return Hash128Size129To240(input, size, seed);
+    }
+    if (size > 16)
+    {
+        return Hash128Size17To128(input, size, seed);
+    }
+    if (size > 8)
+    {
+        return Hash128Size9To16(input, size, seed);
+    }
+    if (size >= 4)
+    {
+        return Hash128Size4To8(input, size, seed);
+    }
+    if (size > 0)
+    {
+        return Hash128Size1To3(input, size, seed);
+    }
+    const uint64_t bitflipLow = ReadLE64(g_secret + 64) ^ ReadLE64(g_secret + 72);
+    const uint64_t bitflipHigh = ReadLE64(g_secret + 80) ^ ReadLE64(g_secret + 88);
+    return Hash128{ XXH64Avalanche(seed ^ bitflipLow), XXH64Avalanche(seed ^ bitflipHigh) };
+}
+
+// The long inputs are hashed with a secret derived from the seed (the default one if the seed is 0).
+void InitSecret(uint8_t* secret, uint64_t seed)
+{
+    for (size_t i = 0; i < SecretSize; i += 16)
+    {
+        WriteLE64(secret + i, ReadLE64(g_secret + i) + seed);
+        WriteLE64(secret + i + 8, ReadLE64(g_secret + i + 8) - seed);
+    }
+}
+
+void InitAccumulators(uint64_t* acc)
+{
+    acc[0] = Prime32_3;
+    acc[1] = Prime64_1;
+    acc[2] = Prime64_2;
+    acc[3] = Prime64_3;
+    acc[4] = Prime64_4;
+    acc[5] = Prime32_2;
+    acc[6] = Prime64_5;
+    acc[7] = Prime32_1;
+}
+
+// Accumulate the stripes of 64 bytes into the 8 lanes, the secret advancing by 8 bytes per stripe.
+using AccumulateFunc = void (*)(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount);
+// Mix the high bits of the lanes into the low ones after each block.
+using ScrambleFunc = void (*)(uint64_t* acc, const uint8_t* secret);
+
+struct HashKernelFuncs
+{
+    AccumulateFunc accumulate;
+    ScrambleFunc scramble;
+};
+
+void AccumulateGeneric(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    for (size_t n = 0; n < stripeCount; ++n)
+    {
+        const uint8_t* stripe = input + n * StripeSize;
+        const uint8_t* key = secret + n * SecretConsumeRate;
+        for (size_t lane = 0; lane < 8; ++lane)
+        {
+            const uint64_t dataValue = ReadLE64(stripe + lane * 8);
+            const uint64_t dataKey = dataValue ^ ReadLE64(key + lane * 8);
+            // Swap the adjacent lanes.
+            acc[lane ^ 1] += dataValue;
+            acc[lane] += (dataKey & 0xFFFFFFFF) * (dataKey >> 32);
+        }
+    }
+}
+
+void ScrambleGeneric(uint64_t* acc, const uint8_t* secret)
+{
+    for (size_t lane = 0; lane < 8; ++lane)
+    {
+        uint64_t value = XorShift64(acc[lane], 47);
+        value ^= ReadLE64(secret + lane * 8);
+        acc[lane] = value * Prime32_1;
+    }
+}
+
+#if defined(RAD_HASH_X86)
+void AccumulateSse2(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+    __m128i a[4] = { xacc[0], xacc[1], xacc[2], xacc[3] };
+    for (size_t n = 0; n < stripeCount; ++n)
+    {
+        const __m128i* xinput = reinterpret_cast<const __m128i*>(input + n * StripeSize);
+        const __m128i* xsecret = reinterpret_cast<const __m128i*>(secret + n * SecretConsumeRate);
+        for (int i = 0; i < 4; ++i)
+        {
+            const __m128i dataVec = _mm_loadu_si128(xinput + i);
+            const __m128i keyVec = _mm_loadu_si128(xsecret + i);
+            const __m128i dataKey = _mm_xor_si128(dataVec, keyVec);
+            // (dataKey & 0xFFFFFFFF) * (dataKey >> 32)
+            const __m128i dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+            const __m128i product = _mm_mul_epu32(dataKey, dataKeyHigh);
+            const __m128i dataSwap = _mm_shuffle_epi32(dataVec, _MM_SHUFFLE(1, 0, 3, 2));
+            a[i] = _mm_add_epi64(product, _mm_add_epi64(a[i], dataSwap));
+        }
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        xacc[i] = a[i];
+    }
+}
+
+void ScrambleSse2(uint64_t* acc, const uint8_t* secret)
+{
+    __m128i* xacc = reinterpret_cast<__m128i*>(acc);
+    const __m128i* xsecret = reinterpret_cast<const __m128i*>(secret);
+    const __m128i prime = _mm_set1_epi32(static_cast<int>(Prime32_1));
+    for (int i = 0; i < 4; ++i)
+    {
+        const __m128i accVec = xacc[i];
+        const __m128i dataVec = _mm_xor_si128(accVec, _mm_srli_epi64(accVec, 47));
+        const __m128i dataKey = _mm_xor_si128(dataVec, _mm_loadu_si128(xsecret + i));
+        const __m128i dataKeyHigh = _mm_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m128i productLow = _mm_mul_epu32(dataKey, prime);
+        const __m128i productHigh = _mm_mul_epu32(dataKeyHigh, prime);
+        xacc[i] = _mm_add_epi64(productLow, _mm_slli_epi64(productHigh, 32));
+    }
+}
+
+RAD_TARGET_AVX2
+void AccumulateAvx2(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    __m256i* xacc = reinterpret_cast<__m256i*>(acc);
+    __m256i a0 = _mm256_load_si256(xacc);
+    __m256i a1 = _mm256_load_si256(xacc + 1);
+    for (size_t n = 0; n < stripeCount; ++n)
+    {
+        const __m256i* xinput = reinterpret_cast<const __m256i*>(input + n * StripeSize);
+        const __m256i* xsecret = reinterpret_cast<const __m256i*>(secret + n * SecretConsumeRate);
+        const __m256i dataVec0 = _mm256_loadu_si256(xinput);
+        const __m256i dataVec1 = _mm256_loadu_si256(xinput + 1);
+        const __m256i dataKey0 = _mm256_xor_si256(dataVec0, _mm256_loadu_si256(xsecret));
+        const __m256i dataKey1 = _mm256_xor_si256(dataVec1, _mm256_loadu_si256(xsecret + 1));
+        const __m256i product0 = _mm256_mul_epu32(dataKey0, _mm256_shuffle_epi32(dataKey0, _MM_SHUFFLE(0, 3, 0, 1)));
+        const __m256i product1 = _mm256_mul_epu32(dataKey1, _mm256_shuffle_epi32(dataKey1, _MM_SHUFFLE(0, 3, 0, 1)));
+        a0 = _mm256_add_epi64(product0, _mm256_add_epi64(a0, _mm256_shuffle_epi32(dataVec0, _MM_SHUFFLE(1, 0, 3, 2))));
+        a1 = _mm256_add_epi64(product1, _mm256_add_epi64(a1, _mm256_shuffle_epi32(dataVec1, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+    _mm256_store_si256(xacc, a0);
+    _mm256_store_si256(xacc + 1, a1);
+}
+
+RAD_TARGET_AVX2
+void ScrambleAvx2(uint64_t* acc, const uint8_t* secret)
+{
+    __m256i* xacc = reinterpret_cast<__m256i*>(acc);
+    const __m256i* xsecret = reinterpret_cast<const __m256i*>(secret);
+    const __m256i prime = _mm256_set1_epi32(static_cast<int>(Prime32_1));
+    for (int i = 0; i < 2; ++i)
+    {
+        const __m256i accVec = _mm256_load_si256(xacc + i);
+        const __m256i dataVec = _mm256_xor_si256(accVec, _mm256_srli_epi64(accVec, 47));
+        const __m256i dataKey = _mm256_xor_si256(dataVec, _mm256_loadu_si256(xsecret + i));
+        const __m256i dataKeyHigh = _mm256_shuffle_epi32(dataKey, _MM_SHUFFLE(0, 3, 0, 1));
+        const __m256i productLow = _mm256_mul_epu32(dataKey, prime);
+        const __m256i productHigh = _mm256_mul_epu32(dataKeyHigh, prime);
+        _mm256_store_si256(xacc + i, _mm256_add_epi64(productLow, _mm256_slli_epi64(productHigh, 32)));
+    }
+}
+#endif // RAD_HASH_X86
+
+#if defined(RAD_HASH_NEON)
+void AccumulateNeon(uint64_t* acc, const uint8_t* input, const uint8_t* secret, size_t stripeCount)
+{
+    uint64x2_t a[4] = { vld1q_u64(acc), vld1q_u64(acc + 2), vld1q_u64(acc + 4), vld1q_u64(acc + 6) };
+    for (size_t n = 0; n < stripeCount; ++n)
+    {
+        const uint8_t* stripe = input + n * StripeSize;
+        const uint8_t* key = secret + n * SecretConsumeRate;
+        for (int i = 0; i < 4; ++i)
+        {
+            const uint64x2_t dataVec = vreinterpretq_u64_u8(vld1q_u8(stripe + 16 * i));
+            const uint64x2_t dataKey = veorq_u64(dataVec, vreinterpretq_u64_u8(vld1q_u8(key + 16 * i)));
+            // (dataKey & 0xFFFFFFFF) * (dataKey >> 32)
+            const uint64x2_t product = vmull_u32(vmovn_u64(dataKey), vshrn_n_u64(dataKey, 32));
+            a[i] = vaddq_u64(a[i], vaddq_u64(vextq_u64(dataVec, dataVec, 1), product));
+        }
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+        vst1q_u64(acc + 2 * i, a[i]);
+    }
+}
+
+void ScrambleNeon(uint64_t* acc, const uint8_t* secret)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        const uint64x2_t accVec = vld1q_u64(acc + 2 * i);
+        uint64x2_t dataKey = veorq_u64(accVec, vshrq_n_u64(accVec, 47));
+        dataKey = veorq_u64(dataKey, vreinterpretq_u64_u8(vld1q_u8(secret + 16 * i)));
+        const uint64x2_t productHigh = vshlq_n_u64(vmull_n_u32(vshrn_n_u64(dataKey, 32), Prime32_1), 32);
+        vst1q_u64(acc + 2 * i, vmlal_n_u32(productHigh, vmovn_u64(dataKey), Prime32_1));
+    }
+}
+#endif // RAD_HASH_NEON
+
+HashKernelFuncs GetKernelFuncs(HashKernel kernel)
+{
+    switch (kernel)
+    {
+#if defined(RAD_HASH_X86)
+    case HashKernel::Sse2:
+        return { AccumulateSse2, ScrambleSse2 };
+    case HashKernel::Avx2:
+        return { AccumulateAvx2, ScrambleAvx2 };
+#endif
+#if defined(RAD_HASH_NEON)
+    case HashKernel::Neon:
+        return { AccumulateNeon, ScrambleNeon };
+#endif
+    default:
+        return { AccumulateGeneric, ScrambleGeneric };
+    }
+}
+
+HashKernel CheckKernel(HashKernel kernel)
+{
+    if (!IsHashKernelSupported(kernel))
+    {
+        const HashKernel best = GetBestHashKernel();
+        LogGlobal(Warn, "Hash: {} is not supported, fallback to {}.",
+            GetHashKernelName(kernel), GetHashKernelName(best));
+        return best;
+    }
+    return kernel;
+}
+
+const HashKernelFuncs& GetBestKernelFuncs()
+{
+    static const HashKernelFuncs funcs = GetKernelFuncs(GetBestHashKernel());
+    return funcs;
+}
+
+uint64_t MergeAccumulators(const uint64_t* acc, const uint8_t* secret, uint64_t start)
+{
+    uint64_t result = start;
+    for (size_t i = 0; i < 4; ++i)
+    {
+        result += Multiply128Fold64(acc[2 * i] ^ ReadLE64(secret + 16 * i),
+            acc[2 * i + 1] ^ ReadLE64(secret + 16 * i + 8));
+    }
+    return Avalanche(result);
+}
+
+// Accumulate the whole input: full blocks with a scramble after each, the remaining stripes,
+// and the last 64 bytes (overlapping the previous stripe).
+void HashLong(uint64_t* acc, const uint8_t* input, size_t size, const uint8_t* secret,
+    const HashKernelFuncs& funcs)
+{
+    InitAccumulators(acc);
+    const size_t blockCount = (size - 1) / BlockSize;
+    for (size_t n = 0; n < blockCount; ++n)
+    {
+        funcs.accumulate(acc, input + n * BlockSize, secret, StripesPerBlock);
+        funcs.scramble(acc, secret + SecretSize - StripeSize);
+    }
+    const size_t stripeCount = ((size - 1) - BlockSize * blockCount) / StripeSize;
+    funcs.accumulate(acc, input + blockCount * BlockSize, secret, stripeCount);
+    funcs.accumulate(acc, input + size - StripeSize, secret + SecretSize - StripeSize - SecretLastAccStart, 1);
+}
+
+Hash128 MergeAccumulators128(const uint64_t* acc, const uint8_t* secret, uint64_t size)
+{
+    Hash128 h;
+    h.low = MergeAccumulators(acc, secret + SecretMergeAccsStart, size * Prime64_1);
+    h.high = MergeAccumulators(acc, secret + SecretSize - 64 - SecretMergeAccsStart, ~(size * Prime64_2));
+    return h;
+}
+
+uint64_t HashBytes64(const uint8_t* input, size_t size, uint64_t seed, const HashKernelFuncs& funcs)
+{
+    if (size <= MidSizeMax)
+    {
+        return HashShort64(input, size, seed);
+    }
+    alignas(64) uint64_t acc[8];
+    alignas(64) uint8_t customSecret[SecretSize];
+    const uint8_t* secret = g_secret;
+    if (seed != 0)
+    {
+        InitSecret(customSecret, seed);
+        secret = customSecret;
+    }
+    HashLong(acc, input, size, secret, funcs);
+    return MergeAccumulators(acc, secret + SecretMergeAccsStart, size * Prime64_1);
+}
+
+Hash128 HashBytes128(const uint8_t* input, size_t size, uint64_t seed, const HashKernelFuncs& funcs)
+{
+    if (size <= MidSizeMax)
+    {
+        return HashShort128(input, size, seed);
+    }
+    alignas(64) uint64_t acc[8];
+    alignas(64) uint8_t customSecret[SecretSize];
+    const uint8_t* secret = g_secret;
+    if (seed != 0)
+    {
+        InitSecret(customSecret, seed);
+        secret = customSecret;
+    }
+    HashLong(acc, input, size, secret, funcs);
+    return MergeAccumulators128(acc, secret, size);
+}
+
+} // namespace
+
+std::string Hash128::ToString() const
+{
+    return StrFormat("{:016x}{:016x}", high, low);
+}
+
+bool IsHashKernelSupported(HashKernel kernel)
+{
+    switch (kernel)
+    {
+    case HashKernel::Generic:
+        return true;
+#if defined(RAD_HASH_X86)
+    case HashKernel::Sse2:
+        // Baseline of x86-64.
+        return true;
+    case HashKernel::Avx2:
+    {
+        static const bool hasAvx2 = cpu_features::GetX86Info().features.avx2;
+        return hasAvx2;
+    }
+#endif
+#if defined(RAD_HASH_NEON)
+    case HashKernel::Neon:
+        // Baseline of AArch64.
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+HashKernel GetBestHashKernel()
+{
+    for (HashKernel kernel : { HashKernel::Avx2, HashKernel::Neon, HashKernel::Sse2 })
+    {
+        if (IsHashKernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return HashKernel::Generic;
+}
+
+const char* GetHashKernelName(HashKernel kernel)
+{
+    switch (kernel)
+    {
+    case HashKernel::Generic: return "Generic";
+    case HashKernel::Sse2: return "SSE2";
+    case HashKernel::Avx2: return "AVX2";
+    case HashKernel::Neon: return "NEON";
+    }
+    return "Unknown";
+}
+
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed)
+{
+    return HashBytes64(static_cast<const uint8_t*>(data), size, seed, GetBestKernelFuncs());
+}
+
+Hash128 HashBytes128(const void* data, size_t size, uint64_t seed)
+{
+    return HashBytes128(static_cast<const uint8_t*>(data), size, seed, GetBestKernelFuncs());
+}
+
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed, HashKernel kernel)
+{
+    return HashBytes64(static_cast<const uint8_t*>(data), size, seed, GetKernelFuncs(CheckKernel(kernel)));
+}
+
+Hash128 HashBytes128(const void* data, size_t size, uint64_t seed, HashKernel kernel)
+{
+    return HashBytes128(static_cast<const uint8_t*>(data), size, seed, GetKernelFuncs(CheckKernel(kernel)));
+}
+
+Hasher::Hasher() :
+    Hasher(0)
+{
+}
+
+Hasher::Hasher(uint64_t seed) :
+    m_kernel(GetBestHashKernel())
+{
+    Reset(seed);
+}
+
+Hasher::Hasher(uint64_t seed, HashKernel kernel) :
+    m_kernel(CheckKernel(kernel))
+{
+    Reset(seed);
+}
+
+Hasher::~Hasher()
+{
+}
+
+void Hasher::Reset()
+{
+    Reset(m_seed);
+}
+
+void Hasher::Reset(uint64_t seed)
+{
+    InitAccumulators(m_acc);
+    InitSecret(m_secret, seed);
+    m_bufferedSize = 0;
+    m_stripesSoFar = 0;
+    m_totalSize = 0;
+    m_seed = seed;
+}
+
+void Hasher::ConsumeStripes(uint64_t* acc, size_t* stripesSoFar, const uint8_t* input, size_t stripeCount) const
+{
+    const HashKernelFuncs funcs = GetKernelFuncs(m_kernel);
+    const uint8_t* secret = m_secret + *stripesSoFar * SecretConsumeRate;
+    if (stripeCount >= StripesPerBlock - *stripesSoFar)
+    {
+        // Complete the current block, then the full blocks.
+        size_t count = StripesPerBlock - *stripesSoFar;
+        do
+        {
+            funcs.accumulate(acc, input, secret, count);
+            funcs.scramble(acc, m_secret + SecretSize - StripeSize);
+            input += count * StripeSize;
+            stripeCount -= count;
+            count = StripesPerBlock;
+            secret = m_secret;
+        } while (stripeCount >= StripesPerBlock);
+        *stripesSoFar = 0;
+    }
+    if (stripeCount > 0)
+    {
+        funcs.accumulate(acc, input, secret, stripeCount);
+        *stripesSoFar += stripeCount;
+    }
+}
+
+void Hasher::Update(const void* data, size_t size)
+{
+    if (size == 0)
+    {
+        return;
+    }
+    const uint8_t* input = static_cast<const uint8_t*>(data);
+    const uint8_t* end = input + size;
+    m_totalSize += size;
+    if (size <= BufferSize - m_bufferedSize)
+    {
+        std::memcpy(m_buffer + m_bufferedSize, input, size);
+        m_bufferedSize += size;
+        return;
+    }
+    // The buffer is consumed only when more input follows, so that the last stripe is always
+    // in the buffer for Digest.
+    if (m_bufferedSize > 0)
+    {
+        const size_t loadSize = BufferSize - m_bufferedSize;
+        std::memcpy(m_buffer + m_bufferedSize, input, loadSize);
+        input += loadSize;
+        ConsumeStripes(m_acc, &m_stripesSoFar, m_buffer, BufferSize / StripeSize);
+        m_bufferedSize = 0;
+    }
+    if (static_cast<size_t>(end - input) > BufferSize)
+    {
+        // Consume the input in place, keeping at least one byte.
+        const size_t stripeCount = static_cast<size_t>(end - 1 - input) / StripeSize;
+        ConsumeStripes(m_acc, &m_stripesSoFar, input, stripeCount);
+        input += stripeCount * StripeSize;
+        // The last stripe consumed, for Digest if less than a stripe remains.
+        std::memcpy(m_buffer + BufferSize - StripeSize, input - StripeSize, StripeSize);
+    }
+    m_bufferedSize = static_cast<size_t>(end - input);
+    std::memcpy(m_buffer, input, m_bufferedSize);
+}
+
+void Hasher::DigestLong(uint64_t* acc) const
+{
+    std::memcpy(acc, m_acc, sizeof(m_acc));
+    alignas(64) uint8_t lastStripe[StripeSize];
+    const uint8_t* lastStripePtr;
+    if (m_bufferedSize >= StripeSize)
+    {
+        const size_t stripeCount = (m_bufferedSize - 1) / StripeSize;
+        size_t stripesSoFar = m_stripesSoFar;
+        ConsumeStripes(acc, &stripesSoFar, m_buffer, stripeCount);
+        lastStripePtr = m_buffer + m_bufferedSize - StripeSize;
+    }
+    else
+    {
+        // The end of the previous stripe (kept at the end of the buffer), and the bytes buffered.
+        const size_t catchupSize = StripeSize - m_bufferedSize;
+        std::memcpy(lastStripe, m_buffer + BufferSize - catchupSize, catchupSize);
+        std::memcpy(lastStripe + catchupSize, m_buffer, m_bufferedSize);
+        lastStripePtr = lastStripe;
+    }
+    GetKernelFuncs(m_kernel).accumulate(acc, lastStripePtr,
+        m_secret + SecretSize - StripeSize - SecretLastAccStart, 1);
+}
+
+uint64_t Hasher::Digest64() const
+{
+    if (m_totalSize > MidSizeMax)
+    {
+        alignas(64) uint64_t acc[8];
+        DigestLong(acc);
+        return MergeAccumulators(acc, m_secret + SecretMergeAccsStart, m_totalSize * Prime64_1);
+    }
+    return HashShort64(m_buffer, static_cast<size_t>(m_totalSize), m_seed);
+}
+
+Hash128 Hasher::Digest128() const
+{
+    if (m_totalSize > MidSizeMax)
+    {
+        alignas(64) uint64_t acc[8];
+        DigestLong(acc);
+        return MergeAccumulators128(acc, m_secret, m_totalSize);
+    }
+    return HashShort128(m_buffer, static_cast<size_t>(m_totalSize), m_seed);
+}
+
+} // namespace rad
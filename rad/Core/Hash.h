@@ -0,0 +1,103 @@
+#pragma once
+
+#include "Global.h"
+#include <string>
+#include <string_view>
+
+namespace rad
+{
+
+struct Hash128
+{
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const Hash128& other) const = default;
+    bool operator<(const Hash128& other) const
+    {
+        return (high != other.high) ? (high < other.high) : (low < other.low);
+    }
+    // 32 hex digits, the high half first (the canonical form of XXH128).
+    std::string ToString() const;
+};
+
+// The instruction sets to accumulate the inputs longer than 240 bytes; all produce the same hashes.
+enum class HashKernel
+{
+    Generic, // Portable, 64-bit multiplies.
+    Sse2,
+    Avx2,
+    Neon,
+};
+
+// Whether the kernel can run on this machine (detected at runtime with cpu_features).
+bool IsHashKernelSupported(HashKernel kernel);
+// The fastest kernel supported.
+HashKernel GetBestHashKernel();
+const char* GetHashKernelName(HashKernel kernel);
+
+// XXH3 (https://github.com/Cyan4973/xxHash), non-cryptographic: fast on short keys and tens of GB/s
+// on long inputs with SIMD, bit-exact with the reference implementation (XXH3_64bits_withSeed
+// and XXH3_128bits_withSeed), so the hashes can be saved to files and compared across machines.
+// Not for untrusted inputs where collisions can be crafted.
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed = 0);
+Hash128 HashBytes128(const void* data, size_t size, uint64_t seed = 0);
+// Use the kernel given (falls back to the best one if not supported).
+uint64_t HashBytes64(const void* data, size_t size, uint64_t seed, HashKernel kernel);
+Hash128 HashBytes128(const void* data, size_t size, uint64_t seed, HashKernel kernel);
+
+inline uint64_t HashString64(std::string_view str, uint64_t seed = 0)
+{
+    return HashBytes64(str.data(), str.size(), seed);
+}
+
+inline Hash128 HashString128(std::string_view str, uint64_t seed = 0)
+{
+    return HashBytes128(str.data(), str.size(), seed);
+}
+
+// Hash an input given in pieces (e.g. read from a stream); the digests are the same as those of
+// HashBytes64/HashBytes128 on the concatenation, and can be taken at any point without ending the stream.
+class Hasher
+{
+public:
+    Hasher();
+    Hasher(uint64_t seed);
+    Hasher(uint64_t seed, HashKernel kernel);
+    ~Hasher();
+
+    // Start a new input, with the same seed or another one.
+    void Reset();
+    void Reset(uint64_t seed);
+    void Update(const void* data, size_t size);
+    void Update(std::string_view str) { Update(str.data(), str.size()); }
+
+    uint64_t Digest64() const;
+    Hash128 Digest128() const;
+
+    uint64_t GetSize() const { return m_totalSize; }
+    HashKernel GetKernel() const { return m_kernel; }
+
+    static constexpr size_t StripeSize = 64;
+    static constexpr size_t SecretSize = 192;
+    static constexpr size_t BufferSize = 256;
+
+private:
+    // Accumulate the stripes of a long input into acc.
+    void ConsumeStripes(uint64_t* acc, size_t* stripesSoFar, const uint8_t* input, size_t stripeCount) const;
+    // Copy the accumulators with the buffered stripes and the last stripe consumed.
+    void DigestLong(uint64_t* acc) const;
+
+    alignas(64) uint64_t m_acc[8];
+    alignas(64) uint8_t m_secret[SecretSize];
+    alignas(64) uint8_t m_buffer[BufferSize];
+    size_t m_bufferedSize = 0;
+    // The stripes accumulated in the current block.
+    size_t m_stripesSoFar = 0;
+    uint64_t m_totalSize = 0;
+    uint64_t m_seed = 0;
+    HashKernel m_kernel;
+
+}; // class Hasher
+
+} // namespace rad
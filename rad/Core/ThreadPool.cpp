@@ -0,0 +1,148 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace rad
+{
+
+ThreadPool::ThreadPool(uint32_t threadCount)
+{
+    threadCount = ResolveThreadCount(threadCount);
+    m_threads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&ThreadPool::WorkerMain, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lockGuard(m_mutex);
+        m_stop = true;
+    }
+    m_taskCond.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::Enqueue(std::function<void()> task)
+{
+    {
+        std::lock_guard lockGuard(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_taskCond.notify_one();
+}
+
+void ThreadPool::WaitIdle()
+{
+    std::unique_lock lock(m_mutex);
+    m_idleCond.wait(lock, [this]() { return m_tasks.empty() && (m_activeCount == 0); });
+}
+
+void ThreadPool::WorkerMain()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(m_mutex);
+            m_taskCond.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+            if (m_tasks.empty())
+            {
+                // Stopped and drained.
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+            m_activeCount++;
+        }
+        task();
+        {
+            std::lock_guard lockGuard(m_mutex);
+            m_activeCount--;
+            if (m_tasks.empty() && (m_activeCount == 0))
+            {
+                m_idleCond.notify_all();
+            }
+        }
+    }
+}
+
+uint32_t ResolveThreadCount(uint32_t threadCount)
+{
+    return (threadCount > 0) ? threadCount : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+void RunOnThreads(uint32_t threadCount, const std::function<void(uint32_t threadIndex)>& func)
+{
+    threadCount = ResolveThreadCount(threadCount);
+    std::mutex mutex;
+    std::exception_ptr exception;
+    auto run = [&](uint32_t threadIndex) {
+        try
+        {
+            func(threadIndex);
+        }
+        catch (...)
+        {
+            std::lock_guard lockGuard(mutex);
+            if (!exception)
+            {
+                exception = std::current_exception();
+            }
+        }
+        };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(run, i);
+    }
+    run(0);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
+void ParallelFor(size_t count, uint32_t threadCount, const std::function<void(size_t index)>& func)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    threadCount = static_cast<uint32_t>(std::min<size_t>(ResolveThreadCount(threadCount), count));
+    std::atomic<size_t> nextIndex = 0;
+    RunOnThreads(threadCount, [&](uint32_t) {
+        while (true)
+        {
+            const size_t i = nextIndex.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count)
+            {
+                break;
+            }
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                // Skip the remaining indices on all threads.
+                nextIndex.store(count, std::memory_order_relaxed);
+                throw;
+            }
+        }
+        });
+}
+
+} // namespace rad
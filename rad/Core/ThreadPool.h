@@ -0,0 +1,72 @@
+#pragma once
+
+#include "Global.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace rad
+{
+
+// A fixed number of worker threads sharing a FIFO task queue.
+class ThreadPool
+{
+public:
+    // @param threadCount: use the hardware concurrency if 0.
+    ThreadPool(uint32_t threadCount = 0);
+    // Wait for all queued tasks to finish.
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_threads.size()); }
+
+    void Enqueue(std::function<void()> task);
+
+    template<typename F>
+    auto Submit(F&& func) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        // std::function requires copyable callables.
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(func));
+        std::future<Result> future = task->get_future();
+        Enqueue([task]() { (*task)(); });
+        return future;
+    }
+
+    // Block until the queue is empty and all workers are idle.
+    void WaitIdle();
+
+private:
+    void WorkerMain();
+
+    std::vector<std::thread> m_threads;
+    std::mutex m_mutex;
+    std::condition_variable m_taskCond;
+    std::condition_variable m_idleCond;
+    std::deque<std::function<void()>> m_tasks;
+    uint32_t m_activeCount = 0;
+    bool m_stop = false;
+
+}; // class ThreadPool
+
+// Use the hardware concurrency if threadCount is 0.
+uint32_t ResolveThreadCount(uint32_t threadCount);
+
+// Call func(threadIndex) on threadCount threads (0 for the hardware concurrency), the index 0 on the calling thread,
+// and return when all have returned; the first exception thrown is rethrown then.
+void RunOnThreads(uint32_t threadCount, const std::function<void(uint32_t threadIndex)>& func);
+
+// Call func(i) for each i in [0, count) on up to threadCount threads (the calling thread included),
+// each taking the next index when done, for tasks of very different costs (e.g. files of any size).
+// After an exception the remaining indices are skipped, and it is rethrown.
+void ParallelFor(size_t count, uint32_t threadCount, const std::function<void(size_t index)>& func);
+
+} // namespace rad
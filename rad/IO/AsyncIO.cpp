@@ -0,0 +1,611 @@
+#include "AsyncIO.h"
+#include "File.h"
+#include "Logging.h"
+#include "rad/Core/ThreadPool.h"
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define RAD_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+namespace rad
+{
+
+AsyncIOEngine::AsyncIOEngine(uint32_t queueDepth) :
+    m_queueDepth(std::max(queueDepth, 1u))
+{
+}
+
+AsyncIOEngine::~AsyncIOEngine()
+{
+}
+
+void AsyncIOEngine::Queue(AsyncIORequest request)
+{
+    if (!m_registeredBuffers.empty() && (request.bufferIndex < 0))
+    {
+        request.bufferIndex = FindRegisteredBuffer(request.buffer, request.size);
+    }
+    if (m_inflightCount + m_queued.size() >= m_queueDepth)
+    {
+        Submit();
+        while (m_inflightCount >= m_queueDepth)
+        {
+            Poll(1);
+        }
+    }
+    m_queued.push_back(std::move(request));
+}
+
+void AsyncIOEngine::Read(int fd, void* buffer, size_t size, uint64_t offset, AsyncIOCallback callback)
+{
+    AsyncIORequest request;
+    request.op = AsyncIOOp::Read;
+    request.fd = fd;
+    request.buffer = buffer;
+    request.size = size;
+    request.offset = offset;
+    request.callback = std::move(callback);
+    Queue(std::move(request));
+}
+
+void AsyncIOEngine::Write(int fd, const void* buffer, size_t size, uint64_t offset, AsyncIOCallback callback)
+{
+    AsyncIORequest request;
+    request.op = AsyncIOOp::Write;
+    request.fd = fd;
+    request.buffer = const_cast<void*>(buffer);
+    request.size = size;
+    request.offset = offset;
+    request.callback = std::move(callback);
+    Queue(std::move(request));
+}
+
+std::future<int64_t> AsyncIOEngine::Read(int fd, void* buffer, size_t size, uint64_t offset)
+{
+    auto promise = std::make_shared<std::promise<int64_t>>();
+    std::future<int64_t> future = promise->get_future();
+    Read(fd, buffer, size, offset, [promise](int64_t result) { promise->set_value(result); });
+    return future;
+}
+
+std::future<int64_t> AsyncIOEngine::Write(int fd, const void* buffer, size_t size, uint64_t offset)
+{
+    auto promise = std::make_shared<std::promise<int64_t>>();
+    std::future<int64_t> future = promise->get_future();
+    Write(fd, buffer, size, offset, [promise](int64_t result) { promise->set_value(result); });
+    return future;
+}
+
+bool AsyncIOEngine::RegisterBuffers(Span<AsyncIOBuffer> buffers)
+{
+    m_registeredBuffers.assign(buffers.begin(), buffers.end());
+    return true;
+}
+
+void AsyncIOEngine::UnregisterBuffers()
+{
+    m_registeredBuffers.clear();
+}
+
+int32_t AsyncIOEngine::FindRegisteredBuffer(const void* buffer, size_t size) const
+{
+    const uint8_t* begin = static_cast<const uint8_t*>(buffer);
+    for (size_t i = 0; i < m_registeredBuffers.size(); ++i)
+    {
+        const uint8_t* registeredBegin = static_cast<const uint8_t*>(m_registeredBuffers[i].data);
+        if ((begin >= registeredBegin) &&
+            (begin + size <= registeredBegin + m_registeredBuffers[i].size))
+        {
+            return static_cast<int32_t>(i);
+        }
+    }
+    return -1;
+}
+
+uint32_t AsyncIOEngine::Submit()
+{
+    if (m_queued.empty())
+    {
+        return 0;
+    }
+    std::vector<AsyncIORequest> requests;
+    requests.swap(m_queued);
+    uint32_t count = SubmitRequests(requests);
+    m_inflightCount += count;
+    return count;
+}
+
+uint32_t AsyncIOEngine::Poll(uint32_t minCompletions)
+{
+    if (m_inflightCount == 0)
+    {
+        return 0;
+    }
+    return ProcessCompletions(std::min(minCompletions, m_inflightCount));
+}
+
+void AsyncIOEngine::WaitAll()
+{
+    // Callbacks may queue more requests.
+    while (!m_queued.empty() || (m_inflightCount > 0))
+    {
+        Submit();
+        Poll(m_inflightCount);
+    }
+}
+
+// Blocking pread/pwrite on worker threads.
+class ThreadPoolAsyncIOEngine : public AsyncIOEngine
+{
+public:
+    ThreadPoolAsyncIOEngine(uint32_t queueDepth, uint32_t threadCount) :
+        AsyncIOEngine(queueDepth),
+        m_threadPool(threadCount)
+    {
+    }
+
+    ~ThreadPoolAsyncIOEngine() override
+    {
+        WaitAll();
+    }
+
+    const char* GetBackendName() const override { return "ThreadPool"; }
+
+protected:
+    struct Completion
+    {
+        AsyncIOCallback callback;
+        int64_t result;
+    };
+
+    uint32_t SubmitRequests(std::vector<AsyncIORequest>& requests) override
+    {
+        for (AsyncIORequest& request : requests)
+        {
+            m_threadPool.Enqueue([this, request = std::move(request)]() mutable {
+                int64_t result = (request.op == AsyncIOOp::Read) ?
+                    File::ReadAt(request.fd, request.buffer, request.size, request.offset) :
+                    File::WriteAt(request.fd, request.buffer, request.size, request.offset);
+                {
+                    std::lock_guard lockGuard(m_completionMutex);
+                    m_completions.push_back({ std::move(request.callback), result });
+                }
+                m_completionCond.notify_one();
+                });
+        }
+        return static_cast<uint32_t>(requests.size());
+    }
+
+    uint32_t ProcessCompletions(uint32_t minCompletions) override
+    {
+        std::deque<Completion> completions;
+        {
+            std::unique_lock lock(m_completionMutex);
+            m_completionCond.wait(lock, [&]() { return (m_completions.size() >= minCompletions); });
+            completions.swap(m_completions);
+        }
+        for (Completion& completion : completions)
+        {
+            m_inflightCount--;
+            if (completion.callback)
+            {
+                completion.callback(completion.result);
+            }
+        }
+        return static_cast<uint32_t>(completions.size());
+    }
+
+private:
+    std::mutex m_completionMutex;
+    std::condition_variable m_completionCond;
+    std::deque<Completion> m_completions;
+    // Destroyed first: join the workers before the completion queue.
+    ThreadPool m_threadPool;
+
+}; // class ThreadPoolAsyncIOEngine
+
+#if defined(RAD_HAS_IO_URING)
+
+static int IoUringSetup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int IoUringRegister(int ringFd, unsigned opcode, const void* arg, unsigned count)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+}
+
+// io_uring with raw syscalls (no liburing dependency).
+class IoUringAsyncIOEngine : public AsyncIOEngine
+{
+public:
+    IoUringAsyncIOEngine(uint32_t queueDepth) :
+        AsyncIOEngine(queueDepth)
+    {
+    }
+
+    ~IoUringAsyncIOEngine() override
+    {
+        if (m_ringFd >= 0)
+        {
+            WaitAll();
+        }
+        Destroy();
+    }
+
+    const char* GetBackendName() const override { return "io_uring"; }
+
+    bool Init()
+    {
+        io_uring_params params = {};
+        m_ringFd = IoUringSetup(m_queueDepth, &params);
+        if (m_ringFd < 0)
+        {
+            LogGlobal(Info, "io_uring_setup failed: {} ({})", strerror(errno), errno);
+            return false;
+        }
+        if (!(params.features & IORING_FEAT_NODROP) || !IsOpSupported(IORING_OP_READ) ||
+            !IsOpSupported(IORING_OP_WRITE))
+        {
+            // Kernel too old (< 5.6).
+            LogGlobal(Info, "io_uring: kernel too old, fallback to thread pool.");
+            Destroy();
+            return false;
+        }
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP);
+        if (singleMap)
+        {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+        m_sqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED)
+        {
+            m_sqRing = nullptr;
+            Destroy();
+            return false;
+        }
+        if (singleMap)
+        {
+            m_cqRing = m_sqRing;
+        }
+        else
+        {
+            m_cqRing = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+            if (m_cqRing == MAP_FAILED)
+            {
+                m_cqRing = nullptr;
+                Destroy();
+                return false;
+            }
+        }
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+        {
+            Destroy();
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        uint8_t* sq = static_cast<uint8_t*>(m_sqRing);
+        m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sqEntries = params.sq_entries;
+        m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        uint8_t* cq = static_cast<uint8_t*>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    bool RegisterBuffers(Span<AsyncIOBuffer> buffers) override
+    {
+        UnregisterBuffers();
+        std::vector<iovec> iovecs(buffers.size());
+        for (size_t i = 0; i < buffers.size(); ++i)
+        {
+            iovecs[i].iov_base = buffers[i].data;
+            iovecs[i].iov_len = buffers[i].size;
+        }
+        if (IoUringRegister(m_ringFd, IORING_REGISTER_BUFFERS,
+            iovecs.data(), static_cast<unsigned>(iovecs.size())) != 0)
+        {
+            LogGlobal(Warn, "io_uring_register(IORING_REGISTER_BUFFERS) failed: {} ({})",
+                strerror(errno), errno);
+            return false;
+        }
+        return AsyncIOEngine::RegisterBuffers(buffers);
+    }
+
+    void UnregisterBuffers() override
+    {
+        if (!m_registeredBuffers.empty())
+        {
+            IoUringRegister(m_ringFd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+        }
+        AsyncIOEngine::UnregisterBuffers();
+    }
+
+protected:
+    uint32_t SubmitRequests(std::vector<AsyncIORequest>& requests) override
+    {
+        for (AsyncIORequest& request : requests)
+        {
+            IoUringRequest* pending = new IoUringRequest{ std::move(request) };
+            if (m_error != 0)
+            {
+                m_failedRequests.push_back(pending);
+                continue;
+            }
+            m_pendingRequests.insert(pending);
+            PushRequest(pending);
+        }
+        if ((m_error == 0) && !Enter(0, 0))
+        {
+            Fail(errno);
+        }
+        return static_cast<uint32_t>(requests.size());
+    }
+
+    uint32_t ProcessCompletions(uint32_t minCompletions) override
+    {
+        uint32_t count = ReapCompletions();
+        while ((count < minCompletions) && (m_error == 0))
+        {
+            if (!Enter(minCompletions - count, IORING_ENTER_GETEVENTS))
+            {
+                Fail(errno);
+                break;
+            }
+            count += ReapCompletions();
+        }
+        return count + ProcessFailedRequests();
+    }
+
+private:
+    struct IoUringRequest
+    {
+        AsyncIORequest request;
+        // The bytes transferred by the previous submissions: short transfers are resubmitted.
+        size_t transferred = 0;
+    };
+
+    bool IsOpSupported(uint8_t op)
+    {
+        std::vector<uint8_t> buffer(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (IoUringRegister(m_ringFd, IORING_REGISTER_PROBE, probe, 256) != 0)
+        {
+            return false;
+        }
+        return (op <= probe->last_op) && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    // Return false with errno set on failure.
+    bool Enter(unsigned minComplete, unsigned flags)
+    {
+        while (true)
+        {
+            int ret = IoUringEnter(m_ringFd, m_pendingSubmitCount, minComplete, flags);
+            if (ret >= 0)
+            {
+                m_pendingSubmitCount -= static_cast<unsigned>(ret);
+                return true;
+            }
+            if (errno != EINTR)
+            {
+                return false;
+            }
+        }
+    }
+
+    // Push the remaining part of the request to the submission queue (submitted by the next Enter);
+    // the length of an entry is 32-bit: larger requests are transferred in several submissions.
+    void PushRequest(IoUringRequest* pending)
+    {
+        const unsigned tail = *m_sqTail;
+        while (tail - std::atomic_ref(*m_sqHead).load(std::memory_order_acquire) >= m_sqEntries)
+        {
+            // The submission queue is full: let the kernel consume.
+            if (!Enter(0, 0))
+            {
+                Fail(errno);
+                return;
+            }
+        }
+        const AsyncIORequest& request = pending->request;
+        const unsigned index = tail & m_sqMask;
+        io_uring_sqe* sqe = &m_sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        const bool isFixed = (request.bufferIndex >= 0);
+        if (request.op == AsyncIOOp::Read)
+        {
+            sqe->opcode = isFixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        }
+        else
+        {
+            sqe->opcode = isFixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        }
+        if (isFixed)
+        {
+            sqe->buf_index = static_cast<uint16_t>(request.bufferIndex);
+        }
+        sqe->fd = request.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(static_cast<uint8_t*>(request.buffer) + pending->transferred);
+        sqe->len = static_cast<uint32_t>(std::min<size_t>(request.size - pending->transferred, UINT32_MAX));
+        sqe->off = request.offset + pending->transferred;
+        sqe->user_data = reinterpret_cast<uint64_t>(pending);
+        m_sqArray[index] = index;
+        std::atomic_ref(*m_sqTail).store(tail + 1, std::memory_order_release);
+        m_pendingSubmitCount++;
+    }
+
+    uint32_t ReapCompletions()
+    {
+        uint32_t count = 0;
+        unsigned head = *m_cqHead;
+        while ((m_error == 0) && (head != std::atomic_ref(*m_cqTail).load(std::memory_order_acquire)))
+        {
+            const io_uring_cqe* cqe = &m_cqes[head & m_cqMask];
+            IoUringRequest* pending = reinterpret_cast<IoUringRequest*>(cqe->user_data);
+            const int32_t res = cqe->res;
+            head++;
+            // Release the entry before the callback, which may poll recursively.
+            std::atomic_ref(*m_cqHead).store(head, std::memory_order_release);
+            if (res > 0)
+            {
+                pending->transferred += static_cast<size_t>(res);
+            }
+            // Loop until done like File::ReadAt/WriteAt: 0 is the end of file.
+            if (((res > 0) && (pending->transferred < pending->request.size)) || (res == -EINTR))
+            {
+                PushRequest(pending);
+                head = *m_cqHead;
+                continue;
+            }
+            m_pendingRequests.erase(pending);
+            std::unique_ptr<IoUringRequest> request(pending);
+            m_inflightCount--;
+            count++;
+            if (request->request.callback)
+            {
+                request->request.callback((res < 0) ? res : static_cast<int64_t>(request->transferred));
+            }
+            head = *m_cqHead;
+        }
+        if ((m_error == 0) && (m_pendingSubmitCount > 0) && !Enter(0, 0))
+        {
+            Fail(errno);
+        }
+        return count;
+    }
+
+    // The ring is unusable: fail all requests in flight with the error (delivered by ProcessCompletions),
+    // and the later ones. The kernel may still complete the requests already submitted,
+    // but their completions are never reaped.
+    void Fail(int err)
+    {
+        if (m_error == 0)
+        {
+            LogGlobal(Error, "io_uring_enter failed: {} ({})", strerror(err), err);
+            m_error = err;
+        }
+        m_failedRequests.insert(m_failedRequests.end(), m_pendingRequests.begin(), m_pendingRequests.end());
+        m_pendingRequests.clear();
+    }
+
+    uint32_t ProcessFailedRequests()
+    {
+        std::vector<IoUringRequest*> failedRequests;
+        failedRequests.swap(m_failedRequests);
+        for (IoUringRequest* pending : failedRequests)
+        {
+            std::unique_ptr<IoUringRequest> request(pending);
+            m_inflightCount--;
+            if (request->request.callback)
+            {
+                request->request.callback(-static_cast<int64_t>(m_error));
+            }
+        }
+        return static_cast<uint32_t>(failedRequests.size());
+    }
+
+    void Destroy()
+    {
+        if (m_sqes)
+        {
+            ::munmap(m_sqes, m_sqesSize);
+            m_sqes = nullptr;
+        }
+        if (m_cqRing && (m_cqRing != m_sqRing))
+        {
+            ::munmap(m_cqRing, m_cqRingSize);
+        }
+        m_cqRing = nullptr;
+        if (m_sqRing)
+        {
+            ::munmap(m_sqRing, m_sqRingSize);
+            m_sqRing = nullptr;
+        }
+        if (m_ringFd >= 0)
+        {
+            ::close(m_ringFd);
+            m_ringFd = -1;
+        }
+    }
+
+    int m_ringFd = -1;
+    void* m_sqRing = nullptr;
+    size_t m_sqRingSize = 0;
+    void* m_cqRing = nullptr;
+    size_t m_cqRingSize = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqesSize = 0;
+
+    unsigned* m_sqHead = nullptr;
+    unsigned* m_sqTail = nullptr;
+    unsigned m_sqMask = 0;
+    unsigned m_sqEntries = 0;
+    unsigned* m_sqArray = nullptr;
+    unsigned* m_cqHead = nullptr;
+    unsigned* m_cqTail = nullptr;
+    unsigned m_cqMask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+    unsigned m_pendingSubmitCount = 0;
+
+    // The requests submitted or in the submission queue.
+    std::unordered_set<IoUringRequest*> m_pendingRequests;
+    std::vector<IoUringRequest*> m_failedRequests;
+    // The errno of the io_uring_enter failure.
+    int m_error = 0;
+
+}; // class IoUringAsyncIOEngine
+
+#endif // RAD_HAS_IO_URING
+
+std::unique_ptr<AsyncIOEngine> AsyncIOEngine::Create(const Options& options)
+{
+#if defined(RAD_HAS_IO_URING)
+    if (!options.forceThreadPool)
+    {
+        auto engine = std::make_unique<IoUringAsyncIOEngine>(options.queueDepth);
+        if (engine->Init())
+        {
+            return engine;
+        }
+    }
+#endif
+    return std::make_unique<ThreadPoolAsyncIOEngine>(options.queueDepth, options.threadCount);
+}
+
+} // namespace rad
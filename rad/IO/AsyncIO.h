@@ -0,0 +1,103 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Container/Span.h"
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+namespace rad
+{
+
+// @param result: the number of bytes transferred, or -errno on failure.
+// Short transfers are continued like File::ReadAt/WriteAt: less than the size only at the end of file.
+using AsyncIOCallback = std::function<void(int64_t result)>;
+
+enum class AsyncIOOp
+{
+    Read,
+    Write,
+};
+
+struct AsyncIORequest
+{
+    AsyncIOOp op = AsyncIOOp::Read;
+    int fd = -1;
+    void* buffer = nullptr;
+    size_t size = 0;
+    uint64_t offset = 0;
+    // Index of the registered buffer that contains [buffer, buffer + size), or -1.
+    int32_t bufferIndex = -1;
+    AsyncIOCallback callback;
+};
+
+struct AsyncIOBuffer
+{
+    void* data;
+    size_t size;
+};
+
+// Batched positional file I/O: requests are queued by Read/Write, sent in batch by Submit,
+// and their callbacks are invoked by Poll/WaitAll in the calling thread.
+// An engine is not thread-safe, use one engine per thread.
+// The engine uses io_uring on Linux, and falls back to a thread pool doing pread/pwrite.
+class AsyncIOEngine
+{
+public:
+    struct Options
+    {
+        // The max number of requests in flight.
+        uint32_t queueDepth = 128;
+        // Worker threads of the fallback engine; 0 for the hardware concurrency.
+        uint32_t threadCount = 0;
+        bool forceThreadPool = false;
+    };
+
+    static std::unique_ptr<AsyncIOEngine> Create(const Options& options);
+    static std::unique_ptr<AsyncIOEngine> Create() { return Create(Options()); }
+    virtual ~AsyncIOEngine();
+
+    virtual const char* GetBackendName() const = 0;
+    uint32_t GetQueueDepth() const { return m_queueDepth; }
+    uint32_t GetQueuedCount() const { return static_cast<uint32_t>(m_queued.size()); }
+    uint32_t GetInflightCount() const { return m_inflightCount; }
+
+    // Queue a request, Submit and Poll if the queue depth is reached.
+    void Queue(AsyncIORequest request);
+    void Read(int fd, void* buffer, size_t size, uint64_t offset, AsyncIOCallback callback);
+    void Write(int fd, const void* buffer, size_t size, uint64_t offset, AsyncIOCallback callback);
+    // The futures are fulfilled in Poll/WaitAll.
+    std::future<int64_t> Read(int fd, void* buffer, size_t size, uint64_t offset);
+    std::future<int64_t> Write(int fd, const void* buffer, size_t size, uint64_t offset);
+
+    // Register buffers to be reused for many requests (pinned by the kernel with io_uring);
+    // the buffers must stay valid until UnregisterBuffers or the engine is destroyed.
+    virtual bool RegisterBuffers(Span<AsyncIOBuffer> buffers);
+    virtual void UnregisterBuffers();
+    // Find the registered buffer containing the range, return -1 if not found.
+    int32_t FindRegisteredBuffer(const void* buffer, size_t size) const;
+
+    // Send all queued requests, return the number of requests submitted.
+    uint32_t Submit();
+    // Invoke the callbacks of completed requests, wait for at least minCompletions;
+    // return the number of completions processed.
+    uint32_t Poll(uint32_t minCompletions = 0);
+    // Submit and wait for all requests to complete.
+    void WaitAll();
+
+protected:
+    AsyncIOEngine(uint32_t queueDepth);
+
+    virtual uint32_t SubmitRequests(std::vector<AsyncIORequest>& requests) = 0;
+    // Return the number of completions processed.
+    virtual uint32_t ProcessCompletions(uint32_t minCompletions) = 0;
+
+    uint32_t m_queueDepth = 0;
+    std::vector<AsyncIORequest> m_queued;
+    uint32_t m_inflightCount = 0;
+    std::vector<AsyncIOBuffer> m_registeredBuffers;
+
+}; // class AsyncIOEngine
+
+} // namespace rad
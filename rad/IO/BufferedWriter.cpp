@@ -0,0 +1,319 @@
+#include "BufferedWriter.h"
+#include "File.h"
+#include "Logging.h"
+#include "rad/Core/Memory.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rad
+{
+
+BufferedWriter::BufferedWriter()
+{
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    Close();
+}
+
+bool BufferedWriter::Open(std::string_view fileName, const Options& options)
+{
+    Close();
+    const std::string path(fileName);
+    m_options = options;
+    m_options.alignment = std::max<size_t>(m_options.alignment, 64);
+    m_options.bufferSize = std::max(m_options.bufferSize, m_options.alignment);
+    m_options.bufferSize = (m_options.bufferSize + m_options.alignment - 1) / m_options.alignment * m_options.alignment;
+
+#ifdef _WIN32
+    const DWORD flags = FILE_ATTRIBUTE_NORMAL | (options.directIO ? FILE_FLAG_NO_BUFFERING : 0);
+    HANDLE handle = CreateFileW(StrU8ToWide(path).c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+        CREATE_ALWAYS, flags, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        LogGlobal(Error, "BufferedWriter::Open: failed to open {}: error={}", path, GetLastError());
+        return false;
+    }
+    m_fd = _open_osfhandle(reinterpret_cast<intptr_t>(handle), _O_WRONLY | _O_BINARY);
+    if (m_fd < 0)
+    {
+        CloseHandle(handle);
+        LogGlobal(Error, "BufferedWriter::Open: _open_osfhandle failed for {}", path);
+        return false;
+    }
+    m_isDirectIO = options.directIO;
+#else
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+#if defined(O_DIRECT)
+    if (options.directIO)
+    {
+        m_fd = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        if (m_fd >= 0)
+        {
+            m_isDirectIO = true;
+        }
+        else if (errno == EINVAL)
+        {
+            LogGlobal(Warn, "BufferedWriter::Open: O_DIRECT is not supported for {}, fallback to buffered I/O.", path);
+        }
+    }
+#endif
+    if (m_fd < 0)
+    {
+        m_fd = ::open(path.c_str(), flags, 0644);
+    }
+    if (m_fd < 0)
+    {
+        LogGlobal(Error, "BufferedWriter::Open: failed to open {}: {} ({})", path, strerror(errno), errno);
+        return false;
+    }
+#if defined(__APPLE__)
+    if (options.directIO && (::fcntl(m_fd, F_NOCACHE, 1) == 0))
+    {
+        m_isDirectIO = true;
+    }
+#endif
+#endif
+
+    m_path = path;
+    for (uint8_t*& buffer : m_buffers)
+    {
+        buffer = static_cast<uint8_t*>(AlignedAlloc(m_options.bufferSize, m_options.alignment));
+    }
+    m_currentBuffer = 0;
+    m_used = 0;
+    m_bufferOffset = 0;
+    m_size = 0;
+    m_unsyncedBytes = 0;
+    m_hasError = false;
+    m_stop = false;
+    if (m_options.backgroundFlush)
+    {
+        m_flushThread = std::thread(&BufferedWriter::FlushThreadMain, this);
+    }
+    return true;
+}
+
+bool BufferedWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return true;
+    }
+    bool result = Flush();
+    if (m_flushThread.joinable())
+    {
+        {
+            std::lock_guard lockGuard(m_mutex);
+            m_stop = true;
+        }
+        m_pendingCond.notify_one();
+        m_flushThread.join();
+    }
+    if ((m_options.syncPolicy != SyncPolicy::None) && result)
+    {
+        result = SyncFile();
+    }
+#ifdef _WIN32
+    _close(m_fd);
+#else
+    ::close(m_fd);
+#endif
+    m_fd = -1;
+    m_isDirectIO = false;
+    for (uint8_t*& buffer : m_buffers)
+    {
+        AlignedFree(buffer);
+        buffer = nullptr;
+    }
+    return result;
+}
+
+bool BufferedWriter::Write(const void* data, size_t size)
+{
+    if (!IsOpen() || m_hasError)
+    {
+        return false;
+    }
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        const size_t bytesToCopy = std::min(size, m_options.bufferSize - m_used);
+        std::memcpy(m_buffers[m_currentBuffer] + m_used, p, bytesToCopy);
+        m_used += bytesToCopy;
+        m_size += bytesToCopy;
+        p += bytesToCopy;
+        size -= bytesToCopy;
+        if (m_used == m_options.bufferSize)
+        {
+            if (!SubmitBuffer())
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool BufferedWriter::Flush()
+{
+    if (!IsOpen())
+    {
+        return false;
+    }
+    WaitForPendingWrite();
+    if ((m_used > 0) && !m_hasError)
+    {
+        uint8_t* buffer = m_buffers[m_currentBuffer];
+        if (!WriteBuffer(buffer, m_used, m_bufferOffset))
+        {
+            m_hasError = true;
+            return false;
+        }
+        // With direct I/O the partial block was written with padding: keep it in the buffer
+        // to be rewritten later, and cut the padding off the file.
+        const size_t tail = m_isDirectIO ? (m_used % m_options.alignment) : 0;
+        if (tail > 0)
+        {
+            std::memmove(buffer, buffer + m_used - tail, tail);
+            if (!TruncateFile(m_size))
+            {
+                m_hasError = true;
+            }
+        }
+        m_bufferOffset += m_used - tail;
+        m_used = tail;
+    }
+    return !m_hasError;
+}
+
+bool BufferedWriter::Sync()
+{
+    return Flush() && SyncFile();
+}
+
+bool BufferedWriter::WriteBuffer(uint8_t* data, size_t size, uint64_t offset)
+{
+    size_t writeSize = size;
+    if (m_isDirectIO)
+    {
+        writeSize = (size + m_options.alignment - 1) / m_options.alignment * m_options.alignment;
+        std::memset(data + size, 0, writeSize - size);
+    }
+    const int64_t bytesWritten = File::WriteAt(m_fd, data, writeSize, offset);
+    if (bytesWritten != static_cast<int64_t>(writeSize))
+    {
+        LogGlobal(Error, "BufferedWriter: failed to write {} bytes at {} to {}: {}",
+            writeSize, offset, m_path, bytesWritten);
+        return false;
+    }
+    m_unsyncedBytes += size;
+    if ((m_options.syncPolicy == SyncPolicy::EveryFlush) ||
+        ((m_options.syncPolicy == SyncPolicy::Interval) && (m_unsyncedBytes >= m_options.syncInterval)))
+    {
+        return SyncFile();
+    }
+    return true;
+}
+
+bool BufferedWriter::SyncFile()
+{
+#ifdef _WIN32
+    const bool result = FlushFileBuffers(reinterpret_cast<HANDLE>(_get_osfhandle(m_fd)));
+#elif defined(__linux__)
+    const bool result = (::fdatasync(m_fd) == 0);
+#else
+    const bool result = (::fsync(m_fd) == 0);
+#endif
+    if (!result)
+    {
+        LogGlobal(Error, "BufferedWriter: failed to sync {}.", m_path);
+        return false;
+    }
+    m_unsyncedBytes = 0;
+    return true;
+}
+
+bool BufferedWriter::TruncateFile(uint64_t size)
+{
+#ifdef _WIN32
+    const bool result = (_chsize_s(m_fd, static_cast<int64_t>(size)) == 0);
+#else
+    const bool result = (::ftruncate(m_fd, static_cast<off_t>(size)) == 0);
+#endif
+    if (!result)
+    {
+        LogGlobal(Error, "BufferedWriter: failed to truncate {} to {} bytes.", m_path, size);
+    }
+    return result;
+}
+
+bool BufferedWriter::SubmitBuffer()
+{
+    if (m_flushThread.joinable())
+    {
+        WaitForPendingWrite();
+        if (m_hasError)
+        {
+            return false;
+        }
+        {
+            std::lock_guard lockGuard(m_mutex);
+            m_pendingData = m_buffers[m_currentBuffer];
+            m_pendingSize = m_used;
+            m_pendingOffset = m_bufferOffset;
+        }
+        m_pendingCond.notify_one();
+        m_currentBuffer ^= 1;
+    }
+    else if (!WriteBuffer(m_buffers[m_currentBuffer], m_used, m_bufferOffset))
+    {
+        m_hasError = true;
+        return false;
+    }
+    m_bufferOffset += m_used;
+    m_used = 0;
+    return true;
+}
+
+void BufferedWriter::WaitForPendingWrite()
+{
+    std::unique_lock lock(m_mutex);
+    m_doneCond.wait(lock, [&]() { return (m_pendingData == nullptr); });
+}
+
+void BufferedWriter::FlushThreadMain()
+{
+    std::unique_lock lock(m_mutex);
+    while (true)
+    {
+        m_pendingCond.wait(lock, [&]() { return (m_pendingData != nullptr) || m_stop; });
+        if (m_pendingData == nullptr)
+        {
+            break;
+        }
+        lock.unlock();
+        const bool result = WriteBuffer(m_pendingData, m_pendingSize, m_pendingOffset);
+        lock.lock();
+        if (!result)
+        {
+            m_hasError = true;
+        }
+        m_pendingData = nullptr;
+        m_doneCond.notify_all();
+    }
+}
+
+} // namespace rad
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace rad
+{
+
+// Write combining for bulk output: small writes are gathered in a large aligned buffer,
+// full buffers are written by a background thread while the producer fills the other one,
+// so the producer only waits when the disk is slower than itself.
+class BufferedWriter
+{
+public:
+    enum class SyncPolicy
+    {
+        None,       // Leave the write back to the OS.
+        OnClose,    // fdatasync once in Close.
+        Interval,   // fdatasync every syncInterval bytes, and in Close.
+        EveryFlush, // fdatasync after every buffer written.
+    };
+
+    struct Options
+    {
+        // Rounded up to a multiple of the alignment.
+        size_t bufferSize = 4 * 1024 * 1024;
+        // Alignment of the buffers, and of the file offsets and sizes with direct I/O.
+        size_t alignment = 4096;
+        // Bypass the page cache (O_DIRECT, F_NOCACHE or FILE_FLAG_NO_BUFFERING) so that streaming
+        // writes don't evict hot data; fallback to buffered I/O if not supported by the file system.
+        bool directIO = false;
+        // Write full buffers on a background thread (double buffering).
+        bool backgroundFlush = true;
+        SyncPolicy syncPolicy = SyncPolicy::OnClose;
+        // Bytes between fdatasync calls of SyncPolicy::Interval.
+        uint64_t syncInterval = 64 * 1024 * 1024;
+    };
+
+    BufferedWriter();
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    // Create or truncate the file.
+    bool Open(std::string_view fileName, const Options& options);
+    bool Open(std::string_view fileName) { return Open(fileName, Options()); }
+    // Flush, sync by the policy and close; return false if any write failed.
+    bool Close();
+    bool IsOpen() const { return (m_fd >= 0); }
+    bool IsDirectIO() const { return m_isDirectIO; }
+    const std::string& GetPath() const { return m_path; }
+
+    // Return false if the file is not open or a previous write failed.
+    bool Write(const void* data, size_t size);
+    bool Write(std::string_view str) { return Write(str.data(), str.size()); }
+    // Write the buffered data to the file and wait for completion.
+    bool Flush();
+    // Flush and fdatasync.
+    bool Sync();
+
+    // The number of bytes written by the user.
+    uint64_t GetSize() const { return m_size; }
+
+private:
+    // Write the buffer at the offset (padded to the alignment with direct I/O), and sync by the policy.
+    bool WriteBuffer(uint8_t* data, size_t size, uint64_t offset);
+    bool SyncFile();
+    bool TruncateFile(uint64_t size);
+    // Send the full current buffer to the background thread (or write it), and switch buffers.
+    bool SubmitBuffer();
+    void WaitForPendingWrite();
+    void FlushThreadMain();
+
+    std::string m_path;
+    int m_fd = -1;
+    Options m_options;
+    bool m_isDirectIO = false;
+
+    uint8_t* m_buffers[2] = {};
+    uint32_t m_currentBuffer = 0;
+    // Bytes used in the current buffer.
+    size_t m_used = 0;
+    // File offset of the current buffer.
+    uint64_t m_bufferOffset = 0;
+    uint64_t m_size = 0;
+    uint64_t m_unsyncedBytes = 0;
+    std::atomic<bool> m_hasError = false;
+
+    // At most one buffer is being written in the background.
+    std::thread m_flushThread;
+    std::mutex m_mutex;
+    std::condition_variable m_pendingCond;
+    std::condition_variable m_doneCond;
+    uint8_t* m_pendingData = nullptr;
+    size_t m_pendingSize = 0;
+    uint64_t m_pendingOffset = 0;
+    bool m_stop = false;
+
+}; // class BufferedWriter
+
+} // namespace rad
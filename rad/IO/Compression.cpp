@@ -0,0 +1,497 @@
+#include "Compression.h"
+#include "Logging.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <zstd.h>
+
+namespace rad
+{
+
+// The zstd seekable format: https://github.com/facebook/zstd/blob/dev/contrib/seekable_format/zstd_seekable_compression_format.md
+static constexpr uint32_t SkippableFrameMagic = 0x184D2A5E;
+static constexpr uint32_t SeekableMagic = 0x8F92EAB1;
+static constexpr size_t SeekTableFooterSize = 9;
+static constexpr size_t SkippableHeaderSize = 8;
+
+static void StoreLE32(uint8_t* p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static uint32_t LoadLE32(const uint8_t* p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+bool IsCompressedData(const void* data, size_t size)
+{
+    if (size < 4)
+    {
+        return false;
+    }
+    const uint32_t magic = LoadLE32(static_cast<const uint8_t*>(data));
+    return (magic == ZSTD_MAGICNUMBER) ||
+        ((magic & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START);
+}
+
+CompressedWriter::CompressedWriter()
+{
+}
+
+CompressedWriter::~CompressedWriter()
+{
+    Close();
+}
+
+bool CompressedWriter::Open(std::string_view fileName, const Options& options)
+{
+    Close();
+    m_options = options;
+    // The seek table stores 32-bit sizes.
+    m_options.blockSize = std::clamp<size_t>(m_options.blockSize, 4096, 1u << 30);
+    if (!m_writer.Open(fileName, m_options.writerOptions))
+    {
+        return false;
+    }
+    m_threadPool = std::make_unique<ThreadPool>(m_options.threadCount);
+    m_block.reserve(m_options.blockSize);
+    m_frames.clear();
+    m_size = 0;
+    m_hasError = false;
+    return true;
+}
+
+bool CompressedWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return true;
+    }
+    SubmitBlock();
+    while (!m_pendingBlocks.empty())
+    {
+        WriteFrontBlock();
+    }
+
+    std::vector<uint8_t> seekTable(SkippableHeaderSize + m_frames.size() * 8 + SeekTableFooterSize);
+    uint8_t* p = seekTable.data();
+    StoreLE32(p, SkippableFrameMagic);
+    StoreLE32(p + 4, static_cast<uint32_t>(seekTable.size() - SkippableHeaderSize));
+    p += SkippableHeaderSize;
+    for (const FrameSize& frame : m_frames)
+    {
+        StoreLE32(p, frame.compressedSize);
+        StoreLE32(p + 4, frame.decompressedSize);
+        p += 8;
+    }
+    StoreLE32(p, static_cast<uint32_t>(m_frames.size()));
+    p[4] = 0; // Seek_Table_Descriptor: no checksums (each frame has its own content checksum).
+    StoreLE32(p + 5, SeekableMagic);
+    m_writer.Write(seekTable.data(), seekTable.size());
+
+    const bool result = m_writer.Close() && !m_hasError;
+    m_threadPool.reset();
+    for (ZSTD_CCtx* context : m_contexts)
+    {
+        ZSTD_freeCCtx(context);
+    }
+    m_contexts.clear();
+    m_block = {};
+    return result;
+}
+
+bool CompressedWriter::Write(const void* data, size_t size)
+{
+    if (!IsOpen() || m_hasError)
+    {
+        return false;
+    }
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0)
+    {
+        const size_t bytesToCopy = std::min(size, m_options.blockSize - m_block.size());
+        m_block.insert(m_block.end(), p, p + bytesToCopy);
+        p += bytesToCopy;
+        size -= bytesToCopy;
+        m_size += bytesToCopy;
+        if (m_block.size() == m_options.blockSize)
+        {
+            SubmitBlock();
+        }
+    }
+    return !m_hasError;
+}
+
+void CompressedWriter::SubmitBlock()
+{
+    if (m_block.empty())
+    {
+        return;
+    }
+    const uint32_t blockSize = static_cast<uint32_t>(m_block.size());
+    m_pendingBlocks.emplace_back(
+        m_threadPool->Submit([this, block = std::move(m_block)]() { return CompressBlock(block); }),
+        blockSize);
+    m_block = {};
+    m_block.reserve(m_options.blockSize);
+
+    // Write the blocks done, and limit the memory of blocks in flight.
+    const size_t maxPendingCount = size_t(m_threadPool->GetThreadCount()) * 2;
+    while (!m_pendingBlocks.empty() &&
+        ((m_pendingBlocks.size() > maxPendingCount) ||
+        (m_pendingBlocks.front().first.wait_for(std::chrono::seconds(0)) == std::future_status::ready)))
+    {
+        WriteFrontBlock();
+    }
+}
+
+bool CompressedWriter::WriteFrontBlock()
+{
+    std::vector<uint8_t> compressed = m_pendingBlocks.front().first.get();
+    const uint32_t decompressedSize = m_pendingBlocks.front().second;
+    m_pendingBlocks.pop_front();
+    if (compressed.empty() || !m_writer.Write(compressed.data(), compressed.size()))
+    {
+        m_hasError = true;
+        return false;
+    }
+    m_frames.push_back({ static_cast<uint32_t>(compressed.size()), decompressedSize });
+    return true;
+}
+
+std::vector<uint8_t> CompressedWriter::CompressBlock(const std::vector<uint8_t>& block)
+{
+    ZSTD_CCtx* context = nullptr;
+    {
+        std::lock_guard lockGuard(m_contextMutex);
+        if (!m_contexts.empty())
+        {
+            context = m_contexts.back();
+            m_contexts.pop_back();
+        }
+    }
+    if (context == nullptr)
+    {
+        context = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, m_options.level);
+        ZSTD_CCtx_setParameter(context, ZSTD_c_checksumFlag, 1);
+    }
+
+    std::vector<uint8_t> compressed(ZSTD_compressBound(block.size()));
+    const size_t result = ZSTD_compress2(context, compressed.data(), compressed.size(),
+        block.data(), block.size());
+    if (ZSTD_isError(result))
+    {
+        LogGlobal(Error, "CompressedWriter: ZSTD_compress2 failed: {}", ZSTD_getErrorName(result));
+        compressed.clear();
+    }
+    else
+    {
+        compressed.resize(result);
+    }
+
+    std::lock_guard lockGuard(m_contextMutex);
+    m_contexts.push_back(context);
+    return compressed;
+}
+
+CompressedReader::CompressedReader()
+{
+}
+
+CompressedReader::~CompressedReader()
+{
+    Close();
+}
+
+bool CompressedReader::Open(std::string_view fileName)
+{
+    Close();
+    if (!m_file.Open(fileName, "rb"))
+    {
+        return false;
+    }
+    m_fileSize = m_file.GetSize();
+
+    uint8_t magic[4] = {};
+    const bool isZstd = (m_file.ReadAt(magic, sizeof(magic), 0) == sizeof(magic)) &&
+        IsCompressedData(magic, sizeof(magic));
+    if (!isZstd)
+    {
+        m_format = Format::Raw;
+        m_size = m_fileSize;
+    }
+    else if (LoadSeekTable())
+    {
+        m_format = Format::ZstdSeekable;
+        m_context = ZSTD_createDCtx();
+    }
+    else
+    {
+        m_format = Format::Zstd;
+        m_context = ZSTD_createDCtx();
+    }
+    return true;
+}
+
+void CompressedReader::Close()
+{
+    if (m_file.IsOpen())
+    {
+        m_file.Close();
+    }
+    if (m_context)
+    {
+        ZSTD_freeDCtx(m_context);
+        m_context = nullptr;
+    }
+    m_format = Format::Raw;
+    m_fileSize = 0;
+    m_size = 0;
+    m_position = 0;
+    m_frames.clear();
+    m_frameIndex = SIZE_MAX;
+    m_input.clear();
+    m_inputPos = 0;
+    m_inputOffset = 0;
+}
+
+bool CompressedReader::LoadSeekTable()
+{
+    uint8_t footer[SeekTableFooterSize] = {};
+    if ((m_fileSize < SkippableHeaderSize + SeekTableFooterSize) ||
+        (m_file.ReadAt(footer, sizeof(footer), m_fileSize - sizeof(footer)) != sizeof(footer)) ||
+        (LoadLE32(footer + 5) != SeekableMagic))
+    {
+        return false;
+    }
+    const uint32_t frameCount = LoadLE32(footer);
+    const bool hasChecksum = (footer[4] & 0x80) != 0;
+    const size_t entrySize = hasChecksum ? 12 : 8;
+    const uint64_t tableSize = uint64_t(frameCount) * entrySize + SeekTableFooterSize;
+    if (m_fileSize < SkippableHeaderSize + tableSize)
+    {
+        return false;
+    }
+    std::vector<uint8_t> table(SkippableHeaderSize + tableSize);
+    const uint64_t tableOffset = m_fileSize - table.size();
+    if ((m_file.ReadAt(table.data(), table.size(), tableOffset) != static_cast<int64_t>(table.size())) ||
+        (LoadLE32(table.data()) != SkippableFrameMagic) ||
+        (LoadLE32(table.data() + 4) != tableSize))
+    {
+        return false;
+    }
+
+    m_frames.resize(frameCount);
+    uint64_t compressedOffset = 0;
+    uint64_t decompressedOffset = 0;
+    for (uint32_t i = 0; i < frameCount; ++i)
+    {
+        const uint8_t* entry = table.data() + SkippableHeaderSize + i * entrySize;
+        Frame& frame = m_frames[i];
+        frame.compressedOffset = compressedOffset;
+        frame.decompressedOffset = decompressedOffset;
+        frame.compressedSize = LoadLE32(entry);
+        frame.decompressedSize = LoadLE32(entry + 4);
+        compressedOffset += frame.compressedSize;
+        decompressedOffset += frame.decompressedSize;
+    }
+    if (compressedOffset != tableOffset)
+    {
+        LogGlobal(Warn, "CompressedReader: invalid seek table in {}.", m_file.GetPath());
+        m_frames.clear();
+        return false;
+    }
+    m_size = decompressedOffset;
+    return true;
+}
+
+bool CompressedReader::LoadFrame(size_t index)
+{
+    if (m_frameIndex == index)
+    {
+        return true;
+    }
+    m_frameIndex = SIZE_MAX;
+    const Frame& frame = m_frames[index];
+    m_compressed.resize(frame.compressedSize);
+    m_decompressed.resize(frame.decompressedSize);
+    if (m_file.ReadAt(m_compressed.data(), m_compressed.size(), frame.compressedOffset) !=
+        static_cast<int64_t>(m_compressed.size()))
+    {
+        LogGlobal(Error, "CompressedReader: failed to read frame {} of {}.", index, m_file.GetPath());
+        return false;
+    }
+    const size_t result = ZSTD_decompressDCtx(m_context, m_decompressed.data(), m_decompressed.size(),
+        m_compressed.data(), m_compressed.size());
+    if (ZSTD_isError(result) || (result != frame.decompressedSize))
+    {
+        LogGlobal(Error, "CompressedReader: failed to decompress frame {} of {}: {}",
+            index, m_file.GetPath(), ZSTD_isError(result) ? ZSTD_getErrorName(result) : "size mismatch");
+        return false;
+    }
+    m_frameIndex = index;
+    return true;
+}
+
+size_t CompressedReader::Read(void* buffer, size_t size)
+{
+    if (!m_file.IsOpen())
+    {
+        return 0;
+    }
+    if (m_format == Format::Raw)
+    {
+        const int64_t bytesRead = m_file.ReadAt(buffer, size, m_position);
+        if (bytesRead <= 0)
+        {
+            return 0;
+        }
+        m_position += bytesRead;
+        return static_cast<size_t>(bytesRead);
+    }
+    if (m_format == Format::Zstd)
+    {
+        return ReadStream(buffer, size);
+    }
+
+    uint8_t* p = static_cast<uint8_t*>(buffer);
+    size_t bytesRead = 0;
+    while ((bytesRead < size) && (m_position < m_size))
+    {
+        auto iter = std::upper_bound(m_frames.begin(), m_frames.end(), m_position,
+            [](uint64_t position, const Frame& frame) { return position < frame.decompressedOffset; });
+        const size_t index = (iter - m_frames.begin()) - 1;
+        if (!LoadFrame(index))
+        {
+            break;
+        }
+        const size_t offsetInFrame = static_cast<size_t>(m_position - m_frames[index].decompressedOffset);
+        const size_t bytesToCopy = std::min(size - bytesRead, m_decompressed.size() - offsetInFrame);
+        std::memcpy(p + bytesRead, m_decompressed.data() + offsetInFrame, bytesToCopy);
+        bytesRead += bytesToCopy;
+        m_position += bytesToCopy;
+    }
+    return bytesRead;
+}
+
+size_t CompressedReader::ReadStream(void* buffer, size_t size)
+{
+    ZSTD_outBuffer output = { buffer, size, 0 };
+    while (output.pos < output.size)
+    {
+        bool isInputEnd = false;
+        if (m_inputPos == m_input.size())
+        {
+            m_input.resize(ZSTD_DStreamInSize());
+            const int64_t bytesRead = m_file.ReadAt(m_input.data(), m_input.size(), m_inputOffset);
+            m_input.resize((bytesRead > 0) ? static_cast<size_t>(bytesRead) : 0);
+            m_inputOffset += m_input.size();
+            m_inputPos = 0;
+            isInputEnd = m_input.empty();
+        }
+        ZSTD_inBuffer input = { m_input.data(), m_input.size(), m_inputPos };
+        const size_t outputPos = output.pos;
+        const size_t result = ZSTD_decompressStream(m_context, &output, &input);
+        m_inputPos = input.pos;
+        if (ZSTD_isError(result))
+        {
+            LogGlobal(Error, "CompressedReader: failed to decompress {}: {}",
+                m_file.GetPath(), ZSTD_getErrorName(result));
+            break;
+        }
+        // No more input, and the decoder has flushed everything.
+        if (isInputEnd && (output.pos == outputPos))
+        {
+            break;
+        }
+    }
+    m_position += output.pos;
+    return output.pos;
+}
+
+bool CompressedReader::Seek(uint64_t offset)
+{
+    if (!m_file.IsOpen() || (m_format == Format::Zstd))
+    {
+        return (offset == m_position);
+    }
+    m_position = std::min(offset, m_size);
+    return true;
+}
+
+std::string CompressedReader::ReadAll(std::string_view fileName)
+{
+    CompressedReader reader;
+    std::string buffer;
+    if (!reader.Open(fileName))
+    {
+        return buffer;
+    }
+    if (reader.GetSize() > 0)
+    {
+        buffer.resize(reader.GetSize());
+        buffer.resize(reader.Read(buffer.data(), buffer.size()));
+    }
+    else
+    {
+        size_t size = 0;
+        buffer.resize(ZSTD_DStreamOutSize());
+        while (size_t bytesRead = reader.Read(buffer.data() + size, buffer.size() - size))
+        {
+            size += bytesRead;
+            if (size == buffer.size())
+            {
+                buffer.resize(buffer.size() * 2);
+            }
+        }
+        buffer.resize(size);
+    }
+    return buffer;
+}
+
+bool ReadFileChunks(std::string_view fileName, const std::function<bool(std::string_view chunk)>& callback,
+    std::vector<char>* buffer)
+{
+    {
+        MappedFile file;
+        if (file.Open(fileName) && file.Map() && !IsCompressedData(file.GetData(), file.GetSize()))
+        {
+            if (file.GetSize() > 0)
+            {
+                file.Advise(MappedFile::Advice::Sequential);
+                callback(file.GetString());
+            }
+            return true;
+        }
+    }
+
+    CompressedReader reader;
+    if (!reader.Open(fileName))
+    {
+        return false;
+    }
+    std::vector<char> localBuffer;
+    if (!buffer)
+    {
+        buffer = &localBuffer;
+    }
+    if (buffer->empty())
+    {
+        buffer->resize(1024 * 1024);
+    }
+    while (size_t bytesRead = reader.Read(buffer->data(), buffer->size()))
+    {
+        if (!callback(std::string_view(buffer->data(), bytesRead)))
+        {
+            break;
+        }
+    }
+    return true;
+}
+
+} // namespace rad
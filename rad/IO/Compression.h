@@ -0,0 +1,164 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+#include "rad/Core/ThreadPool.h"
+#include "File.h"
+#include "BufferedWriter.h"
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+typedef struct ZSTD_CCtx_s ZSTD_CCtx;
+typedef struct ZSTD_DCtx_s ZSTD_DCtx;
+
+namespace rad
+{
+
+// Return true if the data starts with a zstd frame or skippable frame.
+bool IsCompressedData(const void* data, size_t size);
+
+// Compressed files are Zstandard streams of independent frames (one per block), followed by a seek table
+// in a skippable frame (the zstd seekable format), so that they can be decompressed by the zstd tool,
+// and random accessed by CompressedReader.
+class CompressedWriter
+{
+public:
+    struct Options
+    {
+        // zstd compression level (1-19, negative for faster).
+        int level = 3;
+        // Uncompressed bytes per frame, the unit of parallelism and random access.
+        size_t blockSize = 1024 * 1024;
+        // Compress blocks on threadCount threads; use the hardware concurrency if 0.
+        uint32_t threadCount = 0;
+        BufferedWriter::Options writerOptions;
+    };
+
+    CompressedWriter();
+    ~CompressedWriter();
+
+    CompressedWriter(const CompressedWriter&) = delete;
+    CompressedWriter& operator=(const CompressedWriter&) = delete;
+
+    bool Open(std::string_view fileName, const Options& options);
+    bool Open(std::string_view fileName) { return Open(fileName, Options()); }
+    // Compress the remaining data, write the seek table and close; return false if anything failed.
+    bool Close();
+    bool IsOpen() const { return m_writer.IsOpen(); }
+
+    bool Write(const void* data, size_t size);
+    bool Write(std::string_view str) { return Write(str.data(), str.size()); }
+
+    // Uncompressed bytes written.
+    uint64_t GetSize() const { return m_size; }
+    // Compressed bytes written (excluding the data being compressed).
+    uint64_t GetCompressedSize() const { return m_writer.GetSize(); }
+
+private:
+    struct FrameSize
+    {
+        uint32_t compressedSize;
+        uint32_t decompressedSize;
+    };
+
+    // Compress the current block on the thread pool.
+    void SubmitBlock();
+    // Write the oldest compressed block to the file.
+    bool WriteFrontBlock();
+    std::vector<uint8_t> CompressBlock(const std::vector<uint8_t>& block);
+
+    Options m_options;
+    BufferedWriter m_writer;
+    std::unique_ptr<ThreadPool> m_threadPool;
+    std::vector<uint8_t> m_block;
+    std::deque<std::pair<std::future<std::vector<uint8_t>>, uint32_t>> m_pendingBlocks;
+    std::vector<FrameSize> m_frames;
+    uint64_t m_size = 0;
+    bool m_hasError = false;
+
+    // Compression contexts reused by the worker threads.
+    std::mutex m_contextMutex;
+    std::vector<ZSTD_CCtx*> m_contexts;
+
+}; // class CompressedWriter
+
+// Reads files written by CompressedWriter with random access, other zstd streams sequentially,
+// and uncompressed files as they are (detected by the magic number).
+class CompressedReader
+{
+public:
+    enum class Format
+    {
+        Raw,
+        Zstd,
+        ZstdSeekable,
+    };
+
+    CompressedReader();
+    ~CompressedReader();
+
+    CompressedReader(const CompressedReader&) = delete;
+    CompressedReader& operator=(const CompressedReader&) = delete;
+
+    bool Open(std::string_view fileName);
+    void Close();
+    bool IsOpen() { return m_file.IsOpen(); }
+    Format GetFormat() const { return m_format; }
+    bool IsSeekable() const { return (m_format != Format::Zstd); }
+
+    // Return the number of bytes read, 0 at the end of the file or on failure.
+    size_t Read(void* buffer, size_t size);
+    // Set the uncompressed read position; return false if not seekable.
+    bool Seek(uint64_t offset);
+    uint64_t Tell() const { return m_position; }
+    // The uncompressed size, 0 if unknown (Zstd without seek table).
+    uint64_t GetSize() const { return m_size; }
+
+    // Read the whole (uncompressed) content.
+    static std::string ReadAll(std::string_view fileName);
+
+private:
+    struct Frame
+    {
+        uint64_t compressedOffset;
+        uint64_t decompressedOffset;
+        uint32_t compressedSize;
+        uint32_t decompressedSize;
+    };
+
+    bool LoadSeekTable();
+    bool LoadFrame(size_t index);
+    size_t ReadStream(void* buffer, size_t size);
+
+    File m_file;
+    Format m_format = Format::Raw;
+    uint64_t m_fileSize = 0;
+    uint64_t m_size = 0;
+    uint64_t m_position = 0;
+    ZSTD_DCtx* m_context = nullptr;
+
+    // ZstdSeekable: the frames and the decompressed frame cached.
+    std::vector<Frame> m_frames;
+    size_t m_frameIndex = SIZE_MAX;
+    std::vector<uint8_t> m_compressed;
+    std::vector<uint8_t> m_decompressed;
+
+    // Zstd: streaming input.
+    std::vector<uint8_t> m_input;
+    size_t m_inputPos = 0;
+    uint64_t m_inputOffset = 0;
+
+}; // class CompressedReader
+
+// Pass the (uncompressed) content of a file to the callback in chunks, until it returns false:
+// an uncompressed file is mapped and passed as a single chunk without copying, a compressed one
+// is decompressed a buffer at a time (see CompressedReader); an empty file has no chunk.
+// Return false if the file cannot be opened (not logged).
+// @param buffer: the decompression buffer (1 MiB if empty), kept by the caller to reuse; allocated if null.
+bool ReadFileChunks(std::string_view fileName, const std::function<bool(std::string_view chunk)>& callback,
+    std::vector<char>* buffer = nullptr);
+
+} // namespace rad
@@ -1,13 +1,27 @@
 #define _CRT_SECURE_NO_WARNINGS 1
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+// 64-bit off_t for fopen/fseeko/ftello/pread on 32-bit platforms.
+#define _FILE_OFFSET_BITS 64
+#endif
 #include "File.h"
 #include "Logging.h"
+#include "LineReader.h"
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstdarg>
+#include <cstring>
 #include <ctime>
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#ifdef _WIN32
+#include <Windows.h>
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 namespace rad
 {
 
@@ -53,6 +67,15 @@ void File::Close()
     m_handle = nullptr;
 }
 
+int File::GetDescriptor() const
+{
+#ifdef _WIN32
+    return _fileno(m_handle);
+#else
+    return fileno(m_handle);
+#endif
+}
+
 bool File::IsOpen()
 {
     return (m_handle != nullptr);
@@ -68,13 +91,42 @@ size_t File::Read(void* buffer, size_t sizeInBytes, size_t elementCount)
     return fread(buffer, sizeInBytes, elementCount, m_handle);
 }
 
+// Lock the stream once per line instead of once per character.
+static void LockFile(std::FILE* handle)
+{
+#ifdef _WIN32
+    _lock_file(handle);
+#else
+    flockfile(handle);
+#endif
+}
+
+static void UnlockFile(std::FILE* handle)
+{
+#ifdef _WIN32
+    _unlock_file(handle);
+#else
+    funlockfile(handle);
+#endif
+}
+
+static int GetCharUnlocked(std::FILE* handle)
+{
+#ifdef _WIN32
+    return _getc_nolock(handle);
+#else
+    return getc_unlocked(handle);
+#endif
+}
+
 size_t File::ReadLine(void* buffer, size_t bufferSize)
 {
     size_t bytesRead = 0;
     char* str = static_cast<char*>(buffer);
+    LockFile(m_handle);
     while (bytesRead < bufferSize)
     {
-        int32_t c = GetChar();
+        int32_t c = GetCharUnlocked(m_handle);
         if ((c == '\n') || (c == EOF))
         {
             break;
@@ -82,6 +134,7 @@ size_t File::ReadLine(void* buffer, size_t bufferSize)
         str[bytesRead] = static_cast<char>(c);
         bytesRead++;
     }
+    UnlockFile(m_handle);
 
     const size_t endIndex = ((bytesRead < bufferSize) ? bytesRead : (bufferSize - 1));
     str[endIndex] = '\0';
@@ -92,9 +145,10 @@ size_t File::ReadLine(void* buffer, size_t bufferSize)
 size_t File::ReadLine(std::string& buffer)
 {
     size_t bytesRead = 0;
+    LockFile(m_handle);
     while (true)
     {
-        int32_t c = GetChar();
+        int32_t c = GetCharUnlocked(m_handle);
         if ((c == '\n') || (c == EOF))
         {
             break;
@@ -102,6 +156,7 @@ size_t File::ReadLine(std::string& buffer)
         buffer.push_back(static_cast<char>(c));
         bytesRead++;
     }
+    UnlockFile(m_handle);
     return bytesRead;
 }
 
@@ -127,12 +182,17 @@ int32_t File::GetChar()
 
 int64_t File::Seek(int64_t offset, int origin)
 {
-    return fseek(m_handle, static_cast<long>(offset), origin);
+#ifdef _WIN32
+    return _fseeki64(m_handle, offset, origin);
+#else
+    static_assert(sizeof(off_t) >= sizeof(int64_t));
+    return fseeko(m_handle, static_cast<off_t>(offset), origin);
+#endif
 }
 
 int64_t File::Rseek(int64_t offset)
 {
-    return fseek(m_handle, static_cast<long>(offset), SEEK_END);
+    return Seek(offset, SEEK_END);
 }
 
 void File::Rewind()
@@ -148,17 +208,19 @@ void File::FastForward()
 bool File::GetStat(std::string_view fileName, Stat* pStatus)
 {
     assert(pStatus != nullptr);
+    const std::string path(fileName);
 #ifdef _WIN32
     struct _stat64 status {};
-    const int ret = _stat64(fileName.data(), &status);
+    const int ret = _stat64(path.c_str(), &status);
 #else
     struct stat64 status {};
-    const int ret = stat64(fileName.data(), &status);
+    const int ret = stat64(path.c_str(), &status);
 #endif
     if (ret != 0)
     {
-        LogGlobal(Error, "Failed to get file status of %s: %s (%d)",
-            fileName.data(), strerror(ret), ret);
+        LogGlobal(Error, "Failed to get file status of {}: {} ({})",
+            fileName, strerror(errno), errno);
+        return false;
     }
 
     static_assert(sizeof(Stat::size) == sizeof(status.st_size));
@@ -167,6 +229,13 @@ bool File::GetStat(std::string_view fileName, Stat* pStatus)
     pStatus->ctime = static_cast<decltype(Stat::ctime)>(status.st_ctime);
     pStatus->atime = static_cast<decltype(Stat::atime)>(status.st_atime);
     pStatus->mtime = static_cast<decltype(Stat::mtime)>(status.st_mtime);
+#if defined(_WIN32)
+    pStatus->mtimeNs = static_cast<uint64_t>(status.st_mtime) * 1000000000ull;
+#elif defined(__APPLE__)
+    pStatus->mtimeNs = static_cast<uint64_t>(status.st_mtimespec.tv_sec) * 1000000000ull + status.st_mtimespec.tv_nsec;
+#else
+    pStatus->mtimeNs = static_cast<uint64_t>(status.st_mtim.tv_sec) * 1000000000ull + status.st_mtim.tv_nsec;
+#endif
 
     return true;
 }
@@ -188,7 +257,104 @@ uint64_t File::GetSize()
 
 int64_t File::Tell()
 {
-    return ftell(m_handle);
+#ifdef _WIN32
+    return _ftelli64(m_handle);
+#else
+    return ftello(m_handle);
+#endif
+}
+
+int64_t File::ReadAt(void* buffer, size_t size, uint64_t offset)
+{
+    return ReadAt(GetDescriptor(), buffer, size, offset);
+}
+
+int64_t File::WriteAt(const void* buffer, size_t size, uint64_t offset)
+{
+    return WriteAt(GetDescriptor(), buffer, size, offset);
+}
+
+int64_t File::ReadAt(int fd, void* buffer, size_t size, uint64_t offset)
+{
+    uint8_t* p = static_cast<uint8_t*>(buffer);
+    size_t bytesTotal = 0;
+    while (bytesTotal < size)
+    {
+#ifdef _WIN32
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD bytesToRead = static_cast<DWORD>(std::min<size_t>(size - bytesTotal, 0x80000000));
+        DWORD bytesRead = 0;
+        if (!ReadFile(handle, p, bytesToRead, &bytesRead, &overlapped))
+        {
+            DWORD err = GetLastError();
+            if (err == ERROR_HANDLE_EOF)
+            {
+                break;
+            }
+            return -static_cast<int64_t>(err);
+        }
+#else
+        ssize_t bytesRead = ::pread(fd, p, size - bytesTotal, static_cast<off_t>(offset));
+        if (bytesRead < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -errno;
+        }
+#endif
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        p += bytesRead;
+        offset += bytesRead;
+        bytesTotal += bytesRead;
+    }
+    return static_cast<int64_t>(bytesTotal);
+}
+
+int64_t File::WriteAt(int fd, const void* buffer, size_t size, uint64_t offset)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(buffer);
+    size_t bytesTotal = 0;
+    while (bytesTotal < size)
+    {
+#ifdef _WIN32
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(fd));
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        const DWORD bytesToWrite = static_cast<DWORD>(std::min<size_t>(size - bytesTotal, 0x80000000));
+        DWORD bytesWritten = 0;
+        if (!WriteFile(handle, p, bytesToWrite, &bytesWritten, &overlapped))
+        {
+            return -static_cast<int64_t>(GetLastError());
+        }
+#else
+        ssize_t bytesWritten = ::pwrite(fd, p, size - bytesTotal, static_cast<off_t>(offset));
+        if (bytesWritten < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return -errno;
+        }
+#endif
+        if (bytesWritten == 0)
+        {
+            break;
+        }
+        p += bytesWritten;
+        offset += bytesWritten;
+        bytesTotal += bytesWritten;
+    }
+    return static_cast<int64_t>(bytesTotal);
 }
 
 std::string File::ReadAll(std::string_view path)
@@ -207,27 +373,14 @@ std::string File::ReadAll(std::string_view path)
 
 std::vector<std::string> File::ReadLines(std::string_view path)
 {
-    File file;
+    LineReader reader;
     std::vector<std::string> lines;
-    if (file.Open(path, "r"))
+    if (reader.Open(path))
     {
-        std::string line;
-        while (true)
+        std::string_view line;
+        while (reader.ReadLine(line))
         {
-            int32_t c = file.GetChar();
-            if ((c != '\n') && (c != EOF))
-            {
-                line.push_back(static_cast<char>(c));
-            }
-            else
-            {
-                lines.push_back(line);
-                line.clear();
-                if (c == EOF)
-                {
-                    break;
-                }
-            }
+            lines.emplace_back(line);
         }
     }
     return lines;
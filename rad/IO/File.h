@@ -16,6 +16,7 @@ public:
         uint64_t  ctime;  // Time of creation of the file (not valid on FAT).
         uint64_t  atime;  // Time of last access to the file (not valid on FAT).
         uint64_t  mtime;  // Time of last modification to the file.
+        uint64_t  mtimeNs; // mtime in nanoseconds (in seconds precision on Windows).
     };
 
     File();
@@ -23,6 +24,8 @@ public:
 
     const std::string& GetPath() const { return m_path; }
     std::FILE* GetHandle() const { return m_handle; }
+    // The file descriptor of the handle, for OS level I/O.
+    int GetDescriptor() const;
 
     // Read = "r"/"rb"
     // Write = "w"/"wb"
@@ -45,7 +48,8 @@ public:
     int32_t GetChar();
 
     // Sets the file position indicator for the file stream stream to the value pointed to by offset.
-    // @origin: any of RW_SEEK_SET, RW_SEEK_CUR, RW_SEEK_END;
+    // @origin: any of SEEK_SET, SEEK_CUR, SEEK_END;
+    // Offsets are 64-bit on all platforms; return 0 on success.
     int64_t Seek(int64_t offset, int origin);
     int64_t Rseek(int64_t offset);
     void Rewind();
@@ -56,7 +60,18 @@ public:
     uint64_t GetSize();
     int64_t Tell();
 
+    // Positional I/O on the descriptor, bypasses the stream buffer and doesn't move the file position
+    // (except on Windows), so that multiple threads can read one handle concurrently without locking;
+    // Flush before reading data written through the stream.
+    // Transfer until size bytes or the end of the file; return the number of bytes transferred,
+    // or -errno (-GetLastError() on Windows) on failure.
+    int64_t ReadAt(void* buffer, size_t size, uint64_t offset);
+    int64_t WriteAt(const void* buffer, size_t size, uint64_t offset);
+    static int64_t ReadAt(int fd, void* buffer, size_t size, uint64_t offset);
+    static int64_t WriteAt(int fd, const void* buffer, size_t size, uint64_t offset);
+
     static std::string ReadAll(std::string_view path);
+    // Lines exclude the line endings ("\n" or "\r\n"); use LineReader for large files.
     static std::vector<std::string> ReadLines(std::string_view path);
 
 private:
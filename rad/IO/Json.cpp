@@ -1,6 +1,6 @@
 #include "Json.h"
 #include "rad/Core/String.h"
-#include "File.h"
+#include "Compression.h"
 
 namespace rad
 {
@@ -12,18 +12,235 @@ void SetDefaultParseOptions(boost::json::parse_options& options)
     options.allow_infinity_and_nan = true;
 }
 
-boost::json::value ParseJson(std::string_view str)
+boost::json::value ParseJson(std::string_view str, boost::json::storage_ptr storage)
 {
     boost::json::parse_options options = {};
     SetDefaultParseOptions(options);
-    return boost::json::parse(str, {}, options);
+    return boost::json::parse(str, std::move(storage), options);
 }
 
-boost::json::value ParseJsonFromFile(std::string_view fileName)
+boost::json::value ParseJsonFromFile(std::string_view fileName, boost::json::storage_ptr storage)
+{
+    JsonParser parser;
+    return parser.ParseFile(fileName, std::move(storage));
+}
+
+static boost::json::parse_options GetDefaultParseOptions()
 {
     boost::json::parse_options options = {};
     SetDefaultParseOptions(options);
-    return boost::json::parse(File::ReadAll(fileName), {}, options);
+    return options;
+}
+
+JsonParser::JsonParser() :
+    m_parser({}, GetDefaultParseOptions())
+{
+}
+
+JsonParser::JsonParser(const boost::json::parse_options& options) :
+    m_parser({}, options)
+{
+}
+
+JsonParser::~JsonParser()
+{
+}
+
+boost::json::value JsonParser::Parse(std::string_view str, boost::json::storage_ptr storage)
+{
+    m_parser.reset(std::move(storage));
+    boost::system::error_code ec;
+    m_parser.write(str.data(), str.size(), ec);
+    if (!ec)
+    {
+        m_parser.finish(ec);
+    }
+    if (ec)
+    {
+        m_parser.reset();
+        throw boost::system::system_error(ec);
+    }
+    return m_parser.release();
+}
+
+boost::json::value JsonParser::ParseFile(std::string_view fileName, boost::json::storage_ptr storage)
+{
+    m_parser.reset(std::move(storage));
+    boost::system::error_code ec;
+    const bool isOpened = ReadFileChunks(fileName, [&](std::string_view chunk) {
+        m_parser.write(chunk.data(), chunk.size(), ec);
+        return !ec;
+        }, &m_buffer);
+    if (!isOpened)
+    {
+        m_parser.reset();
+        throw boost::system::system_error(
+            boost::system::errc::make_error_code(boost::system::errc::no_such_file_or_directory), std::string(fileName));
+    }
+    if (!ec)
+    {
+        m_parser.finish(ec);
+    }
+    if (ec)
+    {
+        m_parser.reset();
+        throw boost::system::system_error(ec, std::string(fileName));
+    }
+    return m_parser.release();
+}
+
+JsonPath::JsonPath(const JsonPath& other) :
+    m_tokens(other.m_tokens),
+    m_isValid(other.m_isValid)
+{
+}
+
+JsonPath& JsonPath::operator=(const JsonPath& other)
+{
+    m_tokens = other.m_tokens;
+    m_isValid = other.m_isValid;
+    return *this;
+}
+
+bool JsonPath::Parse(std::string_view path)
+{
+    m_tokens.clear();
+    m_isValid = false;
+    auto addToken = [&](std::string key)
+        {
+            Token& token = m_tokens.emplace_back();
+            token.key = std::move(key);
+            // Array index: digits without leading zeros.
+            const std::string& k = token.key;
+            if (!k.empty() && (k.size() <= 19) && ((k[0] != '0') || (k.size() == 1)) &&
+                (k.find_first_not_of("0123456789") == std::string::npos))
+            {
+                token.index = std::stoull(k);
+            }
+        };
+
+    if (path.empty() || (path[0] == '/'))
+    {
+        // JSON pointer: "~0" for '~' and "~1" for '/'.
+        size_t pos = 0;
+        while (pos < path.size())
+        {
+            const size_t end = std::min(path.find('/', pos + 1), path.size());
+            std::string key;
+            for (size_t i = pos + 1; i < end; ++i)
+            {
+                if (path[i] == '~')
+                {
+                    if ((i + 1 < end) && ((path[i + 1] == '0') || (path[i + 1] == '1')))
+                    {
+                        key.push_back((path[++i] == '0') ? '~' : '/');
+                    }
+                    else
+                    {
+                        return false;
+                    }
+                }
+                else
+                {
+                    key.push_back(path[i]);
+                }
+            }
+            addToken(std::move(key));
+            pos = end;
+        }
+    }
+    else
+    {
+        // Dotted path: keys separated by '.', and indices in brackets.
+        size_t pos = 0;
+        while (pos < path.size())
+        {
+            if (path[pos] == '[')
+            {
+                const size_t end = path.find(']', pos);
+                if ((end == std::string_view::npos) || (end == pos + 1))
+                {
+                    return false;
+                }
+                addToken(std::string(path.substr(pos + 1, end - pos - 1)));
+                if (m_tokens.back().index == SIZE_MAX)
+                {
+                    return false;
+                }
+                pos = end + 1;
+            }
+            else
+            {
+                const size_t end = std::min(path.find_first_of(".[", pos), path.size());
+                if (end == pos)
+                {
+                    return false;
+                }
+                addToken(std::string(path.substr(pos, end - pos)));
+                pos = end;
+            }
+            if ((pos < path.size()) && (path[pos] == '.'))
+            {
+                if (++pos == path.size())
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    m_isValid = true;
+    return true;
+}
+
+const boost::json::value* JsonPath::Find(const boost::json::value& root) const
+{
+    if (!m_isValid)
+    {
+        return nullptr;
+    }
+    const boost::json::value* current = &root;
+    for (const Token& token : m_tokens)
+    {
+        if (const boost::json::object* object = current->if_object())
+        {
+            // Try the cached position first, same-shaped objects have the member at the same position.
+            const uint32_t position = token.cachedPosition.load(std::memory_order_relaxed);
+            if (position < object->size())
+            {
+                const boost::json::key_value_pair& member = *(object->begin() + position);
+                if (member.key() == token.key)
+                {
+                    current = &member.value();
+                    continue;
+                }
+            }
+            auto iter = object->find(token.key);
+            if (iter == object->end())
+            {
+                return nullptr;
+            }
+            token.cachedPosition.store(static_cast<uint32_t>(iter - object->begin()), std::memory_order_relaxed);
+            current = &iter->value();
+        }
+        else if (const boost::json::array* array = current->if_array())
+        {
+            if (token.index >= array->size())
+            {
+                return nullptr;
+            }
+            current = &(*array)[token.index];
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+    return current;
+}
+
+boost::json::value* JsonPath::Find(boost::json::value& root) const
+{
+    return const_cast<boost::json::value*>(Find(static_cast<const boost::json::value&>(root)));
 }
 
 const char* JsonRef::GetString(const char* str) const
@@ -135,6 +352,15 @@ JsonRef JsonRef::FindMember(std::string_view key)
     return JsonRef();
 }
 
+JsonRef JsonRef::FindPath(const JsonPath& path)
+{
+    if (IsValid())
+    {
+        return path.Find(*m_val);
+    }
+    return JsonRef();
+}
+
 JsonRef JsonRef::FindMemberCaseInsensitive(std::string_view key)
 {
     if (IsValid() && m_val->is_object())
@@ -2,6 +2,7 @@
 
 #include "rad/Core/Global.h"
 #include <boost/json.hpp>
+#include <atomic>
 // Document Model
 // array: sequence container of JSON values supporing dynamic size and fast, random access.
 // object: associative container of key-value pairs with unique keys (string-value pairs).
@@ -12,8 +13,82 @@
 namespace rad
 {
 
-boost::json::value ParseJson(std::string_view str);
-boost::json::value ParseJsonFromFile(std::string_view fileName);
+// Allow comments, trailing commas, infinity and NaN.
+void SetDefaultParseOptions(boost::json::parse_options& options);
+
+// The values are allocated from the storage, the default heap if null;
+// with a boost::json::monotonic_resource, nodes are bump allocated and freed all at once,
+// but the resource must outlive the value.
+boost::json::value ParseJson(std::string_view str, boost::json::storage_ptr storage = {});
+boost::json::value ParseJsonFromFile(std::string_view fileName, boost::json::storage_ptr storage = {});
+
+// Reusable parser: the internal buffers (value stack, read buffer) persist between calls,
+// amortize the allocations when parsing many documents. Throws boost::system::system_error on failure.
+class JsonParser
+{
+public:
+    JsonParser();
+    JsonParser(const boost::json::parse_options& options);
+    ~JsonParser();
+
+    JsonParser(const JsonParser&) = delete;
+    JsonParser& operator=(const JsonParser&) = delete;
+
+    boost::json::value Parse(std::string_view str, boost::json::storage_ptr storage = {});
+    boost::json::value ParseFile(std::string_view fileName, boost::json::storage_ptr storage = {});
+
+private:
+    boost::json::stream_parser m_parser;
+    std::vector<char> m_buffer;
+
+}; // class JsonParser
+
+// A path parsed once and evaluated against many values: a JSON pointer (RFC 6901) like "/a/b/3/c",
+// or a dotted path like "a.b[3].c". Each step caches the position of the member found last time,
+// documents of the same shape are navigated by comparing the keys only, without hash lookups.
+// The caches are atomic, a path can be shared by threads.
+class JsonPath
+{
+public:
+    JsonPath() {}
+    // Check IsValid() for the result of parsing.
+    explicit JsonPath(std::string_view path) { Parse(path); }
+    JsonPath(const JsonPath& other);
+    JsonPath& operator=(const JsonPath& other);
+    ~JsonPath() {}
+
+    bool Parse(std::string_view path);
+    bool IsValid() const { return m_isValid; }
+    size_t GetTokenCount() const { return m_tokens.size(); }
+
+    // Return nullptr if not found.
+    const boost::json::value* Find(const boost::json::value& root) const;
+    boost::json::value* Find(boost::json::value& root) const;
+
+private:
+    struct Token
+    {
+        std::string key;
+        // The array index if the token is a number, SIZE_MAX otherwise.
+        size_t index = SIZE_MAX;
+        // The member position in the object found last time.
+        mutable std::atomic<uint32_t> cachedPosition = 0;
+
+        Token() {}
+        Token(const Token& other) : key(other.key), index(other.index) {}
+        Token& operator=(const Token& other)
+        {
+            key = other.key;
+            index = other.index;
+            cachedPosition = 0;
+            return *this;
+        }
+    };
+
+    std::vector<Token> m_tokens;
+    bool m_isValid = false;
+
+}; // class JsonPath
 
 // a helper class for json::value.
 class JsonRef
@@ -48,6 +123,7 @@ public:
 
     JsonRef FindMember(std::string_view key);
     JsonRef FindMemberCaseInsensitive(std::string_view key);
+    JsonRef FindPath(const JsonPath& path);
 
 private:
     const boost::json::value* m_val;
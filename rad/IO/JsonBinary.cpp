@@ -0,0 +1,1030 @@
+#include "JsonBinary.h"
+#include "Logging.h"
+#include "MappedFile.h"
+#include <bit>
+#include <cmath>
+
+namespace rad
+{
+
+static void AppendBigEndian(std::string& buffer, uint64_t value, size_t size)
+{
+    for (size_t i = size; i-- > 0;)
+    {
+        buffer.push_back(static_cast<char>(value >> (i * 8)));
+    }
+}
+
+static void PatchBigEndian32(std::string& buffer, size_t offset, uint32_t value)
+{
+    for (size_t i = 0; i < 4; ++i)
+    {
+        buffer[offset + i] = static_cast<char>(value >> ((3 - i) * 8));
+    }
+}
+
+namespace Cbor
+{
+
+enum MajorType : uint8_t
+{
+    UnsignedInt = 0,
+    NegativeInt = 1,
+    ByteString = 2,
+    TextString = 3,
+    Array = 4,
+    Map = 5,
+    Tag = 6,
+    Simple = 7,
+};
+
+// The additional information of the initial byte.
+constexpr uint8_t Uint8Follows = 24;
+constexpr uint8_t Uint16Follows = 25;
+constexpr uint8_t Uint32Follows = 26;
+constexpr uint8_t Uint64Follows = 27;
+constexpr uint8_t IndefiniteLength = 31;
+
+constexpr uint8_t False = 0xF4;
+constexpr uint8_t True = 0xF5;
+constexpr uint8_t Null = 0xF6;
+constexpr uint8_t Undefined = 0xF7;
+constexpr uint8_t Float16 = 0xF9;
+constexpr uint8_t Float32 = 0xFA;
+constexpr uint8_t Float64 = 0xFB;
+constexpr uint8_t Break = 0xFF;
+
+static void AppendHead(std::string& buffer, uint8_t majorType, uint64_t argument)
+{
+    const uint8_t type = static_cast<uint8_t>(majorType << 5);
+    if (argument < 24)
+    {
+        buffer.push_back(static_cast<char>(type | argument));
+    }
+    else if (argument <= UINT8_MAX)
+    {
+        buffer.push_back(static_cast<char>(type | Uint8Follows));
+        AppendBigEndian(buffer, argument, 1);
+    }
+    else if (argument <= UINT16_MAX)
+    {
+        buffer.push_back(static_cast<char>(type | Uint16Follows));
+        AppendBigEndian(buffer, argument, 2);
+    }
+    else if (argument <= UINT32_MAX)
+    {
+        buffer.push_back(static_cast<char>(type | Uint32Follows));
+        AppendBigEndian(buffer, argument, 4);
+    }
+    else
+    {
+        buffer.push_back(static_cast<char>(type | Uint64Follows));
+        AppendBigEndian(buffer, argument, 8);
+    }
+}
+
+static void AppendInt64(std::string& buffer, int64_t i)
+{
+    if (i >= 0)
+    {
+        AppendHead(buffer, UnsignedInt, static_cast<uint64_t>(i));
+    }
+    else
+    {
+        // -1 - i
+        AppendHead(buffer, NegativeInt, ~static_cast<uint64_t>(i));
+    }
+}
+
+static void AppendDouble(std::string& buffer, double d)
+{
+    buffer.push_back(static_cast<char>(Float64));
+    AppendBigEndian(buffer, std::bit_cast<uint64_t>(d), 8);
+}
+
+static void AppendString(std::string& buffer, std::string_view str)
+{
+    AppendHead(buffer, TextString, str.size());
+    buffer.append(str);
+}
+
+static void Append(std::string& buffer, const boost::json::value& value)
+{
+    switch (value.kind())
+    {
+    case boost::json::kind::null:
+        buffer.push_back(static_cast<char>(Null));
+        break;
+    case boost::json::kind::bool_:
+        buffer.push_back(static_cast<char>(value.get_bool() ? True : False));
+        break;
+    case boost::json::kind::int64:
+        AppendInt64(buffer, value.get_int64());
+        break;
+    case boost::json::kind::uint64:
+        AppendHead(buffer, UnsignedInt, value.get_uint64());
+        break;
+    case boost::json::kind::double_:
+        AppendDouble(buffer, value.get_double());
+        break;
+    case boost::json::kind::string:
+        AppendString(buffer, std::string_view(value.get_string().data(), value.get_string().size()));
+        break;
+    case boost::json::kind::array:
+        AppendHead(buffer, Array, value.get_array().size());
+        for (const boost::json::value& element : value.get_array())
+        {
+            Append(buffer, element);
+        }
+        break;
+    case boost::json::kind::object:
+        AppendHead(buffer, Map, value.get_object().size());
+        for (const boost::json::key_value_pair& member : value.get_object())
+        {
+            AppendString(buffer, std::string_view(member.key().data(), member.key().size()));
+            Append(buffer, member.value());
+        }
+        break;
+    }
+}
+
+} // namespace Cbor
+
+namespace MessagePack
+{
+
+constexpr uint8_t FixMap = 0x80;
+constexpr uint8_t FixArray = 0x90;
+constexpr uint8_t FixStr = 0xA0;
+constexpr uint8_t Nil = 0xC0;
+constexpr uint8_t False = 0xC2;
+constexpr uint8_t True = 0xC3;
+constexpr uint8_t Bin8 = 0xC4;
+constexpr uint8_t Bin16 = 0xC5;
+constexpr uint8_t Bin32 = 0xC6;
+constexpr uint8_t Float32 = 0xCA;
+constexpr uint8_t Float64 = 0xCB;
+constexpr uint8_t Uint8 = 0xCC;
+constexpr uint8_t Uint16 = 0xCD;
+constexpr uint8_t Uint32 = 0xCE;
+constexpr uint8_t Uint64 = 0xCF;
+constexpr uint8_t Int8 = 0xD0;
+constexpr uint8_t Int16 = 0xD1;
+constexpr uint8_t Int32 = 0xD2;
+constexpr uint8_t Int64 = 0xD3;
+constexpr uint8_t Str8 = 0xD9;
+constexpr uint8_t Str16 = 0xDA;
+constexpr uint8_t Str32 = 0xDB;
+constexpr uint8_t Array16 = 0xDC;
+constexpr uint8_t Array32 = 0xDD;
+constexpr uint8_t Map16 = 0xDE;
+constexpr uint8_t Map32 = 0xDF;
+
+static void AppendUint64(std::string& buffer, uint64_t u)
+{
+    if (u < 0x80)
+    {
+        buffer.push_back(static_cast<char>(u));
+    }
+    else if (u <= UINT8_MAX)
+    {
+        buffer.push_back(static_cast<char>(Uint8));
+        AppendBigEndian(buffer, u, 1);
+    }
+    else if (u <= UINT16_MAX)
+    {
+        buffer.push_back(static_cast<char>(Uint16));
+        AppendBigEndian(buffer, u, 2);
+    }
+    else if (u <= UINT32_MAX)
+    {
+        buffer.push_back(static_cast<char>(Uint32));
+        AppendBigEndian(buffer, u, 4);
+    }
+    else
+    {
+        buffer.push_back(static_cast<char>(Uint64));
+        AppendBigEndian(buffer, u, 8);
+    }
+}
+
+static void AppendInt64(std::string& buffer, int64_t i)
+{
+    if (i >= 0)
+    {
+        AppendUint64(buffer, static_cast<uint64_t>(i));
+    }
+    else if (i >= -32)
+    {
+        // Negative fixint.
+        buffer.push_back(static_cast<char>(i));
+    }
+    else if (i >= INT8_MIN)
+    {
+        buffer.push_back(static_cast<char>(Int8));
+        AppendBigEndian(buffer, static_cast<uint64_t>(i), 1);
+    }
+    else if (i >= INT16_MIN)
+    {
+        buffer.push_back(static_cast<char>(Int16));
+        AppendBigEndian(buffer, static_cast<uint64_t>(i), 2);
+    }
+    else if (i >= INT32_MIN)
+    {
+        buffer.push_back(static_cast<char>(Int32));
+        AppendBigEndian(buffer, static_cast<uint64_t>(i), 4);
+    }
+    else
+    {
+        buffer.push_back(static_cast<char>(Int64));
+        AppendBigEndian(buffer, static_cast<uint64_t>(i), 8);
+    }
+}
+
+static void AppendDouble(std::string& buffer, double d)
+{
+    buffer.push_back(static_cast<char>(Float64));
+    AppendBigEndian(buffer, std::bit_cast<uint64_t>(d), 8);
+}
+
+static void AppendString(std::string& buffer, std::string_view str)
+{
+    const size_t size = str.size();
+    if (size < 32)
+    {
+        buffer.push_back(static_cast<char>(FixStr | size));
+    }
+    else if (size <= UINT8_MAX)
+    {
+        buffer.push_back(static_cast<char>(Str8));
+        AppendBigEndian(buffer, size, 1);
+    }
+    else if (size <= UINT16_MAX)
+    {
+        buffer.push_back(static_cast<char>(Str16));
+        AppendBigEndian(buffer, size, 2);
+    }
+    else
+    {
+        buffer.push_back(static_cast<char>(Str32));
+        AppendBigEndian(buffer, size, 4);
+    }
+    buffer.append(str);
+}
+
+static void AppendContainerHead(std::string& buffer, bool isObject, size_t size)
+{
+    if (size < 16)
+    {
+        buffer.push_back(static_cast<char>((isObject ? FixMap : FixArray) | size));
+    }
+    else if (size <= UINT16_MAX)
+    {
+        buffer.push_back(static_cast<char>(isObject ? Map16 : Array16));
+        AppendBigEndian(buffer, size, 2);
+    }
+    else
+    {
+        buffer.push_back(static_cast<char>(isObject ? Map32 : Array32));
+        AppendBigEndian(buffer, size, 4);
+    }
+}
+
+static void Append(std::string& buffer, const boost::json::value& value)
+{
+    switch (value.kind())
+    {
+    case boost::json::kind::null:
+        buffer.push_back(static_cast<char>(Nil));
+        break;
+    case boost::json::kind::bool_:
+        buffer.push_back(static_cast<char>(value.get_bool() ? True : False));
+        break;
+    case boost::json::kind::int64:
+        AppendInt64(buffer, value.get_int64());
+        break;
+    case boost::json::kind::uint64:
+        AppendUint64(buffer, value.get_uint64());
+        break;
+    case boost::json::kind::double_:
+        AppendDouble(buffer, value.get_double());
+        break;
+    case boost::json::kind::string:
+        AppendString(buffer, std::string_view(value.get_string().data(), value.get_string().size()));
+        break;
+    case boost::json::kind::array:
+        AppendContainerHead(buffer, false, value.get_array().size());
+        for (const boost::json::value& element : value.get_array())
+        {
+            Append(buffer, element);
+        }
+        break;
+    case boost::json::kind::object:
+        AppendContainerHead(buffer, true, value.get_object().size());
+        for (const boost::json::key_value_pair& member : value.get_object())
+        {
+            AppendString(buffer, std::string_view(member.key().data(), member.key().size()));
+            Append(buffer, member.value());
+        }
+        break;
+    }
+}
+
+} // namespace MessagePack
+
+void EncodeBinaryJson(const boost::json::value& value, BinaryJsonFormat format, std::string& buffer)
+{
+    if (format == BinaryJsonFormat::Cbor)
+    {
+        Cbor::Append(buffer, value);
+    }
+    else
+    {
+        MessagePack::Append(buffer, value);
+    }
+}
+
+std::string EncodeBinaryJson(const boost::json::value& value, BinaryJsonFormat format)
+{
+    std::string buffer;
+    EncodeBinaryJson(value, format, buffer);
+    return buffer;
+}
+
+BinaryJsonEncoder::BinaryJsonEncoder(BinaryJsonFormat format, std::string& buffer) :
+    m_format(format),
+    m_buffer(buffer)
+{
+}
+
+BinaryJsonEncoder::~BinaryJsonEncoder()
+{
+}
+
+void BinaryJsonEncoder::BeginContainer(bool isObject)
+{
+    if (m_format == BinaryJsonFormat::Cbor)
+    {
+        m_buffer.push_back(static_cast<char>(((isObject ? Cbor::Map : Cbor::Array) << 5) | Cbor::Uint32Follows));
+    }
+    else
+    {
+        m_buffer.push_back(static_cast<char>(isObject ? MessagePack::Map32 : MessagePack::Array32));
+    }
+    m_lengthOffsets.push_back(m_buffer.size());
+    m_buffer.append(4, '\0');
+}
+
+void BinaryJsonEncoder::EndContainer(size_t count)
+{
+    PatchBigEndian32(m_buffer, m_lengthOffsets.back(), static_cast<uint32_t>(count));
+    m_lengthOffsets.pop_back();
+}
+
+bool BinaryJsonEncoder::OnObjectBegin()
+{
+    BeginContainer(true);
+    return true;
+}
+
+bool BinaryJsonEncoder::OnObjectEnd(size_t memberCount)
+{
+    EndContainer(memberCount);
+    return true;
+}
+
+bool BinaryJsonEncoder::OnArrayBegin()
+{
+    BeginContainer(false);
+    return true;
+}
+
+bool BinaryJsonEncoder::OnArrayEnd(size_t elementCount)
+{
+    EndContainer(elementCount);
+    return true;
+}
+
+bool BinaryJsonEncoder::OnKey(std::string_view key)
+{
+    return OnString(key);
+}
+
+bool BinaryJsonEncoder::OnString(std::string_view str)
+{
+    if (m_format == BinaryJsonFormat::Cbor)
+    {
+        Cbor::AppendString(m_buffer, str);
+    }
+    else
+    {
+        MessagePack::AppendString(m_buffer, str);
+    }
+    return true;
+}
+
+bool BinaryJsonEncoder::OnInt64(int64_t i)
+{
+    if (m_format == BinaryJsonFormat::Cbor)
+    {
+        Cbor::AppendInt64(m_buffer, i);
+    }
+    else
+    {
+        MessagePack::AppendInt64(m_buffer, i);
+    }
+    return true;
+}
+
+bool BinaryJsonEncoder::OnUint64(uint64_t u)
+{
+    if (m_format == BinaryJsonFormat::Cbor)
+    {
+        Cbor::AppendHead(m_buffer, Cbor::UnsignedInt, u);
+    }
+    else
+    {
+        MessagePack::AppendUint64(m_buffer, u);
+    }
+    return true;
+}
+
+bool BinaryJsonEncoder::OnDouble(double d)
+{
+    if (m_format == BinaryJsonFormat::Cbor)
+    {
+        Cbor::AppendDouble(m_buffer, d);
+    }
+    else
+    {
+        MessagePack::AppendDouble(m_buffer, d);
+    }
+    return true;
+}
+
+bool BinaryJsonEncoder::OnBool(bool b)
+{
+    if (m_format == BinaryJsonFormat::Cbor)
+    {
+        m_buffer.push_back(static_cast<char>(b ? Cbor::True : Cbor::False));
+    }
+    else
+    {
+        m_buffer.push_back(static_cast<char>(b ? MessagePack::True : MessagePack::False));
+    }
+    return true;
+}
+
+bool BinaryJsonEncoder::OnNull()
+{
+    m_buffer.push_back(static_cast<char>(
+        (m_format == BinaryJsonFormat::Cbor) ? Cbor::Null : MessagePack::Nil));
+    return true;
+}
+
+// Recursive descent decoder, sends the events to the handler.
+class BinaryJsonDecoder
+{
+public:
+    // Limit the nesting to avoid stack overflow on malicious data.
+    static constexpr uint32_t MaxDepth = 512;
+
+    BinaryJsonDecoder(std::string_view data, JsonHandler* handler) :
+        m_data(data),
+        m_handler(handler)
+    {
+    }
+
+    bool DecodeCbor(uint32_t depth);
+    bool DecodeMessagePack(uint32_t depth);
+
+    size_t GetOffset() const { return m_offset; }
+    const char* GetError() const { return m_error; }
+    bool IsStopped() const { return m_isStopped; }
+
+private:
+    bool SetError(const char* error)
+    {
+        m_error = error;
+        return false;
+    }
+
+    // Return false if the handler stopped.
+    bool Check(bool result)
+    {
+        m_isStopped = !result;
+        return result;
+    }
+
+    bool ReadByte(uint8_t& byte)
+    {
+        if (m_offset >= m_data.size())
+        {
+            return SetError("unexpected end of data");
+        }
+        byte = static_cast<uint8_t>(m_data[m_offset++]);
+        return true;
+    }
+
+    bool ReadBigEndian(size_t size, uint64_t& value)
+    {
+        if (m_data.size() - m_offset < size)
+        {
+            return SetError("unexpected end of data");
+        }
+        value = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            value = (value << 8) | static_cast<uint8_t>(m_data[m_offset++]);
+        }
+        return true;
+    }
+
+    bool ReadBytes(uint64_t size, std::string_view& bytes)
+    {
+        if (m_data.size() - m_offset < size)
+        {
+            return SetError("unexpected end of data");
+        }
+        bytes = m_data.substr(m_offset, static_cast<size_t>(size));
+        m_offset += static_cast<size_t>(size);
+        return true;
+    }
+
+    bool ReadCborArgument(uint8_t info, uint64_t& argument);
+    // Read a definite or indefinite-length (joined to m_chunks) string.
+    bool ReadCborString(uint8_t majorType, uint8_t info, std::string_view& str);
+
+    std::string_view m_data;
+    JsonHandler* m_handler;
+    size_t m_offset = 0;
+    const char* m_error = nullptr;
+    bool m_isStopped = false;
+    std::string m_chunks;
+
+}; // class BinaryJsonDecoder
+
+bool BinaryJsonDecoder::ReadCborArgument(uint8_t info, uint64_t& argument)
+{
+    if (info < Cbor::Uint8Follows)
+    {
+        argument = info;
+        return true;
+    }
+    else if (info <= Cbor::Uint64Follows)
+    {
+        return ReadBigEndian(size_t(1) << (info - Cbor::Uint8Follows), argument);
+    }
+    return SetError("invalid additional information");
+}
+
+bool BinaryJsonDecoder::ReadCborString(uint8_t majorType, uint8_t info, std::string_view& str)
+{
+    if (info != Cbor::IndefiniteLength)
+    {
+        uint64_t size = 0;
+        return ReadCborArgument(info, size) && ReadBytes(size, str);
+    }
+    m_chunks.clear();
+    while (true)
+    {
+        uint8_t byte = 0;
+        if (!ReadByte(byte))
+        {
+            return false;
+        }
+        if (byte == Cbor::Break)
+        {
+            break;
+        }
+        // The chunks must be definite-length strings of the same type.
+        if (((byte >> 5) != majorType) || ((byte & 31) == Cbor::IndefiniteLength))
+        {
+            return SetError("invalid string chunk");
+        }
+        std::string_view chunk;
+        if (!ReadCborString(majorType, byte & 31, chunk))
+        {
+            return false;
+        }
+        m_chunks.append(chunk);
+    }
+    str = m_chunks;
+    return true;
+}
+
+bool BinaryJsonDecoder::DecodeCbor(uint32_t depth)
+{
+    if (depth > MaxDepth)
+    {
+        return SetError("too deep");
+    }
+    uint8_t byte = 0;
+    if (!ReadByte(byte))
+    {
+        return false;
+    }
+    const uint8_t majorType = byte >> 5;
+    const uint8_t info = byte & 31;
+    uint64_t argument = 0;
+    switch (majorType)
+    {
+    case Cbor::UnsignedInt:
+        if (!ReadCborArgument(info, argument))
+        {
+            return false;
+        }
+        if (argument <= INT64_MAX)
+        {
+            return Check(m_handler->OnInt64(static_cast<int64_t>(argument)));
+        }
+        return Check(m_handler->OnUint64(argument));
+    case Cbor::NegativeInt:
+        if (!ReadCborArgument(info, argument))
+        {
+            return false;
+        }
+        if (argument <= INT64_MAX)
+        {
+            return Check(m_handler->OnInt64(-1 - static_cast<int64_t>(argument)));
+        }
+        // Out of the range of int64.
+        return Check(m_handler->OnDouble(-1.0 - static_cast<double>(argument)));
+    case Cbor::ByteString:
+    case Cbor::TextString:
+    {
+        std::string_view str;
+        return ReadCborString(majorType, info, str) && Check(m_handler->OnString(str));
+    }
+    case Cbor::Array:
+    {
+        if (!Check(m_handler->OnArrayBegin()))
+        {
+            return false;
+        }
+        size_t count = 0;
+        if (info == Cbor::IndefiniteLength)
+        {
+            while (true)
+            {
+                if (m_offset >= m_data.size())
+                {
+                    return SetError("unexpected end of data");
+                }
+                if (static_cast<uint8_t>(m_data[m_offset]) == Cbor::Break)
+                {
+                    m_offset++;
+                    break;
+                }
+                if (!DecodeCbor(depth + 1))
+                {
+                    return false;
+                }
+                count++;
+            }
+        }
+        else
+        {
+            if (!ReadCborArgument(info, argument))
+            {
+                return false;
+            }
+            for (; count < argument; ++count)
+            {
+                if (!DecodeCbor(depth + 1))
+                {
+                    return false;
+                }
+            }
+        }
+        return Check(m_handler->OnArrayEnd(count));
+    }
+    case Cbor::Map:
+    {
+        if (!Check(m_handler->OnObjectBegin()))
+        {
+            return false;
+        }
+        const bool isIndefinite = (info == Cbor::IndefiniteLength);
+        if (!isIndefinite && !ReadCborArgument(info, argument))
+        {
+            return false;
+        }
+        size_t count = 0;
+        while (isIndefinite || (count < argument))
+        {
+            uint8_t keyByte = 0;
+            if (!ReadByte(keyByte))
+            {
+                return false;
+            }
+            if (isIndefinite && (keyByte == Cbor::Break))
+            {
+                break;
+            }
+            const uint8_t keyType = keyByte >> 5;
+            if ((keyType != Cbor::TextString) && (keyType != Cbor::ByteString))
+            {
+                return SetError("map key is not a string");
+            }
+            std::string_view key;
+            if (!ReadCborString(keyType, keyByte & 31, key) ||
+                !Check(m_handler->OnKey(key)) ||
+                !DecodeCbor(depth + 1))
+            {
+                return false;
+            }
+            count++;
+        }
+        return Check(m_handler->OnObjectEnd(count));
+    }
+    case Cbor::Tag:
+        // Ignore the tag and decode the content.
+        return ReadCborArgument(info, argument) && DecodeCbor(depth + 1);
+    default:
+        switch (byte)
+        {
+        case Cbor::False:
+            return Check(m_handler->OnBool(false));
+        case Cbor::True:
+            return Check(m_handler->OnBool(true));
+        case Cbor::Null:
+        case Cbor::Undefined:
+            return Check(m_handler->OnNull());
+        case Cbor::Float16:
+        {
+            if (!ReadBigEndian(2, argument))
+            {
+                return false;
+            }
+            // RFC 8949 Appendix D.
+            const int exponent = (argument >> 10) & 0x1F;
+            const int mantissa = argument & 0x3FF;
+            double value = 0;
+            if (exponent == 0)
+            {
+                value = std::ldexp(mantissa, -24);
+            }
+            else if (exponent != 31)
+            {
+                value = std::ldexp(mantissa + 1024, exponent - 25);
+            }
+            else
+            {
+                value = (mantissa == 0) ? INFINITY : NAN;
+            }
+            return Check(m_handler->OnDouble((argument & 0x8000) ? -value : value));
+        }
+        case Cbor::Float32:
+            return ReadBigEndian(4, argument) &&
+                Check(m_handler->OnDouble(std::bit_cast<float>(static_cast<uint32_t>(argument))));
+        case Cbor::Float64:
+            return ReadBigEndian(8, argument) &&
+                Check(m_handler->OnDouble(std::bit_cast<double>(argument)));
+        default:
+            return SetError("unsupported simple value");
+        }
+    }
+}
+
+bool BinaryJsonDecoder::DecodeMessagePack(uint32_t depth)
+{
+    if (depth > MaxDepth)
+    {
+        return SetError("too deep");
+    }
+    uint8_t byte = 0;
+    if (!ReadByte(byte))
+    {
+        return false;
+    }
+
+    uint64_t size = 0;
+    bool isObject = false;
+    if (byte < 0x80)
+    {
+        return Check(m_handler->OnInt64(byte));
+    }
+    else if (byte >= 0xE0)
+    {
+        return Check(m_handler->OnInt64(static_cast<int8_t>(byte)));
+    }
+    else if ((byte & 0xE0) == MessagePack::FixStr)
+    {
+        std::string_view str;
+        return ReadBytes(byte & 0x1F, str) && Check(m_handler->OnString(str));
+    }
+    else if ((byte & 0xF0) == MessagePack::FixMap)
+    {
+        size = byte & 0x0F;
+        isObject = true;
+    }
+    else if ((byte & 0xF0) == MessagePack::FixArray)
+    {
+        size = byte & 0x0F;
+    }
+    else
+    {
+        uint64_t value = 0;
+        std::string_view str;
+        switch (byte)
+        {
+        case MessagePack::Nil:
+            return Check(m_handler->OnNull());
+        case MessagePack::False:
+            return Check(m_handler->OnBool(false));
+        case MessagePack::True:
+            return Check(m_handler->OnBool(true));
+        case MessagePack::Bin8:
+        case MessagePack::Str8:
+            return ReadBigEndian(1, size) && ReadBytes(size, str) && Check(m_handler->OnString(str));
+        case MessagePack::Bin16:
+        case MessagePack::Str16:
+            return ReadBigEndian(2, size) && ReadBytes(size, str) && Check(m_handler->OnString(str));
+        case MessagePack::Bin32:
+        case MessagePack::Str32:
+            return ReadBigEndian(4, size) && ReadBytes(size, str) && Check(m_handler->OnString(str));
+        case MessagePack::Float32:
+            return ReadBigEndian(4, value) &&
+                Check(m_handler->OnDouble(std::bit_cast<float>(static_cast<uint32_t>(value))));
+        case MessagePack::Float64:
+            return ReadBigEndian(8, value) && Check(m_handler->OnDouble(std::bit_cast<double>(value)));
+        case MessagePack::Uint8:
+        case MessagePack::Uint16:
+        case MessagePack::Uint32:
+        case MessagePack::Uint64:
+            if (!ReadBigEndian(size_t(1) << (byte - MessagePack::Uint8), value))
+            {
+                return false;
+            }
+            if (value <= INT64_MAX)
+            {
+                return Check(m_handler->OnInt64(static_cast<int64_t>(value)));
+            }
+            return Check(m_handler->OnUint64(value));
+        case MessagePack::Int8:
+        case MessagePack::Int16:
+        case MessagePack::Int32:
+        case MessagePack::Int64:
+        {
+            const size_t byteCount = size_t(1) << (byte - MessagePack::Int8);
+            if (!ReadBigEndian(byteCount, value))
+            {
+                return false;
+            }
+            // Sign extend.
+            const int shift = static_cast<int>(64 - byteCount * 8);
+            return Check(m_handler->OnInt64(static_cast<int64_t>(value << shift) >> shift));
+        }
+        case MessagePack::Array16:
+            if (!ReadBigEndian(2, size))
+            {
+                return false;
+            }
+            break;
+        case MessagePack::Array32:
+            if (!ReadBigEndian(4, size))
+            {
+                return false;
+            }
+            break;
+        case MessagePack::Map16:
+            if (!ReadBigEndian(2, size))
+            {
+                return false;
+            }
+            isObject = true;
+            break;
+        case MessagePack::Map32:
+            if (!ReadBigEndian(4, size))
+            {
+                return false;
+            }
+            isObject = true;
+            break;
+        default:
+            // Extension types and the reserved 0xC1.
+            return SetError("unsupported type");
+        }
+    }
+
+    if (!isObject)
+    {
+        if (!Check(m_handler->OnArrayBegin()))
+        {
+            return false;
+        }
+        for (uint64_t i = 0; i < size; ++i)
+        {
+            if (!DecodeMessagePack(depth + 1))
+            {
+                return false;
+            }
+        }
+        return Check(m_handler->OnArrayEnd(static_cast<size_t>(size)));
+    }
+
+    if (!Check(m_handler->OnObjectBegin()))
+    {
+        return false;
+    }
+    for (uint64_t i = 0; i < size; ++i)
+    {
+        uint8_t keyByte = 0;
+        uint64_t keySize = 0;
+        if (!ReadByte(keyByte))
+        {
+            return false;
+        }
+        if ((keyByte & 0xE0) == MessagePack::FixStr)
+        {
+            keySize = keyByte & 0x1F;
+        }
+        else if ((keyByte == MessagePack::Str8) || (keyByte == MessagePack::Bin8))
+        {
+            if (!ReadBigEndian(1, keySize))
+            {
+                return false;
+            }
+        }
+        else if ((keyByte == MessagePack::Str16) || (keyByte == MessagePack::Bin16))
+        {
+            if (!ReadBigEndian(2, keySize))
+            {
+                return false;
+            }
+        }
+        else if ((keyByte == MessagePack::Str32) || (keyByte == MessagePack::Bin32))
+        {
+            if (!ReadBigEndian(4, keySize))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            return SetError("map key is not a string");
+        }
+        std::string_view key;
+        if (!ReadBytes(keySize, key) || !Check(m_handler->OnKey(key)) || !DecodeMessagePack(depth + 1))
+        {
+            return false;
+        }
+    }
+    return Check(m_handler->OnObjectEnd(static_cast<size_t>(size)));
+}
+
+bool DecodeBinaryJson(std::string_view data, BinaryJsonFormat format, JsonHandler* handler,
+    size_t* bytesRead)
+{
+    BinaryJsonDecoder decoder(data, handler);
+    const bool result = (format == BinaryJsonFormat::Cbor) ? decoder.DecodeCbor(0) : decoder.DecodeMessagePack(0);
+    if (bytesRead)
+    {
+        *bytesRead = decoder.GetOffset();
+    }
+    if (!result && !decoder.IsStopped())
+    {
+        LogGlobal(Error, "DecodeBinaryJson: {} (offset={})", decoder.GetError(), decoder.GetOffset());
+    }
+    return result;
+}
+
+bool DecodeBinaryJson(std::string_view data, BinaryJsonFormat format, boost::json::value& value,
+    boost::json::storage_ptr storage)
+{
+    JsonSubtreeCollector collector({ "" },
+        [&](std::string_view, boost::json::value&& root)
+        {
+            value = std::move(root);
+            return true;
+        }, std::move(storage));
+    return DecodeBinaryJson(data, format, &collector);
+}
+
+bool DecodeBinaryJsonFromFile(std::string_view fileName, BinaryJsonFormat format, JsonHandler* handler)
+{
+    MappedFile file;
+    if (!file.Open(fileName) || !file.Map())
+    {
+        LogGlobal(Error, "DecodeBinaryJsonFromFile: failed to map {}", fileName);
+        return false;
+    }
+    file.Advise(MappedFile::Advice::Sequential);
+    return DecodeBinaryJson(file.GetString(), format, handler);
+}
+
+bool DecodeBinaryJsonFromFile(std::string_view fileName, BinaryJsonFormat format, boost::json::value& value,
+    boost::json::storage_ptr storage)
+{
+    MappedFile file;
+    if (!file.Open(fileName) || !file.Map())
+    {
+        LogGlobal(Error, "DecodeBinaryJsonFromFile: failed to map {}", fileName);
+        return false;
+    }
+    file.Advise(MappedFile::Advice::Sequential);
+    return DecodeBinaryJson(file.GetString(), format, value, std::move(storage));
+}
+
+} // namespace rad
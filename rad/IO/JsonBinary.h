@@ -0,0 +1,69 @@
+#pragma once
+
+#include "JsonStream.h"
+
+namespace rad
+{
+
+// Binary encodings of the JSON data model:
+// CBOR (RFC 8949) and MessagePack (https://github.com/msgpack/msgpack/blob/master/spec.md).
+enum class BinaryJsonFormat
+{
+    Cbor,
+    MessagePack,
+};
+
+// Append the encoding of the value to the buffer.
+void EncodeBinaryJson(const boost::json::value& value, BinaryJsonFormat format, std::string& buffer);
+std::string EncodeBinaryJson(const boost::json::value& value, BinaryJsonFormat format);
+
+// Encode the events of JsonStreamParser (or any event source) to the end of the buffer,
+// e.g. convert a huge text document without building the value:
+//  BinaryJsonEncoder encoder(BinaryJsonFormat::Cbor, buffer);
+//  ParseJsonFromFile("huge.json", &encoder);
+// The containers are encoded with fixed-width (32-bit) lengths patched at the end.
+class BinaryJsonEncoder : public JsonHandler
+{
+public:
+    BinaryJsonEncoder(BinaryJsonFormat format, std::string& buffer);
+    ~BinaryJsonEncoder();
+
+    bool OnObjectBegin() override;
+    bool OnObjectEnd(size_t memberCount) override;
+    bool OnArrayBegin() override;
+    bool OnArrayEnd(size_t elementCount) override;
+    bool OnKey(std::string_view key) override;
+    bool OnString(std::string_view str) override;
+    bool OnInt64(int64_t i) override;
+    bool OnUint64(uint64_t u) override;
+    bool OnDouble(double d) override;
+    bool OnBool(bool b) override;
+    bool OnNull() override;
+
+private:
+    void BeginContainer(bool isObject);
+    void EndContainer(size_t count);
+
+    BinaryJsonFormat m_format;
+    std::string& m_buffer;
+    // The offsets of the container lengths to be patched.
+    std::vector<size_t> m_lengthOffsets;
+
+}; // class BinaryJsonEncoder
+
+// Decode one data item and send the events to the handler; the strings passed to the handler
+// point into the data directly (zero-copy) unless split into chunks (CBOR indefinite-length strings).
+// Byte strings are decoded as strings, CBOR tags are ignored; return false on invalid data (logged),
+// or if the handler stopped.
+// @param bytesRead: the size of the item decoded, optional.
+bool DecodeBinaryJson(std::string_view data, BinaryJsonFormat format, JsonHandler* handler,
+    size_t* bytesRead = nullptr);
+bool DecodeBinaryJson(std::string_view data, BinaryJsonFormat format, boost::json::value& value,
+    boost::json::storage_ptr storage = {});
+
+// Decode from the mapping of the file, the strings passed to the handler point into the mapping.
+bool DecodeBinaryJsonFromFile(std::string_view fileName, BinaryJsonFormat format, JsonHandler* handler);
+bool DecodeBinaryJsonFromFile(std::string_view fileName, BinaryJsonFormat format, boost::json::value& value,
+    boost::json::storage_ptr storage = {});
+
+} // namespace rad
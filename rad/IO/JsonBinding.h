@@ -0,0 +1,489 @@
+#pragma once
+
+#include "Json.h"
+#include <array>
+#include <bit>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+// Declarative JSON binding of structs, generated at compile time:
+//
+//  struct WindowConfig
+//  {
+//      std::string title;
+//      int width = 1280;
+//      int height = 720;
+//      std::optional<bool> fullscreen;
+//  };
+//  RAD_JSON_BINDING(WindowConfig, title, width, height, fullscreen)
+//
+//  WindowConfig config;
+//  rad::ReadJson(rad::ParseJsonFromFile("config.json"), config);
+//  boost::json::value jv = rad::WriteJson(config);
+//
+// The macro must be used in the namespace of the struct (found by ADL), and the members must be accessible.
+// It also makes the struct work with boost::json::value_from/value_to.
+// ReadJson walks the object members once, each key is dispatched by a perfect hash table built at compile time;
+// unknown keys are ignored, and missing members keep their values.
+
+namespace rad
+{
+
+template<typename Class, typename Member>
+struct JsonField
+{
+    std::string_view name;
+    Member Class::* pointer;
+};
+
+template<typename Class, typename Member>
+constexpr JsonField<Class, Member> MakeJsonField(std::string_view name, Member Class::* pointer)
+{
+    return { name, pointer };
+}
+
+namespace detail
+{
+
+constexpr uint32_t JsonKeyHash(std::string_view key, uint32_t seed)
+{
+    // FNV-1a with seed.
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : key)
+    {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// Maps each key to its index without collision: slots[hash(key, seed) & (TableSize - 1)] == index.
+template<size_t KeyCount>
+struct JsonKeyTable
+{
+    static constexpr size_t TableSize = std::bit_ceil(KeyCount * 4 + 1);
+    static constexpr uint8_t EmptySlot = 0xFF;
+    static_assert(KeyCount < EmptySlot, "Too many members.");
+
+    std::array<std::string_view, KeyCount> keys = {};
+    std::array<uint8_t, TableSize> slots = {};
+    uint32_t seed = 0;
+    bool isValid = false;
+
+    constexpr JsonKeyTable(const std::array<std::string_view, KeyCount>& keys) :
+        keys(keys)
+    {
+        for (uint32_t seed = 0; seed < 1000000; ++seed)
+        {
+            if (TryBuild(seed))
+            {
+                this->seed = seed;
+                isValid = true;
+                return;
+            }
+        }
+    }
+
+    constexpr bool TryBuild(uint32_t seed)
+    {
+        slots.fill(EmptySlot);
+        for (size_t i = 0; i < KeyCount; ++i)
+        {
+            uint8_t& slot = slots[JsonKeyHash(keys[i], seed) & (TableSize - 1)];
+            if (slot != EmptySlot)
+            {
+                return false;
+            }
+            slot = static_cast<uint8_t>(i);
+        }
+        return true;
+    }
+
+    // Return KeyCount if not found.
+    constexpr size_t Find(std::string_view key) const
+    {
+        const uint8_t slot = slots[JsonKeyHash(key, seed) & (TableSize - 1)];
+        return ((slot != EmptySlot) && (keys[slot] == key)) ? slot : KeyCount;
+    }
+};
+
+template<typename T>
+concept HasJsonFields = requires { RadJsonGetFields(static_cast<const T*>(nullptr)); };
+
+template<typename T>
+constexpr auto GetJsonFields()
+{
+    return RadJsonGetFields(static_cast<const T*>(nullptr));
+}
+
+template<typename T>
+struct JsonBindingTraits
+{
+    static constexpr auto Fields = GetJsonFields<T>();
+    static constexpr size_t FieldCount = std::tuple_size_v<decltype(Fields)>;
+    static constexpr JsonKeyTable<FieldCount> KeyTable = std::apply(
+        [](const auto&... fields) { return JsonKeyTable<FieldCount>({ fields.name... }); }, Fields);
+    static_assert(KeyTable.isValid, "Duplicate member names.");
+};
+
+template<typename T>
+struct IsJsonOptional : std::false_type {};
+template<typename T>
+struct IsJsonOptional<std::optional<T>> : std::true_type {};
+
+} // namespace detail
+
+// Types bound by RAD_JSON_BINDING.
+template<typename T>
+concept JsonBound = detail::HasJsonFields<T>;
+
+template<typename T>
+bool ReadJson(const boost::json::value& jv, T& obj);
+template<typename T>
+void WriteJson(boost::json::value& jv, const T& obj);
+
+namespace detail
+{
+
+template<typename T, size_t... I>
+bool ReadJsonField(size_t index, const boost::json::value& jv, T& obj, std::index_sequence<I...>)
+{
+    constexpr const auto& fields = JsonBindingTraits<T>::Fields;
+    bool result = true;
+    // Expands to a switch on the index.
+    (void)((index == I ? (result = ReadJson(jv, obj.*(std::get<I>(fields).pointer)), true) : false) || ...);
+    return result;
+}
+
+template<typename T, size_t... I>
+void WriteJsonFields(boost::json::object& jo, const T& obj, std::index_sequence<I...>)
+{
+    constexpr const auto& fields = JsonBindingTraits<T>::Fields;
+    auto writeField = [&](const auto& field)
+        {
+            const auto& member = obj.*(field.pointer);
+            if constexpr (IsJsonOptional<std::remove_cvref_t<decltype(member)>>::value)
+            {
+                if (!member)
+                {
+                    return;
+                }
+            }
+            WriteJson(jo[field.name], member);
+        };
+    (writeField(std::get<I>(fields)), ...);
+}
+
+template<typename Map>
+bool ReadJsonMap(const boost::json::value& jv, Map& map)
+{
+    const boost::json::object* jo = jv.if_object();
+    if (jo == nullptr)
+    {
+        return false;
+    }
+    bool result = true;
+    map.clear();
+    for (const boost::json::key_value_pair& member : *jo)
+    {
+        result &= ReadJson(member.value(), map[std::string(member.key())]);
+    }
+    return result;
+}
+
+template<typename Map>
+void WriteJsonMap(boost::json::value& jv, const Map& map)
+{
+    boost::json::object& jo = jv.emplace_object();
+    jo.reserve(map.size());
+    for (const auto& [key, value] : map)
+    {
+        WriteJson(jo[key], value);
+    }
+}
+
+} // namespace detail
+
+// Return false if any value has a mismatched type (or out of range), which is left unchanged.
+template<typename T>
+bool ReadJson(const boost::json::value& jv, T& obj)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        if (const bool* b = jv.if_bool())
+        {
+            obj = *b;
+            return true;
+        }
+        return false;
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        if (const int64_t* i = jv.if_int64())
+        {
+            if (std::in_range<T>(*i))
+            {
+                obj = static_cast<T>(*i);
+                return true;
+            }
+        }
+        else if (const uint64_t* u = jv.if_uint64())
+        {
+            if (std::in_range<T>(*u))
+            {
+                obj = static_cast<T>(*u);
+                return true;
+            }
+        }
+        return false;
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        if (jv.is_number())
+        {
+            obj = jv.to_number<T>();
+            return true;
+        }
+        return false;
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        std::underlying_type_t<T> value = {};
+        if (ReadJson(jv, value))
+        {
+            obj = static_cast<T>(value);
+            return true;
+        }
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        if (const boost::json::string* str = jv.if_string())
+        {
+            obj.assign(str->data(), str->size());
+            return true;
+        }
+        return false;
+    }
+    else if constexpr (std::is_same_v<T, boost::json::value>)
+    {
+        obj = jv;
+        return true;
+    }
+    else if constexpr (detail::IsJsonOptional<T>::value)
+    {
+        if (jv.is_null())
+        {
+            obj.reset();
+            return true;
+        }
+        typename T::value_type value = obj.value_or(typename T::value_type{});
+        if (ReadJson(jv, value))
+        {
+            obj = std::move(value);
+            return true;
+        }
+        return false;
+    }
+    else if constexpr (JsonBound<T>)
+    {
+        const boost::json::object* jo = jv.if_object();
+        if (jo == nullptr)
+        {
+            return false;
+        }
+        using Traits = detail::JsonBindingTraits<T>;
+        bool result = true;
+        for (const boost::json::key_value_pair& member : *jo)
+        {
+            const size_t index = Traits::KeyTable.Find(member.key());
+            if (index < Traits::FieldCount)
+            {
+                result &= detail::ReadJsonField(index, member.value(), obj,
+                    std::make_index_sequence<Traits::FieldCount>());
+            }
+        }
+        return result;
+    }
+    else if constexpr (requires { typename T::key_type; typename T::mapped_type; })
+    {
+        return detail::ReadJsonMap(jv, obj);
+    }
+    else if constexpr (requires { obj.resize(0); obj[0]; })
+    {
+        const boost::json::array* ja = jv.if_array();
+        if (ja == nullptr)
+        {
+            return false;
+        }
+        bool result = true;
+        obj.resize(ja->size());
+        for (size_t i = 0; i < ja->size(); ++i)
+        {
+            result &= ReadJson((*ja)[i], obj[i]);
+        }
+        return result;
+    }
+    else if constexpr (requires { std::tuple_size<T>::value; obj[0]; })
+    {
+        // std::array: the size must match.
+        const boost::json::array* ja = jv.if_array();
+        if ((ja == nullptr) || (ja->size() != std::tuple_size_v<T>))
+        {
+            return false;
+        }
+        bool result = true;
+        for (size_t i = 0; i < ja->size(); ++i)
+        {
+            result &= ReadJson((*ja)[i], obj[i]);
+        }
+        return result;
+    }
+    else
+    {
+        static_assert(sizeof(T) == 0, "ReadJson: unsupported type.");
+    }
+}
+
+template<typename T>
+void WriteJson(boost::json::value& jv, const T& obj)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        jv = obj;
+    }
+    else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+    {
+        jv = static_cast<int64_t>(obj);
+    }
+    else if constexpr (std::is_integral_v<T>)
+    {
+        jv = static_cast<uint64_t>(obj);
+    }
+    else if constexpr (std::is_floating_point_v<T>)
+    {
+        jv = static_cast<double>(obj);
+    }
+    else if constexpr (std::is_enum_v<T>)
+    {
+        WriteJson(jv, static_cast<std::underlying_type_t<T>>(obj));
+    }
+    else if constexpr (std::is_same_v<T, std::string>)
+    {
+        jv = boost::json::string_view(obj.data(), obj.size());
+    }
+    else if constexpr (std::is_same_v<T, boost::json::value>)
+    {
+        jv = obj;
+    }
+    else if constexpr (detail::IsJsonOptional<T>::value)
+    {
+        if (obj)
+        {
+            WriteJson(jv, *obj);
+        }
+        else
+        {
+            jv = nullptr;
+        }
+    }
+    else if constexpr (JsonBound<T>)
+    {
+        boost::json::object& jo = jv.emplace_object();
+        jo.reserve(detail::JsonBindingTraits<T>::FieldCount);
+        detail::WriteJsonFields(jo, obj, std::make_index_sequence<detail::JsonBindingTraits<T>::FieldCount>());
+    }
+    else if constexpr (requires { typename T::key_type; typename T::mapped_type; })
+    {
+        detail::WriteJsonMap(jv, obj);
+    }
+    else if constexpr (requires { obj.size(); obj[0]; })
+    {
+        boost::json::array& ja = jv.emplace_array();
+        ja.reserve(obj.size());
+        for (const auto& element : obj)
+        {
+            WriteJson(ja.emplace_back(nullptr), element);
+        }
+    }
+    else
+    {
+        static_assert(sizeof(T) == 0, "WriteJson: unsupported type.");
+    }
+}
+
+template<typename T>
+boost::json::value WriteJson(const T& obj)
+{
+    boost::json::value jv;
+    WriteJson(jv, obj);
+    return jv;
+}
+
+} // namespace rad
+
+#define RAD_JSON_EXPAND(x) x
+#define RAD_JSON_GET_MACRO(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, Name, ...) Name
+#define RAD_JSON_FOR_EACH_1(Macro, Type, x) Macro(Type, x)
+#define RAD_JSON_FOR_EACH_2(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_1(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_3(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_2(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_4(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_3(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_5(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_4(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_6(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_5(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_7(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_6(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_8(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_7(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_9(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_8(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_10(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_9(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_11(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_10(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_12(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_11(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_13(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_12(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_14(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_13(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_15(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_14(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_16(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_15(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_17(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_16(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_18(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_17(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_19(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_18(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_20(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_19(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_21(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_20(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_22(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_21(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_23(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_22(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_24(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_23(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_25(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_24(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_26(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_25(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_27(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_26(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_28(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_27(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_29(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_28(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_30(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_29(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_31(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_30(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH_32(Macro, Type, x, ...) Macro(Type, x), RAD_JSON_EXPAND(RAD_JSON_FOR_EACH_31(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FOR_EACH(Macro, Type, ...) RAD_JSON_EXPAND(RAD_JSON_GET_MACRO(__VA_ARGS__, \
+    RAD_JSON_FOR_EACH_32, RAD_JSON_FOR_EACH_31, RAD_JSON_FOR_EACH_30, RAD_JSON_FOR_EACH_29, RAD_JSON_FOR_EACH_28, RAD_JSON_FOR_EACH_27, RAD_JSON_FOR_EACH_26, RAD_JSON_FOR_EACH_25, \
+    RAD_JSON_FOR_EACH_24, RAD_JSON_FOR_EACH_23, RAD_JSON_FOR_EACH_22, RAD_JSON_FOR_EACH_21, RAD_JSON_FOR_EACH_20, RAD_JSON_FOR_EACH_19, RAD_JSON_FOR_EACH_18, RAD_JSON_FOR_EACH_17, \
+    RAD_JSON_FOR_EACH_16, RAD_JSON_FOR_EACH_15, RAD_JSON_FOR_EACH_14, RAD_JSON_FOR_EACH_13, RAD_JSON_FOR_EACH_12, RAD_JSON_FOR_EACH_11, RAD_JSON_FOR_EACH_10, RAD_JSON_FOR_EACH_9, \
+    RAD_JSON_FOR_EACH_8, RAD_JSON_FOR_EACH_7, RAD_JSON_FOR_EACH_6, RAD_JSON_FOR_EACH_5, RAD_JSON_FOR_EACH_4, RAD_JSON_FOR_EACH_3, RAD_JSON_FOR_EACH_2, RAD_JSON_FOR_EACH_1)(Macro, Type, __VA_ARGS__))
+#define RAD_JSON_FIELD(Type, Member) rad::MakeJsonField(#Member, &Type::Member)
+
+// Bind up to 32 members of Type.
+#define RAD_JSON_BINDING(Type, ...) \
+    [[maybe_unused]] constexpr auto RadJsonGetFields(const Type*) \
+    { \
+        return std::make_tuple(RAD_JSON_FOR_EACH(RAD_JSON_FIELD, Type, __VA_ARGS__)); \
+    } \
+    inline void tag_invoke(const boost::json::value_from_tag&, boost::json::value& jv, const Type& obj) \
+    { \
+        rad::WriteJson(jv, obj); \
+    } \
+    inline Type tag_invoke(const boost::json::value_to_tag<Type>&, const boost::json::value& jv) \
+    { \
+        Type obj = {}; \
+        if (!rad::ReadJson(jv, obj)) \
+        { \
+            throw std::invalid_argument("value_to<" #Type ">: mismatched JSON."); \
+        } \
+        return obj; \
+    }
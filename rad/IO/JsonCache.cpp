@@ -0,0 +1,113 @@
+#include "JsonCache.h"
+#include "File.h"
+#include "Logging.h"
+#include "rad/System/FileMetadata.h"
+
+namespace rad
+{
+
+JsonDocumentCache::JsonDocumentCache(const Options& options) :
+    m_options(options)
+{
+}
+
+JsonDocumentCache::~JsonDocumentCache()
+{
+}
+
+std::shared_ptr<JsonDocumentCache::Entry> JsonDocumentCache::GetEntry(std::string_view fileName)
+{
+    std::lock_guard lock(m_mutex);
+    std::string key(fileName);
+    auto iter = m_entries.find(key);
+    if (iter == m_entries.end())
+    {
+        iter = m_entries.emplace(std::move(key), std::make_shared<Entry>()).first;
+    }
+    return iter->second;
+}
+
+JsonDocumentCache::Document JsonDocumentCache::Get(std::string_view fileName, bool* isUpdated)
+{
+    if (isUpdated)
+    {
+        *isUpdated = false;
+    }
+
+    std::shared_ptr<Entry> entry = GetEntry(fileName);
+    std::lock_guard lock(entry->mutex);
+
+    const auto now = std::chrono::steady_clock::now();
+    if (!entry->isStale && (now - entry->lastCheck < m_options.checkInterval))
+    {
+        return entry->document;
+    }
+
+    // Not logged: a missing file (e.g. being replaced) is expected, and checked again on every Get.
+    FileMetadata status;
+    if (!GetFileMetadata(FilePath(fileName), &status) || !status.IsRegularFile())
+    {
+        // Keep the last good document, e.g. the file is being replaced.
+        return entry->document;
+    }
+    entry->lastCheck = now;
+    if (!entry->isStale && !entry->isRacy && (status.size == entry->size) && (status.mtimeNs == entry->mtimeNs))
+    {
+        return entry->document;
+    }
+
+    // Racy mtime: a file modified within the mtime granularity of this check may be rewritten
+    // with the same size and mtime, check its contents again next time.
+    const uint64_t checkTimeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    entry->isStale = false;
+    entry->isRacy = (status.mtimeNs + MtimeGranularityNs > checkTimeNs);
+    entry->size = status.size;
+    entry->mtimeNs = status.mtimeNs;
+    try
+    {
+        auto document = std::make_shared<boost::json::value>(ParseJsonFromFile(fileName,
+            boost::json::make_shared_resource<boost::json::monotonic_resource>()));
+        if (entry->document && (*document == *entry->document))
+        {
+            // Touched or checked again (racy), but the same contents: keep sharing the document.
+            return entry->document;
+        }
+        entry->document = std::move(document);
+    }
+    catch (const std::exception& e)
+    {
+        LogGlobal(Error, "JsonDocumentCache: failed to parse {}: {}", fileName, e.what());
+        // Do not parse the same broken file again until it changes (or while racy).
+        return entry->document;
+    }
+    if (isUpdated)
+    {
+        *isUpdated = true;
+    }
+    return entry->document;
+}
+
+void JsonDocumentCache::Invalidate(std::string_view fileName)
+{
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard lock(m_mutex);
+        auto iter = m_entries.find(std::string(fileName));
+        if (iter == m_entries.end())
+        {
+            return;
+        }
+        entry = iter->second;
+    }
+    std::lock_guard lock(entry->mutex);
+    entry->isStale = true;
+}
+
+void JsonDocumentCache::Clear()
+{
+    std::lock_guard lock(m_mutex);
+    m_entries.clear();
+}
+
+} // namespace rad
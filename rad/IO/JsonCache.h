@@ -0,0 +1,70 @@
+#pragma once
+
+#include "Json.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace rad
+{
+
+// Caches the parsed documents by file path (e.g. config files reloaded repeatedly):
+// a file is parsed again only if its size or modification time changed, or it was modified within
+// the mtime granularity of the last check (it may have changed again without changing the mtime);
+// the documents are immutable and shared by all readers without copying.
+class JsonDocumentCache
+{
+public:
+    // Each document owns a monotonic_resource: the nodes are bump allocated and freed all at once
+    // when the last reader releases it.
+    using Document = std::shared_ptr<const boost::json::value>;
+
+    struct Options
+    {
+        // Do not stat the file again within the interval; zero to stat on every Get.
+        std::chrono::milliseconds checkInterval = std::chrono::milliseconds(0);
+    };
+
+    JsonDocumentCache(const Options& options);
+    JsonDocumentCache() : JsonDocumentCache(Options()) {}
+    ~JsonDocumentCache();
+
+    JsonDocumentCache(const JsonDocumentCache&) = delete;
+    JsonDocumentCache& operator=(const JsonDocumentCache&) = delete;
+
+    // Return the latest document of the file, parse it if not cached or changed on disk;
+    // if the file is missing or cannot be parsed (logged), return the last good document, null if none.
+    // isUpdated is set if this call (re)parsed a document different from the cached one.
+    Document Get(std::string_view fileName, bool* isUpdated = nullptr);
+    // Parse the file again on the next Get, regardless of the interval and the file status
+    // (e.g. on a change notification).
+    void Invalidate(std::string_view fileName);
+    // Drop all documents; the readers keep theirs alive.
+    void Clear();
+
+private:
+    struct Entry
+    {
+        // Serialize the checks and reparse of the same file.
+        std::mutex mutex;
+        Document document;
+        uint64_t size = 0;
+        uint64_t mtimeNs = 0;
+        // Parse on the next check even if the file looks unchanged.
+        bool isStale = true;
+        // Modified within the mtime granularity of the last check (racy mtime): it may be rewritten
+        // with the same size and mtime, parse on the next check too (after the check interval).
+        bool isRacy = false;
+        std::chrono::steady_clock::time_point lastCheck;
+    };
+
+    std::shared_ptr<Entry> GetEntry(std::string_view fileName);
+
+    Options m_options;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Entry>> m_entries;
+
+}; // class JsonDocumentCache
+
+} // namespace rad
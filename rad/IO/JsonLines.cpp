@@ -0,0 +1,108 @@
+#include "JsonLines.h"
+#include "Logging.h"
+
+namespace rad
+{
+
+static JsonLinesBatch ParseJsonLinesChunk(std::string_view text, std::string_view chunk, size_t chunkIndex)
+{
+    // The parser (and its value stack) is reused by all chunks parsed on the same thread.
+    thread_local boost::json::parser parser = []()
+        {
+            boost::json::parse_options options = {};
+            SetDefaultParseOptions(options);
+            return boost::json::parser({}, options);
+        }();
+
+    JsonLinesBatch batch;
+    batch.chunkIndex = chunkIndex;
+    ForEachLine(chunk, [&](std::string_view line) {
+        if (line.find_first_not_of(" \t") == std::string_view::npos)
+        {
+            return;
+        }
+        boost::system::error_code ec;
+        parser.reset();
+        parser.write(line.data(), line.size(), ec);
+        if (!ec)
+        {
+            batch.records.push_back(parser.release());
+        }
+        else
+        {
+            if (batch.errorCount == 0)
+            {
+                LogGlobal(Error, "ParseJsonLines: {} (line offset={})",
+                    ec.message(), line.data() - text.data());
+            }
+            batch.errorCount++;
+        }
+        });
+    return batch;
+}
+
+bool ParseJsonLines(std::string_view text, const std::function<void(JsonLinesBatch&& batch)>& onBatch,
+    const TextChunkOptions& options)
+{
+    size_t errorCount = 0;
+    ProcessTextChunks(text,
+        [text](std::string_view chunk, size_t chunkIndex)
+        {
+            return ParseJsonLinesChunk(text, chunk, chunkIndex);
+        },
+        [&](JsonLinesBatch&& batch, size_t)
+        {
+            errorCount += batch.errorCount;
+            onBatch(std::move(batch));
+        },
+        options);
+    return (errorCount == 0);
+}
+
+bool ParseJsonLinesFromFile(std::string_view fileName, const std::function<void(JsonLinesBatch&& batch)>& onBatch,
+    const TextChunkOptions& options)
+{
+    MappedFile file;
+    if (!file.Open(fileName) || !file.Map())
+    {
+        LogGlobal(Error, "ParseJsonLinesFromFile: failed to map {}", fileName);
+        return false;
+    }
+    file.Advise(MappedFile::Advice::Sequential);
+    return ParseJsonLines(file.GetString(), onBatch, options);
+}
+
+static void AppendRecords(std::vector<boost::json::value>& records, JsonLinesBatch&& batch)
+{
+    if (records.empty())
+    {
+        records = std::move(batch.records);
+    }
+    else
+    {
+        records.insert(records.end(),
+            std::make_move_iterator(batch.records.begin()), std::make_move_iterator(batch.records.end()));
+    }
+}
+
+std::vector<boost::json::value> ParseJsonLines(std::string_view text, const TextChunkOptions& options)
+{
+    std::vector<boost::json::value> records;
+    TextChunkOptions orderedOptions = options;
+    orderedOptions.ordered = true;
+    ParseJsonLines(text, [&](JsonLinesBatch&& batch) { AppendRecords(records, std::move(batch)); },
+        orderedOptions);
+    return records;
+}
+
+std::vector<boost::json::value> ParseJsonLinesFromFile(std::string_view fileName, const TextChunkOptions& options)
+{
+    std::vector<boost::json::value> records;
+    TextChunkOptions orderedOptions = options;
+    orderedOptions.ordered = true;
+    ParseJsonLinesFromFile(fileName, [&](JsonLinesBatch&& batch) { AppendRecords(records, std::move(batch)); },
+        orderedOptions);
+    return records;
+}
+
+} // namespace rad
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Json.h"
+#include "TextChunks.h"
+#include <functional>
+
+namespace rad
+{
+
+// The records parsed from one chunk of newline-delimited JSON (NDJSON/JSON Lines).
+struct JsonLinesBatch
+{
+    size_t chunkIndex = 0;
+    std::vector<boost::json::value> records;
+    // Invalid lines are skipped (and logged).
+    size_t errorCount = 0;
+};
+
+// Parse each non-empty line as a JSON value, the chunks are parsed in parallel (see ProcessTextChunks),
+// each worker thread reuses its parser; onBatch is called on the calling thread,
+// in chunk order if options.ordered, otherwise as soon as each chunk is done.
+// Return false if any line is invalid.
+bool ParseJsonLines(std::string_view text, const std::function<void(JsonLinesBatch&& batch)>& onBatch,
+    const TextChunkOptions& options = {});
+// Return false if the file cannot be mapped or any line is invalid.
+bool ParseJsonLinesFromFile(std::string_view fileName, const std::function<void(JsonLinesBatch&& batch)>& onBatch,
+    const TextChunkOptions& options = {});
+
+// Return all records in order.
+std::vector<boost::json::value> ParseJsonLines(std::string_view text, const TextChunkOptions& options = {});
+std::vector<boost::json::value> ParseJsonLinesFromFile(std::string_view fileName, const TextChunkOptions& options = {});
+
+} // namespace rad
@@ -0,0 +1,1060 @@
+#include "JsonScanner.h"
+#include "Logging.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "cpu_features_macros.h"
+#if defined(CPU_FEATURES_ARCH_X86_64)
+#include "cpuinfo_x86.h"
+#include <immintrin.h>
+#define RAD_JSON_SCAN_X86 1
+#elif defined(CPU_FEATURES_ARCH_AARCH64)
+#include <arm_neon.h>
+#define RAD_JSON_SCAN_NEON 1
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RAD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define RAD_TARGET_AVX2
+#endif
+
+namespace rad
+{
+
+namespace
+{
+
+// One bit per byte of a 64-byte block.
+struct BlockMasks
+{
+    uint64_t quote;
+    uint64_t backslash;
+    // Structural characters: {}[]:,
+    uint64_t op;
+    // Space, '\t', '\n' and '\r'.
+    uint64_t whitespace;
+    // Less than 0x20.
+    uint64_t control;
+    uint64_t nonAscii;
+};
+
+using ClassifyFunc = void (*)(const uint8_t* data, size_t blockCount, BlockMasks* masks);
+
+enum : uint8_t
+{
+    ClassQuote = 1 << 0,
+    ClassBackslash = 1 << 1,
+    ClassOp = 1 << 2,
+    ClassWhitespace = 1 << 3,
+    ClassControl = 1 << 4,
+    ClassNonAscii = 1 << 5,
+};
+
+constexpr std::array<uint8_t, 256> g_classes = []()
+    {
+        std::array<uint8_t, 256> table = {};
+        for (int c = 0; c < 0x20; ++c)
+        {
+            table[c] |= ClassControl;
+        }
+        for (int c = 0x80; c < 0x100; ++c)
+        {
+            table[c] |= ClassNonAscii;
+        }
+        table['"'] |= ClassQuote;
+        table['\\'] |= ClassBackslash;
+        for (uint8_t c : { '{', '}', '[', ']', ':', ',' })
+        {
+            table[c] |= ClassOp;
+        }
+        for (uint8_t c : { ' ', '\t', '\n', '\r' })
+        {
+            table[c] |= ClassWhitespace;
+        }
+        return table;
+    }();
+
+void ClassifyGeneric(const uint8_t* data, size_t blockCount, BlockMasks* masks)
+{
+    for (size_t b = 0; b < blockCount; ++b, data += 64)
+    {
+        BlockMasks m = {};
+        for (int i = 0; i < 64; ++i)
+        {
+            const uint64_t c = g_classes[data[i]];
+            m.quote |= (c & 1) << i;
+            m.backslash |= ((c >> 1) & 1) << i;
+            m.op |= ((c >> 2) & 1) << i;
+            m.whitespace |= ((c >> 3) & 1) << i;
+            m.control |= ((c >> 4) & 1) << i;
+            m.nonAscii |= ((c >> 5) & 1) << i;
+        }
+        masks[b] = m;
+    }
+}
+
+#if defined(RAD_JSON_SCAN_X86)
+
+void ClassifySse2(const uint8_t* data, size_t blockCount, BlockMasks* masks)
+{
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i lowerCase = _mm_set1_epi8(0x20);
+    const __m128i openBrace = _mm_set1_epi8('{');
+    const __m128i closeBrace = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i lineFeed = _mm_set1_epi8('\n');
+    const __m128i carriageReturn = _mm_set1_epi8('\r');
+    const __m128i maxControl = _mm_set1_epi8(0x1F);
+    for (size_t b = 0; b < blockCount; ++b, data += 64)
+    {
+        BlockMasks m = {};
+        for (int i = 0; i < 64; i += 16)
+        {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            // '[' and ']' are '{' and '}' without 0x20.
+            const __m128i lower = _mm_or_si128(x, lowerCase);
+            const __m128i op = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(lower, openBrace), _mm_cmpeq_epi8(lower, closeBrace)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, colon), _mm_cmpeq_epi8(x, comma)));
+            const __m128i whitespace = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(x, space), _mm_cmpeq_epi8(x, tab)),
+                _mm_or_si128(_mm_cmpeq_epi8(x, lineFeed), _mm_cmpeq_epi8(x, carriageReturn)));
+            const __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(x, maxControl), x);
+            m.quote |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, quote)))) << i;
+            m.backslash |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(x, backslash)))) << i;
+            m.op |= uint64_t(uint32_t(_mm_movemask_epi8(op))) << i;
+            m.whitespace |= uint64_t(uint32_t(_mm_movemask_epi8(whitespace))) << i;
+            m.control |= uint64_t(uint32_t(_mm_movemask_epi8(control))) << i;
+            m.nonAscii |= uint64_t(uint32_t(_mm_movemask_epi8(x))) << i;
+        }
+        masks[b] = m;
+    }
+}
+
+RAD_TARGET_AVX2 void ClassifyAvx2(const uint8_t* data, size_t blockCount, BlockMasks* masks)
+{
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i lowerCase = _mm256_set1_epi8(0x20);
+    const __m256i openBrace = _mm256_set1_epi8('{');
+    const __m256i closeBrace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i lineFeed = _mm256_set1_epi8('\n');
+    const __m256i carriageReturn = _mm256_set1_epi8('\r');
+    const __m256i maxControl = _mm256_set1_epi8(0x1F);
+    for (size_t b = 0; b < blockCount; ++b, data += 64)
+    {
+        BlockMasks m = {};
+        for (int i = 0; i < 64; i += 32)
+        {
+            const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            const __m256i lower = _mm256_or_si256(x, lowerCase);
+            const __m256i op = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(lower, openBrace), _mm256_cmpeq_epi8(lower, closeBrace)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, colon), _mm256_cmpeq_epi8(x, comma)));
+            const __m256i whitespace = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, space), _mm256_cmpeq_epi8(x, tab)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(x, lineFeed), _mm256_cmpeq_epi8(x, carriageReturn)));
+            const __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(x, maxControl), x);
+            m.quote |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, quote)))) << i;
+            m.backslash |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, backslash)))) << i;
+            m.op |= uint64_t(uint32_t(_mm256_movemask_epi8(op))) << i;
+            m.whitespace |= uint64_t(uint32_t(_mm256_movemask_epi8(whitespace))) << i;
+            m.control |= uint64_t(uint32_t(_mm256_movemask_epi8(control))) << i;
+            m.nonAscii |= uint64_t(uint32_t(_mm256_movemask_epi8(x))) << i;
+        }
+        masks[b] = m;
+    }
+}
+
+#endif // RAD_JSON_SCAN_X86
+
+#if defined(RAD_JSON_SCAN_NEON)
+
+// Gather the top bits of 64 bytes (no movemask on NEON).
+inline uint64_t ToBitmask(uint8x16_t v0, uint8x16_t v1, uint8x16_t v2, uint8x16_t v3)
+{
+    const uint8x16_t weights = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(v0, weights), vandq_u8(v1, weights));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(v2, weights), vandq_u8(v3, weights));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+void ClassifyNeon(const uint8_t* data, size_t blockCount, BlockMasks* masks)
+{
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t lowerCase = vdupq_n_u8(0x20);
+    const uint8x16_t openBrace = vdupq_n_u8('{');
+    const uint8x16_t closeBrace = vdupq_n_u8('}');
+    const uint8x16_t colon = vdupq_n_u8(':');
+    const uint8x16_t comma = vdupq_n_u8(',');
+    const uint8x16_t space = vdupq_n_u8(' ');
+    const uint8x16_t tab = vdupq_n_u8('\t');
+    const uint8x16_t lineFeed = vdupq_n_u8('\n');
+    const uint8x16_t carriageReturn = vdupq_n_u8('\r');
+    const uint8x16_t minNonAscii = vdupq_n_u8(0x80);
+    for (size_t b = 0; b < blockCount; ++b, data += 64)
+    {
+        uint8x16_t q[4], bs[4], op[4], ws[4], ctrl[4], na[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            const uint8x16_t x = vld1q_u8(data + i * 16);
+            const uint8x16_t lower = vorrq_u8(x, lowerCase);
+            q[i] = vceqq_u8(x, quote);
+            bs[i] = vceqq_u8(x, backslash);
+            op[i] = vorrq_u8(vorrq_u8(vceqq_u8(lower, openBrace), vceqq_u8(lower, closeBrace)),
+                vorrq_u8(vceqq_u8(x, colon), vceqq_u8(x, comma)));
+            ws[i] = vorrq_u8(vorrq_u8(vceqq_u8(x, space), vceqq_u8(x, tab)),
+                vorrq_u8(vceqq_u8(x, lineFeed), vceqq_u8(x, carriageReturn)));
+            ctrl[i] = vcltq_u8(x, lowerCase);
+            na[i] = vcgeq_u8(x, minNonAscii);
+        }
+        masks[b].quote = ToBitmask(q[0], q[1], q[2], q[3]);
+        masks[b].backslash = ToBitmask(bs[0], bs[1], bs[2], bs[3]);
+        masks[b].op = ToBitmask(op[0], op[1], op[2], op[3]);
+        masks[b].whitespace = ToBitmask(ws[0], ws[1], ws[2], ws[3]);
+        masks[b].control = ToBitmask(ctrl[0], ctrl[1], ctrl[2], ctrl[3]);
+        masks[b].nonAscii = ToBitmask(na[0], na[1], na[2], na[3]);
+    }
+}
+
+#endif // RAD_JSON_SCAN_NEON
+
+ClassifyFunc GetClassifyFunc(JsonScanKernel kernel)
+{
+    switch (kernel)
+    {
+#if defined(RAD_JSON_SCAN_X86)
+    case JsonScanKernel::Sse2: return ClassifySse2;
+    case JsonScanKernel::Avx2: return ClassifyAvx2;
+#endif
+#if defined(RAD_JSON_SCAN_NEON)
+    case JsonScanKernel::Neon: return ClassifyNeon;
+#endif
+    default: return ClassifyGeneric;
+    }
+}
+
+// The characters escaped: preceded by an odd number of backslashes.
+// @param prevEscaped: carried between blocks, 1 if the first character of the next block is escaped.
+inline uint64_t FindEscaped(uint64_t backslash, uint64_t& prevEscaped)
+{
+    constexpr uint64_t EvenBits = 0x5555555555555555;
+    // A backslash escaped by the previous block is literal.
+    backslash &= ~prevEscaped;
+    const uint64_t starts = backslash & ~(backslash << 1);
+    // Adding the start of a run carries to the end of the run.
+    const uint64_t evenCarries = backslash + (starts & EvenBits);
+    const uint64_t oddCarries = backslash + (starts & ~EvenBits);
+    // The runs of odd length: from an even position to an odd end, or vice versa.
+    const uint64_t escaped = (evenCarries & ~backslash & ~EvenBits) |
+        (oddCarries & ~backslash & EvenBits) | prevEscaped;
+    // An odd run overflows if it reaches the end.
+    prevEscaped = (oddCarries < backslash) ? 1 : 0;
+    return escaped;
+}
+
+// Bit i is the XOR of bits [0, i]: the bits between the pairs of quotes.
+inline uint64_t PrefixXor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+inline bool IsContinuation(const uint8_t* data, size_t size, size_t offset, uint8_t min = 0x80, uint8_t max = 0xBF)
+{
+    return (offset < size) && (data[offset] >= min) && (data[offset] <= max);
+}
+
+// Validate the UTF-8 sequences (RFC 3629) from the offset until an ASCII character;
+// return the end of the validated, or 0 if invalid.
+size_t ValidateUtf8(const uint8_t* data, size_t size, size_t offset)
+{
+    while ((offset < size) && (data[offset] >= 0x80))
+    {
+        const uint8_t c = data[offset];
+        if (c < 0xC2)
+        {
+            // Continuation without leading byte, or overlong.
+            return 0;
+        }
+        else if (c < 0xE0)
+        {
+            if (!IsContinuation(data, size, offset + 1))
+            {
+                return 0;
+            }
+            offset += 2;
+        }
+        else if (c < 0xF0)
+        {
+            // No overlong or surrogates.
+            const uint8_t min = (c == 0xE0) ? 0xA0 : 0x80;
+            const uint8_t max = (c == 0xED) ? 0x9F : 0xBF;
+            if (!IsContinuation(data, size, offset + 1, min, max) ||
+                !IsContinuation(data, size, offset + 2))
+            {
+                return 0;
+            }
+            offset += 3;
+        }
+        else if (c < 0xF5)
+        {
+            // No overlong or greater than U+10FFFF.
+            const uint8_t min = (c == 0xF0) ? 0x90 : 0x80;
+            const uint8_t max = (c == 0xF4) ? 0x8F : 0xBF;
+            if (!IsContinuation(data, size, offset + 1, min, max) ||
+                !IsContinuation(data, size, offset + 2) ||
+                !IsContinuation(data, size, offset + 3))
+            {
+                return 0;
+            }
+            offset += 4;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    return offset;
+}
+
+inline bool IsWhitespace(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == '\n') || (c == '\r');
+}
+
+inline bool IsDecimalDigit(char c)
+{
+    return (c >= '0') && (c <= '9');
+}
+
+// The end of the token excluding the whitespace before the next index.
+inline size_t TrimTokenEnd(const char* data, size_t offset, size_t end)
+{
+    while ((end > offset) && IsWhitespace(data[end - 1]))
+    {
+        --end;
+    }
+    return end;
+}
+
+int ParseHex4(const char* p)
+{
+    int value = 0;
+    for (int i = 0; i < 4; ++i)
+    {
+        const char c = p[i];
+        int digit;
+        if (IsDecimalDigit(c))
+        {
+            digit = c - '0';
+        }
+        else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+        {
+            digit = (c | 0x20) - 'a' + 10;
+        }
+        else
+        {
+            return -1;
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+void AppendUtf8(std::string& str, uint32_t codePoint)
+{
+    if (codePoint < 0x80)
+    {
+        str.push_back(static_cast<char>(codePoint));
+    }
+    else if (codePoint < 0x800)
+    {
+        str.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if (codePoint < 0x10000)
+    {
+        str.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        str.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+// Stage 2 targets: the events are inlined for validation.
+struct NullHandler
+{
+    static constexpr bool DecodeStrings = false;
+    bool OnObjectBegin() { return true; }
+    bool OnObjectEnd(size_t) { return true; }
+    bool OnArrayBegin() { return true; }
+    bool OnArrayEnd(size_t) { return true; }
+    bool OnKey(std::string_view) { return true; }
+    bool OnString(std::string_view) { return true; }
+    bool OnInt64(int64_t) { return true; }
+    bool OnUint64(uint64_t) { return true; }
+    bool OnDouble(double) { return true; }
+    bool OnBool(bool) { return true; }
+    bool OnNull() { return true; }
+};
+
+struct HandlerRef
+{
+    static constexpr bool DecodeStrings = true;
+    JsonHandler* handler;
+    bool OnObjectBegin() { return handler->OnObjectBegin(); }
+    bool OnObjectEnd(size_t memberCount) { return handler->OnObjectEnd(memberCount); }
+    bool OnArrayBegin() { return handler->OnArrayBegin(); }
+    bool OnArrayEnd(size_t elementCount) { return handler->OnArrayEnd(elementCount); }
+    bool OnKey(std::string_view key) { return handler->OnKey(key); }
+    bool OnString(std::string_view str) { return handler->OnString(str); }
+    bool OnInt64(int64_t i) { return handler->OnInt64(i); }
+    bool OnUint64(uint64_t u) { return handler->OnUint64(u); }
+    bool OnDouble(double d) { return handler->OnDouble(d); }
+    bool OnBool(bool b) { return handler->OnBool(b); }
+    bool OnNull() { return handler->OnNull(); }
+};
+
+} // namespace
+
+bool IsJsonScanKernelSupported(JsonScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case JsonScanKernel::Generic:
+        return true;
+#if defined(RAD_JSON_SCAN_X86)
+    case JsonScanKernel::Sse2:
+        // Baseline of x86-64.
+        return true;
+    case JsonScanKernel::Avx2:
+    {
+        static const bool hasAvx2 = cpu_features::GetX86Info().features.avx2;
+        return hasAvx2;
+    }
+#endif
+#if defined(RAD_JSON_SCAN_NEON)
+    case JsonScanKernel::Neon:
+        // Baseline of AArch64.
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+JsonScanKernel GetBestJsonScanKernel()
+{
+    for (JsonScanKernel kernel : { JsonScanKernel::Avx2, JsonScanKernel::Neon, JsonScanKernel::Sse2 })
+    {
+        if (IsJsonScanKernelSupported(kernel))
+        {
+            return kernel;
+        }
+    }
+    return JsonScanKernel::Generic;
+}
+
+const char* GetJsonScanKernelName(JsonScanKernel kernel)
+{
+    switch (kernel)
+    {
+    case JsonScanKernel::Generic: return "Generic";
+    case JsonScanKernel::Sse2: return "SSE2";
+    case JsonScanKernel::Avx2: return "AVX2";
+    case JsonScanKernel::Neon: return "NEON";
+    }
+    return "Unknown";
+}
+
+JsonScanner::JsonScanner() :
+    m_kernel(GetBestJsonScanKernel())
+{
+}
+
+JsonScanner::JsonScanner(JsonScanKernel kernel) :
+    m_kernel(kernel)
+{
+    if (!IsJsonScanKernelSupported(kernel))
+    {
+        m_kernel = GetBestJsonScanKernel();
+        LogGlobal(Warn, "JsonScanner: {} is not supported, fallback to {}.",
+            GetJsonScanKernelName(kernel), GetJsonScanKernelName(m_kernel));
+    }
+}
+
+JsonScanner::~JsonScanner()
+{
+}
+
+bool JsonScanner::SetError(const char* error, size_t offset)
+{
+    m_error = error;
+    m_errorOffset = offset;
+    return false;
+}
+
+bool JsonScanner::Scan(std::string_view json)
+{
+    m_isStopped = false;
+    m_error = "";
+    m_errorOffset = 0;
+    m_indices.clear();
+    if (json.size() > std::numeric_limits<uint32_t>::max())
+    {
+        return SetError("document too large", 0);
+    }
+
+    const ClassifyFunc classify = GetClassifyFunc(m_kernel);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(json.data());
+    const size_t size = json.size();
+    // Classify 4KiB at a time.
+    constexpr size_t BatchBlockCount = 64;
+    BlockMasks masks[BatchBlockCount];
+    uint64_t prevEscaped = 0;
+    uint64_t prevInString = 0;
+    uint64_t prevScalar = 0;
+    size_t utf8End = 0;
+    size_t indexCount = 0;
+
+    size_t offset = 0;
+    while (offset < size)
+    {
+        size_t blockCount = std::min((size - offset) / 64, BatchBlockCount);
+        if (blockCount > 0)
+        {
+            classify(data + offset, blockCount, masks);
+        }
+        else
+        {
+            // The last partial block, padded with spaces.
+            uint8_t tail[64];
+            std::memset(tail, ' ', sizeof(tail));
+            std::memcpy(tail, data + offset, size - offset);
+            classify(tail, 1, masks);
+            blockCount = 1;
+        }
+
+        // Each block has at most 64 indices.
+        if (m_indices.size() < indexCount + blockCount * 64)
+        {
+            m_indices.resize(std::max(indexCount + blockCount * 64, m_indices.size() * 2));
+        }
+
+        for (size_t b = 0; b < blockCount; ++b, offset += 64)
+        {
+            const BlockMasks& m = masks[b];
+            const uint64_t escaped = (m.backslash | prevEscaped) ? FindEscaped(m.backslash, prevEscaped) : 0;
+            const uint64_t quote = m.quote & ~escaped;
+            // From the opening quote (inclusive) to the closing quote (exclusive).
+            const uint64_t inString = PrefixXor(quote) ^ prevInString;
+            prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+            // The characters of strings except the opening quotes.
+            const uint64_t stringTail = inString ^ quote;
+
+            if (const uint64_t invalid = m.control & (inString | ~m.whitespace))
+            {
+                m_indices.resize(indexCount);
+                return SetError("control character", offset + std::countr_zero(invalid));
+            }
+
+            uint64_t nonAscii = m.nonAscii;
+            while (nonAscii)
+            {
+                const size_t pos = offset + std::countr_zero(nonAscii);
+                if (pos >= utf8End)
+                {
+                    utf8End = ValidateUtf8(data, size, pos);
+                    if (utf8End == 0)
+                    {
+                        m_indices.resize(indexCount);
+                        return SetError("invalid UTF-8", pos);
+                    }
+                }
+                nonAscii &= nonAscii - 1;
+            }
+
+            // The structural characters, and the first bytes of scalars: not following another scalar.
+            const uint64_t scalar = ~(m.op | m.whitespace);
+            const uint64_t nonQuoteScalar = scalar & ~quote;
+            const uint64_t followsScalar = (nonQuoteScalar << 1) | prevScalar;
+            prevScalar = nonQuoteScalar >> 63;
+            uint64_t structurals = (m.op | (scalar & ~followsScalar)) & ~stringTail;
+
+            // Write 4 at a time, the extra entries are overwritten by the next block.
+            uint32_t* indices = m_indices.data() + indexCount;
+            const uint32_t count = static_cast<uint32_t>(std::popcount(structurals));
+            const uint32_t base = static_cast<uint32_t>(offset);
+            for (uint32_t i = 0; i < count; i += 4)
+            {
+                indices[i] = base + std::countr_zero(structurals);
+                structurals &= structurals - 1;
+                indices[i + 1] = base + std::countr_zero(structurals);
+                structurals &= structurals - 1;
+                indices[i + 2] = base + std::countr_zero(structurals);
+                structurals &= structurals - 1;
+                indices[i + 3] = base + std::countr_zero(structurals);
+                structurals &= structurals - 1;
+            }
+            indexCount += count;
+        }
+    }
+
+    m_indices.resize(indexCount);
+    if (prevInString)
+    {
+        return SetError("unterminated string", size);
+    }
+    return true;
+}
+
+template<bool Decode>
+bool JsonScanner::ParseString(std::string_view json, size_t offset, size_t end, std::string_view& str)
+{
+    const char* data = json.data();
+    // Only whitespace between the closing quote and the next index (see Scan).
+    const size_t quoteEnd = TrimTokenEnd(data, offset, end);
+    if ((quoteEnd < offset + 2) || (data[quoteEnd - 1] != '"'))
+    {
+        return SetError("invalid string", offset);
+    }
+    const char* p = data + offset + 1;
+    const char* last = data + quoteEnd - 1;
+    const char* escape = static_cast<const char*>(std::memchr(p, '\\', last - p));
+    if (escape == nullptr)
+    {
+        str = std::string_view(p, last - p);
+        return true;
+    }
+
+    if constexpr (Decode)
+    {
+        m_string.assign(p, escape);
+    }
+    p = escape;
+    while (p < last)
+    {
+        if (*p != '\\')
+        {
+            const char* next = static_cast<const char*>(std::memchr(p, '\\', last - p));
+            if (next == nullptr)
+            {
+                next = last;
+            }
+            if constexpr (Decode)
+            {
+                m_string.append(p, next);
+            }
+            p = next;
+            continue;
+        }
+
+        const size_t escapeOffset = p - data;
+        if (last - p < 2)
+        {
+            return SetError("invalid escape", escapeOffset);
+        }
+        char c = 0;
+        switch (p[1])
+        {
+        case '"': c = '"'; break;
+        case '\\': c = '\\'; break;
+        case '/': c = '/'; break;
+        case 'b': c = '\b'; break;
+        case 'f': c = '\f'; break;
+        case 'n': c = '\n'; break;
+        case 'r': c = '\r'; break;
+        case 't': c = '\t'; break;
+        case 'u':
+        {
+            int codePoint = (last - p >= 6) ? ParseHex4(p + 2) : -1;
+            if (codePoint < 0)
+            {
+                return SetError("invalid escape", escapeOffset);
+            }
+            p += 6;
+            if ((codePoint >= 0xD800) && (codePoint <= 0xDBFF))
+            {
+                // Must be followed by the low surrogate.
+                const int low = ((last - p >= 6) && (p[0] == '\\') && (p[1] == 'u')) ? ParseHex4(p + 2) : -1;
+                if ((low < 0xDC00) || (low > 0xDFFF))
+                {
+                    return SetError("invalid surrogate", escapeOffset);
+                }
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                p += 6;
+            }
+            else if ((codePoint >= 0xDC00) && (codePoint <= 0xDFFF))
+            {
+                return SetError("invalid surrogate", escapeOffset);
+            }
+            if constexpr (Decode)
+            {
+                AppendUtf8(m_string, static_cast<uint32_t>(codePoint));
+            }
+            continue;
+        }
+        default:
+            return SetError("invalid escape", escapeOffset);
+        }
+        if constexpr (Decode)
+        {
+            m_string.push_back(c);
+        }
+        p += 2;
+    }
+    str = m_string;
+    return true;
+}
+
+template<typename Handler>
+bool JsonScanner::ParseNumber(std::string_view json, size_t offset, size_t end, Handler& handler)
+{
+    const char* data = json.data();
+    const char* first = data + offset;
+    const char* last = data + TrimTokenEnd(data, offset, end);
+    const char* p = first;
+    const bool isNegative = (*p == '-');
+    if (isNegative)
+    {
+        ++p;
+    }
+    // int: 0 or [1-9][0-9]*
+    const char* digits = p;
+    uint64_t value = 0;
+    if ((p < last) && (*p == '0'))
+    {
+        ++p;
+    }
+    else
+    {
+        while ((p < last) && IsDecimalDigit(*p))
+        {
+            value = value * 10 + (*p - '0');
+            ++p;
+        }
+    }
+    const size_t digitCount = p - digits;
+    if (digitCount == 0)
+    {
+        return SetError("invalid number", offset);
+    }
+    bool isInteger = true;
+    bool hasNegativeExponent = false;
+    // frac: . [0-9]+
+    if ((p < last) && (*p == '.'))
+    {
+        isInteger = false;
+        ++p;
+        if ((p == last) || !IsDecimalDigit(*p))
+        {
+            return SetError("invalid number", offset);
+        }
+        while ((p < last) && IsDecimalDigit(*p))
+        {
+            ++p;
+        }
+    }
+    // exp: [eE] [+-]? [0-9]+
+    if ((p < last) && ((*p == 'e') || (*p == 'E')))
+    {
+        isInteger = false;
+        ++p;
+        if ((p < last) && ((*p == '+') || (*p == '-')))
+        {
+            hasNegativeExponent = (*p == '-');
+            ++p;
+        }
+        if ((p == last) || !IsDecimalDigit(*p))
+        {
+            return SetError("invalid number", offset);
+        }
+        while ((p < last) && IsDecimalDigit(*p))
+        {
+            ++p;
+        }
+    }
+    if (p != last)
+    {
+        return SetError("invalid number", offset);
+    }
+
+    bool ok = true;
+    uint64_t u = 0;
+    // Up to 19 digits fit in uint64_t; the integers out of range are converted to double.
+    if (isInteger && !isNegative && (digitCount <= 19))
+    {
+        ok = (value <= uint64_t(std::numeric_limits<int64_t>::max())) ?
+            handler.OnInt64(static_cast<int64_t>(value)) : handler.OnUint64(value);
+    }
+    else if (isInteger && isNegative && (digitCount <= 19) &&
+        (value <= uint64_t(std::numeric_limits<int64_t>::max()) + 1))
+    {
+        ok = handler.OnInt64(static_cast<int64_t>(0 - value));
+    }
+    else if (isInteger && !isNegative && (digitCount == 20) &&
+        (std::from_chars(digits, last, u).ec == std::errc()))
+    {
+        ok = handler.OnUint64(u);
+    }
+    else
+    {
+        double d = 0;
+        const std::from_chars_result result = std::from_chars(first, last, d);
+        if (result.ec == std::errc::result_out_of_range)
+        {
+            // Underflow to zero, or overflow to infinity.
+            const bool isUnderflow = hasNegativeExponent || (*digits == '0');
+            d = isUnderflow ? 0.0 : HUGE_VAL;
+            d = isNegative ? -d : d;
+        }
+        else if (result.ec != std::errc())
+        {
+            return SetError("invalid number", offset);
+        }
+        ok = handler.OnDouble(d);
+    }
+    if (!ok)
+    {
+        m_isStopped = true;
+        return false;
+    }
+    return true;
+}
+
+template<typename Handler>
+bool JsonScanner::ParseIndexed(std::string_view json, Handler& handler)
+{
+    enum class State
+    {
+        Value,
+        Key,
+        AfterValue,
+    };
+
+    const char* data = json.data();
+    const uint32_t* indices = m_indices.data();
+    const size_t indexCount = m_indices.size();
+    // The token at index i ends before the next index.
+    auto getTokenEnd = [&](size_t i) -> size_t
+        {
+            return (i + 1 < indexCount) ? indices[i + 1] : json.size();
+        };
+    auto stop = [&]()
+        {
+            m_isStopped = true;
+            return false;
+        };
+
+    m_stack.clear();
+    std::string_view str;
+    State state = State::Value;
+    size_t i = 0;
+    while (true)
+    {
+        if ((state == State::AfterValue) && m_stack.empty())
+        {
+            // The end of the document.
+            break;
+        }
+        if (i == indexCount)
+        {
+            return SetError(indexCount == 0 ? "empty document" : "unexpected end", json.size());
+        }
+        const size_t offset = indices[i];
+        const char c = data[offset];
+        if (state == State::Value)
+        {
+            switch (c)
+            {
+            case '{':
+            case '[':
+            {
+                const bool isObject = (c == '{');
+                if (!(isObject ? handler.OnObjectBegin() : handler.OnArrayBegin()))
+                {
+                    return stop();
+                }
+                ++i;
+                const char closing = isObject ? '}' : ']';
+                if ((i < indexCount) && (data[indices[i]] == closing))
+                {
+                    if (!(isObject ? handler.OnObjectEnd(0) : handler.OnArrayEnd(0)))
+                    {
+                        return stop();
+                    }
+                    ++i;
+                    state = State::AfterValue;
+                }
+                else
+                {
+                    m_stack.push_back({ isObject, 0 });
+                    state = isObject ? State::Key : State::Value;
+                }
+                continue;
+            }
+            case '"':
+                if (!ParseString<Handler::DecodeStrings>(json, offset, getTokenEnd(i), str))
+                {
+                    return false;
+                }
+                if (!handler.OnString(str))
+                {
+                    return stop();
+                }
+                break;
+            case 't':
+            case 'f':
+            case 'n':
+            {
+                const std::string_view token(data + offset, TrimTokenEnd(data, offset, getTokenEnd(i)) - offset);
+                bool ok = true;
+                if (token == "true")
+                {
+                    ok = handler.OnBool(true);
+                }
+                else if (token == "false")
+                {
+                    ok = handler.OnBool(false);
+                }
+                else if (token == "null")
+                {
+                    ok = handler.OnNull();
+                }
+                else
+                {
+                    return SetError("invalid literal", offset);
+                }
+                if (!ok)
+                {
+                    return stop();
+                }
+                break;
+            }
+            default:
+                if ((c == '-') || IsDecimalDigit(c))
+                {
+                    if (!ParseNumber(json, offset, getTokenEnd(i), handler))
+                    {
+                        return false;
+                    }
+                    break;
+                }
+                return SetError("unexpected character", offset);
+            }
+            ++i;
+            state = State::AfterValue;
+        }
+        else if (state == State::Key)
+        {
+            if (c != '"')
+            {
+                return SetError("expected key", offset);
+            }
+            if (!ParseString<Handler::DecodeStrings>(json, offset, getTokenEnd(i), str))
+            {
+                return false;
+            }
+            if (!handler.OnKey(str))
+            {
+                return stop();
+            }
+            if ((i + 1 == indexCount) || (data[indices[i + 1]] != ':'))
+            {
+                return SetError("expected ':'", (i + 1 < indexCount) ? indices[i + 1] : json.size());
+            }
+            i += 2;
+            state = State::Value;
+        }
+        else // State::AfterValue
+        {
+            Frame& frame = m_stack.back();
+            ++frame.count;
+            ++i;
+            if (c == ',')
+            {
+                state = frame.isObject ? State::Key : State::Value;
+            }
+            else if (c == (frame.isObject ? '}' : ']'))
+            {
+                const size_t count = frame.count;
+                const bool isObject = frame.isObject;
+                m_stack.pop_back();
+                if (!(isObject ? handler.OnObjectEnd(count) : handler.OnArrayEnd(count)))
+                {
+                    return stop();
+                }
+            }
+            else
+            {
+                return SetError(frame.isObject ? "expected ',' or '}'" : "expected ',' or ']'", offset);
+            }
+        }
+    }
+
+    if (i != indexCount)
+    {
+        return SetError("extra data", indices[i]);
+    }
+    return true;
+}
+
+bool JsonScanner::Validate(std::string_view json)
+{
+    NullHandler handler;
+    return Scan(json) && ParseIndexed(json, handler);
+}
+
+bool JsonScanner::Parse(std::string_view json, JsonHandler* handler)
+{
+    HandlerRef ref = { handler };
+    return Scan(json) && ParseIndexed(json, ref);
+}
+
+bool JsonScanner::Parse(std::string_view json, boost::json::value& value, boost::json::storage_ptr storage)
+{
+    JsonSubtreeCollector collector({ "" },
+        [&](std::string_view, boost::json::value&& root)
+        {
+            value = std::move(root);
+            return true;
+        }, std::move(storage));
+    return Parse(json, &collector);
+}
+
+bool ValidateJson(std::string_view json)
+{
+    thread_local JsonScanner scanner;
+    return scanner.Validate(json);
+}
+
+} // namespace rad
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "JsonStream.h"
+
+namespace rad
+{
+
+// The instruction sets to classify the input of JsonScanner.
+enum class JsonScanKernel
+{
+    Generic, // Portable, one byte at a time.
+    Sse2,
+    Avx2,
+    Neon,
+};
+
+// Whether the kernel can run on this machine (detected at runtime with cpu_features).
+bool IsJsonScanKernelSupported(JsonScanKernel kernel);
+// The fastest kernel supported.
+JsonScanKernel GetBestJsonScanKernel();
+const char* GetJsonScanKernelName(JsonScanKernel kernel);
+
+// Two-stage parser in the style of simdjson (https://arxiv.org/abs/1902.08318):
+// stage 1 classifies 64 bytes at a time into bitmaps (quotes, backslashes, structural characters,
+// whitespace) with SIMD, resolves escapes and strings with bit operations, validates UTF-8
+// and control characters, and records the positions of the structural characters and the first
+// bytes of scalars; stage 2 walks the positions to check the grammar and send the events,
+// touching only the bytes of the scalars.
+// Strict RFC 8259: comments, trailing commas, NaN and Infinity (see SetDefaultParseOptions) are errors.
+// The buffers are reused between documents; the size of a document is limited to 4GiB.
+class JsonScanner
+{
+public:
+    JsonScanner();
+    JsonScanner(JsonScanKernel kernel);
+    ~JsonScanner();
+
+    JsonScanner(const JsonScanner&) = delete;
+    JsonScanner& operator=(const JsonScanner&) = delete;
+
+    // Stage 1: build the structural index; return false on invalid UTF-8, control characters
+    // (except whitespace outside of strings) or an unterminated string.
+    bool Scan(std::string_view json);
+    // The positions of the structural characters and the first bytes of scalars ('"' for strings),
+    // in the order of the document.
+    const std::vector<uint32_t>& GetIndices() const { return m_indices; }
+
+    // Check the document without producing anything (both stages).
+    bool Validate(std::string_view json);
+    // Send the events of the document to the handler; strings without escapes point into the document.
+    // Return false on error or if the handler stopped.
+    bool Parse(std::string_view json, JsonHandler* handler);
+    bool Parse(std::string_view json, boost::json::value& value, boost::json::storage_ptr storage = {});
+
+    JsonScanKernel GetKernel() const { return m_kernel; }
+    // Stopped by the handler (not an error of the document).
+    bool IsStopped() const { return m_isStopped; }
+    // The description of the last error, empty if none.
+    std::string_view GetError() const { return m_error; }
+    size_t GetErrorOffset() const { return m_errorOffset; }
+
+private:
+    struct Frame
+    {
+        bool isObject;
+        size_t count;
+    };
+
+    bool SetError(const char* error, size_t offset);
+    template<typename Handler>
+    bool ParseIndexed(std::string_view json, Handler& handler);
+    // Unescape the string starting at the quote; end is the position of the next index.
+    template<bool Decode>
+    bool ParseString(std::string_view json, size_t offset, size_t end, std::string_view& str);
+    template<typename Handler>
+    bool ParseNumber(std::string_view json, size_t offset, size_t end, Handler& handler);
+
+    JsonScanKernel m_kernel;
+    std::vector<uint32_t> m_indices;
+    // The strings unescaped.
+    std::string m_string;
+    std::vector<Frame> m_stack;
+    bool m_isStopped = false;
+    const char* m_error = "";
+    size_t m_errorOffset = 0;
+
+}; // class JsonScanner
+
+// Validate the document with the best kernel, e.g. before deciding whether to parse it fully.
+bool ValidateJson(std::string_view json);
+
+} // namespace rad
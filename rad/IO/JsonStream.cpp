@@ -0,0 +1,480 @@
+#include "JsonStream.h"
+#include "Compression.h"
+#include "Logging.h"
+#include <boost/json/basic_parser_impl.hpp>
+
+namespace rad
+{
+
+struct JsonStreamParser::Impl
+{
+    // The handler of boost::json::basic_parser, forwards the events to JsonHandler.
+    struct Adapter
+    {
+        static constexpr std::size_t max_object_size = std::size_t(-1);
+        static constexpr std::size_t max_array_size = std::size_t(-1);
+        static constexpr std::size_t max_key_size = std::size_t(-1);
+        static constexpr std::size_t max_string_size = std::size_t(-1);
+
+        JsonHandler* handler;
+        // The parts of the current key or string.
+        std::string parts;
+        bool isStopped = false;
+
+        Adapter(JsonHandler* handler) : handler(handler) {}
+
+        bool Check(bool result, boost::system::error_code& ec)
+        {
+            if (!result)
+            {
+                isStopped = true;
+                ec = boost::system::errc::make_error_code(boost::system::errc::operation_canceled);
+            }
+            return result;
+        }
+
+        std::string_view Join(boost::json::string_view s)
+        {
+            if (parts.empty())
+            {
+                return std::string_view(s.data(), s.size());
+            }
+            parts.append(s.data(), s.size());
+            return parts;
+        }
+
+        bool on_document_begin(boost::system::error_code&) { return true; }
+        bool on_document_end(boost::system::error_code&) { return true; }
+        bool on_object_begin(boost::system::error_code& ec) { return Check(handler->OnObjectBegin(), ec); }
+        bool on_object_end(std::size_t n, boost::system::error_code& ec) { return Check(handler->OnObjectEnd(n), ec); }
+        bool on_array_begin(boost::system::error_code& ec) { return Check(handler->OnArrayBegin(), ec); }
+        bool on_array_end(std::size_t n, boost::system::error_code& ec) { return Check(handler->OnArrayEnd(n), ec); }
+        bool on_key_part(boost::json::string_view s, std::size_t, boost::system::error_code&)
+        {
+            parts.append(s.data(), s.size());
+            return true;
+        }
+        bool on_key(boost::json::string_view s, std::size_t, boost::system::error_code& ec)
+        {
+            const bool result = handler->OnKey(Join(s));
+            parts.clear();
+            return Check(result, ec);
+        }
+        bool on_string_part(boost::json::string_view s, std::size_t, boost::system::error_code&)
+        {
+            parts.append(s.data(), s.size());
+            return true;
+        }
+        bool on_string(boost::json::string_view s, std::size_t, boost::system::error_code& ec)
+        {
+            const bool result = handler->OnString(Join(s));
+            parts.clear();
+            return Check(result, ec);
+        }
+        bool on_number_part(boost::json::string_view, boost::system::error_code&) { return true; }
+        bool on_int64(std::int64_t i, boost::json::string_view, boost::system::error_code& ec) { return Check(handler->OnInt64(i), ec); }
+        bool on_uint64(std::uint64_t u, boost::json::string_view, boost::system::error_code& ec) { return Check(handler->OnUint64(u), ec); }
+        bool on_double(double d, boost::json::string_view, boost::system::error_code& ec) { return Check(handler->OnDouble(d), ec); }
+        bool on_bool(bool b, boost::system::error_code& ec) { return Check(handler->OnBool(b), ec); }
+        bool on_null(boost::system::error_code& ec) { return Check(handler->OnNull(), ec); }
+        bool on_comment_part(boost::json::string_view, boost::system::error_code&) { return true; }
+        bool on_comment(boost::json::string_view, boost::system::error_code&) { return true; }
+    };
+
+    boost::json::basic_parser<Adapter> parser;
+    boost::system::error_code error;
+    uint64_t offset = 0;
+
+    Impl(JsonHandler* handler, const boost::json::parse_options& options) :
+        parser(options, handler)
+    {
+    }
+};
+
+JsonStreamParser::JsonStreamParser(JsonHandler* handler)
+{
+    boost::json::parse_options options = {};
+    SetDefaultParseOptions(options);
+    m_impl = std::make_unique<Impl>(handler, options);
+}
+
+JsonStreamParser::JsonStreamParser(JsonHandler* handler, const boost::json::parse_options& options) :
+    m_impl(std::make_unique<Impl>(handler, options))
+{
+}
+
+JsonStreamParser::~JsonStreamParser()
+{
+}
+
+bool JsonStreamParser::Write(std::string_view chunk)
+{
+    if (m_impl->error)
+    {
+        return false;
+    }
+    m_impl->offset += m_impl->parser.write_some(true, chunk.data(), chunk.size(), m_impl->error);
+    return !m_impl->error;
+}
+
+bool JsonStreamParser::Finish()
+{
+    if (!m_impl->error && !m_impl->parser.done())
+    {
+        m_impl->parser.write_some(false, nullptr, 0, m_impl->error);
+    }
+    return !m_impl->error;
+}
+
+void JsonStreamParser::Reset()
+{
+    m_impl->parser.reset();
+    m_impl->parser.handler().parts.clear();
+    m_impl->parser.handler().isStopped = false;
+    m_impl->error.clear();
+    m_impl->offset = 0;
+}
+
+bool JsonStreamParser::IsDone() const
+{
+    return m_impl->parser.done();
+}
+
+bool JsonStreamParser::IsStopped() const
+{
+    return m_impl->parser.handler().isStopped;
+}
+
+const boost::system::error_code& JsonStreamParser::GetError() const
+{
+    return m_impl->error;
+}
+
+uint64_t JsonStreamParser::GetOffset() const
+{
+    return m_impl->offset;
+}
+
+static bool IsJsonWhitespace(std::string_view str)
+{
+    return (str.find_first_not_of(" \t\r\n") == std::string_view::npos);
+}
+
+bool ParseJson(std::string_view str, JsonHandler* handler)
+{
+    JsonStreamParser parser(handler);
+    if (parser.Write(str) && parser.Finish())
+    {
+        if (IsJsonWhitespace(str.substr(parser.GetOffset())))
+        {
+            return true;
+        }
+        LogGlobal(Error, "ParseJson: extra data at offset {}.", parser.GetOffset());
+        return false;
+    }
+    if (parser.IsStopped())
+    {
+        return true;
+    }
+    LogGlobal(Error, "ParseJson: {} (offset={})", parser.GetError().message(), parser.GetOffset());
+    return false;
+}
+
+bool ParseJsonFromFile(std::string_view fileName, JsonHandler* handler)
+{
+    JsonStreamParser parser(handler);
+    uint64_t chunkOffset = 0;
+    bool hasExtraData = false;
+    const bool isOpened = ReadFileChunks(fileName, [&](std::string_view chunk) {
+        if (!parser.IsDone() && !parser.Write(chunk))
+        {
+            return false;
+        }
+        // Only whitespace may follow the document, like ParseJson.
+        if (parser.IsDone() &&
+            !IsJsonWhitespace(chunk.substr(static_cast<size_t>(std::max(parser.GetOffset(), chunkOffset) - chunkOffset))))
+        {
+            hasExtraData = true;
+            return false;
+        }
+        chunkOffset += chunk.size();
+        return true;
+        });
+    if (!isOpened)
+    {
+        LogGlobal(Error, "ParseJsonFromFile: failed to open {}", fileName);
+        return false;
+    }
+    if (hasExtraData)
+    {
+        LogGlobal(Error, "ParseJsonFromFile: {}: extra data at offset {}.", fileName, parser.GetOffset());
+        return false;
+    }
+    if (parser.Finish() || parser.IsStopped())
+    {
+        return true;
+    }
+    LogGlobal(Error, "ParseJsonFromFile: {}: {} (offset={})",
+        fileName, parser.GetError().message(), parser.GetOffset());
+    return false;
+}
+
+JsonSubtreeCollector::JsonSubtreeCollector(const std::vector<std::string>& pointers, Callback callback,
+    boost::json::storage_ptr storage) :
+    m_callback(std::move(callback)),
+    m_storage(std::move(storage))
+{
+    for (const std::string& pointer : pointers)
+    {
+        if (!pointer.empty() && (pointer[0] != '/'))
+        {
+            LogGlobal(Warn, "JsonSubtreeCollector: invalid JSON pointer: {}", pointer);
+            continue;
+        }
+        std::vector<std::string>& tokens = m_patterns.emplace_back();
+        size_t pos = 0;
+        while (pos < pointer.size())
+        {
+            const size_t end = std::min(pointer.find('/', pos + 1), pointer.size());
+            std::string token = pointer.substr(pos + 1, end - pos - 1);
+            // Unescape: "~1" to "/", then "~0" to "~".
+            for (size_t i = token.find("~1"); i != std::string::npos; i = token.find("~1", i + 1))
+            {
+                token.replace(i, 2, "/");
+            }
+            for (size_t i = token.find("~0"); i != std::string::npos; i = token.find("~0", i + 1))
+            {
+                token.replace(i, 2, "~");
+            }
+            tokens.push_back(std::move(token));
+            pos = end;
+        }
+    }
+}
+
+JsonSubtreeCollector::~JsonSubtreeCollector()
+{
+}
+
+bool JsonSubtreeCollector::IsSelected() const
+{
+    for (const std::vector<std::string>& tokens : m_patterns)
+    {
+        if (tokens.size() != m_frames.size())
+        {
+            continue;
+        }
+        bool isMatched = true;
+        for (size_t i = 0; (i < tokens.size()) && isMatched; ++i)
+        {
+            const Frame& frame = m_frames[i];
+            if (tokens[i] == "*")
+            {
+                continue;
+            }
+            isMatched = frame.isArray ? (tokens[i] == std::to_string(frame.index)) : (tokens[i] == frame.key);
+        }
+        if (isMatched)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string JsonSubtreeCollector::GetPointer() const
+{
+    std::string pointer;
+    for (const Frame& frame : m_frames)
+    {
+        pointer += '/';
+        if (frame.isArray)
+        {
+            pointer += std::to_string(frame.index);
+            continue;
+        }
+        for (char c : frame.key)
+        {
+            if (c == '~')
+            {
+                pointer += "~0";
+            }
+            else if (c == '/')
+            {
+                pointer += "~1";
+            }
+            else
+            {
+                pointer += c;
+            }
+        }
+    }
+    return pointer;
+}
+
+void JsonSubtreeCollector::BeginValue()
+{
+    if (!m_isCapturing && IsSelected())
+    {
+        m_isCapturing = true;
+        m_captureDepth = 0;
+        m_valueStack.reset(m_storage);
+    }
+}
+
+void JsonSubtreeCollector::EndValue()
+{
+    if (!m_frames.empty() && m_frames.back().isArray)
+    {
+        m_frames.back().index++;
+    }
+}
+
+bool JsonSubtreeCollector::EndCapturedValue()
+{
+    if (m_captureDepth > 0)
+    {
+        return true;
+    }
+    m_isCapturing = false;
+    const bool result = m_callback(GetPointer(), m_valueStack.release());
+    EndValue();
+    return result;
+}
+
+bool JsonSubtreeCollector::OnObjectBegin()
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_captureDepth++;
+        return true;
+    }
+    m_frames.push_back({ false, 0, {} });
+    return true;
+}
+
+bool JsonSubtreeCollector::OnObjectEnd(size_t memberCount)
+{
+    if (m_isCapturing)
+    {
+        m_valueStack.push_object(memberCount);
+        m_captureDepth--;
+        return EndCapturedValue();
+    }
+    m_frames.pop_back();
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnArrayBegin()
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_captureDepth++;
+        return true;
+    }
+    m_frames.push_back({ true, 0, {} });
+    return true;
+}
+
+bool JsonSubtreeCollector::OnArrayEnd(size_t elementCount)
+{
+    if (m_isCapturing)
+    {
+        m_valueStack.push_array(elementCount);
+        m_captureDepth--;
+        return EndCapturedValue();
+    }
+    m_frames.pop_back();
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnKey(std::string_view key)
+{
+    if (m_isCapturing)
+    {
+        m_valueStack.push_key(key);
+    }
+    else
+    {
+        m_frames.back().key = key;
+    }
+    return true;
+}
+
+bool JsonSubtreeCollector::OnString(std::string_view str)
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_valueStack.push_string(str);
+        return EndCapturedValue();
+    }
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnInt64(int64_t i)
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_valueStack.push_int64(i);
+        return EndCapturedValue();
+    }
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnUint64(uint64_t u)
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_valueStack.push_uint64(u);
+        return EndCapturedValue();
+    }
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnDouble(double d)
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_valueStack.push_double(d);
+        return EndCapturedValue();
+    }
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnBool(bool b)
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_valueStack.push_bool(b);
+        return EndCapturedValue();
+    }
+    EndValue();
+    return true;
+}
+
+bool JsonSubtreeCollector::OnNull()
+{
+    BeginValue();
+    if (m_isCapturing)
+    {
+        m_valueStack.push_null();
+        return EndCapturedValue();
+    }
+    EndValue();
+    return true;
+}
+
+} // namespace rad
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "Json.h"
+#include <functional>
+#include <memory>
+
+namespace rad
+{
+
+// Receives the events of JsonStreamParser; return false to stop parsing.
+// Keys and strings are complete (the parts split by chunk boundaries are joined),
+// and are valid only during the call.
+class JsonHandler
+{
+public:
+    JsonHandler() {}
+    virtual ~JsonHandler() {}
+
+    virtual bool OnObjectBegin() { return true; }
+    virtual bool OnObjectEnd(size_t memberCount) { return true; }
+    virtual bool OnArrayBegin() { return true; }
+    virtual bool OnArrayEnd(size_t elementCount) { return true; }
+    virtual bool OnKey(std::string_view key) { return true; }
+    virtual bool OnString(std::string_view str) { return true; }
+    virtual bool OnInt64(int64_t i) { return true; }
+    virtual bool OnUint64(uint64_t u) { return true; }
+    virtual bool OnDouble(double d) { return true; }
+    virtual bool OnBool(bool b) { return true; }
+    virtual bool OnNull() { return true; }
+
+}; // class JsonHandler
+
+// Incremental event-based parser: the document is fed in chunks of any size,
+// and only the handler decides what to keep, so the memory doesn't grow with the document.
+class JsonStreamParser
+{
+public:
+    JsonStreamParser(JsonHandler* handler);
+    JsonStreamParser(JsonHandler* handler, const boost::json::parse_options& options);
+    ~JsonStreamParser();
+
+    // Return false on syntax error or the handler stopped; the parser stops after one document.
+    bool Write(std::string_view chunk);
+    // No more input; return false if the document is incomplete.
+    bool Finish();
+    // Prepare for the next document.
+    void Reset();
+
+    bool IsDone() const;
+    // Stopped by the handler (not an error of the document).
+    bool IsStopped() const;
+    const boost::system::error_code& GetError() const;
+    // The number of bytes consumed by Write.
+    uint64_t GetOffset() const;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+
+}; // class JsonStreamParser
+
+// Parse the whole string or file in streaming mode; errors are logged.
+// Files are parsed from the mapping, or decompressed in chunks if compressed (see CompressedReader).
+bool ParseJson(std::string_view str, JsonHandler* handler);
+bool ParseJsonFromFile(std::string_view fileName, JsonHandler* handler);
+
+// Materializes only the subtrees selected by JSON pointers (RFC 6901), e.g. "/config/window";
+// the token "*" matches any member or element, e.g. "/items/*" visits the items one by one.
+// Nested selections are included in the outer subtree and not reported again.
+class JsonSubtreeCollector : public JsonHandler
+{
+public:
+    // @param pointer: the location of the subtree, with the tokens matched by "*" resolved.
+    // Return false to stop parsing.
+    using Callback = std::function<bool(std::string_view pointer, boost::json::value&& value)>;
+
+    JsonSubtreeCollector(const std::vector<std::string>& pointers, Callback callback,
+        boost::json::storage_ptr storage = {});
+    ~JsonSubtreeCollector();
+
+    bool OnObjectBegin() override;
+    bool OnObjectEnd(size_t memberCount) override;
+    bool OnArrayBegin() override;
+    bool OnArrayEnd(size_t elementCount) override;
+    bool OnKey(std::string_view key) override;
+    bool OnString(std::string_view str) override;
+    bool OnInt64(int64_t i) override;
+    bool OnUint64(uint64_t u) override;
+    bool OnDouble(double d) override;
+    bool OnBool(bool b) override;
+    bool OnNull() override;
+
+private:
+    struct Frame
+    {
+        bool isArray;
+        size_t index;
+        std::string key;
+    };
+
+    // Called before each value, start capturing if the location is selected.
+    void BeginValue();
+    // Called after a value is completed outside of the captured subtree.
+    void EndValue();
+    // Called after a value is pushed to the value stack.
+    bool EndCapturedValue();
+    bool IsSelected() const;
+    std::string GetPointer() const;
+
+    std::vector<std::vector<std::string>> m_patterns;
+    Callback m_callback;
+    boost::json::storage_ptr m_storage;
+    std::vector<Frame> m_frames;
+    bool m_isCapturing = false;
+    // The container depth in the captured subtree.
+    size_t m_captureDepth = 0;
+    boost::json::value_stack m_valueStack;
+
+}; // class JsonSubtreeCollector
+
+} // namespace rad
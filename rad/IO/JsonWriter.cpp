@@ -0,0 +1,402 @@
+#include "JsonWriter.h"
+#include "Logging.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace rad
+{
+
+// The characters must be escaped in strings: control characters, '"' and '\\'.
+static constexpr std::array<bool, 256> g_needsEscape = []()
+    {
+        std::array<bool, 256> table = {};
+        for (int c = 0; c < 0x20; ++c)
+        {
+            table[c] = true;
+        }
+        table['"'] = true;
+        table['\\'] = true;
+        return table;
+    }();
+
+JsonWriter::JsonWriter(std::string& output, const Options& options) :
+    m_options(options),
+    m_string(&output)
+{
+    m_buffer.resize(std::max<size_t>(m_options.bufferSize, 64));
+}
+
+JsonWriter::JsonWriter(File* file, const Options& options) :
+    m_options(options),
+    m_file(file)
+{
+    m_buffer.resize(std::max<size_t>(m_options.bufferSize, 64));
+}
+
+JsonWriter::JsonWriter(BufferedWriter* writer, const Options& options) :
+    m_options(options),
+    m_writer(writer)
+{
+    m_buffer.resize(std::max<size_t>(m_options.bufferSize, 64));
+}
+
+JsonWriter::~JsonWriter()
+{
+    Flush();
+}
+
+void JsonWriter::WriteOut(const char* data, size_t size)
+{
+    if (m_string)
+    {
+        m_string->append(data, size);
+    }
+    else if (m_file)
+    {
+        if (m_file->Write(data, size) != 1)
+        {
+            m_hasError = true;
+        }
+    }
+    else if (m_writer)
+    {
+        if (!m_writer->Write(data, size))
+        {
+            m_hasError = true;
+        }
+    }
+}
+
+bool JsonWriter::Flush()
+{
+    if (m_bufferSize > 0)
+    {
+        WriteOut(m_buffer.data(), m_bufferSize);
+        m_bufferSize = 0;
+    }
+    return !m_hasError;
+}
+
+char* JsonWriter::Reserve(size_t size)
+{
+    if (m_bufferSize + size > m_buffer.size())
+    {
+        Flush();
+    }
+    return m_buffer.data() + m_bufferSize;
+}
+
+void JsonWriter::Append(const char* data, size_t size)
+{
+    if (m_bufferSize + size > m_buffer.size())
+    {
+        Flush();
+        if (size > m_buffer.size())
+        {
+            WriteOut(data, size);
+            return;
+        }
+    }
+    std::memcpy(m_buffer.data() + m_bufferSize, data, size);
+    m_bufferSize += size;
+}
+
+void JsonWriter::Put(char c)
+{
+    if (m_bufferSize == m_buffer.size())
+    {
+        Flush();
+    }
+    m_buffer[m_bufferSize++] = c;
+}
+
+void JsonWriter::WriteNewLine()
+{
+    static constexpr std::string_view Spaces = "                                                                ";
+    Put('\n');
+    size_t indent = m_isEmpty.size() * m_options.indent;
+    while (indent > 0)
+    {
+        const size_t count = std::min(indent, Spaces.size());
+        Append(Spaces.data(), count);
+        indent -= count;
+    }
+}
+
+void JsonWriter::BeginValue()
+{
+    if (m_afterKey)
+    {
+        m_afterKey = false;
+        return;
+    }
+    if (!m_isEmpty.empty())
+    {
+        if (!m_isEmpty.back())
+        {
+            Put(',');
+        }
+        m_isEmpty.back() = false;
+        if (m_options.pretty)
+        {
+            WriteNewLine();
+        }
+    }
+}
+
+void JsonWriter::BeginContainer(char bracket)
+{
+    BeginValue();
+    Put(bracket);
+    m_isEmpty.push_back(true);
+}
+
+void JsonWriter::EndContainer(char bracket)
+{
+    const bool isEmpty = m_isEmpty.back();
+    m_isEmpty.pop_back();
+    if (m_options.pretty && !isEmpty)
+    {
+        WriteNewLine();
+    }
+    Put(bracket);
+}
+
+void JsonWriter::WriteString(std::string_view str)
+{
+    static constexpr char HexDigits[] = "0123456789abcdef";
+    Put('"');
+    const char* p = str.data();
+    const char* end = str.data() + str.size();
+    while (p < end)
+    {
+        // Copy the run without characters to escape.
+        const char* run = p;
+        while ((p < end) && !g_needsEscape[static_cast<uint8_t>(*p)])
+        {
+            ++p;
+        }
+        Append(run, p - run);
+        if (p == end)
+        {
+            break;
+        }
+        const char c = *p++;
+        char escaped[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t escapedSize = 2;
+        switch (c)
+        {
+        case '"': escaped[1] = '"'; break;
+        case '\\': escaped[1] = '\\'; break;
+        case '\b': escaped[1] = 'b'; break;
+        case '\f': escaped[1] = 'f'; break;
+        case '\n': escaped[1] = 'n'; break;
+        case '\r': escaped[1] = 'r'; break;
+        case '\t': escaped[1] = 't'; break;
+        default:
+            escaped[1] = 'u';
+            escaped[2] = '0';
+            escaped[3] = '0';
+            escaped[4] = HexDigits[(c >> 4) & 0xF];
+            escaped[5] = HexDigits[c & 0xF];
+            escapedSize = 6;
+            break;
+        }
+        Append(escaped, escapedSize);
+    }
+    Put('"');
+}
+
+void JsonWriter::Write(const boost::json::value& value)
+{
+    switch (value.kind())
+    {
+    case boost::json::kind::null:
+        JsonWriter::OnNull();
+        break;
+    case boost::json::kind::bool_:
+        JsonWriter::OnBool(value.get_bool());
+        break;
+    case boost::json::kind::int64:
+        JsonWriter::OnInt64(value.get_int64());
+        break;
+    case boost::json::kind::uint64:
+        JsonWriter::OnUint64(value.get_uint64());
+        break;
+    case boost::json::kind::double_:
+        JsonWriter::OnDouble(value.get_double());
+        break;
+    case boost::json::kind::string:
+        JsonWriter::OnString(std::string_view(value.get_string().data(), value.get_string().size()));
+        break;
+    case boost::json::kind::array:
+        BeginContainer('[');
+        for (const boost::json::value& element : value.get_array())
+        {
+            Write(element);
+        }
+        EndContainer(']');
+        break;
+    case boost::json::kind::object:
+        BeginContainer('{');
+        for (const boost::json::key_value_pair& member : value.get_object())
+        {
+            JsonWriter::OnKey(std::string_view(member.key().data(), member.key().size()));
+            Write(member.value());
+        }
+        EndContainer('}');
+        break;
+    }
+}
+
+bool JsonWriter::OnObjectBegin()
+{
+    BeginContainer('{');
+    return true;
+}
+
+bool JsonWriter::OnObjectEnd(size_t memberCount)
+{
+    EndContainer('}');
+    return true;
+}
+
+bool JsonWriter::OnArrayBegin()
+{
+    BeginContainer('[');
+    return true;
+}
+
+bool JsonWriter::OnArrayEnd(size_t elementCount)
+{
+    EndContainer(']');
+    return true;
+}
+
+bool JsonWriter::OnKey(std::string_view key)
+{
+    BeginValue();
+    WriteString(key);
+    if (m_options.pretty)
+    {
+        Append(": ", 2);
+    }
+    else
+    {
+        Put(':');
+    }
+    m_afterKey = true;
+    return true;
+}
+
+bool JsonWriter::OnString(std::string_view str)
+{
+    BeginValue();
+    WriteString(str);
+    return true;
+}
+
+bool JsonWriter::OnInt64(int64_t i)
+{
+    BeginValue();
+    char* p = Reserve(24);
+    m_bufferSize += std::to_chars(p, p + 24, i).ptr - p;
+    return true;
+}
+
+bool JsonWriter::OnUint64(uint64_t u)
+{
+    BeginValue();
+    char* p = Reserve(24);
+    m_bufferSize += std::to_chars(p, p + 24, u).ptr - p;
+    return true;
+}
+
+bool JsonWriter::OnDouble(double d)
+{
+    BeginValue();
+    if (std::isnan(d))
+    {
+        // Not representable in JSON.
+        Append("null", 4);
+        return true;
+    }
+    if (std::isinf(d))
+    {
+        // Parsed back as infinity (out of range), the same as boost::json::serialize.
+        if (d < 0)
+        {
+            Append("-1e99999", 8);
+        }
+        else
+        {
+            Append("1e99999", 7);
+        }
+        return true;
+    }
+    char* p = Reserve(32);
+    char* end = std::to_chars(p, p + 32, d).ptr;
+    // Keep it a double when parsed back: "1" to "1.0".
+    if (std::find_if(p, end, [](char c) { return (c == '.') || (c == 'e'); }) == end)
+    {
+        *end++ = '.';
+        *end++ = '0';
+    }
+    m_bufferSize += end - p;
+    return true;
+}
+
+bool JsonWriter::OnBool(bool b)
+{
+    BeginValue();
+    if (b)
+    {
+        Append("true", 4);
+    }
+    else
+    {
+        Append("false", 5);
+    }
+    return true;
+}
+
+bool JsonWriter::OnNull()
+{
+    BeginValue();
+    Append("null", 4);
+    return true;
+}
+
+std::string SerializeJson(const boost::json::value& value, const JsonWriter::Options& options)
+{
+    std::string output;
+    {
+        JsonWriter writer(output, options);
+        writer.Write(value);
+    }
+    return output;
+}
+
+bool WriteJsonToFile(const boost::json::value& value, std::string_view fileName,
+    const JsonWriter::Options& options)
+{
+    BufferedWriter file;
+    if (!file.Open(fileName))
+    {
+        LogGlobal(Error, "WriteJsonToFile: failed to open {}", fileName);
+        return false;
+    }
+    JsonWriter writer(&file, options);
+    writer.Write(value);
+    if (!writer.Flush() || !file.Close())
+    {
+        LogGlobal(Error, "WriteJsonToFile: failed to write {}", fileName);
+        return false;
+    }
+    return true;
+}
+
+} // namespace rad
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "JsonStream.h"
+#include "File.h"
+#include "BufferedWriter.h"
+
+namespace rad
+{
+
+// Serializes values or events (it is a JsonHandler, e.g. reformat a huge document with ParseJsonFromFile)
+// through a fixed-size buffer directly to a string, File or BufferedWriter.
+// Doubles are formatted by std::to_chars (shortest round trip), and strings without characters
+// to escape are copied as they are.
+class JsonWriter : public JsonHandler
+{
+public:
+    struct Options
+    {
+        bool pretty = false;
+        // Spaces per level if pretty.
+        uint32_t indent = 4;
+        size_t bufferSize = 64 * 1024;
+    };
+
+    // Append to the string.
+    JsonWriter(std::string& output, const Options& options);
+    JsonWriter(std::string& output) : JsonWriter(output, Options()) {}
+    JsonWriter(File* file, const Options& options);
+    JsonWriter(File* file) : JsonWriter(file, Options()) {}
+    JsonWriter(BufferedWriter* writer, const Options& options);
+    JsonWriter(BufferedWriter* writer) : JsonWriter(writer, Options()) {}
+    // Flush the buffer.
+    ~JsonWriter();
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void Write(const boost::json::value& value);
+
+    bool OnObjectBegin() override;
+    bool OnObjectEnd(size_t memberCount) override;
+    bool OnArrayBegin() override;
+    bool OnArrayEnd(size_t elementCount) override;
+    bool OnKey(std::string_view key) override;
+    bool OnString(std::string_view str) override;
+    bool OnInt64(int64_t i) override;
+    bool OnUint64(uint64_t u) override;
+    bool OnDouble(double d) override;
+    bool OnBool(bool b) override;
+    bool OnNull() override;
+
+    // Write the buffer to the output; return false if any write failed.
+    bool Flush();
+    bool HasError() const { return m_hasError; }
+
+private:
+    // Write to the output directly.
+    void WriteOut(const char* data, size_t size);
+    // Reserve the space in the buffer, flush it if full.
+    char* Reserve(size_t size);
+    void Append(const char* data, size_t size);
+    void Append(std::string_view str) { Append(str.data(), str.size()); }
+    void Put(char c);
+    // Write the separator and indent before a value.
+    void BeginValue();
+    void BeginContainer(char bracket);
+    void EndContainer(char bracket);
+    void WriteString(std::string_view str);
+    void WriteNewLine();
+
+    Options m_options;
+    std::string* m_string = nullptr;
+    File* m_file = nullptr;
+    BufferedWriter* m_writer = nullptr;
+    std::vector<char> m_buffer;
+    size_t m_bufferSize = 0;
+    bool m_hasError = false;
+
+    // Whether the current container is empty, one per level.
+    std::vector<bool> m_isEmpty;
+    // A key is written, the value follows without separator.
+    bool m_afterKey = false;
+
+}; // class JsonWriter
+
+std::string SerializeJson(const boost::json::value& value, const JsonWriter::Options& options = {});
+// Write to the file through BufferedWriter; return false on failure (logged).
+bool WriteJsonToFile(const boost::json::value& value, std::string_view fileName,
+    const JsonWriter::Options& options = {});
+
+} // namespace rad
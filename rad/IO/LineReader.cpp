@@ -0,0 +1,125 @@
+#include "LineReader.h"
+#include <algorithm>
+#include <cstring>
+
+namespace rad
+{
+
+LineReader::LineReader(size_t bufferSize) :
+    m_bufferSize(std::max<size_t>(bufferSize, 64))
+{
+}
+
+LineReader::~LineReader()
+{
+}
+
+bool LineReader::Open(std::string_view fileName)
+{
+    Close();
+    if (!m_file.Open(fileName, "rb"))
+    {
+        return false;
+    }
+    if (!m_buffer)
+    {
+        m_buffer = std::make_unique<char[]>(m_bufferSize);
+    }
+    return true;
+}
+
+void LineReader::Close()
+{
+    if (m_file.IsOpen())
+    {
+        m_file.Close();
+    }
+    m_begin = 0;
+    m_end = 0;
+    m_scanPos = 0;
+    m_isEOF = false;
+    m_lineNumber = 0;
+}
+
+bool LineReader::ReadLine(std::string_view& line)
+{
+    if (!m_buffer)
+    {
+        return false;
+    }
+    while (true)
+    {
+        const char* newline = static_cast<const char*>(
+            std::memchr(m_buffer.get() + m_scanPos, '\n', m_end - m_scanPos));
+        if (newline)
+        {
+            size_t lineEnd = newline - m_buffer.get();
+            size_t lineSize = lineEnd - m_begin;
+            if ((lineSize > 0) && (m_buffer[lineEnd - 1] == '\r'))
+            {
+                lineSize--;
+            }
+            line = std::string_view(m_buffer.get() + m_begin, lineSize);
+            m_begin = lineEnd + 1;
+            m_scanPos = m_begin;
+            m_lineNumber++;
+            return true;
+        }
+        m_scanPos = m_end;
+        if (!Refill())
+        {
+            break;
+        }
+    }
+
+    // The last line without newline.
+    if (m_begin < m_end)
+    {
+        size_t lineSize = m_end - m_begin;
+        if (m_buffer[m_end - 1] == '\r')
+        {
+            lineSize--;
+        }
+        line = std::string_view(m_buffer.get() + m_begin, lineSize);
+        m_begin = m_end;
+        m_scanPos = m_end;
+        m_lineNumber++;
+        return true;
+    }
+    return false;
+}
+
+bool LineReader::Refill()
+{
+    if (m_isEOF || !m_file.IsOpen())
+    {
+        return false;
+    }
+    const size_t remaining = m_end - m_begin;
+    if (remaining == m_bufferSize)
+    {
+        // The line is longer than the buffer.
+        m_bufferSize *= 2;
+        std::unique_ptr<char[]> buffer = std::make_unique<char[]>(m_bufferSize);
+        std::memcpy(buffer.get(), m_buffer.get() + m_begin, remaining);
+        m_buffer = std::move(buffer);
+    }
+    else if (m_begin > 0)
+    {
+        std::memmove(m_buffer.get(), m_buffer.get() + m_begin, remaining);
+    }
+    m_scanPos -= m_begin;
+    m_begin = 0;
+    m_end = remaining;
+
+    size_t bytesRead = m_file.Read(m_buffer.get() + m_end, 1, m_bufferSize - m_end);
+    if (bytesRead == 0)
+    {
+        m_isEOF = true;
+        return false;
+    }
+    m_end += bytesRead;
+    return true;
+}
+
+} // namespace rad
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+#include "File.h"
+#include <memory>
+
+namespace rad
+{
+
+// Read lines of text files in large blocks, scan newlines with memchr (vectorized by the CRT);
+// the lines are views into the internal buffer, no per-line allocation.
+class LineReader
+{
+public:
+    static constexpr size_t DefaultBufferSize = 1024 * 1024;
+
+    LineReader(size_t bufferSize = DefaultBufferSize);
+    ~LineReader();
+
+    bool Open(std::string_view fileName);
+    void Close();
+    bool IsOpen() { return m_file.IsOpen(); }
+
+    // Return false at the end of the file.
+    // The line excludes the line ending ("\n" or "\r\n"), and is valid until the next call.
+    bool ReadLine(std::string_view& line);
+    // The line number of the last line read (starts from 1).
+    uint64_t GetLineNumber() const { return m_lineNumber; }
+
+private:
+    // Read the next block, keep the unfinished line.
+    bool Refill();
+
+    File m_file;
+    std::unique_ptr<char[]> m_buffer;
+    size_t m_bufferSize = 0;
+    // The unread data: [m_begin, m_end).
+    size_t m_begin = 0;
+    size_t m_end = 0;
+    // The data before m_scanPos has no newline.
+    size_t m_scanPos = 0;
+    bool m_isEOF = false;
+    uint64_t m_lineNumber = 0;
+
+}; // class LineReader
+
+} // namespace rad
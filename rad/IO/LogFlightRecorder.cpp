@@ -0,0 +1,334 @@
+#include "LogFlightRecorder.h"
+#include "Logging.h"
+#include "File.h"
+#include "rad/Core/Integer.h"
+#include <cerrno>
+#include <climits>
+#include <csignal>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#endif
+
+namespace rad
+{
+
+LogFlightRecorder::LogFlightRecorder(size_t capacity, std::string_view dumpFileName) :
+    m_dumpFileName(dumpFileName)
+{
+    m_capacity = RoundUpToPow2(static_cast<uint64_t>(std::max<size_t>(capacity, 1)));
+    m_slots = std::make_unique<Slot[]>(m_capacity);
+    m_signalBuffer = std::make_unique<char[]>(MaxMessageSize);
+#ifdef _WIN32
+    m_dumpFileNameWide = StrU8ToWide(m_dumpFileName);
+#endif
+}
+
+LogFlightRecorder::~LogFlightRecorder()
+{
+}
+
+bool LogFlightRecorder::ReadRecord(uint64_t index, RecordData* record) const
+{
+    const Slot& slot = m_slots[index & (m_capacity - 1)];
+    const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != index * 2 + 2)
+    {
+        return false;
+    }
+    for (size_t i = 0; i < std::size(slot.words); ++i)
+    {
+        const uint64_t word = slot.words[i].load(std::memory_order_relaxed);
+        std::memcpy(reinterpret_cast<char*>(record) + i * sizeof(uint64_t), &word, sizeof(word));
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) != sequence)
+    {
+        return false;
+    }
+    return (record->loggerNameSize <= MaxLoggerNameSize) &&
+        (static_cast<size_t>(record->formatSize) + record->argsSize <= sizeof(record->data)) &&
+        (record->level >= LogLevel::Debug) && (record->level < LogLevel::Count);
+}
+
+size_t LogFlightRecorder::FormatRecord(const RecordData& record, char* buffer, size_t bufferSize)
+{
+    const std::string_view format(record.data, record.formatSize);
+    size_t size = 0;
+    auto append = [&](std::string_view str) {
+        const size_t count = std::min(str.size(), bufferSize - size);
+        std::memcpy(buffer + size, str.data(), count);
+        size += count;
+        };
+    if (record.formatFunc)
+    {
+        try
+        {
+            if (!record.formatFunc(format, record.data + record.formatSize, record.argsSize,
+                buffer, bufferSize, &size))
+            {
+                size = 0;
+                append(format);
+                append(" (invalid arguments)");
+            }
+        }
+        catch (const std::exception&)
+        {
+            size = 0;
+            append(format);
+            append(" (format error)");
+        }
+    }
+    else
+    {
+        append(format);
+        append(" (arguments truncated)");
+    }
+    return size;
+}
+
+std::vector<std::string> LogFlightRecorder::GetMessages() const
+{
+    std::vector<std::string> messages;
+    const uint64_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    const uint64_t beginIndex = (writeIndex > m_capacity) ? (writeIndex - m_capacity) : 0;
+    messages.reserve(writeIndex - beginIndex);
+    std::string buffer(MaxMessageSize, '\0');
+    for (uint64_t index = beginIndex; index < writeIndex; ++index)
+    {
+        RecordData record;
+        if (!ReadRecord(index, &record))
+        {
+            continue;
+        }
+        const size_t size = FormatRecord(record, buffer.data(), buffer.size());
+        messages.push_back(FormatLogMessage(
+            std::chrono::system_clock::time_point(std::chrono::system_clock::duration(record.time)),
+            std::string_view(record.loggerName, record.loggerNameSize), record.level,
+            std::string_view(buffer.data(), size)));
+    }
+    return messages;
+}
+
+size_t LogFlightRecorder::Dump(std::string_view fileName) const
+{
+    std::vector<std::string> messages = GetMessages();
+    File file;
+    if (!file.Open(std::string(fileName), "wb"))
+    {
+        return 0;
+    }
+    for (const std::string& message : messages)
+    {
+        file.Write(message.data(), message.size());
+    }
+    file.Close();
+    return messages.size();
+}
+
+static void WriteAll(int fd, const char* data, size_t size)
+{
+    while (size > 0)
+    {
+#ifndef _WIN32
+        const ssize_t written = write(fd, data, size);
+        if ((written < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+#else
+        const int written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, INT_MAX)));
+#endif
+        if (written <= 0)
+        {
+            return;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+// Append the text to the buffer at p, truncated at end (no formatting library in the signal handlers).
+static void AppendText(char*& p, const char* end, std::string_view text)
+{
+    const size_t count = std::min(text.size(), static_cast<size_t>(end - p));
+    std::memcpy(p, text.data(), count);
+    p += count;
+}
+
+static void AppendDecimal(char*& p, const char* end, uint64_t value, int minDigits)
+{
+    char digits[20];
+    int count = 0;
+    do
+    {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while ((value > 0) || (count < minDigits));
+    while ((count > 0) && (p < end))
+    {
+        *p++ = digits[--count];
+    }
+}
+
+static void AppendHex(char*& p, const char* end, const char* data, size_t size)
+{
+    static constexpr char HexDigits[] = "0123456789abcdef";
+    for (size_t i = 0; (i < size) && (end - p >= 2); ++i)
+    {
+        const uint8_t byte = static_cast<uint8_t>(data[i]);
+        *p++ = HexDigits[byte >> 4];
+        *p++ = HexDigits[byte & 0xF];
+    }
+}
+
+size_t LogFlightRecorder::DumpFromSignalHandler() const
+{
+#ifndef _WIN32
+    const int fd = open(m_dumpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#else
+    const int fd = _wopen(m_dumpFileNameWide.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#endif
+    if (fd < 0)
+    {
+        return 0;
+    }
+    const uint64_t writeIndex = m_writeIndex.load(std::memory_order_acquire);
+    const uint64_t beginIndex = (writeIndex > m_capacity) ? (writeIndex - m_capacity) : 0;
+    size_t recordCount = 0;
+    for (uint64_t index = beginIndex; index < writeIndex; ++index)
+    {
+        RecordData record;
+        if (!ReadRecord(index, &record))
+        {
+            continue;
+        }
+        // "[hh:mm:ss.mmm] loggerName: level: format | args: hex\n", like FormatLogMessage.
+        char* p = m_signalBuffer.get();
+        const char* end = p + MaxMessageSize;
+        const uint64_t milliseconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::duration(record.time)).count());
+        const uint64_t seconds = milliseconds / 1000 % 86400;
+        AppendText(p, end, "[");
+        AppendDecimal(p, end, seconds / 3600, 2);
+        AppendText(p, end, ":");
+        AppendDecimal(p, end, seconds / 60 % 60, 2);
+        AppendText(p, end, ":");
+        AppendDecimal(p, end, seconds % 60, 2);
+        AppendText(p, end, ".");
+        AppendDecimal(p, end, milliseconds % 1000, 3);
+        AppendText(p, end, "] ");
+        AppendText(p, end, std::string_view(record.loggerName, record.loggerNameSize));
+        AppendText(p, end, ": ");
+        AppendText(p, end, GetLogLevelString(record.level));
+        AppendText(p, end, ": ");
+        AppendText(p, end, std::string_view(record.data, record.formatSize));
+        if (!record.formatFunc)
+        {
+            AppendText(p, end, " (arguments truncated)");
+        }
+        else if (record.argsSize > 0)
+        {
+            AppendText(p, end, " | args: ");
+            AppendHex(p, end, record.data + record.formatSize, record.argsSize);
+        }
+        AppendText(p, end, "\n");
+        WriteAll(fd, m_signalBuffer.get(), static_cast<size_t>(p - m_signalBuffer.get()));
+        recordCount++;
+    }
+#ifndef _WIN32
+    close(fd);
+#else
+    _close(fd);
+#endif
+    return recordCount;
+}
+
+static std::atomic<LogFlightRecorder*> g_logFlightRecorder = nullptr;
+
+#ifndef _WIN32
+static constexpr int FatalSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS };
+static struct sigaction g_previousSignalActions[std::size(FatalSignals)];
+#else
+static constexpr int FatalSignals[] = { SIGSEGV, SIGABRT, SIGFPE, SIGILL };
+static void (*g_previousSignalHandlers[std::size(FatalSignals)])(int);
+#endif
+
+static void FlightRecorderSignalHandler(int sig)
+{
+    static std::atomic_flag s_dumped = ATOMIC_FLAG_INIT;
+    if (!s_dumped.test_and_set())
+    {
+        if (LogFlightRecorder* recorder = g_logFlightRecorder.load(std::memory_order_acquire))
+        {
+            recorder->DumpFromSignalHandler();
+        }
+    }
+    // Chain: restore the previous handler (the default one terminates), and raise again;
+    // the signal is blocked in the handler, and delivered to the previous one once this returns.
+    for (size_t i = 0; i < std::size(FatalSignals); ++i)
+    {
+        if (FatalSignals[i] == sig)
+        {
+#ifndef _WIN32
+            sigaction(sig, &g_previousSignalActions[i], nullptr);
+#else
+            std::signal(sig, g_previousSignalHandlers[i]);
+#endif
+        }
+    }
+    std::raise(sig);
+}
+
+bool EnableLogFlightRecorder(size_t capacity, std::string_view dumpFileName, bool installSignalHandlers)
+{
+    // Never deleted: other threads may be recording without any synchronization.
+    LogFlightRecorder* recorder = new LogFlightRecorder(capacity, dumpFileName);
+    LogFlightRecorder* expected = nullptr;
+    if (!g_logFlightRecorder.compare_exchange_strong(expected, recorder, std::memory_order_acq_rel))
+    {
+        delete recorder;
+        return false;
+    }
+    if (installSignalHandlers)
+    {
+        for (size_t i = 0; i < std::size(FatalSignals); ++i)
+        {
+#ifndef _WIN32
+            struct sigaction action = {};
+            action.sa_handler = FlightRecorderSignalHandler;
+            sigemptyset(&action.sa_mask);
+            sigaction(FatalSignals[i], &action, &g_previousSignalActions[i]);
+#else
+            g_previousSignalHandlers[i] = std::signal(FatalSignals[i], FlightRecorderSignalHandler);
+            if (g_previousSignalHandlers[i] == SIG_ERR)
+            {
+                g_previousSignalHandlers[i] = SIG_DFL;
+            }
+#endif
+        }
+    }
+    return true;
+}
+
+LogFlightRecorder* GetLogFlightRecorder()
+{
+    return g_logFlightRecorder.load(std::memory_order_acquire);
+}
+
+size_t DumpLogFlightRecorder()
+{
+    if (LogFlightRecorder* recorder = GetLogFlightRecorder())
+    {
+        return recorder->Dump();
+    }
+    return 0;
+}
+
+} // namespace rad
@@ -0,0 +1,289 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+
+namespace rad
+{
+
+enum class LogLevel;
+
+namespace detail
+{
+
+template<typename T>
+concept FlightArgString = std::is_convertible_v<const T&, std::string_view>;
+
+// Trivially copyable values are copied as is, strings are copied (truncated if too long),
+// the other types are formatted eagerly into the record (truncated, without allocating).
+template<typename T>
+using FlightArgDecoded = std::conditional_t<
+    !FlightArgString<T> && std::is_trivially_copyable_v<T>, T, std::string_view>;
+
+template<typename T>
+bool EncodeFlightArg(char*& p, const char* end, const T& arg)
+{
+    if constexpr (!FlightArgString<T> && std::is_trivially_copyable_v<T>)
+    {
+        if (static_cast<size_t>(end - p) < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(p, &arg, sizeof(T));
+        p += sizeof(T);
+        return true;
+    }
+    else
+    {
+        if (static_cast<size_t>(end - p) < sizeof(uint16_t))
+        {
+            return false;
+        }
+        const size_t capacity = std::min<size_t>(static_cast<size_t>(end - p) - sizeof(uint16_t), UINT16_MAX);
+        char* str = p + sizeof(uint16_t);
+        uint16_t size = 0;
+        if constexpr (FlightArgString<T>)
+        {
+            const std::string_view view = arg;
+            size = static_cast<uint16_t>(std::min(view.size(), capacity));
+            std::memcpy(str, view.data(), size);
+        }
+        else
+        {
+            const auto result = std::format_to_n(str, static_cast<std::ptrdiff_t>(capacity), "{}", arg);
+            size = static_cast<uint16_t>(result.out - str);
+        }
+        std::memcpy(p, &size, sizeof(size));
+        p += sizeof(uint16_t) + size;
+        return true;
+    }
+}
+
+// Never reads past end: valid is cleared (and an empty value returned) if the argument doesn't fit.
+template<typename T>
+FlightArgDecoded<T> DecodeFlightArg(const char*& p, const char* end, bool& valid)
+{
+    if constexpr (!FlightArgString<T> && std::is_trivially_copyable_v<T>)
+    {
+        T value{};
+        if (!valid || (static_cast<size_t>(end - p) < sizeof(T)))
+        {
+            valid = false;
+            return value;
+        }
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+    else
+    {
+        uint16_t size = 0;
+        if (!valid || (static_cast<size_t>(end - p) < sizeof(size)))
+        {
+            valid = false;
+            return std::string_view();
+        }
+        std::memcpy(&size, p, sizeof(size));
+        p += sizeof(size);
+        if (static_cast<size_t>(end - p) < size)
+        {
+            valid = false;
+            return std::string_view();
+        }
+        std::string_view str(p, size);
+        p += size;
+        return str;
+    }
+}
+
+// Writes to a fixed buffer and drops what doesn't fit, without allocating.
+struct FlightBufferIterator
+{
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = void;
+
+    char* p = nullptr;
+    char* end = nullptr;
+
+    FlightBufferIterator& operator*() { return *this; }
+    FlightBufferIterator& operator++() { return *this; }
+    FlightBufferIterator& operator++(int) { return *this; }
+    FlightBufferIterator& operator=(char c)
+    {
+        if (p < end)
+        {
+            *p++ = c;
+        }
+        return *this;
+    }
+};
+
+// Format the decoded arguments into the buffer, set the size written (truncated if too long);
+// return false if the arguments don't decode to exactly argsSize bytes (not encoded with Args).
+template<typename... Args>
+bool FormatFlightRecord(std::string_view format, const char* args, size_t argsSize,
+    char* buffer, size_t bufferSize, size_t* pSize)
+{
+    [[maybe_unused]] const char* p = args;
+    [[maybe_unused]] const char* end = args + argsSize;
+    bool valid = true;
+    // Braced initialization guarantees the left-to-right evaluation order.
+    std::tuple<FlightArgDecoded<Args>...> values{ DecodeFlightArg<Args>(p, end, valid)... };
+    if (!valid || (p != end))
+    {
+        return false;
+    }
+    *pSize = std::apply([&](auto&... values) {
+        FlightBufferIterator out = std::vformat_to(FlightBufferIterator{ buffer, buffer + bufferSize },
+            format, std::make_format_args(values...));
+        return static_cast<size_t>(out.p - buffer);
+        }, values);
+    return true;
+}
+
+} // namespace detail
+
+// Keep the latest log records of all levels (including the ones filtered out by loggers)
+// in a lock-free ring of fixed size records. The arguments are copied in compact form,
+// and only formatted when dumped.
+class LogFlightRecorder
+{
+public:
+    static constexpr size_t RecordSize = 256;
+    static constexpr size_t MaxLoggerNameSize = 32;
+    // The formatted messages longer than this are truncated.
+    static constexpr size_t MaxMessageSize = 4096;
+
+    // @param capacity: the max number of records, rounded up to power of 2.
+    // @param dumpFileName: where Dump() writes to.
+    LogFlightRecorder(size_t capacity, std::string_view dumpFileName);
+    ~LogFlightRecorder();
+
+    size_t GetCapacity() const { return m_capacity; }
+    const std::string& GetDumpFileName() const { return m_dumpFileName; }
+
+    // @param loggerName: copied (truncated to MaxLoggerNameSize).
+    template<typename... Args>
+    void Record(std::string_view loggerName, LogLevel level, std::string_view format, const Args&... args)
+    {
+        // Build the record on the stack, then publish it to the slot (seqlock).
+        RecordData record;
+        record.time = std::chrono::system_clock::now().time_since_epoch().count();
+        record.level = level;
+        record.loggerNameSize = static_cast<uint8_t>(std::min(loggerName.size(), MaxLoggerNameSize));
+        std::memcpy(record.loggerName, loggerName.data(), record.loggerNameSize);
+        char* p = record.data;
+        [[maybe_unused]] const char* end = record.data + sizeof(record.data);
+        record.formatSize = static_cast<uint16_t>(std::min(format.size(), sizeof(record.data)));
+        std::memcpy(p, format.data(), record.formatSize);
+        p += record.formatSize;
+        if ((detail::EncodeFlightArg(p, end, args) && ...))
+        {
+            record.formatFunc = &detail::FormatFlightRecord<std::decay_t<Args>...>;
+        }
+        else
+        {
+            record.formatFunc = nullptr;
+        }
+        record.argsSize = static_cast<uint16_t>(p - (record.data + record.formatSize));
+
+        const uint64_t index = m_writeIndex.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = m_slots[index & (m_capacity - 1)];
+        // Claim the slot by making its sequence odd, from an even (published) sequence of an older record:
+        // a writer that lapped the ring must not write over one still writing (the reader would accept a record
+        // torn between both). Drop the record if the slot is being written, or already holds a newer record.
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        do
+        {
+            if ((sequence % 2 != 0) || (sequence > index * 2))
+            {
+                return;
+            }
+        } while (!slot.sequence.compare_exchange_weak(sequence, index * 2 + 1, std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_release);
+        const size_t usedSize = static_cast<size_t>(p - reinterpret_cast<const char*>(&record));
+        const size_t wordCount = (usedSize + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+        for (size_t i = 0; i < wordCount; ++i)
+        {
+            uint64_t word;
+            std::memcpy(&word, reinterpret_cast<const char*>(&record) + i * sizeof(uint64_t), sizeof(word));
+            slot.words[i].store(word, std::memory_order_relaxed);
+        }
+        slot.sequence.store(index * 2 + 2, std::memory_order_release);
+    }
+
+    // Format the records in order, the oldest first.
+    std::vector<std::string> GetMessages() const;
+    // @return the number of records written.
+    size_t Dump(std::string_view fileName) const;
+    size_t Dump() const { return Dump(m_dumpFileName); }
+    // Dump to the dump file for the fatal signal handlers, where the heap and stdio may be corrupted or locked:
+    // only open/write/close into a buffer allocated beforehand, and no formatting, the records are written
+    // as the format string followed by the arguments in hex; the times are in UTC.
+    // Not thread-safe: meant to be called once, before the process terminates.
+    size_t DumpFromSignalHandler() const;
+
+private:
+    using FormatFunc = bool(*)(std::string_view format, const char* args, size_t argsSize,
+        char* buffer, size_t bufferSize, size_t* pSize);
+
+    // Copied in and out of the slots through atomic words.
+    struct RecordData
+    {
+        std::chrono::system_clock::rep time;
+        FormatFunc formatFunc;
+        LogLevel level;
+        uint16_t formatSize;
+        uint16_t argsSize;
+        uint8_t loggerNameSize;
+        char loggerName[MaxLoggerNameSize];
+        // The format string, followed by the encoded arguments.
+        char data[RecordSize - 72];
+    };
+    static_assert(sizeof(RecordData) == RecordSize - sizeof(uint64_t));
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> sequence = 0;
+        std::atomic<uint64_t> words[sizeof(RecordData) / sizeof(uint64_t)];
+    };
+    static_assert(sizeof(Slot) == RecordSize);
+
+    // Copy the record at index and validate it with the sequence before and after (seqlock);
+    // return false if it has been overwritten (torn), or its sizes are out of range.
+    bool ReadRecord(uint64_t index, RecordData* record) const;
+    // Format the message of a validated record into buffer, return the size (truncated if too long).
+    static size_t FormatRecord(const RecordData& record, char* buffer, size_t bufferSize);
+
+    std::unique_ptr<Slot[]> m_slots;
+    size_t m_capacity = 0;
+    std::atomic<uint64_t> m_writeIndex = 0;
+    std::string m_dumpFileName;
+#ifdef _WIN32
+    // Converted beforehand: no allocation in the signal handlers.
+    std::wstring m_dumpFileNameWide;
+#endif
+    std::unique_ptr<char[]> m_signalBuffer;
+
+}; // class LogFlightRecorder
+
+// Start recording logs of all loggers, only the first call takes effect;
+// the recorder dumps on Critical messages, and on fatal signals if installSignalHandlers.
+bool EnableLogFlightRecorder(size_t capacity, std::string_view dumpFileName, bool installSignalHandlers = true);
+// Return nullptr if not enabled.
+LogFlightRecorder* GetLogFlightRecorder();
+// Dump the recorder on demand, return the number of records written.
+size_t DumpLogFlightRecorder();
+
+} // namespace rad
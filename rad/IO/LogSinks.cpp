@@ -0,0 +1,222 @@
+#include "LogSinks.h"
+#include <cstdio>
+
+namespace rad
+{
+
+ConsoleLogSink::ConsoleLogSink()
+{
+}
+
+ConsoleLogSink::~ConsoleLogSink()
+{
+}
+
+void ConsoleLogSink::Write(LogLevel level, std::string_view message)
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (level <= LogLevel::Info)
+    {
+        fwrite(message.data(), message.size(), 1, stdout);
+    }
+    else
+    {
+        fwrite(message.data(), message.size(), 1, stderr);
+    }
+}
+
+void ConsoleLogSink::Flush()
+{
+    std::lock_guard lockGuard(m_mutex);
+    fflush(stdout);
+    fflush(stderr);
+}
+
+FileLogSink::FileLogSink()
+{
+}
+
+FileLogSink::FileLogSink(std::string_view fileName, bool overwrite)
+{
+    Open(fileName, overwrite);
+}
+
+FileLogSink::~FileLogSink()
+{
+}
+
+bool FileLogSink::Open(std::string_view fileName, bool overwrite)
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (m_file.IsOpen())
+    {
+        m_file.Close();
+    }
+    return m_file.Open(std::string(fileName), overwrite ? "wb" : "ab");
+}
+
+void FileLogSink::Close()
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (m_file.IsOpen())
+    {
+        m_file.Close();
+    }
+}
+
+bool FileLogSink::IsOpen()
+{
+    std::lock_guard lockGuard(m_mutex);
+    return m_file.IsOpen();
+}
+
+void FileLogSink::Write(LogLevel level, std::string_view message)
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (m_file.IsOpen())
+    {
+        m_file.Write(message.data(), message.size());
+    }
+}
+
+void FileLogSink::Flush()
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (m_file.IsOpen())
+    {
+        m_file.Flush();
+    }
+}
+
+RotatingFileLogSink::RotatingFileLogSink(std::string_view fileName, uint64_t maxFileSize, uint32_t maxFiles) :
+    m_fileName(fileName),
+    m_maxFileSize(maxFileSize),
+    m_maxFiles(maxFiles)
+{
+    if (m_file.Open(m_fileName, "ab"))
+    {
+        m_fileSize = m_file.GetSize();
+    }
+}
+
+RotatingFileLogSink::~RotatingFileLogSink()
+{
+}
+
+bool RotatingFileLogSink::IsOpen()
+{
+    std::lock_guard lockGuard(m_mutex);
+    return m_file.IsOpen();
+}
+
+// log.txt -> log.{index}.txt
+std::string RotatingFileLogSink::GetFileName(uint32_t index) const
+{
+    if (index == 0)
+    {
+        return m_fileName;
+    }
+    size_t extPos = m_fileName.rfind('.');
+    size_t sepPos = m_fileName.find_last_of("/\\");
+    if ((extPos == std::string::npos) ||
+        ((sepPos != std::string::npos) && (extPos < sepPos)))
+    {
+        return m_fileName + "." + std::to_string(index);
+    }
+    return m_fileName.substr(0, extPos) + "." + std::to_string(index) + m_fileName.substr(extPos);
+}
+
+void RotatingFileLogSink::Write(LogLevel level, std::string_view message)
+{
+    std::lock_guard lockGuard(m_mutex);
+    if ((m_fileSize > 0) && (m_fileSize + message.size() > m_maxFileSize))
+    {
+        Rotate();
+    }
+    if (m_file.IsOpen())
+    {
+        m_file.Write(message.data(), message.size());
+        m_fileSize += message.size();
+    }
+}
+
+void RotatingFileLogSink::Flush()
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (m_file.IsOpen())
+    {
+        m_file.Flush();
+    }
+}
+
+void RotatingFileLogSink::Rotate()
+{
+    if (m_file.IsOpen())
+    {
+        m_file.Close();
+    }
+    if (m_maxFiles > 0)
+    {
+        std::remove(GetFileName(m_maxFiles).c_str());
+        for (uint32_t index = m_maxFiles; index > 0; --index)
+        {
+            std::rename(GetFileName(index - 1).c_str(), GetFileName(index).c_str());
+        }
+    }
+    m_file.Open(m_fileName, "wb");
+    m_fileSize = 0;
+}
+
+RingBufferLogSink::RingBufferLogSink(size_t capacity) :
+    m_capacity(capacity)
+{
+}
+
+RingBufferLogSink::~RingBufferLogSink()
+{
+}
+
+std::vector<std::string> RingBufferLogSink::GetMessages()
+{
+    std::lock_guard lockGuard(m_mutex);
+    return std::vector<std::string>(m_messages.begin(), m_messages.end());
+}
+
+void RingBufferLogSink::Clear()
+{
+    std::lock_guard lockGuard(m_mutex);
+    m_messages.clear();
+}
+
+void RingBufferLogSink::Write(LogLevel level, std::string_view message)
+{
+    std::lock_guard lockGuard(m_mutex);
+    if (m_capacity == 0)
+    {
+        return;
+    }
+    if (m_messages.size() >= m_capacity)
+    {
+        m_messages.pop_front();
+    }
+    m_messages.emplace_back(message);
+}
+
+CallbackLogSink::CallbackLogSink(Callback callback) :
+    m_callback(std::move(callback))
+{
+}
+
+CallbackLogSink::~CallbackLogSink()
+{
+}
+
+void CallbackLogSink::Write(LogLevel level, std::string_view message)
+{
+    if (m_callback)
+    {
+        m_callback(level, message);
+    }
+}
+
+} // namespace rad
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Logging.h"
+#include "File.h"
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace rad
+{
+
+// Output to stdout (Debug/Info) and stderr (Warn/Error/Critical).
+class ConsoleLogSink : public LogSink
+{
+public:
+    ConsoleLogSink();
+    ~ConsoleLogSink() override;
+
+    void Write(LogLevel level, std::string_view message) override;
+    void Flush() override;
+
+private:
+    std::mutex m_mutex;
+
+}; // class ConsoleLogSink
+
+class FileLogSink : public LogSink
+{
+public:
+    FileLogSink();
+    FileLogSink(std::string_view fileName, bool overwrite = false);
+    ~FileLogSink() override;
+
+    // @param overwrite: if true, overwrite existing contents.
+    bool Open(std::string_view fileName, bool overwrite = false);
+    void Close();
+    bool IsOpen();
+
+    void Write(LogLevel level, std::string_view message) override;
+    void Flush() override;
+
+private:
+    std::mutex m_mutex;
+    File m_file;
+
+}; // class FileLogSink
+
+// Rotate files when the current file exceeds maxFileSize:
+// log.txt -> log.1.txt -> log.2.txt ... -> log.{maxFiles}.txt (deleted).
+class RotatingFileLogSink : public LogSink
+{
+public:
+    RotatingFileLogSink(std::string_view fileName, uint64_t maxFileSize, uint32_t maxFiles);
+    ~RotatingFileLogSink() override;
+
+    bool IsOpen();
+    std::string GetFileName(uint32_t index) const;
+
+    void Write(LogLevel level, std::string_view message) override;
+    void Flush() override;
+
+private:
+    void Rotate();
+
+    std::mutex m_mutex;
+    File m_file;
+    std::string m_fileName;
+    uint64_t m_maxFileSize = 0;
+    uint32_t m_maxFiles = 0;
+    uint64_t m_fileSize = 0;
+
+}; // class RotatingFileLogSink
+
+// Keep the latest messages in memory, useful for in-app consoles and tests.
+class RingBufferLogSink : public LogSink
+{
+public:
+    RingBufferLogSink(size_t capacity);
+    ~RingBufferLogSink() override;
+
+    std::vector<std::string> GetMessages();
+    void Clear();
+
+    void Write(LogLevel level, std::string_view message) override;
+    void Flush() override {}
+
+private:
+    std::mutex m_mutex;
+    std::deque<std::string> m_messages;
+    size_t m_capacity = 0;
+
+}; // class RingBufferLogSink
+
+// Forward messages to a user function; the callback must be thread-safe.
+class CallbackLogSink : public LogSink
+{
+public:
+    using Callback = std::function<void(LogLevel level, std::string_view message)>;
+
+    CallbackLogSink(Callback callback);
+    ~CallbackLogSink() override;
+
+    void Write(LogLevel level, std::string_view message) override;
+    void Flush() override {}
+
+private:
+    Callback m_callback;
+
+}; // class CallbackLogSink
+
+} // namespace rad
@@ -1,8 +1,8 @@
 #include "Logging.h"
+#include "LogSinks.h"
 #include "rad/Core/TypeTraits.h"
+#include <algorithm>
 #include <cstdarg>
-#include <fstream>
-#include <mutex>
 
 namespace rad
 {
@@ -21,65 +21,211 @@ const char* GetLogLevelString(LogLevel level)
     return g_logLevelStrings[ToUnderlying(level)];
 }
 
-static std::mutex g_logMutex;
-static std::ofstream g_logFile;
+std::string FormatLogMessage(std::chrono::system_clock::time_point time,
+    std::string_view loggerName, LogLevel level, std::string_view message)
+{
+    long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+        time.time_since_epoch()).count() % 1000;
+    std::time_t t = std::chrono::system_clock::to_time_t(time);
+    std::tm timeInfo = {};
+    LocalTime(&t, &timeInfo);
+    return std::format("[{:0>2}:{:0>2}:{:0>2}.{:0>3}] {}: {}: {}\n",
+        timeInfo.tm_hour, timeInfo.tm_min, timeInfo.tm_sec, milliseconds,
+        loggerName, GetLogLevelString(level), message);
+}
+
+// Function-local statics: loggers in other translation units may be constructed first.
+Ref<LogSink> GetConsoleLogSink()
+{
+    static Ref<LogSink> s_sink = new ConsoleLogSink();
+    return s_sink;
+}
+
+static Ref<FileLogSink> GetDefaultFileLogSinkImpl()
+{
+    static Ref<FileLogSink> s_sink = new FileLogSink();
+    return s_sink;
+}
+
+Ref<LogSink> GetDefaultFileLogSink()
+{
+    return GetDefaultFileLogSinkImpl();
+}
 
 bool SetLogFile(std::string_view fileName, bool overwrite)
 {
-    std::lock_guard lockGuard(g_logMutex);
-    if (g_logFile.is_open())
+    return GetDefaultFileLogSinkImpl()->Open(fileName, overwrite);
+}
+
+static int64_t GetLogSiteTime()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool LogSite::TryAcquire(uint64_t* pSuppressedCount)
+{
+    if (m_emissionInterval > 0)
     {
-        g_logFile.close();
+        const int64_t now = GetLogSiteTime();
+        int64_t arrivalTime = m_theoreticalArrivalTime.load(std::memory_order_relaxed);
+        int64_t newArrivalTime = 0;
+        do {
+            newArrivalTime = std::max(arrivalTime, now) + m_emissionInterval;
+            if (newArrivalTime - now > m_burstTolerance)
+            {
+                m_suppressedCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        } while (!m_theoreticalArrivalTime.compare_exchange_weak(
+            arrivalTime, newArrivalTime, std::memory_order_relaxed));
     }
-    std::ios_base::openmode mode = std::ios_base::app;
-    if (overwrite)
+    *pSuppressedCount = (m_suppressedCount.load(std::memory_order_relaxed) > 0) ?
+        m_suppressedCount.exchange(0, std::memory_order_relaxed) : 0;
+    return true;
+}
+
+bool LogSite::Deduplicate(std::string_view message, uint64_t* pRepeatCount)
+{
+    const size_t hash = std::hash<std::string_view>()(message);
+    const int64_t now = GetLogSiteTime();
+    *pRepeatCount = 0;
+    if (m_lastMessageHash.exchange(hash, std::memory_order_relaxed) == hash)
     {
-        mode = std::ios_base::out;
+        m_repeatCount.fetch_add(1, std::memory_order_relaxed);
+        // Report periodically if the message keeps repeating.
+        int64_t reportTime = m_repeatReportTime.load(std::memory_order_relaxed);
+        if ((now - reportTime >= m_repeatReportInterval) &&
+            m_repeatReportTime.compare_exchange_strong(reportTime, now, std::memory_order_relaxed))
+        {
+            *pRepeatCount = m_repeatCount.exchange(0, std::memory_order_relaxed);
+        }
+        return true;
     }
-    g_logFile.open(fileName.data(), mode);
-    return g_logFile.is_open();
+    else
+    {
+        // The message changed: report the repeats of the previous one.
+        *pRepeatCount = m_repeatCount.exchange(0, std::memory_order_relaxed);
+        m_repeatReportTime.store(now, std::memory_order_relaxed);
+        return false;
+    }
+}
+
+Logger::Logger(std::string_view name) :
+    Logger(name, { GetConsoleLogSink(), GetDefaultFileLogSink() })
+{
 }
 
-Logger::Logger(std::string_view name)
+Logger::Logger(std::string_view name, LogSinkList sinks)
 {
     m_name = name;
+    PublishSinks(std::move(sinks));
 }
 
 Logger::~Logger()
 {
 }
 
-void Logger::Output(LogLevel level, std::string_view buffer)
+void Logger::EnableOutputToConsole(bool enable)
 {
-    std::lock_guard lockGuard(g_logMutex);
+    if (enable)
+    {
+        AddSink(GetConsoleLogSink());
+    }
+    else
+    {
+        RemoveSink(GetConsoleLogSink().get());
+    }
+}
 
-    if (m_enableOutputToConsole)
+void Logger::EnableOutputToFile(bool enable)
+{
+    if (enable)
     {
-        if (level <= LogLevel::Info)
-        {
-            fwrite(buffer.data(), buffer.size(), 1, stdout);
-        }
-        else
+        AddSink(GetDefaultFileLogSink());
+    }
+    else
+    {
+        RemoveSink(GetDefaultFileLogSink().get());
+    }
+}
+
+void Logger::SetSinks(LogSinkList sinks)
+{
+    std::lock_guard lockGuard(m_sinkUpdateMutex);
+    PublishSinks(std::move(sinks));
+}
+
+template<typename Update>
+void Logger::UpdateSinks(Update&& update)
+{
+    std::lock_guard lockGuard(m_sinkUpdateMutex);
+    LogSinkList sinks = *GetSinks();
+    update(sinks);
+    PublishSinks(std::move(sinks));
+}
+
+void Logger::PublishSinks(LogSinkList sinks)
+{
+    m_sinks.store(std::make_shared<const LogSinkList>(std::move(sinks)), std::memory_order_release);
+}
+
+void Logger::AddSink(Ref<LogSink> sink)
+{
+    UpdateSinks([&](LogSinkList& sinks) {
+        if (std::find(sinks.begin(), sinks.end(), sink) == sinks.end())
         {
-            fwrite(buffer.data(), buffer.size(), 1, stderr);
+            sinks.push_back(sink);
         }
-    }
+    });
+}
 
-    if (m_enableOutputToFile && g_logFile.is_open())
+void Logger::RemoveSink(const LogSink* sink)
+{
+    UpdateSinks([&](LogSinkList& sinks) {
+        std::erase_if(sinks, [&](const Ref<LogSink>& s) { return (s.get() == sink); });
+    });
+}
+
+void Logger::ClearSinks()
+{
+    SetSinks({});
+}
+
+void Logger::OutputMessage(LogLevel level, std::string_view message)
+{
+    Output(level, FormatLogMessage(std::chrono::system_clock::now(), m_name, level, message));
+}
+
+void Logger::Output(LogLevel level, std::string_view buffer)
+{
+    // A snapshot: the list can be swapped by other threads in the meantime, but stays alive until returned.
+    const std::shared_ptr<const LogSinkList> sinks = GetSinks();
+    const bool flush = (level >= GetFlushLevel());
+    for (const Ref<LogSink>& sink : *sinks)
     {
-        g_logFile.write(buffer.data(), buffer.size());
+        if (sink->ShouldLog(level))
+        {
+            sink->Write(level, buffer);
+            if (flush)
+            {
+                sink->Flush();
+            }
+        }
     }
-
-    if (level >= m_flushLevel)
+    if (level >= LogLevel::Critical)
     {
-        Flush();
+        DumpLogFlightRecorder();
     }
 }
 
 void Logger::Flush()
 {
-    fflush(stdout);
-    g_logFile.flush();
+    const std::shared_ptr<const LogSinkList> sinks = GetSinks();
+    for (const Ref<LogSink>& sink : *sinks)
+    {
+        sink->Flush();
+    }
 }
 
 Logger g_logGlobal = Logger("Global");
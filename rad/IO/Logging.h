@@ -3,7 +3,28 @@
 #include "rad/Core/Global.h"
 #include "rad/Core/String.h"
 #include "rad/Core/Time.h"
+#include "rad/Core/RefCounted.h"
+#include "LogFlightRecorder.h"
+#include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef RAD_LOG_SITE_BURST
+#define RAD_LOG_SITE_BURST 100
+#endif
+#ifndef RAD_LOG_SITE_RATE
+#define RAD_LOG_SITE_RATE 50
+#endif
+#ifndef RAD_LOG_SITE_REPEAT_REPORT_INTERVAL
+#define RAD_LOG_SITE_REPEAT_REPORT_INTERVAL 1000
+#endif
+// The messages at or above this level are never rate limited or deduplicated
+// (Critical triggers the flight recorder dump, which must not be dropped).
+#ifndef RAD_LOG_SITE_EXEMPT_LEVEL
+#define RAD_LOG_SITE_EXEMPT_LEVEL Critical
+#endif
 
 namespace rad
 {
@@ -20,55 +41,195 @@ enum class LogLevel
 
 const char* GetLogLevelString(LogLevel level);
 
+// Format as "[hh:mm:ss.mmm] loggerName: level: message\n".
+std::string FormatLogMessage(std::chrono::system_clock::time_point time,
+    std::string_view loggerName, LogLevel level, std::string_view message);
+
 // @param overwrite: if true, overwrite existing contents.
 bool SetLogFile(std::string_view fileName, bool overwrite = false);
 
+// A destination of formatted log messages (console, file, memory...).
+// Sinks can be shared by multiple loggers, each sink does its own synchronization.
+class LogSink : public RefCounted<LogSink>
+{
+public:
+    LogSink() {}
+    virtual ~LogSink() {}
+
+    // Messages below this level are ignored by the sink.
+    void SetLevel(LogLevel level) { m_level.store(level, std::memory_order_relaxed); }
+    LogLevel GetLevel() const { return m_level.load(std::memory_order_relaxed); }
+    bool ShouldLog(LogLevel level) const { return (level >= GetLevel()); }
+
+    // @param message: a complete line including the trailing newline.
+    virtual void Write(LogLevel level, std::string_view message) = 0;
+    virtual void Flush() = 0;
+
+private:
+    std::atomic<LogLevel> m_level = LogLevel::Debug;
+
+}; // class LogSink
+
+using LogSinkList = std::vector<Ref<LogSink>>;
+
+// Shared by all loggers by default: stdout for Debug/Info, stderr for the others.
+Ref<LogSink> GetConsoleLogSink();
+// Shared by all loggers by default: the file opened by SetLogFile.
+Ref<LogSink> GetDefaultFileLogSink();
+
+// Static state of a log statement (call site), for rate limiting (token bucket)
+// and collapsing repeated messages; the fast path is lock-free.
+class LogSite
+{
+public:
+    // @param burst: max messages can be logged at once.
+    // @param ratePerSecond: the rate the bucket refills; zero to disable rate limiting.
+    // @param repeatReportInterval: the interval to report the count of repeated messages.
+    // @param exemptLevel: the messages at or above this level are always logged.
+    // constexpr: static instances are constant-initialized without guards.
+    constexpr LogSite(uint32_t burst = RAD_LOG_SITE_BURST, uint32_t ratePerSecond = RAD_LOG_SITE_RATE,
+        std::chrono::milliseconds repeatReportInterval = std::chrono::milliseconds(RAD_LOG_SITE_REPEAT_REPORT_INTERVAL),
+        LogLevel exemptLevel = LogLevel::RAD_LOG_SITE_EXEMPT_LEVEL) :
+        m_emissionInterval((ratePerSecond > 0) ? (1000000000ll / ratePerSecond) : 0),
+        m_burstTolerance((ratePerSecond > 0) ? (1000000000ll / ratePerSecond * burst) : 0),
+        m_repeatReportInterval(std::chrono::duration_cast<std::chrono::nanoseconds>(repeatReportInterval).count()),
+        m_exemptLevel(exemptLevel)
+    {
+    }
+    ~LogSite() {}
+
+    bool IsExempt(LogLevel level) const { return (level >= m_exemptLevel); }
+
+    // Return false if the message should be dropped;
+    // otherwise, the count of dropped messages since the last success is returned.
+    bool TryAcquire(uint64_t* pSuppressedCount);
+    // Return true if the message is the same as the last one (should be dropped);
+    // pRepeatCount is set if the repeat count should be reported.
+    bool Deduplicate(std::string_view message, uint64_t* pRepeatCount);
+
+private:
+    // Generic cell rate algorithm: an equivalent of token bucket with a single atomic.
+    int64_t m_emissionInterval = 0;
+    int64_t m_burstTolerance = 0;
+    std::atomic<int64_t> m_theoreticalArrivalTime = 0;
+    std::atomic<uint64_t> m_suppressedCount = 0;
+
+    int64_t m_repeatReportInterval = 0;
+    std::atomic<size_t> m_lastMessageHash = 0;
+    std::atomic<uint64_t> m_repeatCount = 0;
+    std::atomic<int64_t> m_repeatReportTime = 0;
+
+    LogLevel m_exemptLevel = LogLevel::Critical;
+
+}; // class LogSite
+
 // If not satisfied, try spdlog: https://github.com/gabime/spdlog
 class Logger
 {
 public:
+    // Output to the console and the default log file.
     Logger(std::string_view name);
+    Logger(std::string_view name, LogSinkList sinks);
     ~Logger();
 
-    void SetOutputLevel(LogLevel outputLevel) { m_outputLevel = outputLevel; }
-    void SetFlushLevel(LogLevel flushLevel) { m_outputLevel = flushLevel; }
+    const std::string& GetName() const { return m_name; }
 
-    void EnableOutputToConsole(bool enable = true) { m_enableOutputToConsole = enable; }
+    void SetOutputLevel(LogLevel outputLevel) { m_outputLevel.store(outputLevel, std::memory_order_relaxed); }
+    void SetFlushLevel(LogLevel flushLevel) { m_flushLevel.store(flushLevel, std::memory_order_relaxed); }
+    LogLevel GetOutputLevel() const { return m_outputLevel.load(std::memory_order_relaxed); }
+    LogLevel GetFlushLevel() const { return m_flushLevel.load(std::memory_order_relaxed); }
+    bool ShouldLog(LogLevel level) const { return (level >= GetOutputLevel()); }
+
+    void EnableOutputToConsole(bool enable = true);
     // Only takes effect if log file is opened (call SetLogFile first).
-    void EnableOutputToFile(bool enable = true) { m_enableOutputToFile = enable; }
+    void EnableOutputToFile(bool enable = true);
+
+    // The sink list is replaced as a whole (read-copy-update), loggers can be reconfigured
+    // at runtime while other threads are logging. A replaced list (and the sinks removed with it)
+    // is released when the last thread writing to it returns.
+    std::shared_ptr<const LogSinkList> GetSinks() const { return m_sinks.load(std::memory_order_acquire); }
+    void SetSinks(LogSinkList sinks);
+    // Do nothing if the sink is already added.
+    void AddSink(Ref<LogSink> sink);
+    void RemoveSink(const LogSink* sink);
+    void ClearSinks();
 
     // Standard format specification: https://en.cppreference.com/w/cpp/utility/format/spec
     template<typename... Args>
     void Log(LogLevel level, std::string_view format, Args&&... args)
     {
-        std::chrono::system_clock::time_point tp = std::chrono::system_clock::now();
-        long long milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
-            tp.time_since_epoch()).count() % 1000;
-        std::time_t t = std::chrono::system_clock::to_time_t(tp);
-        std::tm timeInfo = {};
-        LocalTime(&t, &timeInfo);
-        std::string message = std::vformat(
-            std::string("[{:0>2}:{:0>2}:{:0>2}.{:0>3}] {}: {}: ").append(format).append("\n"),
-            std::make_format_args(timeInfo.tm_hour, timeInfo.tm_min, timeInfo.tm_sec, milliseconds,
-                m_name, GetLogLevelString(level), args...)
-        );
-        Output(level, message);
+        if (LogFlightRecorder* recorder = GetLogFlightRecorder())
+        {
+            recorder->Record(m_name, level, format, args...);
+        }
+        if (!ShouldLog(level))
+        {
+            return;
+        }
+        OutputMessage(level, std::vformat(format, std::make_format_args(args...)));
+    }
+
+    // Rate limited and deduplicated by the call site state, except the levels the site exempts.
+    template<typename... Args>
+    void Log(LogSite& site, LogLevel level, std::string_view format, Args&&... args)
+    {
+        if (LogFlightRecorder* recorder = GetLogFlightRecorder())
+        {
+            recorder->Record(m_name, level, format, args...);
+        }
+        if (!ShouldLog(level))
+        {
+            return;
+        }
+        if (site.IsExempt(level))
+        {
+            OutputMessage(level, std::vformat(format, std::make_format_args(args...)));
+            return;
+        }
+        uint64_t suppressedCount = 0;
+        if (!site.TryAcquire(&suppressedCount))
+        {
+            return;
+        }
+        if (suppressedCount > 0)
+        {
+            OutputMessage(level, std::format("{} messages suppressed by rate limit", suppressedCount));
+        }
+        std::string message = std::vformat(format, std::make_format_args(args...));
+        uint64_t repeatCount = 0;
+        const bool isRepeated = site.Deduplicate(message, &repeatCount);
+        if (repeatCount > 0)
+        {
+            OutputMessage(level, std::format("last message repeated {} times", repeatCount));
+        }
+        if (!isRepeated)
+        {
+            OutputMessage(level, message);
+        }
     }
 
+    // Prepend time, logger name and level.
+    void OutputMessage(LogLevel level, std::string_view message);
     void Output(LogLevel level, std::string_view buffer);
     void Flush();
 
 private:
+    template<typename Update>
+    void UpdateSinks(Update&& update);
+    // Called with m_sinkUpdateMutex locked.
+    void PublishSinks(LogSinkList sinks);
+
     std::string m_name;
 #ifdef _DEBUG
-    LogLevel m_outputLevel = LogLevel::Debug;
+    std::atomic<LogLevel> m_outputLevel = LogLevel::Debug;
 #else
-    LogLevel m_outputLevel = LogLevel::Info;
+    std::atomic<LogLevel> m_outputLevel = LogLevel::Info;
 #endif
-    LogLevel m_flushLevel = LogLevel::Warn;
+    std::atomic<LogLevel> m_flushLevel = LogLevel::Warn;
 
-    bool m_enableOutputToConsole = true;
-    bool m_enableOutputToFile = true;
+    std::atomic<std::shared_ptr<const LogSinkList>> m_sinks;
+    // Serialize the updates.
+    std::mutex m_sinkUpdateMutex;
 
 }; // Logger
 
@@ -77,7 +238,8 @@ extern Logger g_logGlobal;
 } // namespace rad
 
 #ifndef RAD_NO_LOGGING
-#define LogGlobal(Level, Format, ...) rad::g_logGlobal.Log(rad::LogLevel::Level, Format, ##__VA_ARGS__)
+#define LogGlobal(Level, Format, ...) \
+    do { static rad::LogSite _logSite; rad::g_logGlobal.Log(_logSite, rad::LogLevel::Level, Format, ##__VA_ARGS__); } while (0)
 #else
 #define LogGlobal(Level, Format, ...)
 #endif
@@ -0,0 +1,275 @@
+#include "MappedFile.h"
+#include "Logging.h"
+#include <cerrno>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rad
+{
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        m_path = std::move(other.m_path);
+        m_access = other.m_access;
+        m_fileSize = std::exchange(other.m_fileSize, 0);
+#ifdef _WIN32
+        m_fileHandle = std::exchange(other.m_fileHandle, nullptr);
+        m_mappingHandle = std::exchange(other.m_mappingHandle, nullptr);
+#else
+        m_fd = std::exchange(other.m_fd, -1);
+#endif
+        m_mapBase = std::exchange(other.m_mapBase, nullptr);
+        m_mapSize = std::exchange(other.m_mapSize, 0);
+        m_data = std::exchange(other.m_data, nullptr);
+        m_offset = std::exchange(other.m_offset, 0);
+        m_size = std::exchange(other.m_size, 0);
+        m_isMapped = std::exchange(other.m_isMapped, false);
+    }
+    return *this;
+}
+
+bool MappedFile::Open(std::string_view fileName, Access access)
+{
+    Close();
+    std::string path(fileName);
+#ifdef _WIN32
+    const DWORD desiredAccess = (access == Access::ReadWrite) ?
+        (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+    HANDLE fileHandle = CreateFileW(StrU8ToWide(path).c_str(), desiredAccess,
+        FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        LogGlobal(Error, "MappedFile::Open: failed to open {}: error={}", path, GetLastError());
+        return false;
+    }
+    LARGE_INTEGER fileSize = {};
+    GetFileSizeEx(fileHandle, &fileSize);
+    m_fileHandle = fileHandle;
+    m_fileSize = static_cast<uint64_t>(fileSize.QuadPart);
+    if (m_fileSize > 0)
+    {
+        const DWORD protect = (access == Access::ReadWrite) ? PAGE_READWRITE : PAGE_READONLY;
+        m_mappingHandle = CreateFileMappingW(fileHandle, nullptr, protect, 0, 0, nullptr);
+        if (m_mappingHandle == nullptr)
+        {
+            LogGlobal(Error, "MappedFile::Open: CreateFileMapping failed for {}: error={}",
+                path, GetLastError());
+            Close();
+            return false;
+        }
+    }
+#else
+    const int flags = (access == Access::ReadWrite) ? O_RDWR : O_RDONLY;
+    int fd = ::open(path.c_str(), flags | O_CLOEXEC);
+    if (fd < 0)
+    {
+        LogGlobal(Error, "MappedFile::Open: failed to open {}: {} ({})", path, strerror(errno), errno);
+        return false;
+    }
+    struct stat status = {};
+    if (::fstat(fd, &status) != 0)
+    {
+        LogGlobal(Error, "MappedFile::Open: failed to stat {}: {} ({})", path, strerror(errno), errno);
+        ::close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_fileSize = static_cast<uint64_t>(status.st_size);
+#endif
+    m_path = std::move(path);
+    m_access = access;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    Unmap();
+#ifdef _WIN32
+    if (m_mappingHandle)
+    {
+        CloseHandle(m_mappingHandle);
+        m_mappingHandle = nullptr;
+    }
+    if (m_fileHandle)
+    {
+        CloseHandle(m_fileHandle);
+        m_fileHandle = nullptr;
+    }
+#else
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+    m_path.clear();
+    m_fileSize = 0;
+}
+
+bool MappedFile::IsOpen() const
+{
+#ifdef _WIN32
+    return (m_fileHandle != nullptr);
+#else
+    return (m_fd >= 0);
+#endif
+}
+
+bool MappedFile::Map(uint64_t offset, size_t size)
+{
+    Unmap();
+    if (!IsOpen() || (offset > m_fileSize))
+    {
+        return false;
+    }
+    if ((size == 0) || (size > m_fileSize - offset))
+    {
+        size = static_cast<size_t>(m_fileSize - offset);
+    }
+    if (size == 0)
+    {
+        m_offset = offset;
+        m_isMapped = true;
+        return true;
+    }
+
+    const uint64_t alignedOffset = offset - offset % GetAllocationGranularity();
+    const size_t mapSize = static_cast<size_t>(offset - alignedOffset) + size;
+#ifdef _WIN32
+    const DWORD desiredAccess = (m_access == Access::ReadWrite) ? FILE_MAP_WRITE : FILE_MAP_READ;
+    void* mapBase = MapViewOfFile(m_mappingHandle, desiredAccess,
+        static_cast<DWORD>(alignedOffset >> 32), static_cast<DWORD>(alignedOffset & 0xFFFFFFFF), mapSize);
+    if (mapBase == nullptr)
+    {
+        LogGlobal(Error, "MappedFile::Map(offset={}, size={}) failed for {}: error={}",
+            offset, size, m_path, GetLastError());
+        return false;
+    }
+#else
+    const int prot = (m_access == Access::ReadWrite) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* mapBase = ::mmap(nullptr, mapSize, prot, MAP_SHARED, m_fd, static_cast<off_t>(alignedOffset));
+    if (mapBase == MAP_FAILED)
+    {
+        LogGlobal(Error, "MappedFile::Map(offset={}, size={}) failed for {}: {} ({})",
+            offset, size, m_path, strerror(errno), errno);
+        return false;
+    }
+#endif
+    m_mapBase = mapBase;
+    m_mapSize = mapSize;
+    m_data = static_cast<std::byte*>(mapBase) + (offset - alignedOffset);
+    m_offset = offset;
+    m_size = size;
+    m_isMapped = true;
+    return true;
+}
+
+void MappedFile::Unmap()
+{
+    if (m_mapBase)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(m_mapBase);
+#else
+        ::munmap(m_mapBase, m_mapSize);
+#endif
+    }
+    m_mapBase = nullptr;
+    m_mapSize = 0;
+    m_data = nullptr;
+    m_offset = 0;
+    m_size = 0;
+    m_isMapped = false;
+}
+
+bool MappedFile::Advise(Advice advice)
+{
+    if (m_mapBase == nullptr)
+    {
+        return false;
+    }
+#ifdef _WIN32
+    if (advice == Advice::WillNeed)
+    {
+        WIN32_MEMORY_RANGE_ENTRY range = { m_mapBase, m_mapSize };
+        return (PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != FALSE);
+    }
+    // Windows has no equivalent of the other hints.
+    return false;
+#else
+    int posixAdvice = MADV_NORMAL;
+    switch (advice)
+    {
+    case Advice::Normal: posixAdvice = MADV_NORMAL; break;
+    case Advice::Sequential: posixAdvice = MADV_SEQUENTIAL; break;
+    case Advice::Random: posixAdvice = MADV_RANDOM; break;
+    case Advice::WillNeed: posixAdvice = MADV_WILLNEED; break;
+    case Advice::DontNeed: posixAdvice = MADV_DONTNEED; break;
+    case Advice::HugePage:
+#ifdef MADV_HUGEPAGE
+        posixAdvice = MADV_HUGEPAGE; break;
+#else
+        return false;
+#endif
+    }
+    return (::madvise(m_mapBase, m_mapSize, posixAdvice) == 0);
+#endif
+}
+
+bool MappedFile::Flush(bool async)
+{
+    if (m_mapBase == nullptr)
+    {
+        return true;
+    }
+#ifdef _WIN32
+    if (!FlushViewOfFile(m_mapBase, m_mapSize))
+    {
+        return false;
+    }
+    return async ? true : (FlushFileBuffers(m_fileHandle) != FALSE);
+#else
+    return (::msync(m_mapBase, m_mapSize, async ? MS_ASYNC : MS_SYNC) == 0);
+#endif
+}
+
+size_t MappedFile::GetAllocationGranularity()
+{
+#ifdef _WIN32
+    static const size_t s_granularity = []() {
+        SYSTEM_INFO info = {};
+        GetSystemInfo(&info);
+        return static_cast<size_t>(info.dwAllocationGranularity);
+    }();
+#else
+    static const size_t s_granularity = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+    return s_granularity;
+}
+
+} // namespace rad
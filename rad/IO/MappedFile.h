@@ -0,0 +1,92 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+#include "rad/Container/Span.h"
+#include <cstddef>
+
+namespace rad
+{
+
+// Map a file (or a window of it) into the address space, read the contents without copying.
+class MappedFile
+{
+public:
+    enum class Access
+    {
+        ReadOnly,
+        ReadWrite,
+    };
+
+    // Hints on how the mapping will be accessed (madvise on POSIX).
+    enum class Advice
+    {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+        DontNeed,
+        HugePage,
+    };
+
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(std::string_view fileName, Access access = Access::ReadOnly);
+    void Close();
+    bool IsOpen() const;
+
+    const std::string& GetPath() const { return m_path; }
+    Access GetAccess() const { return m_access; }
+    uint64_t GetFileSize() const { return m_fileSize; }
+
+    // Map the window [offset, offset + size) of the file, map to the end of the file if size is 0;
+    // offset needs not be aligned. The previous mapping (if any) is unmapped.
+    bool Map(uint64_t offset = 0, size_t size = 0);
+    void Unmap();
+    bool IsMapped() const { return m_isMapped; }
+
+    uint64_t GetOffset() const { return m_offset; }
+    size_t GetSize() const { return m_size; }
+    const std::byte* GetData() const { return m_data; }
+    // Only valid for Access::ReadWrite.
+    std::byte* GetMutableData() { return (m_access == Access::ReadWrite) ? m_data : nullptr; }
+    Span<const std::byte> GetView() const { return Span<const std::byte>(m_data, m_size); }
+    std::string_view GetString() const { return std::string_view(reinterpret_cast<const char*>(m_data), m_size); }
+
+    // Take effect on the current mapping; return false if not supported.
+    bool Advise(Advice advice);
+    // Write the modified pages back to the file.
+    bool Flush(bool async = false);
+
+    // The granularity the mapping offsets must align to.
+    static size_t GetAllocationGranularity();
+
+private:
+    std::string m_path;
+    Access m_access = Access::ReadOnly;
+    uint64_t m_fileSize = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mappingHandle = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    // The aligned mapping returned by the OS.
+    void* m_mapBase = nullptr;
+    size_t m_mapSize = 0;
+    // The window requested.
+    std::byte* m_data = nullptr;
+    uint64_t m_offset = 0;
+    size_t m_size = 0;
+    // Empty windows are mapped without m_mapBase.
+    bool m_isMapped = false;
+
+}; // class MappedFile
+
+} // namespace rad
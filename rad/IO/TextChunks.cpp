@@ -0,0 +1,29 @@
+#include "TextChunks.h"
+#include <algorithm>
+
+namespace rad
+{
+
+std::vector<std::string_view> SplitTextChunks(std::string_view text, size_t chunkSize)
+{
+    std::vector<std::string_view> chunks;
+    chunkSize = std::max<size_t>(chunkSize, 1);
+    chunks.reserve(text.size() / chunkSize + 1);
+    size_t begin = 0;
+    while (begin < text.size())
+    {
+        if (text.size() - begin <= chunkSize)
+        {
+            chunks.push_back(text.substr(begin));
+            break;
+        }
+        // Extend the chunk to the end of the line.
+        size_t end = text.find('\n', begin + chunkSize - 1);
+        end = (end == std::string_view::npos) ? text.size() : (end + 1);
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+} // namespace rad
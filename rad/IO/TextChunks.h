@@ -0,0 +1,199 @@
+#pragma once
+
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+#include "rad/Core/ThreadPool.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <type_traits>
+
+namespace rad
+{
+
+// Split text into chunks of about chunkSize bytes, each chunk ends after a newline
+// (except the last one), so that no line is split across chunks.
+std::vector<std::string_view> SplitTextChunks(std::string_view text, size_t chunkSize);
+
+// Invoke func(std::string_view line) for each line in the chunk, "\r\n" is handled.
+template<typename Func>
+void ForEachLine(std::string_view chunk, Func&& func)
+{
+    const char* p = chunk.data();
+    const char* end = chunk.data() + chunk.size();
+    while (p < end)
+    {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* lineEnd = newline ? newline : end;
+        std::string_view line(p, lineEnd - p);
+        if (!line.empty() && (line.back() == '\r'))
+        {
+            line.remove_suffix(1);
+        }
+        func(line);
+        p = newline ? (newline + 1) : end;
+    }
+}
+
+struct TextChunkOptions
+{
+    size_t chunkSize = 4 * 1024 * 1024;
+    // Use a temporary pool of threadCount threads (0 for hardware concurrency) if threadPool is null.
+    ThreadPool* threadPool = nullptr;
+    uint32_t threadCount = 0;
+    // Reduce in chunk order; otherwise, reduce in completion order.
+    bool ordered = true;
+};
+
+// Run map(std::string_view chunk, size_t chunkIndex) -> Result on the thread pool, and
+// reduce(Result&& result, size_t chunkIndex) on the calling thread.
+// The first exception thrown by map or reduce is rethrown after all chunks are done,
+// and no chunk is reduced after it.
+template<typename Map, typename Reduce>
+void ProcessTextChunks(std::string_view text, Map&& map, Reduce&& reduce,
+    const TextChunkOptions& options = {})
+{
+    using Result = std::invoke_result_t<Map&, std::string_view, size_t>;
+    std::vector<std::string_view> chunks = SplitTextChunks(text, options.chunkSize);
+    if (chunks.empty())
+    {
+        return;
+    }
+
+    std::optional<ThreadPool> localThreadPool;
+    ThreadPool* threadPool = options.threadPool;
+    if (threadPool == nullptr)
+    {
+        threadPool = &localThreadPool.emplace(options.threadCount);
+    }
+
+    if (options.ordered)
+    {
+        std::vector<std::future<Result>> futures;
+        futures.reserve(chunks.size());
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            futures.push_back(threadPool->Submit([&map, chunk = chunks[i], i]() { return map(chunk, i); }));
+        }
+        std::exception_ptr exception;
+        for (size_t i = 0; i < futures.size(); ++i)
+        {
+            try
+            {
+                Result result = futures[i].get();
+                if (!exception)
+                {
+                    reduce(std::move(result), i);
+                }
+            }
+            catch (...)
+            {
+                if (!exception)
+                {
+                    exception = std::current_exception();
+                }
+            }
+        }
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+    else
+    {
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::vector<std::pair<std::optional<Result>, size_t>> completed;
+        std::exception_ptr exception;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            threadPool->Enqueue([&, chunk = chunks[i], i]() {
+                std::optional<Result> result;
+                std::exception_ptr taskException;
+                try
+                {
+                    result.emplace(map(chunk, i));
+                }
+                catch (...)
+                {
+                    taskException = std::current_exception();
+                }
+                {
+                    std::lock_guard lockGuard(mutex);
+                    if (taskException && !exception)
+                    {
+                        exception = taskException;
+                    }
+                    completed.emplace_back(std::move(result), i);
+                    // Notify under the lock: the caller may return and destroy cond once it sees the result.
+                    cond.notify_one();
+                }
+                });
+        }
+        size_t reducedCount = 0;
+        std::vector<std::pair<std::optional<Result>, size_t>> batch;
+        bool hasException = false;
+        while (reducedCount < chunks.size())
+        {
+            {
+                std::unique_lock lock(mutex);
+                cond.wait(lock, [&]() { return !completed.empty(); });
+                batch.swap(completed);
+                hasException = (exception != nullptr);
+            }
+            for (auto& [result, index] : batch)
+            {
+                if (result && !hasException)
+                {
+                    try
+                    {
+                        reduce(std::move(*result), index);
+                    }
+                    catch (...)
+                    {
+                        // Keep waiting for the chunks in flight: the workers use the locals.
+                        std::lock_guard lockGuard(mutex);
+                        if (!exception)
+                        {
+                            exception = std::current_exception();
+                        }
+                        hasException = true;
+                    }
+                }
+            }
+            reducedCount += batch.size();
+            batch.clear();
+        }
+        // Wait for the last worker to release the lock before the locals are destroyed.
+        std::lock_guard lockGuard(mutex);
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+template<typename Map, typename Reduce>
+void ProcessTextChunks(const MappedFile& file, Map&& map, Reduce&& reduce,
+    const TextChunkOptions& options = {})
+{
+    ProcessTextChunks(file.GetString(), std::forward<Map>(map), std::forward<Reduce>(reduce), options);
+}
+
+// Map the file and process it in parallel chunks; return false if the file cannot be mapped.
+template<typename Map, typename Reduce>
+bool ProcessFileChunks(std::string_view fileName, Map&& map, Reduce&& reduce,
+    const TextChunkOptions& options = {})
+{
+    MappedFile file;
+    if (!file.Open(fileName) || !file.Map())
+    {
+        return false;
+    }
+    file.Advise(MappedFile::Advice::Sequential);
+    ProcessTextChunks(file, std::forward<Map>(map), std::forward<Reduce>(reduce), options);
+    return true;
+}
+
+} // namespace rad
@@ -0,0 +1,462 @@
+#include "DirectorySnapshot.h"
+#include "FileHash.h"
+#include "FileMetadata.h"
+#include "rad/Core/ThreadPool.h"
+#include "rad/IO/File.h"
+#include "rad/IO/Logging.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+
+namespace rad
+{
+
+namespace
+{
+
+constexpr char SnapshotMagic[8] = { 'R', 'A', 'D', 'D', 'S', 'N', 'A', 'P' };
+// 2: the hashes and the checksum are XXH3 (HashBytes64, the low half of HashBytes128 for the files).
+// 3: the capture time in the header.
+constexpr uint32_t SnapshotVersion = 3;
+constexpr uint32_t SnapshotFlagHasHashes = 0x1;
+
+// The type codes in the file, independent of the values of std::filesystem::file_type.
+constexpr FileType SnapshotFileTypes[] =
+{
+    FileType::unknown,
+    FileType::regular,
+    FileType::directory,
+    FileType::symlink,
+    FileType::block,
+    FileType::character,
+    FileType::fifo,
+    FileType::socket,
+};
+
+uint8_t EncodeFileType(FileType type)
+{
+    for (size_t i = 0; i < std::size(SnapshotFileTypes); ++i)
+    {
+        if (SnapshotFileTypes[i] == type)
+        {
+            return static_cast<uint8_t>(i);
+        }
+    }
+    return 0;
+}
+
+uint64_t ReadU64(const uint8_t* p)
+{
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i)
+    {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+uint32_t ReadU32(const uint8_t* p)
+{
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+        (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void WriteU32(std::string& buffer, uint32_t value)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        buffer.push_back(static_cast<char>(value >> (i * 8)));
+    }
+}
+
+void WriteU64(std::string& buffer, uint64_t value)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        buffer.push_back(static_cast<char>(value >> (i * 8)));
+    }
+}
+
+void WriteVarint(std::string& buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<char>(value));
+}
+
+// Read the values with bounds checks; fail once any read is out of bounds.
+class SnapshotReader
+{
+public:
+    SnapshotReader(const uint8_t* data, size_t size) :
+        m_data(data),
+        m_end(data + size)
+    {
+    }
+
+    bool IsOk() const { return m_isOk; }
+    bool IsEnd() const { return m_data == m_end; }
+
+    uint64_t ReadVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (m_data >= m_end)
+            {
+                break;
+            }
+            const uint8_t byte = *m_data++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+        m_isOk = false;
+        return 0;
+    }
+
+    const uint8_t* ReadBytes(size_t size)
+    {
+        if (static_cast<size_t>(m_end - m_data) < size)
+        {
+            m_isOk = false;
+            return nullptr;
+        }
+        const uint8_t* p = m_data;
+        m_data += size;
+        return p;
+    }
+
+    uint8_t ReadU8()
+    {
+        const uint8_t* p = ReadBytes(1);
+        return p ? *p : 0;
+    }
+
+    uint64_t ReadU64()
+    {
+        const uint8_t* p = ReadBytes(8);
+        return p ? rad::ReadU64(p) : 0;
+    }
+
+private:
+    const uint8_t* m_data;
+    const uint8_t* m_end;
+    bool m_isOk = true;
+
+}; // class SnapshotReader
+
+} // namespace
+
+DirectorySnapshot::DirectorySnapshot()
+{
+}
+
+DirectorySnapshot::~DirectorySnapshot()
+{
+}
+
+bool DirectorySnapshot::Capture(const FilePath& root, const Options& options)
+{
+    Clear();
+    // Before walking: the files changed during the capture are newer.
+    m_captureTimeNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    DirectoryWalkOptions walkOptions;
+    walkOptions.threadCount = options.threadCount;
+    walkOptions.followSymlinks = options.followSymlinks;
+    walkOptions.filter = options.filter;
+    std::mutex mutex;
+    std::vector<DirectoryWalkEntry> walkEntries;
+    bool isComplete = WalkDirectoryBatched(root, [&](std::vector<DirectoryWalkEntry>& batch) {
+        std::lock_guard lock(mutex);
+        std::move(batch.begin(), batch.end(), std::back_inserter(walkEntries));
+        }, walkOptions);
+
+    std::vector<FilePath> paths;
+    paths.reserve(walkEntries.size());
+    for (const DirectoryWalkEntry& entry : walkEntries)
+    {
+        paths.emplace_back(entry.path);
+    }
+    FileMetadataOptions metadataOptions;
+    metadataOptions.threadCount = options.threadCount;
+    metadataOptions.followSymlinks = options.followSymlinks;
+    const std::vector<FileMetadata> metadata = GetFileMetadata(paths, metadataOptions);
+
+    // The walker joins the relative paths to the root with a separator.
+    std::string prefix = root.string();
+    if (!prefix.empty() && (prefix.back() != '/') && (prefix.back() != char(FilePath::preferred_separator)))
+    {
+        prefix.push_back(char(FilePath::preferred_separator));
+    }
+    m_entries.reserve(walkEntries.size());
+    for (size_t i = 0; i < walkEntries.size(); ++i)
+    {
+        // Removed since walked.
+        if (!metadata[i].Exists())
+        {
+            continue;
+        }
+        DirectorySnapshotEntry& entry = m_entries.emplace_back();
+        entry.path = walkEntries[i].path.substr(prefix.size());
+        if constexpr (FilePath::preferred_separator != '/')
+        {
+            std::replace(entry.path.begin(), entry.path.end(), char(FilePath::preferred_separator), '/');
+        }
+        entry.type = metadata[i].type;
+        entry.size = metadata[i].IsDirectory() ? 0 : metadata[i].size;
+        entry.mtimeNs = metadata[i].mtimeNs;
+        entry.inode = metadata[i].inode;
+    }
+    std::sort(m_entries.begin(), m_entries.end(),
+        [](const DirectorySnapshotEntry& lhs, const DirectorySnapshotEntry& rhs) { return lhs.path < rhs.path; });
+
+    if (options.hashContents)
+    {
+        std::atomic<bool> isHashed = true;
+        ThreadPool threadPool(options.threadCount);
+        for (DirectorySnapshotEntry& entry : m_entries)
+        {
+            if (entry.type != FileType::regular)
+            {
+                continue;
+            }
+            if (options.baseline)
+            {
+                // A file modified within the mtime granularity of the baseline capture may have
+                // the same size and mtime but different contents (racy mtime): hash it again.
+                const DirectorySnapshotEntry* old = options.baseline->Find(entry.path);
+                const uint64_t baselineTimeNs = options.baseline->GetCaptureTimeNs();
+                if (old && (old->hash != 0) && (old->type == entry.type) &&
+                    (old->size == entry.size) && (old->mtimeNs == entry.mtimeNs) &&
+                    (baselineTimeNs > MtimeGranularityNs) && (entry.mtimeNs < baselineTimeNs - MtimeGranularityNs))
+                {
+                    entry.hash = old->hash;
+                    continue;
+                }
+            }
+            threadPool.Enqueue([&, path = prefix + entry.path]() {
+                FileHashResult result;
+                if (HashFile(path, &result))
+                {
+                    entry.hash = result.hash.low;
+                }
+                else
+                {
+                    LogGlobal(Warn, "DirectorySnapshot::Capture: failed to hash {}", path);
+                    isHashed = false;
+                }
+                });
+        }
+        threadPool.WaitIdle();
+        isComplete = isComplete && isHashed;
+        m_hasHashes = true;
+    }
+    return isComplete;
+}
+
+bool DirectorySnapshot::Save(std::string_view fileName) const
+{
+    std::string buffer;
+    buffer.reserve(32 + m_entries.size() * 32);
+    buffer.append(SnapshotMagic, sizeof(SnapshotMagic));
+    WriteU32(buffer, SnapshotVersion);
+    WriteU32(buffer, m_hasHashes ? SnapshotFlagHasHashes : 0);
+    WriteU64(buffer, m_entries.size());
+    WriteU64(buffer, m_captureTimeNs);
+    std::string_view prevPath;
+    for (const DirectorySnapshotEntry& entry : m_entries)
+    {
+        // Front coding: the length of the prefix shared with the previous path, and the rest.
+        const size_t sharedSize = std::mismatch(prevPath.begin(), prevPath.end(),
+            entry.path.begin(), entry.path.end()).first - prevPath.begin();
+        WriteVarint(buffer, sharedSize);
+        WriteVarint(buffer, entry.path.size() - sharedSize);
+        buffer.append(entry.path, sharedSize);
+        buffer.push_back(static_cast<char>(EncodeFileType(entry.type)));
+        WriteVarint(buffer, entry.size);
+        WriteVarint(buffer, entry.mtimeNs);
+        WriteVarint(buffer, entry.inode);
+        if (m_hasHashes)
+        {
+            WriteU64(buffer, entry.hash);
+        }
+        prevPath = entry.path;
+    }
+    WriteU64(buffer, HashBytes64(buffer.data(), buffer.size()));
+
+    const std::string tempFileName = std::string(fileName) + ".tmp";
+    File file;
+    if (!file.Open(tempFileName, "wb"))
+    {
+        LogGlobal(Error, "DirectorySnapshot::Save: failed to open {}", tempFileName);
+        return false;
+    }
+    const bool isWritten = (file.Write(buffer.data(), buffer.size()) == 1);
+    file.Close();
+    if (!isWritten)
+    {
+        LogGlobal(Error, "DirectorySnapshot::Save: failed to write {}", tempFileName);
+        Remove(tempFileName);
+        return false;
+    }
+    try
+    {
+        Rename(tempFileName, FilePath(fileName));
+    }
+    catch (const FileSystemError& e)
+    {
+        LogGlobal(Error, "DirectorySnapshot::Save: {}", e.what());
+        return false;
+    }
+    return true;
+}
+
+bool DirectorySnapshot::Load(std::string_view fileName)
+{
+    Clear();
+    const std::string buffer = File::ReadAll(fileName);
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(buffer.data());
+    constexpr size_t HeaderSize = sizeof(SnapshotMagic) + 4 + 4 + 8 + 8;
+    if ((buffer.size() < HeaderSize + 8) ||
+        (std::memcmp(data, SnapshotMagic, sizeof(SnapshotMagic)) != 0))
+    {
+        LogGlobal(Error, "DirectorySnapshot::Load: {} is not a snapshot.", fileName);
+        return false;
+    }
+    const size_t payloadSize = buffer.size() - 8;
+    if (HashBytes64(data, payloadSize) != ReadU64(data + payloadSize))
+    {
+        LogGlobal(Error, "DirectorySnapshot::Load: {} is corrupted (checksum mismatch).", fileName);
+        return false;
+    }
+    const uint32_t version = ReadU32(data + 8);
+    if (version != SnapshotVersion)
+    {
+        LogGlobal(Error, "DirectorySnapshot::Load: {} has unsupported version {}.", fileName, version);
+        return false;
+    }
+    const bool hasHashes = (ReadU32(data + 12) & SnapshotFlagHasHashes) != 0;
+    const uint64_t entryCount = ReadU64(data + 16);
+    const uint64_t captureTimeNs = ReadU64(data + 24);
+
+    SnapshotReader reader(data + HeaderSize, payloadSize - HeaderSize);
+    std::vector<DirectorySnapshotEntry> entries;
+    // Each entry takes at least 6 bytes, don't trust the count for the allocation.
+    entries.reserve(std::min<uint64_t>(entryCount, (payloadSize - HeaderSize) / 6));
+    for (uint64_t i = 0; (i < entryCount) && reader.IsOk(); ++i)
+    {
+        DirectorySnapshotEntry entry;
+        const uint64_t sharedSize = reader.ReadVarint();
+        const uint64_t suffixSize = reader.ReadVarint();
+        const uint8_t* suffix = reader.ReadBytes(suffixSize);
+        const std::string_view prevPath = entries.empty() ? std::string_view() : std::string_view(entries.back().path);
+        if (!suffix || (sharedSize > prevPath.size()))
+        {
+            break;
+        }
+        entry.path.reserve(sharedSize + suffixSize);
+        entry.path.append(prevPath.substr(0, sharedSize));
+        entry.path.append(reinterpret_cast<const char*>(suffix), suffixSize);
+        const uint8_t type = reader.ReadU8();
+        entry.type = (type < std::size(SnapshotFileTypes)) ? SnapshotFileTypes[type] : FileType::unknown;
+        entry.size = reader.ReadVarint();
+        entry.mtimeNs = reader.ReadVarint();
+        entry.inode = reader.ReadVarint();
+        if (hasHashes)
+        {
+            entry.hash = reader.ReadU64();
+        }
+        // The paths must be sorted for Find and DiffSnapshots.
+        if (!entries.empty() && (entry.path <= entries.back().path))
+        {
+            break;
+        }
+        entries.push_back(std::move(entry));
+    }
+    if (!reader.IsOk() || !reader.IsEnd() || (entries.size() != entryCount))
+    {
+        LogGlobal(Error, "DirectorySnapshot::Load: {} is malformed.", fileName);
+        return false;
+    }
+    m_entries = std::move(entries);
+    m_hasHashes = hasHashes;
+    m_captureTimeNs = captureTimeNs;
+    return true;
+}
+
+const DirectorySnapshotEntry* DirectorySnapshot::Find(std::string_view path) const
+{
+    auto iter = std::lower_bound(m_entries.begin(), m_entries.end(), path,
+        [](const DirectorySnapshotEntry& entry, std::string_view path) { return entry.path < path; });
+    if ((iter != m_entries.end()) && (iter->path == path))
+    {
+        return &(*iter);
+    }
+    return nullptr;
+}
+
+void DirectorySnapshot::Clear()
+{
+    m_entries.clear();
+    m_hasHashes = false;
+    m_captureTimeNs = 0;
+}
+
+DirectoryDiff DiffSnapshots(const DirectorySnapshot& oldSnapshot, const DirectorySnapshot& newSnapshot)
+{
+    DirectoryDiff diff;
+    const std::vector<DirectorySnapshotEntry>& oldEntries = oldSnapshot.GetEntries();
+    const std::vector<DirectorySnapshotEntry>& newEntries = newSnapshot.GetEntries();
+    size_t i = 0;
+    size_t j = 0;
+    while ((i < oldEntries.size()) || (j < newEntries.size()))
+    {
+        if ((j == newEntries.size()) || ((i < oldEntries.size()) && (oldEntries[i].path < newEntries[j].path)))
+        {
+            diff.removed.push_back(oldEntries[i++].path);
+        }
+        else if ((i == oldEntries.size()) || (newEntries[j].path < oldEntries[i].path))
+        {
+            diff.added.push_back(newEntries[j++].path);
+        }
+        else
+        {
+            const DirectorySnapshotEntry& oldEntry = oldEntries[i++];
+            const DirectorySnapshotEntry& newEntry = newEntries[j++];
+            bool isModified = false;
+            if (oldEntry.type != newEntry.type)
+            {
+                isModified = true;
+            }
+            else if (newEntry.type == FileType::directory)
+            {
+                isModified = false;
+            }
+            else if ((oldEntry.hash != 0) && (newEntry.hash != 0))
+            {
+                isModified = (oldEntry.hash != newEntry.hash) || (oldEntry.size != newEntry.size);
+            }
+            else
+            {
+                isModified = (oldEntry.size != newEntry.size) || (oldEntry.mtimeNs != newEntry.mtimeNs);
+            }
+            if (isModified)
+            {
+                diff.modified.push_back(newEntry.path);
+            }
+        }
+    }
+    return diff;
+}
+
+} // namespace rad
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "DirectoryWalker.h"
+
+namespace rad
+{
+
+struct DirectorySnapshotEntry
+{
+    // Relative to the root, separated by '/'.
+    std::string path;
+    FileType type = FileType::unknown;
+    uint64_t size = 0;
+    uint64_t mtimeNs = 0;
+    uint64_t inode = 0;
+    // The content hash of regular files, 0 if not computed.
+    uint64_t hash = 0;
+};
+
+// The files of a directory tree at some point, to find what changed since:
+// captured with WalkDirectory and GetFileMetadata in parallel, sorted by path,
+// and saved in a compact binary format (front-coded paths and varints, with a checksum).
+class DirectorySnapshot
+{
+public:
+    struct Options
+    {
+        // Use the hardware concurrency if 0.
+        uint32_t threadCount = 0;
+        bool followSymlinks = false;
+        // Hash the contents of regular files, so that a file touched without being changed
+        // is not reported as modified.
+        bool hashContents = false;
+        // Reuse the hashes of the files whose size and mtime have not changed in this snapshot
+        // (usually the previous one), instead of reading them again; except the files modified
+        // shortly before it was captured (within the mtime granularity).
+        const DirectorySnapshot* baseline = nullptr;
+        // Skip the entries (and the subtrees) the filter returns false for.
+        std::function<bool(const DirectoryWalkEntry& entry)> filter;
+    };
+
+    DirectorySnapshot();
+    ~DirectorySnapshot();
+
+    DirectorySnapshot(const DirectorySnapshot&) = default;
+    DirectorySnapshot& operator=(const DirectorySnapshot&) = default;
+    DirectorySnapshot(DirectorySnapshot&&) noexcept = default;
+    DirectorySnapshot& operator=(DirectorySnapshot&&) noexcept = default;
+
+    // Replace the entries with the tree of root; return false if any part of it cannot be read
+    // (the entries captured are kept).
+    bool Capture(const FilePath& root, const Options& options);
+    bool Capture(const FilePath& root) { return Capture(root, Options()); }
+
+    // Write to a temporary file renamed over fileName, so that a crash never leaves a partial snapshot.
+    bool Save(std::string_view fileName) const;
+    // Return false (and leave the snapshot empty) if the file is missing, truncated or corrupted.
+    bool Load(std::string_view fileName);
+
+    const std::vector<DirectorySnapshotEntry>& GetEntries() const { return m_entries; }
+    // Binary search by the relative path; nullptr if not found.
+    const DirectorySnapshotEntry* Find(std::string_view path) const;
+    bool HasHashes() const { return m_hasHashes; }
+    // When Capture started, in nanoseconds since the Unix epoch like the mtimes; 0 if not captured.
+    uint64_t GetCaptureTimeNs() const { return m_captureTimeNs; }
+    void Clear();
+
+private:
+    std::vector<DirectorySnapshotEntry> m_entries;
+    bool m_hasHashes = false;
+    uint64_t m_captureTimeNs = 0;
+
+}; // class DirectorySnapshot
+
+struct DirectoryDiff
+{
+    // Relative paths, sorted.
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    // Changed type, size or mtime; if both snapshots have the hash of a file, only a changed hash counts.
+    // The mtimes of directories are ignored (they change with their children).
+    std::vector<std::string> modified;
+
+    bool IsEmpty() const { return added.empty() && removed.empty() && modified.empty(); }
+};
+
+// Merge the sorted entries in linear time.
+DirectoryDiff DiffSnapshots(const DirectorySnapshot& oldSnapshot, const DirectorySnapshot& newSnapshot);
+
+} // namespace rad
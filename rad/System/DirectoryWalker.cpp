@@ -0,0 +1,541 @@
+#include "DirectoryWalker.h"
+#include "rad/Core/ThreadPool.h"
+#include "rad/IO/Logging.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+namespace rad
+{
+
+namespace
+{
+
+#ifndef _WIN32
+// Kept open while the subdirectories are queued, which are opened relative to it.
+struct DirectoryHandle
+{
+    int fd = -1;
+
+    explicit DirectoryHandle(int fd) : fd(fd) {}
+    ~DirectoryHandle() { close(fd); }
+    DirectoryHandle(const DirectoryHandle&) = delete;
+    DirectoryHandle& operator=(const DirectoryHandle&) = delete;
+};
+#endif
+
+struct WalkTask
+{
+    // Relative to the root, empty for the root itself.
+    std::string relativePath;
+    // The directory name starts at relativePath[nameOffset].
+    uint32_t nameOffset = 0;
+    // The depth of the entries in the directory.
+    uint32_t depth = 0;
+#ifndef _WIN32
+    // The parent directory, null for the root: no path resolution from the root (deep trees, renames).
+    std::shared_ptr<const DirectoryHandle> parent;
+#endif
+};
+
+#ifndef _WIN32
+FileType GetFileTypeFromDirent(unsigned char type)
+{
+    switch (type)
+    {
+    case DT_REG: return FileType::regular;
+    case DT_DIR: return FileType::directory;
+    case DT_LNK: return FileType::symlink;
+    case DT_BLK: return FileType::block;
+    case DT_CHR: return FileType::character;
+    case DT_FIFO: return FileType::fifo;
+    case DT_SOCK: return FileType::socket;
+    default: return FileType::unknown;
+    }
+}
+#endif
+
+class DirectoryWalker
+{
+public:
+    using Callback = std::function<void(const DirectoryWalkEntry& entry)>;
+    using BatchCallback = std::function<void(std::vector<DirectoryWalkEntry>& batch)>;
+
+    DirectoryWalker(const FilePath& root, const DirectoryWalkOptions& options,
+        const Callback* callback, const BatchCallback* batchCallback);
+    ~DirectoryWalker();
+
+    bool Run();
+
+private:
+    struct Worker
+    {
+        // Guards the tasks only, the others are owned by the worker thread.
+        std::mutex mutex;
+        std::deque<WalkTask> tasks;
+        std::vector<DirectoryWalkEntry> batch;
+        std::vector<char> buffer;
+#ifndef _WIN32
+        // The directory being read, the parent of the subtasks queued.
+        std::shared_ptr<const DirectoryHandle> directory;
+#endif
+    };
+
+    void WorkerMain(uint32_t index);
+    // Take the newest task of the worker, or steal the oldest of another.
+    bool PopTask(uint32_t index, WalkTask& task);
+    void PushTask(Worker& worker, WalkTask&& task);
+    void ReadDirectory(Worker& worker, const WalkTask& task);
+    // Filter, report and queue the subdirectory.
+    void AddEntry(Worker& worker, const WalkTask& task, DirectoryWalkEntry&& entry);
+    void FlushBatch(Worker& worker);
+    // Return false if the directory is already visited (following symlinks).
+    bool VisitOnce(uint64_t device, uint64_t inode);
+    void SetException(std::exception_ptr exception);
+
+    std::string m_rootPath;
+    // m_rootPath with a trailing separator.
+    std::string m_prefix;
+    DirectoryWalkOptions m_options;
+    const Callback* m_callback;
+    const BatchCallback* m_batchCallback;
+#ifndef _WIN32
+    int m_rootFd = -1;
+#endif
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    // The directories queued or being read; the walk is done when it drops to zero.
+    std::atomic<size_t> m_pendingCount = 0;
+    std::atomic<size_t> m_queuedCount = 0;
+    std::atomic<uint32_t> m_sleepingCount = 0;
+    std::mutex m_idleMutex;
+    std::condition_variable m_idleCond;
+
+    std::atomic<bool> m_hasError = false;
+    std::atomic<bool> m_stop = false;
+    std::mutex m_exceptionMutex;
+    std::exception_ptr m_exception;
+    std::mutex m_visitedMutex;
+    std::set<std::pair<uint64_t, uint64_t>> m_visited;
+
+}; // class DirectoryWalker
+
+DirectoryWalker::DirectoryWalker(const FilePath& root, const DirectoryWalkOptions& options,
+    const Callback* callback, const BatchCallback* batchCallback) :
+    m_rootPath(root.string()),
+    m_options(options),
+    m_callback(callback),
+    m_batchCallback(batchCallback)
+{
+    m_prefix = m_rootPath;
+    if (!m_prefix.empty() && (m_prefix.back() != '/') && (m_prefix.back() != char(FilePath::preferred_separator)))
+    {
+        m_prefix.push_back(char(FilePath::preferred_separator));
+    }
+    m_options.batchSize = std::max<size_t>(m_options.batchSize, 1);
+    m_workers.resize(ResolveThreadCount(m_options.threadCount));
+    for (std::unique_ptr<Worker>& worker : m_workers)
+    {
+        worker = std::make_unique<Worker>();
+    }
+}
+
+DirectoryWalker::~DirectoryWalker()
+{
+#ifndef _WIN32
+    if (m_rootFd >= 0)
+    {
+        close(m_rootFd);
+    }
+#endif
+}
+
+bool DirectoryWalker::Run()
+{
+#ifndef _WIN32
+    m_rootFd = open(m_rootPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (m_rootFd < 0)
+    {
+        LogGlobal(Error, "WalkDirectory: failed to open {}: {} ({})", m_rootPath, strerror(errno), errno);
+        return false;
+    }
+#else
+    if (!IsDirectory(m_rootPath))
+    {
+        LogGlobal(Error, "WalkDirectory: {} is not a directory.", m_rootPath);
+        return false;
+    }
+#endif
+
+    PushTask(*m_workers[0], WalkTask{});
+    RunOnThreads(static_cast<uint32_t>(m_workers.size()), [this](uint32_t threadIndex) { WorkerMain(threadIndex); });
+
+    if (m_exception)
+    {
+        std::rethrow_exception(m_exception);
+    }
+    return !m_hasError;
+}
+
+void DirectoryWalker::WorkerMain(uint32_t index)
+{
+    Worker& worker = *m_workers[index];
+    WalkTask task;
+    while (true)
+    {
+        if (PopTask(index, task))
+        {
+            if (!m_stop)
+            {
+                try
+                {
+                    ReadDirectory(worker, task);
+                }
+                catch (...)
+                {
+                    SetException(std::current_exception());
+                }
+            }
+            // The subdirectories are queued before, so it drops to zero only at the end.
+            if (m_pendingCount.fetch_sub(1) == 1)
+            {
+                std::lock_guard lock(m_idleMutex);
+                m_idleCond.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock lock(m_idleMutex);
+        ++m_sleepingCount;
+        m_idleCond.wait(lock, [this]() { return (m_queuedCount > 0) || (m_pendingCount == 0); });
+        --m_sleepingCount;
+        if (m_pendingCount == 0)
+        {
+            break;
+        }
+    }
+
+    if (!worker.batch.empty() && !m_stop)
+    {
+        try
+        {
+            FlushBatch(worker);
+        }
+        catch (...)
+        {
+            SetException(std::current_exception());
+        }
+    }
+}
+
+bool DirectoryWalker::PopTask(uint32_t index, WalkTask& task)
+{
+    {
+        Worker& worker = *m_workers[index];
+        std::lock_guard lock(worker.mutex);
+        if (!worker.tasks.empty())
+        {
+            // Depth first on the own subtree, while the directory entries are hot in cache.
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            --m_queuedCount;
+            return true;
+        }
+    }
+    const uint32_t workerCount = static_cast<uint32_t>(m_workers.size());
+    for (uint32_t i = 1; i < workerCount; ++i)
+    {
+        Worker& victim = *m_workers[(index + i) % workerCount];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty())
+        {
+            // The oldest is the closest to the root, likely the largest subtree.
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --m_queuedCount;
+            return true;
+        }
+    }
+    return false;
+}
+
+void DirectoryWalker::PushTask(Worker& worker, WalkTask&& task)
+{
+    ++m_pendingCount;
+    {
+        std::lock_guard lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    ++m_queuedCount;
+    if (m_sleepingCount > 0)
+    {
+        std::lock_guard lock(m_idleMutex);
+        m_idleCond.notify_one();
+    }
+}
+
+void DirectoryWalker::AddEntry(Worker& worker, const WalkTask& task, DirectoryWalkEntry&& entry)
+{
+    if (m_options.filter && !m_options.filter(entry))
+    {
+        return;
+    }
+    const bool isDirectory = (entry.type == FileType::directory);
+    if (isDirectory && (task.depth < m_options.maxDepth))
+    {
+        WalkTask subtask;
+        subtask.relativePath = entry.path.substr(m_prefix.size());
+        subtask.nameOffset = entry.nameOffset - static_cast<uint32_t>(m_prefix.size());
+        subtask.depth = task.depth + 1;
+#ifndef _WIN32
+        subtask.parent = worker.directory;
+#endif
+        PushTask(worker, std::move(subtask));
+    }
+    if (m_batchCallback)
+    {
+        worker.batch.push_back(std::move(entry));
+        if (worker.batch.size() >= m_options.batchSize)
+        {
+            FlushBatch(worker);
+        }
+    }
+    else
+    {
+        (*m_callback)(entry);
+    }
+}
+
+void DirectoryWalker::FlushBatch(Worker& worker)
+{
+    (*m_batchCallback)(worker.batch);
+    worker.batch.clear();
+}
+
+bool DirectoryWalker::VisitOnce(uint64_t device, uint64_t inode)
+{
+    std::lock_guard lock(m_visitedMutex);
+    return m_visited.emplace(device, inode).second;
+}
+
+void DirectoryWalker::SetException(std::exception_ptr exception)
+{
+    std::lock_guard lock(m_exceptionMutex);
+    if (!m_exception)
+    {
+        m_exception = exception;
+    }
+    m_stop = true;
+}
+
+#ifndef _WIN32
+
+void DirectoryWalker::ReadDirectory(Worker& worker, const WalkTask& task)
+{
+    const std::string directoryPath = task.relativePath.empty() ? m_rootPath : (m_prefix + task.relativePath);
+    const int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC | (m_options.followSymlinks ? 0 : O_NOFOLLOW);
+    const int fd = task.parent ? openat(task.parent->fd, task.relativePath.c_str() + task.nameOffset, flags) :
+        openat(m_rootFd, ".", flags);
+    if (fd < 0)
+    {
+        LogGlobal(Warn, "WalkDirectory: failed to open {}: {} ({})", directoryPath, strerror(errno), errno);
+        m_hasError = true;
+        return;
+    }
+    worker.directory = std::make_shared<const DirectoryHandle>(fd);
+    // Release the directory when read: closed once its subdirectories are opened.
+    struct DirectoryRelease
+    {
+        Worker& worker;
+        ~DirectoryRelease() { worker.directory.reset(); }
+    } directoryRelease{ worker };
+    if (m_options.followSymlinks)
+    {
+        struct stat status = {};
+        if ((fstat(fd, &status) == 0) && !VisitOnce(status.st_dev, status.st_ino))
+        {
+            return;
+        }
+    }
+
+    std::string prefix = task.relativePath.empty() ? m_prefix : (directoryPath + '/');
+    auto addEntry = [&](const char* name, unsigned char direntType, uint64_t inode)
+        {
+            if ((name[0] == '.') && ((name[1] == '\0') || ((name[1] == '.') && (name[2] == '\0'))))
+            {
+                return;
+            }
+            DirectoryWalkEntry entry;
+            entry.type = GetFileTypeFromDirent(direntType);
+            if ((entry.type == FileType::unknown) ||
+                ((entry.type == FileType::symlink) && m_options.followSymlinks))
+            {
+                // Not reported by the file system, or the type of the target.
+                struct stat status = {};
+                const int statFlags = m_options.followSymlinks ? 0 : AT_SYMLINK_NOFOLLOW;
+                if (fstatat(fd, name, &status, statFlags) == 0)
+                {
+                    entry.type = GetFileTypeFromMode(status.st_mode);
+                }
+            }
+            entry.path.reserve(prefix.size() + std::strlen(name));
+            entry.path = prefix;
+            entry.path += name;
+            entry.nameOffset = static_cast<uint32_t>(prefix.size());
+            entry.depth = task.depth;
+            entry.inode = inode;
+            AddEntry(worker, task, std::move(entry));
+        };
+
+#if defined(__linux__)
+    // Read many entries per system call, without the DIR stream.
+    constexpr size_t BufferSize = 64 * 1024;
+    if (worker.buffer.size() < BufferSize)
+    {
+        worker.buffer.resize(BufferSize);
+    }
+    while (!m_stop)
+    {
+        const long bytesRead = syscall(SYS_getdents64, fd, worker.buffer.data(), worker.buffer.size());
+        if (bytesRead <= 0)
+        {
+            if (bytesRead < 0)
+            {
+                LogGlobal(Warn, "WalkDirectory: failed to read {}: {} ({})", directoryPath, strerror(errno), errno);
+                m_hasError = true;
+            }
+            break;
+        }
+        for (long offset = 0; offset < bytesRead;)
+        {
+            const struct dirent64* dirent = reinterpret_cast<const struct dirent64*>(worker.buffer.data() + offset);
+            addEntry(dirent->d_name, dirent->d_type, dirent->d_ino);
+            offset += dirent->d_reclen;
+        }
+    }
+#else
+    // The stream owns a duplicate: the handle keeps the fd for the subdirectories.
+    const int dirFd = dup(fd);
+    DIR* dir = (dirFd >= 0) ? fdopendir(dirFd) : nullptr;
+    if (dir == nullptr)
+    {
+        LogGlobal(Warn, "WalkDirectory: failed to read {}: {} ({})", directoryPath, strerror(errno), errno);
+        m_hasError = true;
+        if (dirFd >= 0)
+        {
+            close(dirFd);
+        }
+        return;
+    }
+    while (!m_stop)
+    {
+        errno = 0;
+        const struct dirent* dirent = readdir(dir);
+        if (dirent == nullptr)
+        {
+            if (errno != 0)
+            {
+                LogGlobal(Warn, "WalkDirectory: failed to read {}: {} ({})", directoryPath, strerror(errno), errno);
+                m_hasError = true;
+            }
+            break;
+        }
+        addEntry(dirent->d_name, dirent->d_type, dirent->d_ino);
+    }
+    // Closes the duplicate.
+    closedir(dir);
+#endif
+}
+
+#else
+
+void DirectoryWalker::ReadDirectory(Worker& worker, const WalkTask& task)
+{
+    const FilePath directoryPath = task.relativePath.empty() ? FilePath(m_rootPath) : FilePath(m_prefix + task.relativePath);
+    std::error_code ec;
+    DirectoryIterator iter(directoryPath, ec);
+    if (ec)
+    {
+        LogGlobal(Warn, "WalkDirectory: failed to open {}: {}", directoryPath.string(), ec.message());
+        m_hasError = true;
+        return;
+    }
+    const std::string prefix = task.relativePath.empty() ? m_prefix : (directoryPath.string() + '\\');
+    for (; !m_stop && (iter != DirectoryIterator()); iter.increment(ec))
+    {
+        DirectoryWalkEntry entry;
+        // Cached by the iterator from FindNextFile, no extra system call.
+        entry.type = m_options.followSymlinks ? iter->status(ec).type() : iter->symlink_status(ec).type();
+        if ((entry.type == FileType::directory) && m_options.followSymlinks && iter->is_symlink(ec))
+        {
+            // No inode to detect loops, do not descend into symlinks.
+            entry.type = FileType::symlink;
+        }
+        entry.path = prefix + iter->path().filename().string();
+        entry.nameOffset = static_cast<uint32_t>(prefix.size());
+        entry.depth = task.depth;
+        AddEntry(worker, task, std::move(entry));
+    }
+    if (ec)
+    {
+        LogGlobal(Warn, "WalkDirectory: failed to read {}: {}", directoryPath.string(), ec.message());
+        m_hasError = true;
+    }
+}
+
+#endif
+
+} // namespace
+
+bool WalkDirectory(const FilePath& root, const std::function<void(const DirectoryWalkEntry& entry)>& callback,
+    const DirectoryWalkOptions& options)
+{
+    DirectoryWalker walker(root, options, &callback, nullptr);
+    return walker.Run();
+}
+
+bool WalkDirectoryBatched(const FilePath& root, const std::function<void(std::vector<DirectoryWalkEntry>& batch)>& callback,
+    const DirectoryWalkOptions& options)
+{
+    DirectoryWalker walker(root, options, nullptr, &callback);
+    return walker.Run();
+}
+
+std::vector<DirectoryWalkEntry> WalkDirectory(const FilePath& root, const DirectoryWalkOptions& options)
+{
+    std::mutex mutex;
+    std::vector<DirectoryWalkEntry> entries;
+    WalkDirectoryBatched(root,
+        [&](std::vector<DirectoryWalkEntry>& batch)
+        {
+            std::lock_guard lock(mutex);
+            if (entries.empty())
+            {
+                entries = std::move(batch);
+            }
+            else
+            {
+                entries.insert(entries.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+            }
+        }, options);
+    return entries;
+}
+
+} // namespace rad
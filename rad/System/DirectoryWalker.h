@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FileSystem.h"
+#include <functional>
+
+namespace rad
+{
+
+struct DirectoryWalkEntry
+{
+    // The root joined with the relative path.
+    std::string path;
+    // The file name starts at path[nameOffset].
+    uint32_t nameOffset = 0;
+    // 0 for the entries directly in the root.
+    uint32_t depth = 0;
+    // From the directory entry (d_type), without stat unless the file system doesn't report it;
+    // symlinks are reported as symlinks unless followed.
+    FileType type = FileType::unknown;
+    uint64_t inode = 0;
+
+    std::string_view GetName() const { return std::string_view(path).substr(nameOffset); }
+};
+
+struct DirectoryWalkOptions
+{
+    // Use the hardware concurrency if 0; the calling thread is one of them.
+    uint32_t threadCount = 0;
+    // The entries deeper than maxDepth are not visited.
+    uint32_t maxDepth = UINT32_MAX;
+    // Descend into the symlinks to directories (visited once, no loops).
+    bool followSymlinks = false;
+    // Called on the worker threads before an entry is reported: return false to skip it,
+    // and the subtree if a directory.
+    std::function<bool(const DirectoryWalkEntry& entry)> filter;
+    // The number of entries per batch of WalkDirectoryBatched.
+    size_t batchSize = 1024;
+};
+
+// Walk the tree in parallel: each worker reads directories (with getdents64 on Linux) opened relative to
+// their parent (openat, the parent is kept open while its subdirectories are queued), and takes
+// the subdirectories it found first, others steal the oldest ones (the largest subtrees) when idle.
+// The entries are reported on the worker threads in no particular order, the callback must be thread-safe.
+// Return false if the root or any subdirectory cannot be read (logged and skipped).
+bool WalkDirectory(const FilePath& root, const std::function<void(const DirectoryWalkEntry& entry)>& callback,
+    const DirectoryWalkOptions& options = {});
+// The entries are reported in batches of options.batchSize (the last ones of each worker may be smaller),
+// the batch can be moved from.
+bool WalkDirectoryBatched(const FilePath& root, const std::function<void(std::vector<DirectoryWalkEntry>& batch)>& callback,
+    const DirectoryWalkOptions& options = {});
+// Return all entries, in no particular order.
+std::vector<DirectoryWalkEntry> WalkDirectory(const FilePath& root, const DirectoryWalkOptions& options = {});
+
+} // namespace rad
@@ -0,0 +1,243 @@
+#include "FileHash.h"
+#include "FileMetadata.h"
+#include "rad/Core/ThreadPool.h"
+#include "rad/IO/MappedFile.h"
+#include <algorithm>
+#include <mutex>
+#include <tuple>
+
+namespace rad
+{
+
+namespace
+{
+
+// The files larger than this are mapped and hashed window by window.
+constexpr uint64_t HashWindowSize = 64 * 1024 * 1024;
+
+struct DuplicateCandidate
+{
+    std::string path;
+    uint64_t size = 0;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    Hash128 hash;
+    bool isValid = true;
+};
+
+// Hash the candidates (the first maxSize bytes of the larger ones if maxSize is nonzero),
+// and drop those that cannot be read.
+void HashCandidates(std::vector<DuplicateCandidate*>& candidates, uint64_t maxSize, uint32_t threadCount)
+{
+    ParallelFor(candidates.size(), threadCount, [&](size_t i) {
+        DuplicateCandidate* candidate = candidates[i];
+        FileHashResult result;
+        candidate->isValid = HashFile(candidate->path, &result, maxSize) && (result.size == candidate->size);
+        candidate->hash = result.hash;
+        });
+    std::erase_if(candidates, [](const DuplicateCandidate* candidate) { return !candidate->isValid; });
+}
+
+// Sort by the key and keep the runs of the candidates with the same key with at least two.
+template<typename Key>
+void KeepDuplicateRuns(std::vector<DuplicateCandidate*>& candidates, const Key& key)
+{
+    std::sort(candidates.begin(), candidates.end(),
+        [&](const DuplicateCandidate* lhs, const DuplicateCandidate* rhs) {
+            return std::make_pair(key(*lhs), std::string_view(lhs->path)) <
+                std::make_pair(key(*rhs), std::string_view(rhs->path));
+        });
+    size_t keptCount = 0;
+    for (size_t begin = 0; begin < candidates.size();)
+    {
+        size_t end = begin + 1;
+        while ((end < candidates.size()) && (key(*candidates[end]) == key(*candidates[begin])))
+        {
+            ++end;
+        }
+        if (end - begin >= 2)
+        {
+            std::move(candidates.begin() + begin, candidates.begin() + end, candidates.begin() + keptCount);
+            keptCount += end - begin;
+        }
+        begin = end;
+    }
+    candidates.resize(keptCount);
+}
+
+std::vector<DuplicateFileGroup> FindDuplicates(std::vector<DuplicateCandidate>& storage,
+    const DuplicateFileOptions& options)
+{
+    std::vector<DuplicateCandidate*> candidates;
+    candidates.reserve(storage.size());
+    for (DuplicateCandidate& candidate : storage)
+    {
+        candidates.push_back(&candidate);
+    }
+
+    // Count the hard links to the same file once (the first path).
+    std::sort(candidates.begin(), candidates.end(),
+        [](const DuplicateCandidate* lhs, const DuplicateCandidate* rhs) {
+            return std::tie(lhs->device, lhs->inode, lhs->path) < std::tie(rhs->device, rhs->inode, rhs->path);
+        });
+    candidates.erase(std::unique(candidates.begin(), candidates.end(),
+        [](const DuplicateCandidate* lhs, const DuplicateCandidate* rhs) {
+            // The inode is 0 if the file system doesn't report it.
+            return (lhs->inode != 0) && (lhs->device == rhs->device) && (lhs->inode == rhs->inode);
+        }), candidates.end());
+
+    auto sizeKey = [](const DuplicateCandidate& candidate) { return candidate.size; };
+    auto hashKey = [](const DuplicateCandidate& candidate) { return std::make_pair(candidate.size, candidate.hash); };
+    KeepDuplicateRuns(candidates, sizeKey);
+
+    if (options.prefixSize > 0)
+    {
+        // The hash of the prefix is the hash of the whole file for the small ones.
+        HashCandidates(candidates, options.prefixSize, options.threadCount);
+        KeepDuplicateRuns(candidates, hashKey);
+        std::vector<DuplicateCandidate*> largeCandidates;
+        for (DuplicateCandidate* candidate : candidates)
+        {
+            if (candidate->size > options.prefixSize)
+            {
+                largeCandidates.push_back(candidate);
+            }
+        }
+        HashCandidates(largeCandidates, 0, options.threadCount);
+        std::erase_if(candidates, [](const DuplicateCandidate* candidate) { return !candidate->isValid; });
+    }
+    else
+    {
+        HashCandidates(candidates, 0, options.threadCount);
+    }
+    KeepDuplicateRuns(candidates, hashKey);
+
+    std::vector<DuplicateFileGroup> groups;
+    for (size_t i = 0; i < candidates.size(); ++i)
+    {
+        if ((i == 0) || (hashKey(*candidates[i]) != hashKey(*candidates[i - 1])))
+        {
+            DuplicateFileGroup& group = groups.emplace_back();
+            group.size = candidates[i]->size;
+            group.hash = candidates[i]->hash;
+        }
+        groups.back().paths.push_back(std::move(candidates[i]->path));
+    }
+    std::sort(groups.begin(), groups.end(),
+        [](const DuplicateFileGroup& lhs, const DuplicateFileGroup& rhs) {
+            const uint64_t lhsWasted = lhs.size * (lhs.paths.size() - 1);
+            const uint64_t rhsWasted = rhs.size * (rhs.paths.size() - 1);
+            if (lhsWasted != rhsWasted)
+            {
+                return lhsWasted > rhsWasted;
+            }
+            return lhs.paths.front() < rhs.paths.front();
+        });
+    return groups;
+}
+
+void AddCandidates(const std::vector<FilePath>& paths, const std::vector<FileMetadata>& metadata,
+    const DuplicateFileOptions& options, std::vector<DuplicateCandidate>& candidates)
+{
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (!metadata[i].IsRegularFile() || (metadata[i].size < options.minSize))
+        {
+            continue;
+        }
+        DuplicateCandidate& candidate = candidates.emplace_back();
+        candidate.path = paths[i].string();
+        candidate.size = metadata[i].size;
+        candidate.device = metadata[i].device;
+        candidate.inode = metadata[i].inode;
+    }
+}
+
+} // namespace
+
+bool HashFile(const FilePath& p, FileHashResult* result, uint64_t maxSize)
+{
+    *result = {};
+    MappedFile file;
+    if (!file.Open(p.string()))
+    {
+        return false;
+    }
+    const uint64_t fileSize = file.GetFileSize();
+    const uint64_t hashSize = (maxSize > 0) ? std::min(fileSize, maxSize) : fileSize;
+    if (hashSize <= HashWindowSize)
+    {
+        // Map(0, 0) would map the whole file.
+        if ((hashSize > 0) && !file.Map(0, static_cast<size_t>(hashSize)))
+        {
+            return false;
+        }
+        file.Advise(MappedFile::Advice::Sequential);
+        result->hash = HashBytes128(file.GetData(), file.GetSize());
+    }
+    else
+    {
+        Hasher hasher;
+        for (uint64_t offset = 0; offset < hashSize; offset += HashWindowSize)
+        {
+            if (!file.Map(offset, static_cast<size_t>(std::min(HashWindowSize, hashSize - offset))))
+            {
+                return false;
+            }
+            file.Advise(MappedFile::Advice::Sequential);
+            hasher.Update(file.GetData(), file.GetSize());
+        }
+        result->hash = hasher.Digest128();
+    }
+    result->size = fileSize;
+    result->isValid = true;
+    return true;
+}
+
+std::vector<FileHashResult> HashFiles(const std::vector<FilePath>& paths, const FileHashOptions& options)
+{
+    std::vector<FileHashResult> results(paths.size());
+    ParallelFor(paths.size(), options.threadCount, [&](size_t i) {
+        HashFile(paths[i], &results[i], options.maxSize);
+        });
+    return results;
+}
+
+std::vector<DuplicateFileGroup> FindDuplicateFiles(const FilePath& root, const DuplicateFileOptions& options)
+{
+    DirectoryWalkOptions walkOptions;
+    walkOptions.threadCount = options.threadCount;
+    walkOptions.followSymlinks = options.followSymlinks;
+    walkOptions.filter = options.filter;
+    std::vector<FilePath> paths;
+    std::mutex mutex;
+    WalkDirectoryBatched(root, [&](std::vector<DirectoryWalkEntry>& batch) {
+        std::lock_guard lock(mutex);
+        for (DirectoryWalkEntry& entry : batch)
+        {
+            if (entry.type != FileType::directory)
+            {
+                paths.emplace_back(std::move(entry.path));
+            }
+        }
+        }, walkOptions);
+
+    FileMetadataOptions metadataOptions;
+    metadataOptions.threadCount = options.threadCount;
+    metadataOptions.followSymlinks = options.followSymlinks;
+    std::vector<DuplicateCandidate> candidates;
+    AddCandidates(paths, GetFileMetadata(paths, metadataOptions), options, candidates);
+    return FindDuplicates(candidates, options);
+}
+
+std::vector<DuplicateFileGroup> FindDuplicateFiles(const std::vector<FilePath>& paths,
+    const DuplicateFileOptions& options)
+{
+    FileMetadataOptions metadataOptions;
+    metadataOptions.threadCount = options.threadCount;
+    std::vector<DuplicateCandidate> candidates;
+    AddCandidates(paths, GetFileMetadata(paths, metadataOptions), options, candidates);
+    return FindDuplicates(candidates, options);
+}
+
+} // namespace rad
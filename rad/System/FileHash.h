@@ -0,0 +1,68 @@
+#pragma once
+
+#include "DirectoryWalker.h"
+#include "rad/Core/Hash.h"
+#include <vector>
+
+namespace rad
+{
+
+struct FileHashOptions
+{
+    // Use the hardware concurrency if 0; the calling thread is one of them.
+    uint32_t threadCount = 0;
+    // Hash only the first maxSize bytes of each file if nonzero.
+    uint64_t maxSize = 0;
+};
+
+struct FileHashResult
+{
+    // HashBytes128 of the contents (of the first FileHashOptions::maxSize bytes).
+    Hash128 hash;
+    // The size of the file, not of the bytes hashed.
+    uint64_t size = 0;
+    // False if the file cannot be read (logged).
+    bool isValid = false;
+};
+
+// Hash the contents of a file read through MappedFile: mapped at once up to 64MiB, and in windows
+// of 64MiB fed to a Hasher beyond, so that hashing huge files doesn't map them whole.
+// The hash is the same as HashBytes128 of the contents.
+bool HashFile(const FilePath& p, FileHashResult* result, uint64_t maxSize = 0);
+// Hash the files in parallel, one file per task; the results are in the order of the paths.
+std::vector<FileHashResult> HashFiles(const std::vector<FilePath>& paths, const FileHashOptions& options = {});
+
+struct DuplicateFileOptions
+{
+    // Use the hardware concurrency if 0.
+    uint32_t threadCount = 0;
+    // The smaller files are ignored (all empty files are duplicates of each other).
+    uint64_t minSize = 1;
+    // Descend into the symlinks to directories, and report the symlinks to files as their targets.
+    bool followSymlinks = false;
+    // Hash the first prefixSize bytes of the files of the same size first, and the whole files
+    // only if these match (most files of the same size differ early); 0 to hash the whole files at once.
+    uint64_t prefixSize = 4096;
+    // Skip the entries (and the subtrees) the filter returns false for.
+    std::function<bool(const DirectoryWalkEntry& entry)> filter;
+};
+
+struct DuplicateFileGroup
+{
+    uint64_t size = 0;
+    Hash128 hash;
+    // Sorted, at least two.
+    std::vector<std::string> paths;
+};
+
+// Find the regular files with the same contents: only the files sharing their size with another are read,
+// those sharing the hash of the prefix too are hashed whole, and grouped by the 128-bit hash
+// (the contents are not compared byte by byte, a collision is unlikely unless crafted).
+// The hard links (and symlinks) to the same file are counted once.
+// The groups are sorted by the space they waste (size * (count - 1)), largest first.
+std::vector<DuplicateFileGroup> FindDuplicateFiles(const FilePath& root, const DuplicateFileOptions& options = {});
+// Search the files given (the filter and followSymlinks don't apply, the symlinks are followed).
+std::vector<DuplicateFileGroup> FindDuplicateFiles(const std::vector<FilePath>& paths,
+    const DuplicateFileOptions& options = {});
+
+} // namespace rad
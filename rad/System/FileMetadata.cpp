@@ -0,0 +1,360 @@
+#include "FileMetadata.h"
+#include "rad/Core/ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <exception>
+#include <mutex>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/sysmacros.h>
+#endif
+
+namespace rad
+{
+
+namespace
+{
+
+#ifdef _WIN32
+// FILETIME counts 100ns intervals since 1601-01-01.
+uint64_t FileTimeToUnixNs(const FILETIME& time)
+{
+    const uint64_t ticks = (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    constexpr uint64_t UnixEpochTicks = 116444736000000000ull;
+    return (ticks > UnixEpochTicks) ? (ticks - UnixEpochTicks) * 100 : 0;
+}
+
+bool QueryFileMetadata(const FilePath& p, FileMetadata* metadata, bool followSymlinks)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExW(p.c_str(), GetFileExInfoStandard, &data))
+    {
+        metadata->error = static_cast<int>(GetLastError());
+        metadata->type = ((metadata->error == ERROR_FILE_NOT_FOUND) || (metadata->error == ERROR_PATH_NOT_FOUND)) ?
+            FileType::not_found : FileType::none;
+        return false;
+    }
+    DWORD attributes = data.dwFileAttributes;
+    FILETIME creationTime = data.ftCreationTime;
+    FILETIME lastAccessTime = data.ftLastAccessTime;
+    FILETIME lastWriteTime = data.ftLastWriteTime;
+    uint64_t size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    if ((attributes & FILE_ATTRIBUTE_REPARSE_POINT) && followSymlinks)
+    {
+        // The attributes are of the link itself: open the target for its information.
+        HANDLE handle = CreateFileW(p.c_str(), FILE_READ_ATTRIBUTES,
+            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+            OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+        BY_HANDLE_FILE_INFORMATION info = {};
+        if ((handle == INVALID_HANDLE_VALUE) || !GetFileInformationByHandle(handle, &info))
+        {
+            metadata->error = static_cast<int>(GetLastError());
+            metadata->type = FileType::not_found;
+            if (handle != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(handle);
+            }
+            return false;
+        }
+        CloseHandle(handle);
+        attributes = info.dwFileAttributes;
+        creationTime = info.ftCreationTime;
+        lastAccessTime = info.ftLastAccessTime;
+        lastWriteTime = info.ftLastWriteTime;
+        size = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+        metadata->hardLinkCount = info.nNumberOfLinks;
+        metadata->device = info.dwVolumeSerialNumber;
+        metadata->inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    }
+    else
+    {
+        // Not reported without opening the file.
+        metadata->hardLinkCount = 1;
+    }
+
+    if (attributes & FILE_ATTRIBUTE_REPARSE_POINT)
+    {
+        metadata->type = FileType::symlink;
+    }
+    else if (attributes & FILE_ATTRIBUTE_DIRECTORY)
+    {
+        metadata->type = FileType::directory;
+    }
+    else
+    {
+        metadata->type = FileType::regular;
+    }
+    metadata->perms = (attributes & FILE_ATTRIBUTE_READONLY) ?
+        (FilePerms::all & ~(FilePerms::owner_write | FilePerms::group_write | FilePerms::others_write)) :
+        FilePerms::all;
+    metadata->size = (metadata->type == FileType::directory) ? 0 : size;
+    metadata->atimeNs = FileTimeToUnixNs(lastAccessTime);
+    metadata->mtimeNs = FileTimeToUnixNs(lastWriteTime);
+    metadata->ctimeNs = metadata->mtimeNs;
+    metadata->btimeNs = FileTimeToUnixNs(creationTime);
+    return true;
+}
+#else // POSIX
+bool SetQueryError(FileMetadata* metadata, int error)
+{
+    metadata->error = error;
+    metadata->type = ((error == ENOENT) || (error == ENOTDIR)) ? FileType::not_found : FileType::none;
+    return false;
+}
+
+bool QueryFileMetadataWithStat(const FilePath& p, FileMetadata* metadata, bool followSymlinks)
+{
+    struct stat status = {};
+    const int ret = followSymlinks ? stat(p.c_str(), &status) : lstat(p.c_str(), &status);
+    if (ret != 0)
+    {
+        return SetQueryError(metadata, errno);
+    }
+    metadata->type = GetFileTypeFromMode(status.st_mode);
+    metadata->perms = static_cast<FilePerms>(status.st_mode & 07777);
+    metadata->size = static_cast<uint64_t>(status.st_size);
+    metadata->hardLinkCount = static_cast<uint64_t>(status.st_nlink);
+    metadata->device = static_cast<uint64_t>(status.st_dev);
+    metadata->inode = static_cast<uint64_t>(status.st_ino);
+#if defined(__APPLE__)
+    metadata->atimeNs = static_cast<uint64_t>(status.st_atimespec.tv_sec) * 1000000000ull + status.st_atimespec.tv_nsec;
+    metadata->mtimeNs = static_cast<uint64_t>(status.st_mtimespec.tv_sec) * 1000000000ull + status.st_mtimespec.tv_nsec;
+    metadata->ctimeNs = static_cast<uint64_t>(status.st_ctimespec.tv_sec) * 1000000000ull + status.st_ctimespec.tv_nsec;
+    metadata->btimeNs = static_cast<uint64_t>(status.st_birthtimespec.tv_sec) * 1000000000ull + status.st_birthtimespec.tv_nsec;
+#else
+    metadata->atimeNs = static_cast<uint64_t>(status.st_atim.tv_sec) * 1000000000ull + status.st_atim.tv_nsec;
+    metadata->mtimeNs = static_cast<uint64_t>(status.st_mtim.tv_sec) * 1000000000ull + status.st_mtim.tv_nsec;
+    metadata->ctimeNs = static_cast<uint64_t>(status.st_ctim.tv_sec) * 1000000000ull + status.st_ctim.tv_nsec;
+#endif
+    return true;
+}
+
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+uint64_t StatxTimeToNs(const struct statx_timestamp& time)
+{
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ull + time.tv_nsec;
+}
+
+// statx fills only the fields requested (and supported by the file system),
+// and is not available on kernels older than 4.11.
+bool QueryFileMetadata(const FilePath& p, FileMetadata* metadata, bool followSymlinks)
+{
+    static std::atomic<bool> isStatxSupported = true;
+    if (!isStatxSupported.load(std::memory_order_relaxed))
+    {
+        return QueryFileMetadataWithStat(p, metadata, followSymlinks);
+    }
+    struct statx status = {};
+    const int flags = AT_STATX_SYNC_AS_STAT | (followSymlinks ? 0 : AT_SYMLINK_NOFOLLOW);
+    if (statx(AT_FDCWD, p.c_str(), flags, STATX_BASIC_STATS | STATX_BTIME, &status) != 0)
+    {
+        if (errno == ENOSYS)
+        {
+            isStatxSupported.store(false, std::memory_order_relaxed);
+            return QueryFileMetadataWithStat(p, metadata, followSymlinks);
+        }
+        return SetQueryError(metadata, errno);
+    }
+    metadata->type = GetFileTypeFromMode(status.stx_mode);
+    metadata->perms = static_cast<FilePerms>(status.stx_mode & 07777);
+    metadata->size = status.stx_size;
+    metadata->hardLinkCount = status.stx_nlink;
+    metadata->device = makedev(status.stx_dev_major, status.stx_dev_minor);
+    metadata->inode = status.stx_ino;
+    metadata->atimeNs = StatxTimeToNs(status.stx_atime);
+    metadata->mtimeNs = StatxTimeToNs(status.stx_mtime);
+    metadata->ctimeNs = StatxTimeToNs(status.stx_ctime);
+    metadata->btimeNs = (status.stx_mask & STATX_BTIME) ? StatxTimeToNs(status.stx_btime) : 0;
+    return true;
+}
+#else
+bool QueryFileMetadata(const FilePath& p, FileMetadata* metadata, bool followSymlinks)
+{
+    return QueryFileMetadataWithStat(p, metadata, followSymlinks);
+}
+#endif
+#endif // POSIX
+
+// Query paths[indices[i]] (or paths[i] if indices is null) into results[i] in batches of options.batchSize,
+// on up to options.threadCount threads.
+void QueryFileMetadataParallel(const std::vector<FilePath>& paths, const std::vector<size_t>* indices,
+    FileMetadata* results, const FileMetadataOptions& options)
+{
+    const size_t count = indices ? indices->size() : paths.size();
+    const size_t batchSize = std::max<size_t>(options.batchSize, 1);
+    const size_t batchCount = (count + batchSize - 1) / batchSize;
+    ParallelFor(batchCount, options.threadCount, [&](size_t batch) {
+        const size_t end = std::min(count, (batch + 1) * batchSize);
+        for (size_t i = batch * batchSize; i < end; ++i)
+        {
+            const FilePath& p = indices ? paths[(*indices)[i]] : paths[i];
+            QueryFileMetadata(p, &results[i], options.followSymlinks);
+        }
+        });
+}
+
+} // namespace
+
+FileTime FileMetadata::GetLastWriteTime() const
+{
+    const std::chrono::sys_time<std::chrono::nanoseconds> time{ std::chrono::nanoseconds(mtimeNs) };
+    return std::chrono::time_point_cast<FileTime::duration>(std::chrono::file_clock::from_sys(time));
+}
+
+bool GetFileMetadata(const FilePath& p, FileMetadata* metadata, bool followSymlinks)
+{
+    assert(metadata != nullptr);
+    *metadata = {};
+    return QueryFileMetadata(p, metadata, followSymlinks);
+}
+
+std::vector<FileMetadata> GetFileMetadata(const std::vector<FilePath>& paths, const FileMetadataOptions& options)
+{
+    std::vector<FileMetadata> results(paths.size());
+    QueryFileMetadataParallel(paths, nullptr, results.data(), options);
+    return results;
+}
+
+FileMetadataCache::FileMetadataCache()
+{
+}
+
+FileMetadataCache::FileMetadataCache(const FileMetadataOptions& options) :
+    m_options(options)
+{
+}
+
+FileMetadataCache::~FileMetadataCache()
+{
+}
+
+FileMetadata FileMetadataCache::Get(const FilePath& p)
+{
+    uint64_t generation = 0;
+    {
+        std::shared_lock lock(m_mutex);
+        auto iter = m_entries.find(p);
+        if (iter != m_entries.end())
+        {
+            m_hitCount.fetch_add(1, std::memory_order_relaxed);
+            return iter->second;
+        }
+        generation = m_generation;
+    }
+    m_missCount.fetch_add(1, std::memory_order_relaxed);
+    FileMetadata metadata;
+    QueryFileMetadata(p, &metadata, m_options.followSymlinks);
+    std::unique_lock lock(m_mutex);
+    // Invalidated while querying: the result may be stale, don't cache it.
+    if (m_generation == generation)
+    {
+        m_entries.insert_or_assign(p, metadata);
+    }
+    return metadata;
+}
+
+std::vector<FileMetadata> FileMetadataCache::Get(const std::vector<FilePath>& paths)
+{
+    std::vector<FileMetadata> results(paths.size());
+    // The paths not cached, each queried once: missSlots[i] indexes the unique misses.
+    std::unordered_map<FilePath, size_t, PathHash> missMap;
+    std::vector<size_t> missIndices;
+    std::vector<size_t> missSlots(paths.size(), SIZE_MAX);
+    uint64_t generation = 0;
+    {
+        std::shared_lock lock(m_mutex);
+        generation = m_generation;
+        for (size_t i = 0; i < paths.size(); ++i)
+        {
+            auto iter = m_entries.find(paths[i]);
+            if (iter != m_entries.end())
+            {
+                results[i] = iter->second;
+                continue;
+            }
+            auto [missIter, isInserted] = missMap.try_emplace(paths[i], missIndices.size());
+            if (isInserted)
+            {
+                missIndices.push_back(i);
+            }
+            missSlots[i] = missIter->second;
+        }
+    }
+    m_hitCount.fetch_add(paths.size() - missIndices.size(), std::memory_order_relaxed);
+    if (missIndices.empty())
+    {
+        return results;
+    }
+
+    m_missCount.fetch_add(missIndices.size(), std::memory_order_relaxed);
+    std::vector<FileMetadata> misses(missIndices.size());
+    QueryFileMetadataParallel(paths, &missIndices, misses.data(), m_options);
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        if (missSlots[i] != SIZE_MAX)
+        {
+            results[i] = misses[missSlots[i]];
+        }
+    }
+    std::unique_lock lock(m_mutex);
+    if (m_generation == generation)
+    {
+        for (size_t i = 0; i < missIndices.size(); ++i)
+        {
+            m_entries.insert_or_assign(paths[missIndices[i]], misses[i]);
+        }
+    }
+    return results;
+}
+
+void FileMetadataCache::Invalidate(const FilePath& p)
+{
+    std::unique_lock lock(m_mutex);
+    m_entries.erase(p);
+    m_generation++;
+}
+
+void FileMetadataCache::InvalidateTree(const FilePath& p)
+{
+    // "dir/" ends with an empty element.
+    const FilePath root = p.has_filename() ? p : p.parent_path();
+    std::unique_lock lock(m_mutex);
+    m_generation++;
+    for (auto iter = m_entries.begin(); iter != m_entries.end(); )
+    {
+        // Compare by the path elements, so that "dir" doesn't match "dir2/file".
+        const FilePath& path = iter->first;
+        if (std::mismatch(root.begin(), root.end(), path.begin(), path.end()).first == root.end())
+        {
+            iter = m_entries.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void FileMetadataCache::Clear()
+{
+    std::unique_lock lock(m_mutex);
+    m_entries.clear();
+    m_generation++;
+}
+
+size_t FileMetadataCache::GetSize() const
+{
+    std::shared_lock lock(m_mutex);
+    return m_entries.size();
+}
+
+} // namespace rad
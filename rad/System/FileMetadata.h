@@ -0,0 +1,104 @@
+#pragma once
+
+#include "FileSystem.h"
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace rad
+{
+
+// A snapshot of everything IsRegularFile/GetFileSize/GetLastWriteTime/File::GetStat would return,
+// fetched with a single system call (statx on Linux, GetFileAttributesExW on Windows).
+struct FileMetadata
+{
+    // FileType::not_found if the file doesn't exist, FileType::none on other errors (see error).
+    FileType type = FileType::none;
+    FilePerms perms = FilePerms::unknown;
+    uint64_t size = 0;
+    uint64_t hardLinkCount = 0;
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    // Nanoseconds since the Unix epoch.
+    uint64_t atimeNs = 0;
+    uint64_t mtimeNs = 0;
+    // The last status change on POSIX.
+    uint64_t ctimeNs = 0;
+    // The creation time, 0 if the file system doesn't report it.
+    uint64_t btimeNs = 0;
+    // errno (GetLastError() on Windows) if the query failed, 0 otherwise.
+    int error = 0;
+
+    bool Exists() const { return (type != FileType::none) && (type != FileType::not_found); }
+    bool IsRegularFile() const { return type == FileType::regular; }
+    bool IsDirectory() const { return type == FileType::directory; }
+    bool IsSymlink() const { return type == FileType::symlink; }
+    FileTime GetLastWriteTime() const;
+};
+
+// The coarsest mtime resolution of the common file systems (FAT); the file systems with finer timestamps
+// may still update them at the kernel tick. A file modified within it of a check may keep the same size
+// and mtime (racy mtime), its contents must be checked again.
+constexpr uint64_t MtimeGranularityNs = 2000000000;
+
+struct FileMetadataOptions
+{
+    // Use the hardware concurrency if 0; the calling thread is one of them.
+    uint32_t threadCount = 0;
+    // Report the symlinks themselves if false.
+    bool followSymlinks = true;
+    // The number of paths queried by a thread at a time; smaller lists are queried in the calling thread.
+    size_t batchSize = 256;
+};
+
+// Return false if the file cannot be queried (metadata->type and metadata->error tell why);
+// nothing is logged, since missing files are expected by most callers.
+bool GetFileMetadata(const FilePath& p, FileMetadata* metadata, bool followSymlinks = true);
+// Query the paths in parallel batches; the results are in the order of the paths.
+std::vector<FileMetadata> GetFileMetadata(const std::vector<FilePath>& paths,
+    const FileMetadataOptions& options = {});
+
+// Serve repeated queries of the same paths from memory: the entries are valid until invalidated,
+// e.g. after writing a file, or when a watcher reports a change; failed queries are cached too.
+// The paths are compared as given (not normalized). Thread-safe.
+class FileMetadataCache
+{
+public:
+    FileMetadataCache();
+    FileMetadataCache(const FileMetadataOptions& options);
+    ~FileMetadataCache();
+
+    FileMetadataCache(const FileMetadataCache&) = delete;
+    FileMetadataCache& operator=(const FileMetadataCache&) = delete;
+
+    FileMetadata Get(const FilePath& p);
+    // The paths not cached are queried in parallel batches, each once; a duplicate counts as a hit.
+    std::vector<FileMetadata> Get(const std::vector<FilePath>& paths);
+
+    void Invalidate(const FilePath& p);
+    // Invalidate the path and all paths under it.
+    void InvalidateTree(const FilePath& p);
+    void Clear();
+
+    size_t GetSize() const;
+    uint64_t GetHitCount() const { return m_hitCount.load(std::memory_order_relaxed); }
+    uint64_t GetMissCount() const { return m_missCount.load(std::memory_order_relaxed); }
+
+private:
+    struct PathHash
+    {
+        size_t operator()(const FilePath& p) const { return Hash(p); }
+    };
+
+    FileMetadataOptions m_options;
+    mutable std::shared_mutex m_mutex;
+    std::unordered_map<FilePath, FileMetadata, PathHash> m_entries;
+    // Incremented by each invalidation: the queries that started before aren't cached.
+    uint64_t m_generation = 0;
+    std::atomic<uint64_t> m_hitCount = 0;
+    std::atomic<uint64_t> m_missCount = 0;
+
+}; // class FileMetadataCache
+
+} // namespace rad
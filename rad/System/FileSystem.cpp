@@ -1,6 +1,8 @@
 #include "FileSystem.h"
+#include "rad/Core/ThreadPool.h"
 #include <cerrno>
 #include <ctime>
+#include <exception>
 
 #ifdef _WIN32
 #include <Windows.h>
@@ -14,10 +16,17 @@
 #undef CopyFile
 #endif
 #else
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#endif
+
 namespace rad
 {
 
@@ -101,6 +110,23 @@ FileStatus GetSymlinkStatus(const FilePath& p)
     return std::filesystem::symlink_status(p);
 }
 
+#ifndef _WIN32
+FileType GetFileTypeFromMode(uint32_t mode)
+{
+    switch (mode & S_IFMT)
+    {
+    case S_IFREG: return FileType::regular;
+    case S_IFDIR: return FileType::directory;
+    case S_IFLNK: return FileType::symlink;
+    case S_IFBLK: return FileType::block;
+    case S_IFCHR: return FileType::character;
+    case S_IFIFO: return FileType::fifo;
+    case S_IFSOCK: return FileType::socket;
+    default: return FileType::unknown;
+    }
+}
+#endif
+
 bool Exists(FileStatus s)
 {
     return std::filesystem::exists(s);
@@ -166,11 +192,251 @@ void Copy(const FilePath& from, const FilePath& to, FileCopyOptions options)
     std::filesystem::copy(from, to, options);
 }
 
+#if defined(__linux__)
+// Copy the data between descriptors, from the current offsets; return 0 or errno.
+static int CopyFileData(int fdFrom, int fdTo, uint64_t size)
+{
+    if (::ioctl(fdTo, FICLONE, fdFrom) == 0)
+    {
+        return 0;
+    }
+
+    // The files of procfs and sysfs report the size 0: read them to the end.
+    const bool readToEnd = (size == 0);
+    uint64_t bytesCopied = 0;
+    bool useCopyFileRange = !readToEnd;
+    bool useSendFile = !readToEnd;
+    while (readToEnd || (bytesCopied < size))
+    {
+        const size_t chunkSize = readToEnd ? (64 * 1024) :
+            static_cast<size_t>(std::min<uint64_t>(size - bytesCopied, 1ull << 30));
+        ssize_t n = -1;
+        if (useCopyFileRange)
+        {
+            n = ::copy_file_range(fdFrom, nullptr, fdTo, nullptr, chunkSize, 0);
+            // Not supported across file systems (before Linux 5.3) or by the file system.
+            if ((n < 0) && (bytesCopied == 0) &&
+                ((errno == EXDEV) || (errno == EINVAL) || (errno == ENOSYS) || (errno == EOPNOTSUPP)))
+            {
+                useCopyFileRange = false;
+                continue;
+            }
+        }
+        else if (useSendFile)
+        {
+            n = ::sendfile(fdTo, fdFrom, nullptr, chunkSize);
+            if ((n < 0) && (bytesCopied == 0) && ((errno == EINVAL) || (errno == ENOSYS)))
+            {
+                useSendFile = false;
+                continue;
+            }
+        }
+        else
+        {
+            char buffer[64 * 1024];
+            n = ::read(fdFrom, buffer, std::min(chunkSize, sizeof(buffer)));
+            for (ssize_t written = 0; (n > 0) && (written < n);)
+            {
+                ssize_t w = ::write(fdTo, buffer + written, n - written);
+                if (w < 0)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    return errno;
+                }
+                written += w;
+            }
+        }
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        if (n == 0)
+        {
+            // Some file systems (procfs, sysfs, some FUSE and NFS) return 0 before the end:
+            // fallback to the next method from the current offsets; only read returning 0 is the end.
+            if (useCopyFileRange)
+            {
+                useCopyFileRange = false;
+                continue;
+            }
+            if (useSendFile)
+            {
+                useSendFile = false;
+                continue;
+            }
+            break;
+        }
+        bytesCopied += n;
+    }
+    if (!readToEnd && (bytesCopied < size))
+    {
+        // The file is truncated while copying.
+        return EIO;
+    }
+    return 0;
+}
+
+// Return false to fallback to std::filesystem::copy_file, which reports the errors.
+static bool CopyFileInKernel(const FilePath& from, const FilePath& to, FileCopyOptions options)
+{
+    const int fdFrom = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fdFrom < 0)
+    {
+        return false;
+    }
+    struct stat statFrom = {};
+    if ((::fstat(fdFrom, &statFrom) != 0) || !S_ISREG(statFrom.st_mode))
+    {
+        ::close(fdFrom);
+        return false;
+    }
+
+    struct stat statTo = {};
+    if (::stat(to.c_str(), &statTo) == 0)
+    {
+        const bool isEquivalent = (statTo.st_dev == statFrom.st_dev) && (statTo.st_ino == statFrom.st_ino);
+        if (isEquivalent || !S_ISREG(statTo.st_mode))
+        {
+            ::close(fdFrom);
+            return false;
+        }
+        if ((options & FileCopyOptions::skip_existing) != FileCopyOptions::none)
+        {
+            ::close(fdFrom);
+            return true;
+        }
+        if ((options & FileCopyOptions::update_existing) != FileCopyOptions::none)
+        {
+            if ((statTo.st_mtim.tv_sec > statFrom.st_mtim.tv_sec) ||
+                ((statTo.st_mtim.tv_sec == statFrom.st_mtim.tv_sec) &&
+                    (statTo.st_mtim.tv_nsec >= statFrom.st_mtim.tv_nsec)))
+            {
+                ::close(fdFrom);
+                return true;
+            }
+        }
+        else if ((options & FileCopyOptions::overwrite_existing) == FileCopyOptions::none)
+        {
+            ::close(fdFrom);
+            return false;
+        }
+    }
+
+    const int fdTo = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, statFrom.st_mode & 07777);
+    if (fdTo < 0)
+    {
+        ::close(fdFrom);
+        return false;
+    }
+    int err = CopyFileData(fdFrom, fdTo, static_cast<uint64_t>(statFrom.st_size));
+    if ((err == 0) && (::fchmod(fdTo, statFrom.st_mode & 07777) != 0))
+    {
+        err = errno;
+    }
+    ::close(fdFrom);
+    if ((::close(fdTo) != 0) && (err == 0))
+    {
+        err = errno;
+    }
+    if (err != 0)
+    {
+        throw FileSystemError("CopyFile", from, to, std::error_code(err, std::generic_category()));
+    }
+    return true;
+}
+#endif
+
 void CopyFile(const FilePath& from, const FilePath& to, FileCopyOptions options)
 {
+#if defined(__linux__)
+    if (CopyFileInKernel(from, to, options))
+    {
+        return;
+    }
+#endif
     std::filesystem::copy_file(from, to, options);
 }
 
+void CopyParallel(const FilePath& from, const FilePath& to, FileCopyOptions options, uint32_t threadCount)
+{
+    if (!IsDirectory(from))
+    {
+        Copy(from, to, options);
+        return;
+    }
+    const bool copySymlinks = (options & FileCopyOptions::copy_symlinks) != FileCopyOptions::none;
+    const bool skipSymlinks = (options & FileCopyOptions::skip_symlinks) != FileCopyOptions::none;
+    const bool directoriesOnly = (options & FileCopyOptions::directories_only) != FileCopyOptions::none;
+    const bool createLinks = (options &
+        (FileCopyOptions::create_hard_links | FileCopyOptions::create_symlinks)) != FileCopyOptions::none;
+    const FileCopyOptions fileOptions = options &
+        (FileCopyOptions::skip_existing | FileCopyOptions::overwrite_existing | FileCopyOptions::update_existing);
+
+    std::mutex mutex;
+    std::exception_ptr exception;
+    ThreadPool threadPool(threadCount);
+    CreateDirectory(to, from);
+    for (auto iter = RecursiveDirectorIterator(from); iter != RecursiveDirectorIterator(); ++iter)
+    {
+        const DirectoryEntry& entry = *iter;
+        const FilePath target = to / entry.path().lexically_relative(from);
+        if (entry.is_symlink())
+        {
+            if (copySymlinks)
+            {
+                CopySymlink(entry.path(), target);
+            }
+            else if (!skipSymlinks)
+            {
+                // Follow the link, as std::filesystem::copy does (the iterator doesn't).
+                Copy(entry.path(), target, options | FileCopyOptions::recursive);
+            }
+        }
+        else if (entry.is_directory())
+        {
+            CreateDirectory(target, entry.path());
+        }
+        else if (directoriesOnly)
+        {
+            continue;
+        }
+        else if (entry.is_regular_file() && !createLinks)
+        {
+            threadPool.Enqueue([&, source = entry.path(), target]() {
+                try
+                {
+                    CopyFile(source, target, fileOptions);
+                }
+                catch (...)
+                {
+                    std::lock_guard lockGuard(mutex);
+                    if (!exception)
+                    {
+                        exception = std::current_exception();
+                    }
+                }
+                });
+        }
+        else
+        {
+            // Hard links, symlinks and the other file types, in the calling thread.
+            Copy(entry.path(), target, options);
+        }
+    }
+    threadPool.WaitIdle();
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+}
+
 void CopySymlink(const FilePath& from, const FilePath& to)
 {
     std::filesystem::copy_symlink(from, to);
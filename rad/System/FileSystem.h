@@ -54,6 +54,10 @@ bool IsEquivalent(const FilePath& p1, const FilePath& p2);
 std::uintmax_t GetFileSize(const FilePath& p);
 FileStatus GetFileStatus(const FilePath& p);
 FileStatus GetSymlinkStatus(const FilePath& p);
+#ifndef _WIN32
+// The type of a POSIX file mode (st_mode of stat, stx_mode of statx).
+FileType GetFileTypeFromMode(uint32_t mode);
+#endif
 bool Exists(FileStatus s);
 std::uintmax_t GetHardLinkCount(const FilePath& p);
 FileTime GetLastWriteTime(const FilePath& p);
@@ -73,7 +77,16 @@ void CreateSymlink(const FilePath& target, const FilePath& link);
 void CreateDirectorySymlink(const FilePath& target, const FilePath& link);
 
 void Copy(const FilePath& from, const FilePath& to, FileCopyOptions options = FileCopyOptions::none);
+// Copy the data in the kernel on Linux: try FICLONE (reflink on Btrfs/XFS), copy_file_range, sendfile,
+// then read/write; same options and exceptions as std::filesystem::copy_file.
 void CopyFile(const FilePath& from, const FilePath& to, FileCopyOptions options = FileCopyOptions::none);
+// Copy a directory tree recursively: directories are created in the calling thread,
+// and files are copied with CopyFile in parallel; the first error is rethrown after all copies are done.
+// Symlinks are handled as std::filesystem::copy (copy_symlinks, skip_symlinks or followed),
+// and create_hard_links/create_symlinks/directories_only are honoured in the calling thread.
+// @param threadCount: use the hardware concurrency if 0.
+void CopyParallel(const FilePath& from, const FilePath& to,
+    FileCopyOptions options = FileCopyOptions::none, uint32_t threadCount = 0);
 void CopySymlink(const FilePath& from, const FilePath& to);
 
 // Delete file or empty directory, the same as POSIX remove.
@@ -0,0 +1,670 @@
+#include "FileWatcher.h"
+#include "rad/IO/Logging.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace rad
+{
+
+namespace
+{
+
+// Whether path is root or under it, comparing by elements ("dir" is not a parent of "dir2/file").
+bool IsSameOrUnder(std::string_view path, std::string_view root)
+{
+    if (!path.starts_with(root))
+    {
+        return false;
+    }
+    return (path.size() == root.size()) || (!root.empty() && (root.back() == '/')) ||
+        (path[root.size()] == '/');
+}
+
+std::string JoinPath(std::string_view directoryPath, std::string_view name)
+{
+    std::string path;
+    path.reserve(directoryPath.size() + 1 + name.size());
+    path = directoryPath;
+    if (!path.empty() && (path.back() != '/'))
+    {
+        path.push_back('/');
+    }
+    path += name;
+    return path;
+}
+
+#if defined(__linux__)
+constexpr uint32_t WatchMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB |
+    IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+#endif
+
+} // namespace
+
+FileWatcher::FileWatcher()
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+    Stop();
+}
+
+bool FileWatcher::Start(Callback callback, const Options& options)
+{
+    if (IsRunning())
+    {
+        LogGlobal(Error, "FileWatcher::Start: already running.");
+        return false;
+    }
+    m_callback = std::move(callback);
+    m_options = options;
+#if defined(__linux__)
+    m_isPolling = options.usePolling;
+#else
+    m_isPolling = true;
+#endif
+
+    std::unique_lock lock(m_mutex);
+#if defined(__linux__)
+    if (!m_isPolling)
+    {
+        m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        m_wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if ((m_fd < 0) || (m_wakeFd < 0))
+        {
+            LogGlobal(Error, "FileWatcher::Start: failed to create inotify: {} ({})", strerror(errno), errno);
+            if (m_fd >= 0)
+            {
+                close(m_fd);
+                m_fd = -1;
+            }
+            if (m_wakeFd >= 0)
+            {
+                close(m_wakeFd);
+                m_wakeFd = -1;
+            }
+            return false;
+        }
+        for (const std::unique_ptr<Root>& root : m_roots)
+        {
+            AddRootWatches(*root);
+        }
+    }
+#endif
+    m_isStarted = true;
+    m_stop = false;
+    lock.unlock();
+    if (m_isPolling)
+    {
+        PollRoots(false);
+    }
+    m_thread = std::thread(&FileWatcher::WorkerMain, this);
+    return true;
+}
+
+void FileWatcher::Stop()
+{
+    if (!IsRunning())
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+        m_isStarted = false;
+    }
+    m_stopCond.notify_all();
+#if defined(__linux__)
+    if (m_wakeFd >= 0)
+    {
+        const uint64_t value = 1;
+        [[maybe_unused]] ssize_t bytesWritten = write(m_wakeFd, &value, sizeof(value));
+    }
+#endif
+    m_thread.join();
+
+    std::lock_guard lock(m_mutex);
+#if defined(__linux__)
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+    if (m_wakeFd >= 0)
+    {
+        close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+#endif
+    m_watchPaths.clear();
+    m_watchDescriptors.clear();
+    m_pendingEvents.clear();
+    m_pendingIndices.clear();
+}
+
+bool FileWatcher::AddPath(const FilePath& path)
+{
+    auto root = std::make_unique<Root>();
+    root->path = path.string();
+    while ((root->path.size() > 1) && (root->path.back() == '/'))
+    {
+        root->path.pop_back();
+    }
+    // A file may not exist yet; it is seen when created in its directory.
+    root->isDirectory = IsDirectory(path);
+    root->parentPath = FilePath(root->path).parent_path().string();
+    root->name = FilePath(root->path).filename().string();
+
+    std::lock_guard lock(m_mutex);
+    for (const std::unique_ptr<Root>& existing : m_roots)
+    {
+        if (existing->path == root->path)
+        {
+            return true;
+        }
+    }
+    bool isWatched = true;
+#if defined(__linux__)
+    if (m_isStarted && !m_isPolling)
+    {
+        isWatched = AddRootWatches(*root);
+    }
+#endif
+    m_roots.push_back(std::move(root));
+    if (m_isStarted && m_isPolling)
+    {
+        // Take the initial state of the new root (the others are unchanged since the last poll at most).
+        Root& added = *m_roots.back();
+        if (added.isDirectory)
+        {
+            DirectorySnapshot::Options options;
+            options.threadCount = 1;
+            isWatched = added.snapshot.Capture(added.path, options);
+        }
+        else
+        {
+            GetFileMetadata(added.path, &added.metadata);
+        }
+    }
+    return isWatched;
+}
+
+void FileWatcher::RemovePath(const FilePath& path)
+{
+    std::string rootPath = path.string();
+    while ((rootPath.size() > 1) && (rootPath.back() == '/'))
+    {
+        rootPath.pop_back();
+    }
+    std::lock_guard lock(m_mutex);
+    std::erase_if(m_roots, [&](const std::unique_ptr<Root>& root) { return root->path == rootPath; });
+#if defined(__linux__)
+    if (m_fd >= 0)
+    {
+        RemoveUnneededWatches();
+    }
+#endif
+}
+
+size_t FileWatcher::DispatchEvents()
+{
+    std::vector<std::vector<FileWatchEvent>> batches;
+    {
+        std::lock_guard lock(m_queueMutex);
+        batches.swap(m_queuedBatches);
+    }
+    size_t eventCount = 0;
+    for (const std::vector<FileWatchEvent>& batch : batches)
+    {
+        m_callback(batch);
+        eventCount += batch.size();
+    }
+    return eventCount;
+}
+
+void FileWatcher::WorkerMain()
+{
+    using Clock = std::chrono::steady_clock;
+    if (m_isPolling)
+    {
+        Clock::time_point nextPollTime = Clock::now() + m_options.pollInterval;
+        while (true)
+        {
+            const std::chrono::milliseconds waitTime = FlushPendingEvents();
+            Clock::time_point wakeTime = nextPollTime;
+            if (waitTime.count() >= 0)
+            {
+                wakeTime = std::min(wakeTime, Clock::now() + waitTime);
+            }
+            {
+                std::unique_lock lock(m_mutex);
+                if (m_stopCond.wait_until(lock, wakeTime, [&]() { return m_stop; }))
+                {
+                    break;
+                }
+            }
+            if (Clock::now() >= nextPollTime)
+            {
+                PollRoots(true);
+                nextPollTime = Clock::now() + m_options.pollInterval;
+            }
+        }
+        return;
+    }
+
+#if defined(__linux__)
+    while (true)
+    {
+        const std::chrono::milliseconds waitTime = FlushPendingEvents();
+        struct pollfd fds[2] = {};
+        fds[0].fd = m_fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = m_wakeFd;
+        fds[1].events = POLLIN;
+        const int ret = poll(fds, 2, static_cast<int>(waitTime.count()));
+        if ((ret < 0) && (errno != EINTR))
+        {
+            LogGlobal(Error, "FileWatcher: poll failed: {} ({})", strerror(errno), errno);
+            break;
+        }
+        if (fds[1].revents & POLLIN)
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_stop)
+            {
+                break;
+            }
+        }
+        if (fds[0].revents & POLLIN)
+        {
+            ProcessNotifications();
+        }
+    }
+#endif
+}
+
+void FileWatcher::AddPendingEvent(FileWatchAction action, std::string path, bool isDirectory, bool isCreated)
+{
+    const auto now = std::chrono::steady_clock::now();
+    if (m_pendingEvents.empty())
+    {
+        m_firstEventTime = now;
+    }
+    m_lastEventTime = now;
+
+    const bool existedBefore = !((action == FileWatchAction::Added) && isCreated);
+    auto [iter, isInserted] = m_pendingIndices.try_emplace(path, PendingIndex{ m_pendingEvents.size(), existedBefore });
+    if (isInserted)
+    {
+        m_pendingEvents.push_back({ action, std::move(path), isDirectory });
+        return;
+    }
+    FileWatchEvent& event = m_pendingEvents[iter->second.index];
+    const FileWatchAction prevAction = event.action;
+    event.isDirectory = isDirectory;
+    if ((prevAction == FileWatchAction::Overflow) || (action == FileWatchAction::Overflow))
+    {
+        event.action = FileWatchAction::Overflow;
+    }
+    else if ((prevAction == FileWatchAction::Added) && (action == FileWatchAction::Removed))
+    {
+        if (iter->second.existedBefore)
+        {
+            // Replaced (moved in), then removed: the receiver knew the original one.
+            event.action = FileWatchAction::Removed;
+        }
+        else
+        {
+            // Created and removed in the batch (e.g. a temporary file): cancelled,
+            // the empty path is skipped when delivered.
+            event.path.clear();
+            m_pendingIndices.erase(iter);
+        }
+    }
+    else if (prevAction == FileWatchAction::Added)
+    {
+        // Still new to the receiver.
+    }
+    else if (action == FileWatchAction::Removed)
+    {
+        event.action = FileWatchAction::Removed;
+    }
+    else
+    {
+        // Existed before the batch and still exists (replaced, or written again).
+        event.action = FileWatchAction::Modified;
+    }
+}
+
+std::chrono::milliseconds FileWatcher::FlushPendingEvents()
+{
+    std::vector<FileWatchEvent> events;
+    {
+        std::lock_guard lock(m_mutex);
+        if (m_pendingEvents.empty())
+        {
+            return std::chrono::milliseconds(-1);
+        }
+        const auto now = std::chrono::steady_clock::now();
+        const auto quietTime = now - m_lastEventTime;
+        const auto age = now - m_firstEventTime;
+        if ((quietTime < m_options.debounce) && (age < m_options.maxLatency))
+        {
+            const auto waitTime = std::min(m_options.debounce - quietTime, m_options.maxLatency - age);
+            return std::chrono::ceil<std::chrono::milliseconds>(waitTime);
+        }
+        events.reserve(m_pendingEvents.size());
+        for (FileWatchEvent& event : m_pendingEvents)
+        {
+            if (!event.path.empty())
+            {
+                events.push_back(std::move(event));
+            }
+        }
+        m_pendingEvents.clear();
+        m_pendingIndices.clear();
+    }
+    if (!events.empty())
+    {
+        Deliver(std::move(events));
+    }
+    return std::chrono::milliseconds(-1);
+}
+
+void FileWatcher::Deliver(std::vector<FileWatchEvent>&& events)
+{
+    if (m_options.deferDispatch)
+    {
+        std::lock_guard lock(m_queueMutex);
+        m_queuedBatches.push_back(std::move(events));
+    }
+    else
+    {
+        m_callback(events);
+    }
+}
+
+bool FileWatcher::IsWatched(std::string_view directoryPath, std::string_view name) const
+{
+    for (const std::unique_ptr<Root>& root : m_roots)
+    {
+        if ((root->isDirectory && IsSameOrUnder(directoryPath, root->path)) ||
+            ((root->parentPath == directoryPath) && (root->name == name)))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FileWatcher::IsUnderDirectoryRoot(std::string_view directoryPath) const
+{
+    for (const std::unique_ptr<Root>& root : m_roots)
+    {
+        if (root->isDirectory && IsSameOrUnder(directoryPath, root->path))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#if defined(__linux__)
+void FileWatcher::ProcessNotifications()
+{
+    alignas(struct inotify_event) char buffer[64 * 1024];
+    while (true)
+    {
+        const ssize_t bytesRead = read(m_fd, buffer, sizeof(buffer));
+        if (bytesRead <= 0)
+        {
+            if ((bytesRead < 0) && (errno != EAGAIN) && (errno != EINTR))
+            {
+                LogGlobal(Error, "FileWatcher: failed to read inotify events: {} ({})", strerror(errno), errno);
+            }
+            break;
+        }
+
+        std::lock_guard lock(m_mutex);
+        for (ssize_t offset = 0; offset < bytesRead; )
+        {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buffer + offset);
+            offset += sizeof(struct inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                LogGlobal(Warn, "FileWatcher: the inotify queue overflowed, events were lost.");
+                for (const std::unique_ptr<Root>& root : m_roots)
+                {
+                    AddPendingEvent(FileWatchAction::Overflow, root->path, root->isDirectory);
+                }
+                continue;
+            }
+            auto watchIter = m_watchPaths.find(event->wd);
+            if (watchIter == m_watchPaths.end())
+            {
+                continue;
+            }
+            const std::string directoryPath = watchIter->second;
+            if (event->mask & IN_IGNORED)
+            {
+                m_watchDescriptors.erase(directoryPath);
+                m_watchPaths.erase(watchIter);
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+            {
+                // Others are reported by the parents (a root too, if its parent could be watched);
+                // a root is watched again when recreated in its parent.
+                for (const std::unique_ptr<Root>& root : m_roots)
+                {
+                    if (root->isDirectory && (root->path == directoryPath))
+                    {
+                        AddPendingEvent(FileWatchAction::Removed, directoryPath, true);
+                    }
+                }
+                if (event->mask & IN_MOVE_SELF)
+                {
+                    // The watches would report the new location under the old path.
+                    RemoveWatchTree(directoryPath);
+                }
+                continue;
+            }
+
+            const std::string_view name = (event->len > 0) ? std::string_view(event->name) : std::string_view();
+            if (name.empty() || !IsWatched(directoryPath, name))
+            {
+                continue;
+            }
+            const bool isDirectory = (event->mask & IN_ISDIR) != 0;
+            std::string path = JoinPath(directoryPath, name);
+            if (event->mask & (IN_CREATE | IN_MOVED_TO))
+            {
+                AddPendingEvent(FileWatchAction::Added, path, isDirectory, (event->mask & IN_CREATE) != 0);
+                // A new subdirectory, or a directory root recreated.
+                if (isDirectory && IsUnderDirectoryRoot(path))
+                {
+                    AddWatchTree(path, true);
+                }
+            }
+            else if (event->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                if (isDirectory && (event->mask & IN_MOVED_FROM))
+                {
+                    RemoveWatchTree(path);
+                }
+                AddPendingEvent(FileWatchAction::Removed, std::move(path), isDirectory);
+            }
+            else if (event->mask & (IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB))
+            {
+                AddPendingEvent(FileWatchAction::Modified, std::move(path), isDirectory);
+            }
+        }
+    }
+}
+
+bool FileWatcher::AddRootWatches(const Root& root)
+{
+    if (!root.isDirectory)
+    {
+        return AddWatch(root.parentPath);
+    }
+    // Not required: the tree is watched until the root is removed.
+    if (!root.name.empty() && (root.parentPath != root.path))
+    {
+        AddWatch(root.parentPath);
+    }
+    return AddWatchTree(root.path, false);
+}
+
+bool FileWatcher::AddWatchTree(const std::string& directoryPath, bool reportEntries)
+{
+    if (!AddWatch(directoryPath))
+    {
+        return false;
+    }
+    DirectoryWalkOptions options;
+    // A new directory is usually small, don't start threads for it.
+    options.threadCount = reportEntries ? 1 : 0;
+    if (!reportEntries)
+    {
+        options.filter = [](const DirectoryWalkEntry& entry) { return entry.type == FileType::directory; };
+    }
+    bool isWatched = true;
+    for (DirectoryWalkEntry& entry : WalkDirectory(directoryPath, options))
+    {
+        const bool isDirectory = (entry.type == FileType::directory);
+        if (isDirectory)
+        {
+            isWatched = AddWatch(entry.path) && isWatched;
+        }
+        if (reportEntries)
+        {
+            AddPendingEvent(FileWatchAction::Added, std::move(entry.path), isDirectory, true);
+        }
+    }
+    return isWatched;
+}
+
+bool FileWatcher::AddWatch(const std::string& directoryPath)
+{
+    const int wd = inotify_add_watch(m_fd, directoryPath.empty() ? "." : directoryPath.c_str(), WatchMask);
+    if (wd < 0)
+    {
+        LogGlobal(Warn, "FileWatcher: failed to watch {}: {} ({})", directoryPath, strerror(errno), errno);
+        return false;
+    }
+    // The same directory may have been watched under another path (moved).
+    auto iter = m_watchPaths.find(wd);
+    if (iter != m_watchPaths.end())
+    {
+        m_watchDescriptors.erase(iter->second);
+    }
+    m_watchPaths[wd] = directoryPath;
+    m_watchDescriptors[directoryPath] = wd;
+    return true;
+}
+
+void FileWatcher::RemoveWatchTree(const std::string& directoryPath)
+{
+    for (auto iter = m_watchDescriptors.begin(); iter != m_watchDescriptors.end(); )
+    {
+        if (IsSameOrUnder(iter->first, directoryPath))
+        {
+            inotify_rm_watch(m_fd, iter->second);
+            m_watchPaths.erase(iter->second);
+            iter = m_watchDescriptors.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void FileWatcher::RemoveUnneededWatches()
+{
+    for (auto iter = m_watchDescriptors.begin(); iter != m_watchDescriptors.end(); )
+    {
+        const std::string& directoryPath = iter->first;
+        const bool isNeeded = IsUnderDirectoryRoot(directoryPath) ||
+            std::any_of(m_roots.begin(), m_roots.end(),
+                [&](const std::unique_ptr<Root>& root) { return root->parentPath == directoryPath; });
+        if (!isNeeded)
+        {
+            inotify_rm_watch(m_fd, iter->second);
+            m_watchPaths.erase(iter->second);
+            iter = m_watchDescriptors.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+#endif
+
+void FileWatcher::PollRoots(bool reportChanges)
+{
+    std::lock_guard lock(m_mutex);
+    DirectorySnapshot::Options options;
+    // Leave the cores to the application.
+    options.threadCount = 1;
+    for (const std::unique_ptr<Root>& root : m_roots)
+    {
+        if (root->isDirectory)
+        {
+            DirectorySnapshot snapshot;
+            snapshot.Capture(root->path, options);
+            if (reportChanges)
+            {
+                const DirectoryDiff diff = DiffSnapshots(root->snapshot, snapshot);
+                for (const std::string& path : diff.added)
+                {
+                    AddPendingEvent(FileWatchAction::Added, JoinPath(root->path, path),
+                        snapshot.Find(path)->type == FileType::directory, true);
+                }
+                for (const std::string& path : diff.removed)
+                {
+                    AddPendingEvent(FileWatchAction::Removed, JoinPath(root->path, path),
+                        root->snapshot.Find(path)->type == FileType::directory);
+                }
+                for (const std::string& path : diff.modified)
+                {
+                    AddPendingEvent(FileWatchAction::Modified, JoinPath(root->path, path),
+                        snapshot.Find(path)->type == FileType::directory);
+                }
+            }
+            root->snapshot = std::move(snapshot);
+        }
+        else
+        {
+            FileMetadata metadata;
+            GetFileMetadata(root->path, &metadata);
+            if (reportChanges)
+            {
+                if (metadata.Exists() != root->metadata.Exists())
+                {
+                    AddPendingEvent(metadata.Exists() ? FileWatchAction::Added : FileWatchAction::Removed,
+                        root->path, false, true);
+                }
+                else if (metadata.Exists() && ((metadata.type != root->metadata.type) ||
+                    (metadata.size != root->metadata.size) || (metadata.mtimeNs != root->metadata.mtimeNs)))
+                {
+                    AddPendingEvent(FileWatchAction::Modified, root->path, false);
+                }
+            }
+            root->metadata = metadata;
+        }
+    }
+}
+
+} // namespace rad
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "DirectorySnapshot.h"
+#include "FileMetadata.h"
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace rad
+{
+
+enum class FileWatchAction
+{
+    Added,      // Created or moved in; a file replaced by a rename (atomic save) is reported as added.
+    Removed,    // Deleted or moved out.
+    Modified,   // Written or attributes changed (touch).
+    Overflow,   // Events were lost (the kernel queue overflowed): rescan the path.
+};
+
+struct FileWatchEvent
+{
+    FileWatchAction action;
+    // The watched path joined with the relative path.
+    std::string path;
+    bool isDirectory = false;
+};
+
+// Watch directory trees and files for changes, without polling on Linux (inotify): the events are
+// coalesced by path (e.g. added then modified is added, created then removed is nothing)
+// and delivered in batches once the paths have been quiet for the debounce time,
+// so that a burst of writes (saving a shader, copying a folder) results in one callback.
+// Other platforms fall back to comparing DirectorySnapshots every poll interval.
+// Pair with the caches instead of checking the files on every access: e.g. call
+// JsonDocumentCache::Invalidate or FileMetadataCache::InvalidateTree from the callback.
+class FileWatcher
+{
+public:
+    using Callback = std::function<void(const std::vector<FileWatchEvent>& events)>;
+
+    struct Options
+    {
+        // Deliver the events after the paths have been quiet for this long...
+        std::chrono::milliseconds debounce = std::chrono::milliseconds(50);
+        // ...or when the first event is this old, even if the changes go on.
+        std::chrono::milliseconds maxLatency = std::chrono::milliseconds(1000);
+        // Queue the batches for DispatchEvents (e.g. from EventHandler::OnIdle of the DirectMedia event loop)
+        // instead of calling back on the worker thread.
+        bool deferDispatch = false;
+        // Use the polling fallback even if the platform has native notifications.
+        bool usePolling = false;
+        std::chrono::milliseconds pollInterval = std::chrono::milliseconds(500);
+    };
+
+    FileWatcher();
+    // Stop.
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Start the worker thread; the callback is called on the worker unless options.deferDispatch.
+    bool Start(Callback callback, const Options& options);
+    bool Start(Callback callback) { return Start(std::move(callback), Options()); }
+    // Wait for the worker to exit; the pending events are dropped.
+    void Stop();
+    bool IsRunning() const { return m_thread.joinable(); }
+
+    // Watch a directory recursively (the subdirectories created later included), or a single file.
+    // The parent directory is watched too, so that a file is seen when replaced by a rename,
+    // and a directory removed or moved away is watched again when recreated (or moved back).
+    // Can be called before or after Start, from any thread (the callback included).
+    bool AddPath(const FilePath& path);
+    void RemovePath(const FilePath& path);
+
+    // Call back with the batches queued (options.deferDispatch) on the calling thread;
+    // return the number of events dispatched.
+    size_t DispatchEvents();
+
+private:
+    struct Root
+    {
+        std::string path;
+        // The directory containing the root, and the name of the root in it.
+        std::string parentPath;
+        std::string name;
+        bool isDirectory = false;
+        // The state for the polling fallback.
+        DirectorySnapshot snapshot;
+        FileMetadata metadata;
+    };
+
+    void WorkerMain();
+    // Merge the event into the pending ones by path.
+    // @param isCreated: the path didn't exist before (IN_CREATE, not IN_MOVED_TO, which may replace a file).
+    void AddPendingEvent(FileWatchAction action, std::string path, bool isDirectory, bool isCreated = false);
+    // Deliver the pending events if quiet for the debounce time or too old;
+    // return the time to wait for the next delivery, -1 if nothing is pending.
+    std::chrono::milliseconds FlushPendingEvents();
+    void Deliver(std::vector<FileWatchEvent>&& events);
+    // Whether an entry of the directory is watched by a root (under a directory root, or a file root).
+    bool IsWatched(std::string_view directoryPath, std::string_view name) const;
+    bool IsUnderDirectoryRoot(std::string_view directoryPath) const;
+#if defined(__linux__)
+    void ProcessNotifications();
+    // Add the watches of the root: the tree of a directory, and the parent directory.
+    bool AddRootWatches(const Root& root);
+    // Add the watches of the directory and its subdirectories; report their entries as added
+    // (they may have been created before the watches).
+    bool AddWatchTree(const std::string& directoryPath, bool reportEntries);
+    bool AddWatch(const std::string& directoryPath);
+    // Remove the watches of the directory and its subdirectories.
+    void RemoveWatchTree(const std::string& directoryPath);
+    // Remove the watches no root needs anymore.
+    void RemoveUnneededWatches();
+#endif
+    void PollRoots(bool reportChanges);
+
+    Callback m_callback;
+    Options m_options;
+    bool m_isPolling = false;
+
+    // Guard the roots, the watches and the pending events.
+    std::mutex m_mutex;
+    std::vector<std::unique_ptr<Root>> m_roots;
+    // Between Start and Stop (the watches are added by AddPath).
+    bool m_isStarted = false;
+    int m_fd = -1;
+    // eventfd to wake the worker up from poll.
+    int m_wakeFd = -1;
+    std::unordered_map<int, std::string> m_watchPaths;
+    std::unordered_map<std::string, int> m_watchDescriptors;
+
+    struct PendingIndex
+    {
+        size_t index;
+        // Whether the path existed before its first event in the batch.
+        bool existedBefore;
+    };
+    std::vector<FileWatchEvent> m_pendingEvents;
+    // The index of the pending event by path.
+    std::unordered_map<std::string, PendingIndex> m_pendingIndices;
+    std::chrono::steady_clock::time_point m_firstEventTime;
+    std::chrono::steady_clock::time_point m_lastEventTime;
+
+    std::mutex m_queueMutex;
+    std::vector<std::vector<FileWatchEvent>> m_queuedBatches;
+
+    std::thread m_thread;
+    std::condition_variable m_stopCond;
+    bool m_stop = false;
+
+}; // class FileWatcher
+
+} // namespace rad
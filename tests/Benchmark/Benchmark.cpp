@@ -0,0 +1,39 @@
+#include "Benchmark.h"
+#include "rad/IO/File.h"
+#include "rad/System/FileSystem.h"
+
+static constexpr size_t BenchmarkTextFileSize = 128 * 1024 * 1024;
+
+const std::string& GetBenchmarkTextFile()
+{
+    static const std::string s_fileName = []() {
+        std::string fileName = "BenchmarkText.csv";
+        if (rad::Exists(fileName) && (rad::GetFileSize(fileName) >= BenchmarkTextFileSize))
+        {
+            return fileName;
+        }
+        rad::File file;
+        file.Open(fileName, "wb");
+        std::string line;
+        uint64_t seed = 0x9E3779B97F4A7C15;
+        size_t bytesWritten = 0;
+        while (bytesWritten < BenchmarkTextFileSize)
+        {
+            // xorshift: deterministic line lengths and contents.
+            seed ^= seed << 13;
+            seed ^= seed >> 7;
+            seed ^= seed << 17;
+            line = rad::StrFormat("line,{},{},{}", bytesWritten, seed,
+                std::string(seed % 120, static_cast<char>('A' + seed % 26)));
+            for (int field = 0; field < 4; ++field)
+            {
+                line += rad::StrFormat(",{}", (seed >> (field * 8)) & 0xFF);
+            }
+            line.push_back('\n');
+            file.Write(line.data(), line.size());
+            bytesWritten += line.size();
+        }
+        return fileName;
+    }();
+    return s_fileName;
+}
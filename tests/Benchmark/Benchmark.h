@@ -0,0 +1,9 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include "rad/Core/Global.h"
+#include "rad/Core/String.h"
+
+// Generate the test file once (in the working directory) and return its path.
+// Lines are like "line,123,ABCDEFGH...\n", with 8 comma separated fields.
+const std::string& GetBenchmarkTextFile();
@@ -0,0 +1,57 @@
+#include "Benchmark.h"
+#include "rad/IO/File.h"
+#include "rad/IO/BufferedWriter.h"
+#include <cstdio>
+
+static constexpr size_t RecordSize = 100;
+static constexpr size_t RecordCount = 1024 * 1024;
+
+static const std::string& GetRecord()
+{
+    static const std::string record = std::string(RecordSize - 1, 'x') + '\n';
+    return record;
+}
+
+// stdio with the default buffer.
+static void BM_FileWriteRecords(benchmark::State& state)
+{
+    const std::string& record = GetRecord();
+    for (auto _ : state)
+    {
+        rad::File file;
+        file.Open("BenchmarkWrite.txt", "wb");
+        for (size_t i = 0; i < RecordCount; ++i)
+        {
+            file.Write(record.data(), record.size());
+        }
+        file.Close();
+    }
+    state.SetBytesProcessed(state.iterations() * RecordSize * RecordCount);
+    std::remove("BenchmarkWrite.txt");
+}
+BENCHMARK(BM_FileWriteRecords)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// @param range(0): direct I/O; range(1): background flush.
+static void BM_BufferedWriterRecords(benchmark::State& state)
+{
+    const std::string& record = GetRecord();
+    rad::BufferedWriter::Options options;
+    options.directIO = (state.range(0) != 0);
+    options.backgroundFlush = (state.range(1) != 0);
+    options.syncPolicy = rad::BufferedWriter::SyncPolicy::None;
+    for (auto _ : state)
+    {
+        rad::BufferedWriter writer;
+        writer.Open("BenchmarkWrite.txt", options);
+        for (size_t i = 0; i < RecordCount; ++i)
+        {
+            writer.Write(record);
+        }
+        writer.Close();
+    }
+    state.SetBytesProcessed(state.iterations() * RecordSize * RecordCount);
+    std::remove("BenchmarkWrite.txt");
+}
+BENCHMARK(BM_BufferedWriterRecords)->ArgNames({ "direct", "background" })
+    ->Args({ 0, 0 })->Args({ 0, 1 })->Args({ 1, 0 })->Args({ 1, 1 })
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
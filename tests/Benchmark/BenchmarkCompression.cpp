@@ -0,0 +1,47 @@
+#include "Benchmark.h"
+#include "rad/IO/Compression.h"
+#include "rad/IO/MappedFile.h"
+#include "rad/System/FileSystem.h"
+
+// @param range(0): the number of compression threads.
+static void BM_CompressFile(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    rad::MappedFile file;
+    file.Open(fileName);
+    file.Map();
+    rad::CompressedWriter::Options options;
+    options.threadCount = static_cast<uint32_t>(state.range(0));
+    options.writerOptions.syncPolicy = rad::BufferedWriter::SyncPolicy::None;
+    uint64_t compressedSize = 0;
+    for (auto _ : state)
+    {
+        rad::CompressedWriter writer;
+        writer.Open("BenchmarkText.csv.zst", options);
+        writer.Write(file.GetString());
+        writer.Close();
+        compressedSize = rad::GetFileSize("BenchmarkText.csv.zst");
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.GetSize()));
+    state.counters["ratio"] = double(file.GetSize()) / double(compressedSize);
+}
+BENCHMARK(BM_CompressFile)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_DecompressFile(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    if (!rad::Exists("BenchmarkText.csv.zst"))
+    {
+        rad::CompressedWriter writer;
+        writer.Open("BenchmarkText.csv.zst");
+        writer.Write(rad::File::ReadAll(fileName));
+        writer.Close();
+    }
+    for (auto _ : state)
+    {
+        std::string content = rad::CompressedReader::ReadAll("BenchmarkText.csv.zst");
+        benchmark::DoNotOptimize(content.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_DecompressFile)->UseRealTime()->Unit(benchmark::kMillisecond);
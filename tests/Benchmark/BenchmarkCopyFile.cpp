@@ -0,0 +1,102 @@
+#include "Benchmark.h"
+#include "rad/IO/File.h"
+#include "rad/System/FileSystem.h"
+
+// Generate a tree of 64 directories with 64 files of 4 KiB each, once.
+static const rad::FilePath& GetBenchmarkTree()
+{
+    static const rad::FilePath root = []() {
+        const rad::FilePath root = "BenchmarkTree";
+        constexpr int DirCount = 64;
+        constexpr int FileCountPerDir = 64;
+        if (!rad::Exists(root))
+        {
+            const std::string content(4096, 'x');
+            for (int i = 0; i < DirCount; ++i)
+            {
+                const rad::FilePath dir = root / std::to_string(i);
+                rad::CreateDirectories(dir);
+                for (int j = 0; j < FileCountPerDir; ++j)
+                {
+                    rad::File file;
+                    file.Open((dir / (std::to_string(j) + ".txt")).string(), "wb");
+                    file.Write(content.data(), content.size());
+                }
+            }
+        }
+        return root;
+        }();
+    return root;
+}
+
+static void BM_CopyLargeFileReadWrite(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    std::vector<char> buffer(1024 * 1024);
+    for (auto _ : state)
+    {
+        rad::File from;
+        rad::File to;
+        from.Open(fileName, "rb");
+        to.Open("BenchmarkCopy.csv", "wb");
+        while (size_t bytesRead = from.Read(buffer.data(), 1, buffer.size()))
+        {
+            to.Write(buffer.data(), 1, bytesRead);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+    rad::Remove("BenchmarkCopy.csv");
+}
+BENCHMARK(BM_CopyLargeFileReadWrite)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_CopyLargeFileStd(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        std::filesystem::copy_file(fileName, "BenchmarkCopy.csv", rad::FileCopyOptions::overwrite_existing);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+    rad::Remove("BenchmarkCopy.csv");
+}
+BENCHMARK(BM_CopyLargeFileStd)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_CopyLargeFile(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        rad::CopyFile(fileName, "BenchmarkCopy.csv", rad::FileCopyOptions::overwrite_existing);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+    rad::Remove("BenchmarkCopy.csv");
+}
+BENCHMARK(BM_CopyLargeFile)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_CopyTreeStd(benchmark::State& state)
+{
+    const rad::FilePath& root = GetBenchmarkTree();
+    for (auto _ : state)
+    {
+        std::filesystem::copy(root, "BenchmarkTreeCopy", rad::FileCopyOptions::recursive);
+        state.PauseTiming();
+        rad::RemoveAll("BenchmarkTreeCopy");
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_CopyTreeStd)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// @param range(0): the number of threads.
+static void BM_CopyTreeParallel(benchmark::State& state)
+{
+    const rad::FilePath& root = GetBenchmarkTree();
+    for (auto _ : state)
+    {
+        rad::CopyParallel(root, "BenchmarkTreeCopy", rad::FileCopyOptions::recursive,
+            static_cast<uint32_t>(state.range(0)));
+        state.PauseTiming();
+        rad::RemoveAll("BenchmarkTreeCopy");
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_CopyTreeParallel)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
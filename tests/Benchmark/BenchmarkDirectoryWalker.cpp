@@ -0,0 +1,114 @@
+#include "Benchmark.h"
+#include "rad/IO/File.h"
+#include "rad/System/DirectorySnapshot.h"
+#include "rad/System/DirectoryWalker.h"
+#include <atomic>
+
+// Generate a tree of 8x8x8 directories with 64 empty files in each leaf, once.
+static const rad::FilePath& GetWalkTree()
+{
+    static const rad::FilePath root = []() {
+        const rad::FilePath root = "BenchmarkWalkTree";
+        constexpr int FanOut = 8;
+        constexpr int FileCountPerDir = 64;
+        if (!rad::Exists(root))
+        {
+            for (int i = 0; i < FanOut * FanOut * FanOut; ++i)
+            {
+                const rad::FilePath dir = root / std::to_string(i / (FanOut * FanOut)) /
+                    std::to_string(i / FanOut % FanOut) / std::to_string(i % FanOut);
+                rad::CreateDirectories(dir);
+                for (int j = 0; j < FileCountPerDir; ++j)
+                {
+                    rad::File file;
+                    file.Open((dir / (std::to_string(j) + ".txt")).string(), "wb");
+                }
+            }
+        }
+        return root;
+        }();
+    return root;
+}
+
+static void BM_WalkDirectoryStd(benchmark::State& state)
+{
+    const rad::FilePath& root = GetWalkTree();
+    size_t fileCount = 0;
+    for (auto _ : state)
+    {
+        fileCount = 0;
+        for (const rad::DirectoryEntry& entry : rad::RecursiveDirectorIterator(root))
+        {
+            fileCount += entry.is_regular_file() ? 1 : 0;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fileCount));
+}
+BENCHMARK(BM_WalkDirectoryStd)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// @param range(0): the number of threads.
+static void BM_WalkDirectory(benchmark::State& state)
+{
+    const rad::FilePath& root = GetWalkTree();
+    rad::DirectoryWalkOptions options;
+    options.threadCount = static_cast<uint32_t>(state.range(0));
+    std::atomic<size_t> fileCount = 0;
+    for (auto _ : state)
+    {
+        fileCount = 0;
+        rad::WalkDirectoryBatched(root, [&](std::vector<rad::DirectoryWalkEntry>& batch) {
+            size_t count = 0;
+            for (const rad::DirectoryWalkEntry& entry : batch)
+            {
+                count += (entry.type == rad::FileType::regular) ? 1 : 0;
+            }
+            fileCount += count;
+            }, options);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(fileCount));
+}
+BENCHMARK(BM_WalkDirectory)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// @param range(0): the number of threads.
+static void BM_CaptureDirectorySnapshot(benchmark::State& state)
+{
+    const rad::FilePath& root = GetWalkTree();
+    rad::DirectorySnapshot::Options options;
+    options.threadCount = static_cast<uint32_t>(state.range(0));
+    rad::DirectorySnapshot snapshot;
+    for (auto _ : state)
+    {
+        snapshot.Capture(root, options);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(snapshot.GetEntries().size()));
+}
+BENCHMARK(BM_CaptureDirectorySnapshot)->RangeMultiplier(4)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+static void BM_DiffDirectorySnapshots(benchmark::State& state)
+{
+    const rad::FilePath& root = GetWalkTree();
+    rad::DirectorySnapshot snapshot;
+    snapshot.Capture(root);
+    for (auto _ : state)
+    {
+        rad::DirectoryDiff diff = rad::DiffSnapshots(snapshot, snapshot);
+        benchmark::DoNotOptimize(diff);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(snapshot.GetEntries().size()));
+}
+BENCHMARK(BM_DiffDirectorySnapshots)->Unit(benchmark::kMicrosecond);
+
+static void BM_LoadDirectorySnapshot(benchmark::State& state)
+{
+    const rad::FilePath& root = GetWalkTree();
+    rad::DirectorySnapshot snapshot;
+    snapshot.Capture(root);
+    snapshot.Save("BenchmarkWalkTree.snap");
+    for (auto _ : state)
+    {
+        snapshot.Load("BenchmarkWalkTree.snap");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(snapshot.GetEntries().size()));
+    state.counters["FileSize"] = static_cast<double>(rad::GetFileSize("BenchmarkWalkTree.snap"));
+}
+BENCHMARK(BM_LoadDirectorySnapshot)->Unit(benchmark::kMicrosecond);
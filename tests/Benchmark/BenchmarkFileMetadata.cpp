@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "rad/IO/File.h"
+#include "rad/System/FileMetadata.h"
+
+// Generate 4096 small files in 64 directories once, and return their paths.
+static const std::vector<rad::FilePath>& GetMetadataFiles()
+{
+    static const std::vector<rad::FilePath> paths = []() {
+        const rad::FilePath root = "BenchmarkMetadataTree";
+        std::vector<rad::FilePath> paths;
+        for (int i = 0; i < 4096; ++i)
+        {
+            const rad::FilePath dir = root / std::to_string(i / 64);
+            const rad::FilePath path = dir / (std::to_string(i % 64) + ".txt");
+            if (!rad::Exists(path))
+            {
+                rad::CreateDirectories(dir);
+                rad::File file;
+                file.Open(path.string(), "wb");
+                file.Write(path.string().data(), path.string().size());
+            }
+            paths.push_back(path);
+        }
+        return paths;
+        }();
+    return paths;
+}
+
+// What a build tool typically asks per input with the std::filesystem helpers.
+static void BM_FileQueriesStd(benchmark::State& state)
+{
+    const std::vector<rad::FilePath>& paths = GetMetadataFiles();
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const rad::FilePath& path : paths)
+        {
+            if (rad::IsRegularFile(path))
+            {
+                sum += rad::GetFileSize(path);
+                sum += rad::GetLastWriteTime(path).time_since_epoch().count();
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(paths.size()));
+}
+BENCHMARK(BM_FileQueriesStd)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// @param range(0): the number of threads.
+static void BM_GetFileMetadata(benchmark::State& state)
+{
+    const std::vector<rad::FilePath>& paths = GetMetadataFiles();
+    rad::FileMetadataOptions options;
+    options.threadCount = static_cast<uint32_t>(state.range(0));
+    for (auto _ : state)
+    {
+        std::vector<rad::FileMetadata> results = rad::GetFileMetadata(paths, options);
+        benchmark::DoNotOptimize(results.data());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(paths.size()));
+}
+BENCHMARK(BM_GetFileMetadata)->RangeMultiplier(2)->Range(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+static void BM_FileMetadataCache(benchmark::State& state)
+{
+    const std::vector<rad::FilePath>& paths = GetMetadataFiles();
+    rad::FileMetadataCache cache;
+    cache.Get(paths);
+    for (auto _ : state)
+    {
+        uint64_t sum = 0;
+        for (const rad::FilePath& path : paths)
+        {
+            const rad::FileMetadata metadata = cache.Get(path);
+            sum += metadata.IsRegularFile() ? metadata.size + metadata.mtimeNs : 0;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(paths.size()));
+}
+BENCHMARK(BM_FileMetadataCache)->UseRealTime()->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,144 @@
+#include "Benchmark.h"
+#include "rad/Core/Hash.h"
+#include "rad/IO/File.h"
+#include "rad/System/FileHash.h"
+#include <functional>
+#include <random>
+
+static const std::string& GetHashInput()
+{
+    static const std::string input = []() {
+        std::string input(16 * 1024 * 1024, '\0');
+        std::mt19937_64 random(1234);
+        for (char& c : input)
+        {
+            c = static_cast<char>(random());
+        }
+        return input;
+        }();
+    return input;
+}
+
+// @param range(0): the size of the input; range(1): the kernel.
+static void BM_HashBytes64(benchmark::State& state)
+{
+    const std::string_view input = std::string_view(GetHashInput()).substr(0, state.range(0));
+    const rad::HashKernel kernel = static_cast<rad::HashKernel>(state.range(1));
+    if (!rad::IsHashKernelSupported(kernel))
+    {
+        state.SkipWithError("The kernel is not supported.");
+        return;
+    }
+    state.SetLabel(rad::GetHashKernelName(kernel));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(rad::HashBytes64(input.data(), input.size(), 0, kernel));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_HashBytes64)->ArgsProduct({ { 16, 256, 4096, 1 << 20 }, { 0, 1, 2, 3 } });
+
+static void BM_HashBytes128(benchmark::State& state)
+{
+    const std::string_view input = std::string_view(GetHashInput()).substr(0, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(rad::HashBytes128(input.data(), input.size()));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_HashBytes128)->Arg(16)->Arg(256)->Arg(4096)->Arg(1 << 20);
+
+// The baseline: std::hash of the standard library (MurmurHash2 in libstdc++).
+static void BM_HashStd(benchmark::State& state)
+{
+    const std::string_view input = std::string_view(GetHashInput()).substr(0, state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(std::hash<std::string_view>()(input));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_HashStd)->Arg(16)->Arg(256)->Arg(4096)->Arg(1 << 20);
+
+// Hash 16MiB in pieces of range(0) bytes.
+static void BM_Hasher(benchmark::State& state)
+{
+    const std::string& input = GetHashInput();
+    const size_t pieceSize = static_cast<size_t>(state.range(0));
+    rad::Hasher hasher;
+    for (auto _ : state)
+    {
+        hasher.Reset();
+        for (size_t offset = 0; offset < input.size(); offset += pieceSize)
+        {
+            hasher.Update(input.data() + offset, std::min(pieceSize, input.size() - offset));
+        }
+        benchmark::DoNotOptimize(hasher.Digest128());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.size()));
+}
+BENCHMARK(BM_Hasher)->Arg(100)->Arg(4096)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
+
+// Generate 256 files of 256KiB once (64MiB, one in four is a duplicate), and return their paths.
+static const std::vector<rad::FilePath>& GetHashFiles()
+{
+    static const std::vector<rad::FilePath> paths = []() {
+        const rad::FilePath root = "BenchmarkHashTree";
+        const std::string& input = GetHashInput();
+        constexpr size_t FileSize = 256 * 1024;
+        std::vector<rad::FilePath> paths;
+        for (size_t i = 0; i < 256; ++i)
+        {
+            const rad::FilePath dir = root / std::to_string(i / 16);
+            const rad::FilePath path = dir / (std::to_string(i % 16) + ".bin");
+            if (!rad::Exists(path))
+            {
+                rad::CreateDirectories(dir);
+                rad::File file;
+                file.Open(path.string(), "wb");
+                // Distinct windows of the input, the fourth file is a copy of the third.
+                const size_t source = (i % 4 == 3) ? (i - 1) : i;
+                file.Write(input.data() + source * 60 * 1024, FileSize);
+            }
+            paths.push_back(path);
+        }
+        return paths;
+        }();
+    return paths;
+}
+
+// @param range(0): the number of threads.
+static void BM_HashFiles(benchmark::State& state)
+{
+    const std::vector<rad::FilePath>& paths = GetHashFiles();
+    rad::FileHashOptions options;
+    options.threadCount = static_cast<uint32_t>(state.range(0));
+    uint64_t size = 0;
+    for (auto _ : state)
+    {
+        std::vector<rad::FileHashResult> results = rad::HashFiles(paths, options);
+        size = 0;
+        for (const rad::FileHashResult& result : results)
+        {
+            size += result.size;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size));
+}
+BENCHMARK(BM_HashFiles)->RangeMultiplier(2)->Range(1, 16)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// @param range(0): the number of threads; range(1): the prefix size (0 to hash the whole files at once).
+static void BM_FindDuplicateFiles(benchmark::State& state)
+{
+    GetHashFiles();
+    rad::DuplicateFileOptions options;
+    options.threadCount = static_cast<uint32_t>(state.range(0));
+    options.prefixSize = static_cast<uint64_t>(state.range(1));
+    for (auto _ : state)
+    {
+        std::vector<rad::DuplicateFileGroup> groups = rad::FindDuplicateFiles("BenchmarkHashTree", options);
+        benchmark::DoNotOptimize(groups.data());
+    }
+}
+BENCHMARK(BM_FindDuplicateFiles)->ArgsProduct({ { 1, 4 }, { 0, 4096 } })->UseRealTime()->Unit(benchmark::kMillisecond);
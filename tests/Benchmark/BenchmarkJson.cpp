@@ -0,0 +1,407 @@
+#include "Benchmark.h"
+#include "rad/IO/Json.h"
+#include "rad/IO/JsonLines.h"
+#include "rad/IO/JsonBinding.h"
+#include "rad/IO/JsonBinary.h"
+#include "rad/IO/JsonWriter.h"
+#include "rad/IO/JsonCache.h"
+#include "rad/IO/JsonScanner.h"
+
+// Config: nested objects with short strings, like the application settings.
+static const std::string& GetConfigDocument()
+{
+    static const std::string doc = []()
+        {
+            std::string str = "{";
+            for (int i = 0; i < 200; ++i)
+            {
+                str += rad::StrFormat(R"({}"section{}": {{"enabled": true, "name": "section {}", "path": "/usr/share/rad/{}",)"
+                    R"( "scale": 1.5, "size": [1920, 1080], "tags": ["alpha", "beta", "gamma"], "options": {{)",
+                    (i > 0) ? "," : "", i, i, i);
+                for (int j = 0; j < 10; ++j)
+                {
+                    str += rad::StrFormat(R"({}"option{}": {{"value": {}, "comment": "option {} of section {}"}})",
+                        (j > 0) ? "," : "", j, i * j, j, i);
+                }
+                str += "}}";
+            }
+            str += "}";
+            return str;
+        }();
+    return doc;
+}
+
+// Telemetry: a large array of flat records, mostly numbers.
+static const std::string& GetTelemetryDocument()
+{
+    static const std::string doc = []()
+        {
+            std::string str = R"({"device": "sensor-0001", "samples": [)";
+            for (int i = 0; i < 20000; ++i)
+            {
+                str += rad::StrFormat(R"({}{{"t": {}, "cpu": {:.3f}, "mem": {}, "temp": {:.2f}, "ok": {}}})",
+                    (i > 0) ? "," : "", 1700000000000ll + i * 10, (i % 1000) / 10.0, 1024 * 1024 + i,
+                    40.0 + (i % 300) / 10.0, (i % 7) ? "true" : "false");
+            }
+            str += "]}";
+            return str;
+        }();
+    return doc;
+}
+
+static const std::string& GetDocument(int64_t index)
+{
+    return (index == 0) ? GetConfigDocument() : GetTelemetryDocument();
+}
+
+// Parse and destroy with the default heap storage.
+// @param range(0): 0 for the config document, 1 for the telemetry document.
+static void BM_ParseJsonDefault(benchmark::State& state)
+{
+    const std::string& doc = GetDocument(state.range(0));
+    for (auto _ : state)
+    {
+        boost::json::value value = rad::ParseJson(doc);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(doc.size()));
+}
+BENCHMARK(BM_ParseJsonDefault)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_ParseJsonMonotonic(benchmark::State& state)
+{
+    const std::string& doc = GetDocument(state.range(0));
+    for (auto _ : state)
+    {
+        boost::json::monotonic_resource arena;
+        boost::json::value value = rad::ParseJson(doc, &arena);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(doc.size()));
+}
+BENCHMARK(BM_ParseJsonMonotonic)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Reuse the parser, and the arena memory from the previous document.
+static void BM_ParseJsonReused(benchmark::State& state)
+{
+    const std::string& doc = GetDocument(state.range(0));
+    rad::JsonParser parser;
+    std::vector<unsigned char> arenaBuffer(doc.size() * 4);
+    for (auto _ : state)
+    {
+        boost::json::monotonic_resource arena(arenaBuffer.data(), arenaBuffer.size());
+        boost::json::value value = parser.Parse(doc, &arena);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(doc.size()));
+}
+BENCHMARK(BM_ParseJsonReused)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Telemetry records as JSON Lines.
+static const std::string& GetJsonLinesDocument()
+{
+    static const std::string doc = []()
+        {
+            std::string str;
+            for (int i = 0; i < 200000; ++i)
+            {
+                str += rad::StrFormat(R"({{"t": {}, "device": "sensor-{:04}", "cpu": {:.3f}, "mem": {}, "ok": {}}})" "\n",
+                    1700000000000ll + i * 10, i % 1000, (i % 1000) / 10.0, 1024 * 1024 + i, (i % 7) ? "true" : "false");
+            }
+            return str;
+        }();
+    return doc;
+}
+
+// Baseline: line by line on one thread.
+static void BM_ParseJsonLinesSerial(benchmark::State& state)
+{
+    const std::string& doc = GetJsonLinesDocument();
+    for (auto _ : state)
+    {
+        size_t recordCount = 0;
+        rad::ForEachLine(doc, [&](std::string_view line) {
+            boost::json::value value = rad::ParseJson(line);
+            benchmark::DoNotOptimize(value);
+            recordCount++;
+            });
+        benchmark::DoNotOptimize(recordCount);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(doc.size()));
+}
+BENCHMARK(BM_ParseJsonLinesSerial)->Unit(benchmark::kMillisecond);
+
+// @param range(0): the number of threads.
+static void BM_ParseJsonLines(benchmark::State& state)
+{
+    const std::string& doc = GetJsonLinesDocument();
+    rad::ThreadPool threadPool(static_cast<uint32_t>(state.range(0)));
+    rad::TextChunkOptions options;
+    options.chunkSize = 1024 * 1024;
+    options.threadPool = &threadPool;
+    options.ordered = false;
+    for (auto _ : state)
+    {
+        size_t recordCount = 0;
+        rad::ParseJsonLines(doc, [&](rad::JsonLinesBatch&& batch) { recordCount += batch.records.size(); }, options);
+        benchmark::DoNotOptimize(recordCount);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(doc.size()));
+}
+BENCHMARK(BM_ParseJsonLines)->RangeMultiplier(2)->Range(1, 16)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+struct SampleRecord
+{
+    int64_t t = 0;
+    std::string device;
+    double cpu = 0;
+    uint64_t mem = 0;
+    bool ok = false;
+};
+RAD_JSON_BINDING(SampleRecord, t, device, cpu, mem, ok)
+
+static const std::vector<boost::json::value>& GetJsonLinesRecords()
+{
+    static const std::vector<boost::json::value> records = rad::ParseJsonLines(GetJsonLinesDocument());
+    return records;
+}
+
+// Baseline: look up each member with JsonRef.
+static void BM_ReadRecordsJsonRef(benchmark::State& state)
+{
+    const std::vector<boost::json::value>& records = GetJsonLinesRecords();
+    for (auto _ : state)
+    {
+        for (const boost::json::value& jv : records)
+        {
+            rad::JsonRef ref(jv);
+            SampleRecord record;
+            record.t = ref.FindMember("t").GetInt64();
+            record.device = ref.FindMember("device").GetString();
+            record.cpu = ref.FindMember("cpu").GetDouble();
+            record.mem = ref.FindMember("mem").GetInt64();
+            record.ok = ref.FindMember("ok").GetBool();
+            benchmark::DoNotOptimize(record);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(records.size()));
+}
+BENCHMARK(BM_ReadRecordsJsonRef)->Unit(benchmark::kMillisecond);
+
+static void BM_ReadRecordsBinding(benchmark::State& state)
+{
+    const std::vector<boost::json::value>& records = GetJsonLinesRecords();
+    for (auto _ : state)
+    {
+        for (const boost::json::value& jv : records)
+        {
+            SampleRecord record;
+            rad::ReadJson(jv, record);
+            benchmark::DoNotOptimize(record);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(records.size()));
+}
+BENCHMARK(BM_ReadRecordsBinding)->Unit(benchmark::kMillisecond);
+
+// Encode and decode, compared with the text format.
+// @param range(0): 0 for the config document, 1 for the telemetry document.
+// @param range(1): 0 for text JSON, 1 for CBOR, 2 for MessagePack.
+static void BM_EncodeJson(benchmark::State& state)
+{
+    const boost::json::value value = rad::ParseJson(GetDocument(state.range(0)));
+    const int64_t format = state.range(1);
+    std::string buffer;
+    for (auto _ : state)
+    {
+        buffer.clear();
+        if (format == 0)
+        {
+            buffer = boost::json::serialize(value);
+        }
+        else
+        {
+            rad::EncodeBinaryJson(value, (format == 1) ? rad::BinaryJsonFormat::Cbor : rad::BinaryJsonFormat::MessagePack,
+                buffer);
+        }
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.counters["size"] = static_cast<double>(buffer.size());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(buffer.size()));
+}
+BENCHMARK(BM_EncodeJson)->ArgsProduct({ { 0, 1 }, { 0, 1, 2 } })->Unit(benchmark::kMicrosecond);
+
+static void BM_DecodeJson(benchmark::State& state)
+{
+    const boost::json::value value = rad::ParseJson(GetDocument(state.range(0)));
+    const int64_t format = state.range(1);
+    const rad::BinaryJsonFormat binaryFormat =
+        (format == 1) ? rad::BinaryJsonFormat::Cbor : rad::BinaryJsonFormat::MessagePack;
+    const std::string encoded = (format == 0) ? boost::json::serialize(value) : rad::EncodeBinaryJson(value, binaryFormat);
+    for (auto _ : state)
+    {
+        boost::json::value decoded;
+        if (format == 0)
+        {
+            decoded = rad::ParseJson(encoded);
+        }
+        else
+        {
+            rad::DecodeBinaryJson(encoded, binaryFormat, decoded);
+        }
+        benchmark::DoNotOptimize(decoded);
+    }
+    state.counters["size"] = static_cast<double>(encoded.size());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(encoded.size()));
+}
+BENCHMARK(BM_DecodeJson)->ArgsProduct({ { 0, 1 }, { 0, 1, 2 } })->Unit(benchmark::kMicrosecond);
+
+// Navigate "options.option5.value" of each section of the config document.
+static void BM_FindMemberChain(benchmark::State& state)
+{
+    const boost::json::value value = rad::ParseJson(GetConfigDocument());
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        for (const boost::json::key_value_pair& section : value.get_object())
+        {
+            rad::JsonRef ref(section.value());
+            sum += ref.FindMember("options").FindMember("option5").FindMember("value").GetInt64();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(value.get_object().size()));
+}
+BENCHMARK(BM_FindMemberChain)->Unit(benchmark::kMicrosecond);
+
+static void BM_JsonPath(benchmark::State& state)
+{
+    const boost::json::value value = rad::ParseJson(GetConfigDocument());
+    const rad::JsonPath path("options.option5.value");
+    for (auto _ : state)
+    {
+        int64_t sum = 0;
+        for (const boost::json::key_value_pair& section : value.get_object())
+        {
+            sum += rad::JsonRef(section.value()).FindPath(path).GetInt64();
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(value.get_object().size()));
+}
+BENCHMARK(BM_JsonPath)->Unit(benchmark::kMicrosecond);
+
+// Serialize to a file: boost::json::serialize to a temporary string then write, or JsonWriter.
+// @param range(0): 0 for the config document, 1 for the telemetry document.
+static void BM_SerializeJsonToFile(benchmark::State& state)
+{
+    const boost::json::value value = rad::ParseJson(GetDocument(state.range(0)));
+    for (auto _ : state)
+    {
+        rad::File file;
+        file.Open("BenchmarkJson.json", "wb");
+        std::string str = boost::json::serialize(value);
+        file.Write(str.data(), str.size());
+        file.Close();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::SerializeJson(value).size()));
+}
+BENCHMARK(BM_SerializeJsonToFile)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_JsonWriterToFile(benchmark::State& state)
+{
+    const boost::json::value value = rad::ParseJson(GetDocument(state.range(0)));
+    for (auto _ : state)
+    {
+        rad::File file;
+        file.Open("BenchmarkJson.json", "wb");
+        rad::JsonWriter writer(&file);
+        writer.Write(value);
+        writer.Flush();
+        file.Close();
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::SerializeJson(value).size()));
+}
+BENCHMARK(BM_JsonWriterToFile)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+// Reload an unchanged config file: parse every time vs. the cache (stat only).
+
+static void BM_ReloadConfigParse(benchmark::State& state)
+{
+    rad::WriteJsonToFile(rad::ParseJson(GetConfigDocument()), "BenchmarkJsonConfig.json");
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(rad::ParseJsonFromFile("BenchmarkJsonConfig.json"));
+    }
+}
+BENCHMARK(BM_ReloadConfigParse)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReloadConfigCache(benchmark::State& state)
+{
+    rad::WriteJsonToFile(rad::ParseJson(GetConfigDocument()), "BenchmarkJsonConfig.json");
+    rad::JsonDocumentCache cache;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(cache.Get("BenchmarkJsonConfig.json"));
+    }
+}
+BENCHMARK(BM_ReloadConfigCache)->Unit(benchmark::kMicrosecond);
+
+// Validate with the structural scanner of each kernel, and parse to events or DOM.
+
+static void BM_ScanJson(benchmark::State& state)
+{
+    const std::string& json = GetDocument(state.range(0));
+    const rad::JsonScanKernel kernel = static_cast<rad::JsonScanKernel>(state.range(1));
+    if (!rad::IsJsonScanKernelSupported(kernel))
+    {
+        state.SkipWithError("The kernel is not supported.");
+        return;
+    }
+    rad::JsonScanner scanner(kernel);
+    state.SetLabel(rad::GetJsonScanKernelName(kernel));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scanner.Scan(json));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ScanJson)->ArgsProduct({ { 0, 1 }, { 0, 1, 2, 3 } })->Unit(benchmark::kMicrosecond);
+
+static void BM_ValidateJson(benchmark::State& state)
+{
+    const std::string& json = GetDocument(state.range(0));
+    rad::JsonScanner scanner;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(scanner.Validate(json));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ValidateJson)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_ValidateJsonStream(benchmark::State& state)
+{
+    const std::string& json = GetDocument(state.range(0));
+    rad::JsonHandler handler;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(rad::ParseJson(json, &handler));
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ValidateJsonStream)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+static void BM_ParseJsonScanner(benchmark::State& state)
+{
+    const std::string& json = GetDocument(state.range(0));
+    rad::JsonScanner scanner;
+    for (auto _ : state)
+    {
+        boost::json::value value;
+        scanner.Parse(json, value);
+        benchmark::DoNotOptimize(value);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_ParseJsonScanner)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
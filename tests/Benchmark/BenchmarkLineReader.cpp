@@ -0,0 +1,88 @@
+#include "Benchmark.h"
+#include "rad/IO/File.h"
+#include "rad/IO/LineReader.h"
+#include "rad/System/FileSystem.h"
+
+// Character by character with std::getc (the implementation File::ReadLine used to have).
+static void BM_ReadLineGetChar(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        rad::File file;
+        file.Open(fileName, "rb");
+        size_t lineCount = 0;
+        std::string line;
+        while (true)
+        {
+            int32_t c = file.GetChar();
+            if (c == EOF)
+            {
+                break;
+            }
+            if (c == '\n')
+            {
+                lineCount++;
+                line.clear();
+            }
+            else
+            {
+                line.push_back(static_cast<char>(c));
+            }
+        }
+        benchmark::DoNotOptimize(lineCount);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_ReadLineGetChar)->Unit(benchmark::kMillisecond);
+
+static void BM_FileReadLine(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        rad::File file;
+        file.Open(fileName, "rb");
+        size_t lineCount = 0;
+        std::string line;
+        while (file.ReadLine(line) > 0)
+        {
+            lineCount++;
+            line.clear();
+        }
+        benchmark::DoNotOptimize(lineCount);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_FileReadLine)->Unit(benchmark::kMillisecond);
+
+static void BM_FileReadLines(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        std::vector<std::string> lines = rad::File::ReadLines(fileName);
+        benchmark::DoNotOptimize(lines.data());
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_FileReadLines)->Unit(benchmark::kMillisecond);
+
+static void BM_LineReader(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        rad::LineReader reader(static_cast<size_t>(state.range(0)));
+        reader.Open(fileName);
+        size_t lineCount = 0;
+        std::string_view line;
+        while (reader.ReadLine(line))
+        {
+            lineCount++;
+        }
+        benchmark::DoNotOptimize(lineCount);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_LineReader)->Arg(64 * 1024)->Arg(1024 * 1024)->Arg(8 * 1024 * 1024)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,65 @@
+#include "Benchmark.h"
+#include "rad/IO/LineReader.h"
+#include "rad/IO/TextChunks.h"
+#include "rad/System/FileSystem.h"
+#include <algorithm>
+
+struct LineFieldCount
+{
+    size_t lineCount = 0;
+    size_t fieldCount = 0;
+};
+
+static LineFieldCount CountLinesAndFields(std::string_view chunk)
+{
+    LineFieldCount count;
+    rad::ForEachLine(chunk, [&](std::string_view line) {
+        count.lineCount++;
+        count.fieldCount += std::count(line.begin(), line.end(), ',') + 1;
+        });
+    return count;
+}
+
+// Single-threaded baseline.
+static void BM_CountFieldsLineReader(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    for (auto _ : state)
+    {
+        rad::LineReader reader;
+        reader.Open(fileName);
+        LineFieldCount count;
+        std::string_view line;
+        while (reader.ReadLine(line))
+        {
+            count.lineCount++;
+            count.fieldCount += std::count(line.begin(), line.end(), ',') + 1;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_CountFieldsLineReader)->Unit(benchmark::kMillisecond);
+
+// @param range(0): the number of threads.
+static void BM_CountFieldsTextChunks(benchmark::State& state)
+{
+    const std::string& fileName = GetBenchmarkTextFile();
+    rad::ThreadPool threadPool(static_cast<uint32_t>(state.range(0)));
+    rad::TextChunkOptions options;
+    options.threadPool = &threadPool;
+    options.ordered = false;
+    for (auto _ : state)
+    {
+        LineFieldCount total;
+        rad::ProcessFileChunks(fileName,
+            [](std::string_view chunk, size_t) { return CountLinesAndFields(chunk); },
+            [&](LineFieldCount count, size_t) {
+                total.lineCount += count.lineCount;
+                total.fieldCount += count.fieldCount;
+            }, options);
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(rad::GetFileSize(fileName)));
+}
+BENCHMARK(BM_CountFieldsTextChunks)->RangeMultiplier(2)->Range(1, 32)->UseRealTime()->Unit(benchmark::kMillisecond);
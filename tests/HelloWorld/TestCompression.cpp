@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "rad/IO/File.h"
+#include "rad/IO/Compression.h"
+#include "rad/System/FileSystem.h"
+
+static std::string MakeCompressibleContent(size_t size)
+{
+    std::string content;
+    content.reserve(size);
+    for (size_t i = 0; content.size() < size; ++i)
+    {
+        content += "{\"id\":" + std::to_string(i) + ",\"name\":\"item" + std::to_string(i % 97) + "\"}\n";
+    }
+    content.resize(size);
+    return content;
+}
+
+TEST(IO, Compression)
+{
+    const std::string content = MakeCompressibleContent(1000000);
+    rad::CompressedWriter::Options options;
+    options.blockSize = 64 * 1024;
+    options.threadCount = 4;
+    rad::CompressedWriter writer;
+    ASSERT_TRUE(writer.Open("Compressed.zst", options));
+    for (size_t offset = 0; offset < content.size(); offset += 1000)
+    {
+        ASSERT_TRUE(writer.Write(std::string_view(content).substr(offset, 1000)));
+    }
+    EXPECT_EQ(writer.GetSize(), content.size());
+    ASSERT_TRUE(writer.Close());
+    const uint64_t compressedSize = rad::GetFileSize("Compressed.zst");
+    EXPECT_LT(compressedSize, content.size() / 4);
+
+    rad::CompressedReader reader;
+    ASSERT_TRUE(reader.Open("Compressed.zst"));
+    EXPECT_EQ(reader.GetFormat(), rad::CompressedReader::Format::ZstdSeekable);
+    EXPECT_EQ(reader.GetSize(), content.size());
+    EXPECT_EQ(rad::CompressedReader::ReadAll("Compressed.zst"), content);
+
+    // Random access across frames.
+    std::string buffer(100000, 0);
+    for (uint64_t offset : { 0ull, 65530ull, 500000ull, 999990ull })
+    {
+        ASSERT_TRUE(reader.Seek(offset));
+        const size_t bytesRead = reader.Read(buffer.data(), buffer.size());
+        EXPECT_EQ(bytesRead, std::min<size_t>(buffer.size(), content.size() - offset));
+        EXPECT_EQ(std::string_view(buffer.data(), bytesRead), std::string_view(content).substr(offset, bytesRead));
+        EXPECT_EQ(reader.Tell(), offset + bytesRead);
+    }
+    reader.Close();
+
+    // Without the seek table (a plain zstd stream): sequential only.
+    const uint64_t frameCount = (content.size() + options.blockSize - 1) / options.blockSize;
+    rad::ResizeFile("Compressed.zst", compressedSize - (8 + frameCount * 8 + 9));
+    ASSERT_TRUE(reader.Open("Compressed.zst"));
+    EXPECT_EQ(reader.GetFormat(), rad::CompressedReader::Format::Zstd);
+    EXPECT_FALSE(reader.Seek(100));
+    reader.Close();
+    EXPECT_EQ(rad::CompressedReader::ReadAll("Compressed.zst"), content);
+
+    // Uncompressed files are read as they are.
+    {
+        rad::File file;
+        ASSERT_TRUE(file.Open("Uncompressed.txt", "wb"));
+        file.Write(content.data(), content.size());
+    }
+    ASSERT_TRUE(reader.Open("Uncompressed.txt"));
+    EXPECT_EQ(reader.GetFormat(), rad::CompressedReader::Format::Raw);
+    ASSERT_TRUE(reader.Seek(123));
+    EXPECT_EQ(reader.Read(buffer.data(), 10), 10);
+    EXPECT_EQ(std::string_view(buffer.data(), 10), std::string_view(content).substr(123, 10));
+    reader.Close();
+    EXPECT_EQ(rad::CompressedReader::ReadAll("Uncompressed.txt"), content);
+
+    // Empty.
+    ASSERT_TRUE(writer.Open("Empty.zst"));
+    ASSERT_TRUE(writer.Close());
+    ASSERT_TRUE(reader.Open("Empty.zst"));
+    EXPECT_EQ(reader.GetFormat(), rad::CompressedReader::Format::ZstdSeekable);
+    EXPECT_EQ(reader.Read(buffer.data(), buffer.size()), 0);
+    reader.Close();
+
+    // Chunks of compressed and uncompressed files.
+    auto readChunks = [](std::string_view fileName, size_t* pChunkCount) {
+        std::string content;
+        *pChunkCount = 0;
+        std::vector<char> chunkBuffer(4096);
+        EXPECT_TRUE(rad::ReadFileChunks(fileName, [&](std::string_view chunk) {
+            content += chunk;
+            (*pChunkCount)++;
+            return true;
+            }, &chunkBuffer));
+        return content;
+        };
+    size_t chunkCount = 0;
+    EXPECT_EQ(readChunks("Compressed.zst", &chunkCount), content);
+    EXPECT_EQ(chunkCount, (content.size() + 4095) / 4096);
+    EXPECT_EQ(readChunks("Uncompressed.txt", &chunkCount), content);
+    EXPECT_EQ(chunkCount, 1);
+    EXPECT_EQ(readChunks("Empty.zst", &chunkCount), "");
+    EXPECT_EQ(chunkCount, 0);
+    EXPECT_FALSE(rad::ReadFileChunks("NotExist.zst", [](std::string_view) { return true; }));
+}
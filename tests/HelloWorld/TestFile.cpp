@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+#include "rad/IO/File.h"
+#include "rad/IO/MappedFile.h"
+#include "rad/IO/AsyncIO.h"
+#include "rad/IO/LineReader.h"
+#include "rad/IO/TextChunks.h"
+#include "rad/IO/BufferedWriter.h"
+#include <algorithm>
+
+static std::string MakeTestContent(size_t size)
+{
+    std::string content(size, 0);
+    for (size_t i = 0; i < size; ++i)
+    {
+        content[i] = static_cast<char>('a' + i % 26);
+    }
+    return content;
+}
+
+static void WriteTestFile(std::string_view fileName, std::string_view content)
+{
+    rad::File file;
+    ASSERT_TRUE(file.Open(fileName, "wb"));
+    file.Write(content.data(), content.size());
+    file.Close();
+}
+
+TEST(IO, MappedFile)
+{
+    const std::string content = MakeTestContent(100000);
+    WriteTestFile("MappedFile.txt", content);
+
+    rad::MappedFile file;
+    ASSERT_TRUE(file.Open("MappedFile.txt"));
+    EXPECT_EQ(file.GetFileSize(), content.size());
+    ASSERT_TRUE(file.Map());
+    file.Advise(rad::MappedFile::Advice::Sequential);
+    EXPECT_EQ(file.GetString(), content);
+
+    // Window with unaligned offset.
+    ASSERT_TRUE(file.Map(5001, 100));
+    EXPECT_EQ(file.GetView().size(), 100);
+    EXPECT_EQ(file.GetString(), std::string_view(content).substr(5001, 100));
+    EXPECT_EQ(file.GetMutableData(), nullptr);
+    file.Close();
+
+    ASSERT_TRUE(file.Open("MappedFile.txt", rad::MappedFile::Access::ReadWrite));
+    ASSERT_TRUE(file.Map(10, 1));
+    *file.GetMutableData() = std::byte('#');
+    EXPECT_TRUE(file.Flush());
+    file.Close();
+    EXPECT_EQ(rad::File::ReadAll("MappedFile.txt")[10], '#');
+}
+
+static void TestAsyncIOEngine(rad::AsyncIOEngine* engine)
+{
+    const size_t chunkSize = 4096;
+    const size_t chunkCount = 64;
+    const std::string content = MakeTestContent(chunkSize * chunkCount);
+    rad::File file;
+    ASSERT_TRUE(file.Open("AsyncIO.bin", "wb+"));
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        engine->Write(file.GetDescriptor(), content.data() + i * chunkSize, chunkSize, i * chunkSize,
+            [&](int64_t result) { EXPECT_EQ(result, chunkSize); });
+    }
+    engine->WaitAll();
+
+    std::string buffer(content.size(), 0);
+    engine->RegisterBuffers({ rad::AsyncIOBuffer{ buffer.data(), buffer.size() } });
+    size_t bytesRead = 0;
+    for (size_t i = 0; i < chunkCount; ++i)
+    {
+        engine->Read(file.GetDescriptor(), buffer.data() + i * chunkSize, chunkSize, i * chunkSize,
+            [&](int64_t result) { bytesRead += result; });
+    }
+    engine->WaitAll();
+    engine->UnregisterBuffers();
+    EXPECT_EQ(bytesRead, content.size());
+    EXPECT_EQ(buffer, content);
+
+    char c = 0;
+    std::future<int64_t> future = engine->Read(file.GetDescriptor(), &c, 1, 27);
+    engine->WaitAll();
+    EXPECT_EQ(future.get(), 1);
+    EXPECT_EQ(c, content[27]);
+
+    // Read past the end of file: short reads are continued until the end.
+    std::string tail(content.size(), 0);
+    future = engine->Read(file.GetDescriptor(), tail.data(), tail.size(), chunkSize);
+    engine->WaitAll();
+    EXPECT_EQ(future.get(), content.size() - chunkSize);
+    EXPECT_EQ(tail.substr(0, content.size() - chunkSize), content.substr(chunkSize));
+}
+
+TEST(IO, AsyncIO)
+{
+    rad::AsyncIOEngine::Options options;
+    options.queueDepth = 16;
+    std::unique_ptr<rad::AsyncIOEngine> engine = rad::AsyncIOEngine::Create(options);
+    TestAsyncIOEngine(engine.get());
+
+    options.forceThreadPool = true;
+    engine = rad::AsyncIOEngine::Create(options);
+    EXPECT_STREQ(engine->GetBackendName(), "ThreadPool");
+    TestAsyncIOEngine(engine.get());
+}
+
+TEST(IO, LineReader)
+{
+    const std::string longLine = MakeTestContent(1000);
+    WriteTestFile("LineReader.txt", "first\r\n\nthird\n" + longLine + "\nlast");
+
+    // Small buffer to test refill and growth.
+    rad::LineReader reader(64);
+    ASSERT_TRUE(reader.Open("LineReader.txt"));
+    std::vector<std::string> lines;
+    std::string_view line;
+    while (reader.ReadLine(line))
+    {
+        lines.emplace_back(line);
+    }
+    EXPECT_EQ(reader.GetLineNumber(), 5);
+    EXPECT_EQ(lines, std::vector<std::string>({ "first", "", "third", longLine, "last" }));
+    EXPECT_EQ(rad::File::ReadLines("LineReader.txt"), lines);
+}
+
+TEST(IO, TextChunks)
+{
+    std::string text;
+    for (int i = 0; i < 1000; ++i)
+    {
+        text += std::to_string(i) + ((i % 3 == 0) ? ",a,b\r\n" : ",c\n");
+    }
+    text += "last";
+
+    std::vector<std::string_view> chunks = rad::SplitTextChunks(text, 100);
+    std::string joined;
+    for (size_t i = 0; i < chunks.size(); ++i)
+    {
+        EXPECT_TRUE((i == chunks.size() - 1) || chunks[i].ends_with('\n'));
+        joined += chunks[i];
+    }
+    EXPECT_EQ(joined, text);
+    EXPECT_TRUE(rad::SplitTextChunks("", 100).empty());
+
+    auto countLines = [](std::string_view chunk, size_t) {
+        size_t lineCount = 0;
+        rad::ForEachLine(chunk, [&](std::string_view) { lineCount++; });
+        return lineCount;
+        };
+    rad::TextChunkOptions options;
+    options.chunkSize = 64;
+    options.threadCount = 4;
+    for (bool ordered : { true, false })
+    {
+        options.ordered = ordered;
+        size_t lineCount = 0;
+        std::vector<size_t> indices;
+        rad::ProcessTextChunks(text, countLines,
+            [&](size_t count, size_t index) { lineCount += count; indices.push_back(index); }, options);
+        EXPECT_EQ(lineCount, 1001);
+        if (ordered)
+        {
+            EXPECT_TRUE(std::is_sorted(indices.begin(), indices.end()));
+        }
+    }
+
+    // Ordered reduce reassembles the lines.
+    WriteTestFile("TextChunks.txt", text);
+    std::vector<std::string> lines;
+    options.ordered = true;
+    EXPECT_TRUE(rad::ProcessFileChunks("TextChunks.txt",
+        [](std::string_view chunk, size_t) {
+            std::vector<std::string> chunkLines;
+            rad::ForEachLine(chunk, [&](std::string_view line) { chunkLines.emplace_back(line); });
+            return chunkLines;
+        },
+        [&](std::vector<std::string>&& chunkLines, size_t) {
+            lines.insert(lines.end(), chunkLines.begin(), chunkLines.end());
+        }, options));
+    EXPECT_EQ(lines, rad::File::ReadLines("TextChunks.txt"));
+
+    // Exceptions are propagated to the caller.
+    EXPECT_THROW(rad::ProcessTextChunks(text,
+        [](std::string_view, size_t index) -> int { if (index == 3) throw std::runtime_error("map"); return 0; },
+        [](int, size_t) {}, options), std::runtime_error);
+    for (bool ordered : { true, false })
+    {
+        options.ordered = ordered;
+        size_t reducedCount = 0;
+        EXPECT_THROW(rad::ProcessTextChunks(text, countLines,
+            [&](size_t, size_t) { if (++reducedCount == 2) throw std::runtime_error("reduce"); }, options),
+            std::runtime_error);
+        EXPECT_EQ(reducedCount, 2);
+    }
+}
+
+TEST(IO, FilePositional)
+{
+    const std::string content = MakeTestContent(100000);
+    WriteTestFile("FilePositional.txt", content);
+
+    rad::File file;
+    ASSERT_TRUE(file.Open("FilePositional.txt", "rb+"));
+    EXPECT_EQ(file.Seek(5000, SEEK_SET), 0);
+    EXPECT_EQ(file.Tell(), 5000);
+    EXPECT_EQ(file.Rseek(0), 0);
+    EXPECT_EQ(file.Tell(), static_cast<int64_t>(content.size()));
+
+    // Positional I/O doesn't move the file position.
+    file.Rewind();
+    std::string buffer(100, 0);
+    EXPECT_EQ(file.ReadAt(buffer.data(), buffer.size(), 777), 100);
+    EXPECT_EQ(buffer, content.substr(777, 100));
+    EXPECT_EQ(file.ReadAt(buffer.data(), buffer.size(), content.size() - 10), 10);
+    EXPECT_EQ(file.Tell(), 0);
+    EXPECT_EQ(file.WriteAt("0123456789", 10, 50000), 10);
+    EXPECT_EQ(file.ReadAt(buffer.data(), 10, 50000), 10);
+    EXPECT_EQ(buffer.substr(0, 10), "0123456789");
+    file.Close();
+
+#ifndef _WIN32
+    // Beyond 4GB (sparse on most file systems).
+    ASSERT_TRUE(file.Open("FileLarge.bin", "wb+"));
+    const int64_t largeOffset = (int64_t(1) << 32) + 123;
+    if (file.WriteAt("large", 5, largeOffset) == 5)
+    {
+        EXPECT_EQ(file.Rseek(0), 0);
+        EXPECT_EQ(file.Tell(), largeOffset + 5);
+        EXPECT_EQ(file.Seek(largeOffset, SEEK_SET), 0);
+        char large[5] = {};
+        EXPECT_EQ(file.Read(large, 5), 1);
+        EXPECT_EQ(std::string_view(large, 5), "large");
+    }
+    file.Close();
+    std::remove("FileLarge.bin");
+#endif
+}
+
+TEST(IO, BufferedWriter)
+{
+    const std::string content = MakeTestContent(100000);
+    for (bool directIO : { false, true })
+    {
+        for (bool backgroundFlush : { false, true })
+        {
+            rad::BufferedWriter::Options options;
+            options.bufferSize = 8192;
+            options.directIO = directIO;
+            options.backgroundFlush = backgroundFlush;
+            options.syncPolicy = rad::BufferedWriter::SyncPolicy::Interval;
+            options.syncInterval = 32768;
+
+            rad::BufferedWriter writer;
+            ASSERT_TRUE(writer.Open("BufferedWriter.txt", options));
+            // Writes of various sizes, some larger than the buffer.
+            size_t offset = 0;
+            for (size_t size = 1; offset < content.size(); size = size * 3 + 1)
+            {
+                size = std::min(size, content.size() - offset);
+                ASSERT_TRUE(writer.Write(content.data() + offset, size));
+                offset += size;
+                if ((offset > 500) && (offset < 1000))
+                {
+                    // Partial flush in the middle (rewrites the unaligned tail with direct I/O).
+                    ASSERT_TRUE(writer.Flush());
+                    EXPECT_EQ(rad::File::ReadAll("BufferedWriter.txt"), content.substr(0, offset));
+                }
+            }
+            EXPECT_EQ(writer.GetSize(), content.size());
+            ASSERT_TRUE(writer.Close());
+            EXPECT_EQ(rad::File::ReadAll("BufferedWriter.txt"), content);
+        }
+    }
+}
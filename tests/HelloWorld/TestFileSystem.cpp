@@ -0,0 +1,565 @@
+#include <gtest/gtest.h>
+#include "rad/IO/File.h"
+#include "rad/System/FileSystem.h"
+#include "rad/System/DirectoryWalker.h"
+#include "rad/System/DirectorySnapshot.h"
+#include "rad/System/FileHash.h"
+#include "rad/System/FileMetadata.h"
+#include "rad/System/FileWatcher.h"
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+static void WriteFile(const rad::FilePath& path, std::string_view content)
+{
+    rad::File file;
+    ASSERT_TRUE(file.Open(path.string(), "wb"));
+    file.Write(content.data(), content.size());
+    file.Close();
+}
+
+TEST(FileSystem, CopyFile)
+{
+    std::string content(3 * 1024 * 1024 + 123, 0);
+    for (size_t i = 0; i < content.size(); ++i)
+    {
+        content[i] = static_cast<char>(i * 7 + i / 4096);
+    }
+    WriteFile("CopyFrom.bin", content);
+    rad::Remove("CopyTo.bin");
+
+    rad::CopyFile("CopyFrom.bin", "CopyTo.bin");
+    EXPECT_EQ(rad::File::ReadAll("CopyTo.bin"), content);
+    EXPECT_THROW(rad::CopyFile("CopyFrom.bin", "CopyTo.bin"), rad::FileSystemError);
+
+    WriteFile("CopyTo.bin", "old");
+    rad::CopyFile("CopyFrom.bin", "CopyTo.bin", rad::FileCopyOptions::skip_existing);
+    EXPECT_EQ(rad::File::ReadAll("CopyTo.bin"), "old");
+    rad::CopyFile("CopyFrom.bin", "CopyTo.bin", rad::FileCopyOptions::overwrite_existing);
+    EXPECT_EQ(rad::File::ReadAll("CopyTo.bin"), content);
+
+    EXPECT_THROW(rad::CopyFile("CopyFromNotExist.bin", "CopyTo.bin",
+        rad::FileCopyOptions::overwrite_existing), rad::FileSystemError);
+    rad::Remove("CopyFrom.bin");
+    rad::Remove("CopyTo.bin");
+}
+
+TEST(FileSystem, CopyParallel)
+{
+    rad::RemoveAll("CopyTreeFrom");
+    rad::RemoveAll("CopyTreeTo");
+    std::vector<std::pair<rad::FilePath, std::string>> files;
+    for (int i = 0; i < 4; ++i)
+    {
+        const rad::FilePath dir = rad::FilePath("CopyTreeFrom") / ("dir" + std::to_string(i)) / "sub";
+        rad::CreateDirectories(dir);
+        for (int j = 0; j < 10; ++j)
+        {
+            const rad::FilePath path = dir / ("file" + std::to_string(j) + ".txt");
+            files.emplace_back(path, std::string(i * 1000 + j, 'a' + j));
+            WriteFile(path, files.back().second);
+        }
+    }
+    rad::CreateDirectories("CopyTreeFrom/empty");
+
+    rad::CopyParallel("CopyTreeFrom", "CopyTreeTo", rad::FileCopyOptions::recursive, 4);
+    for (const auto& [path, content] : files)
+    {
+        EXPECT_EQ(rad::File::ReadAll(("CopyTreeTo" / path.lexically_relative("CopyTreeFrom")).string()), content);
+    }
+    EXPECT_TRUE(rad::IsDirectory("CopyTreeTo/empty"));
+    // Files exist.
+    EXPECT_THROW(rad::CopyParallel("CopyTreeFrom", "CopyTreeTo"), rad::FileSystemError);
+    rad::CopyParallel("CopyTreeFrom", "CopyTreeTo", rad::FileCopyOptions::overwrite_existing);
+
+#ifndef _WIN32
+    rad::CreateSymlink("sub/file1.txt", "CopyTreeFrom/dir0/link.txt");
+    rad::RemoveAll("CopyTreeTo");
+    rad::CopyParallel("CopyTreeFrom", "CopyTreeTo", rad::FileCopyOptions::skip_symlinks);
+    EXPECT_FALSE(rad::Exists(rad::GetSymlinkStatus("CopyTreeTo/dir0/link.txt")));
+    rad::RemoveAll("CopyTreeTo");
+    rad::CopyParallel("CopyTreeFrom", "CopyTreeTo", rad::FileCopyOptions::copy_symlinks);
+    EXPECT_TRUE(rad::IsSymlink("CopyTreeTo/dir0/link.txt"));
+    rad::RemoveAll("CopyTreeTo");
+    rad::CopyParallel("CopyTreeFrom", "CopyTreeTo");
+    EXPECT_FALSE(rad::IsSymlink("CopyTreeTo/dir0/link.txt"));
+    EXPECT_EQ(rad::File::ReadAll("CopyTreeTo/dir0/link.txt"), files[1].second);
+#endif
+
+    rad::RemoveAll("CopyTreeFrom");
+    rad::RemoveAll("CopyTreeTo");
+}
+
+TEST(FileSystem, WalkDirectory)
+{
+    rad::RemoveAll("WalkTree");
+    for (int i = 0; i < 8; ++i)
+    {
+        const rad::FilePath dir = rad::FilePath("WalkTree") / ("dir" + std::to_string(i)) / "sub" / "leaf";
+        rad::CreateDirectories(dir);
+        for (int j = 0; j < 20; ++j)
+        {
+            WriteFile(dir / ("file" + std::to_string(j) + ".txt"), "x");
+            WriteFile(dir.parent_path() / ("file" + std::to_string(j) + ".dat"), "x");
+        }
+    }
+    rad::CreateDirectories("WalkTree/empty");
+    std::set<std::string> expected;
+    for (const rad::DirectoryEntry& entry : rad::RecursiveDirectorIterator("WalkTree"))
+    {
+        expected.insert(entry.path().string());
+    }
+
+    rad::DirectoryWalkOptions options;
+    options.threadCount = 4;
+    std::set<std::string> paths;
+    for (const rad::DirectoryWalkEntry& entry : rad::WalkDirectory("WalkTree", options))
+    {
+        EXPECT_EQ(entry.type == rad::FileType::directory, rad::IsDirectory(entry.path)) << entry.path;
+        EXPECT_EQ(entry.path.substr(entry.nameOffset), rad::FilePath(entry.path).filename().string());
+        EXPECT_EQ(entry.depth, std::count(entry.path.begin(), entry.path.end(), '/') - 1) << entry.path;
+        paths.insert(entry.path);
+    }
+    EXPECT_EQ(paths, expected);
+
+    // Callback and batches.
+    std::mutex mutex;
+    paths.clear();
+    EXPECT_TRUE(rad::WalkDirectory("WalkTree/", [&](const rad::DirectoryWalkEntry& entry) {
+        std::lock_guard lock(mutex);
+        paths.insert(entry.path);
+        }, options));
+    std::set<std::string> expectedWithSlash;
+    for (const std::string& path : expected)
+    {
+        expectedWithSlash.insert("WalkTree/" + path.substr(9));
+    }
+    EXPECT_EQ(paths, expectedWithSlash);
+    options.batchSize = 7;
+    size_t entryCount = 0;
+    EXPECT_TRUE(rad::WalkDirectoryBatched("WalkTree", [&](std::vector<rad::DirectoryWalkEntry>& batch) {
+        EXPECT_LE(batch.size(), 7);
+        std::lock_guard lock(mutex);
+        entryCount += batch.size();
+        }, options));
+    EXPECT_EQ(entryCount, expected.size());
+
+    // Skip the "sub" subtrees and the files; the depth is limited.
+    options.filter = [](const rad::DirectoryWalkEntry& entry) {
+        return (entry.type == rad::FileType::directory) && (entry.GetName() != "sub");
+        };
+    EXPECT_EQ(rad::WalkDirectory("WalkTree", options).size(), 9);
+    options.filter = nullptr;
+    options.maxDepth = 1;
+    EXPECT_EQ(rad::WalkDirectory("WalkTree", options).size(), 9 + 8);
+
+#ifndef _WIN32
+    // Symlinks are reported but not followed by default; a loop is visited once.
+    options.maxDepth = UINT32_MAX;
+    rad::CreateDirectorySymlink("..", "WalkTree/dir0/loop");
+    rad::CreateDirectorySymlink("../dir1", "WalkTree/dir0/link1");
+    EXPECT_EQ(rad::WalkDirectory("WalkTree", options).size(), expected.size() + 2);
+    options.followSymlinks = true;
+    // The links are reported as directories, and each directory is walked only once.
+    EXPECT_EQ(rad::WalkDirectory("WalkTree", options).size(), expected.size() + 2);
+#endif
+
+    EXPECT_FALSE(rad::WalkDirectory("WalkTreeNotExist", [](const rad::DirectoryWalkEntry&) {}));
+    rad::RemoveAll("WalkTree");
+}
+
+TEST(FileSystem, FileMetadata)
+{
+    rad::RemoveAll("MetadataTree");
+    rad::CreateDirectories("MetadataTree/sub");
+    WriteFile("MetadataTree/a.txt", "hello");
+    WriteFile("MetadataTree/sub/b.txt", std::string(1000, 'b'));
+
+    rad::FileMetadata metadata;
+    ASSERT_TRUE(rad::GetFileMetadata("MetadataTree/a.txt", &metadata));
+    EXPECT_TRUE(metadata.IsRegularFile());
+    EXPECT_EQ(metadata.size, 5);
+    EXPECT_EQ(metadata.size, rad::GetFileSize("MetadataTree/a.txt"));
+    EXPECT_EQ(metadata.GetLastWriteTime(), rad::GetLastWriteTime("MetadataTree/a.txt"));
+    EXPECT_EQ(metadata.hardLinkCount, 1);
+    rad::File::Stat stat = {};
+    ASSERT_TRUE(rad::File::GetStat("MetadataTree/a.txt", &stat));
+    EXPECT_EQ(metadata.mtimeNs, stat.mtimeNs);
+    ASSERT_TRUE(rad::GetFileMetadata("MetadataTree/sub", &metadata));
+    EXPECT_TRUE(metadata.IsDirectory());
+    EXPECT_FALSE(rad::GetFileMetadata("MetadataTree/none.txt", &metadata));
+    EXPECT_EQ(metadata.type, rad::FileType::not_found);
+    EXPECT_FALSE(metadata.Exists());
+    EXPECT_NE(metadata.error, 0);
+
+    // The results are in the order of the paths, whatever the batches and threads.
+    std::vector<rad::FilePath> paths;
+    for (int i = 0; i < 100; ++i)
+    {
+        paths.push_back((i % 3 == 0) ? "MetadataTree/a.txt" :
+            (i % 3 == 1) ? "MetadataTree/sub/b.txt" : "MetadataTree/none.txt");
+    }
+    rad::FileMetadataOptions options;
+    options.threadCount = 4;
+    options.batchSize = 3;
+    std::vector<rad::FileMetadata> results = rad::GetFileMetadata(paths, options);
+    ASSERT_EQ(results.size(), paths.size());
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        EXPECT_EQ(results[i].Exists(), i % 3 != 2);
+        EXPECT_EQ(results[i].size, (i % 3 == 0) ? 5 : (i % 3 == 1) ? 1000 : 0);
+    }
+
+#ifndef _WIN32
+    rad::CreateSymlink("a.txt", "MetadataTree/link.txt");
+    ASSERT_TRUE(rad::GetFileMetadata("MetadataTree/link.txt", &metadata));
+    EXPECT_TRUE(metadata.IsRegularFile());
+    ASSERT_TRUE(rad::GetFileMetadata("MetadataTree/link.txt", &metadata, false));
+    EXPECT_TRUE(metadata.IsSymlink());
+#endif
+
+    // Served from memory until invalidated.
+    rad::FileMetadataCache cache(options);
+    EXPECT_EQ(cache.Get("MetadataTree/a.txt").size, 5);
+    EXPECT_FALSE(cache.Get("MetadataTree/none.txt").Exists());
+    WriteFile("MetadataTree/a.txt", "hello world");
+    WriteFile("MetadataTree/none.txt", "created");
+    EXPECT_EQ(cache.Get("MetadataTree/a.txt").size, 5);
+    EXPECT_FALSE(cache.Get("MetadataTree/none.txt").Exists());
+    EXPECT_EQ(cache.GetHitCount(), 2);
+    EXPECT_EQ(cache.GetMissCount(), 2);
+    cache.Invalidate("MetadataTree/a.txt");
+    EXPECT_EQ(cache.Get("MetadataTree/a.txt").size, 11);
+    EXPECT_EQ(cache.GetMissCount(), 3);
+
+    results = cache.Get(paths);
+    EXPECT_EQ(cache.GetMissCount(), 4);
+    EXPECT_EQ(cache.GetSize(), 3);
+    EXPECT_EQ(results[0].size, 11);
+    EXPECT_EQ(results[1].size, 1000);
+    EXPECT_FALSE(results[2].Exists());
+
+    // "MetadataTree/s" is not a parent of "MetadataTree/sub/b.txt".
+    cache.InvalidateTree("MetadataTree/s");
+    EXPECT_EQ(cache.GetSize(), 3);
+    cache.InvalidateTree("MetadataTree/sub/");
+    EXPECT_EQ(cache.GetSize(), 2);
+    cache.InvalidateTree("MetadataTree");
+    EXPECT_EQ(cache.GetSize(), 0);
+    results = cache.Get(paths);
+    EXPECT_TRUE(results[2].Exists());
+    cache.Clear();
+    EXPECT_EQ(cache.GetSize(), 0);
+    rad::RemoveAll("MetadataTree");
+}
+
+TEST(FileSystem, DirectorySnapshot)
+{
+    rad::RemoveAll("SnapshotTree");
+    rad::CreateDirectories("SnapshotTree/sub/deep");
+    WriteFile("SnapshotTree/a.txt", "a");
+    WriteFile("SnapshotTree/b.txt", "b");
+    WriteFile("SnapshotTree/sub/c.txt", "c");
+    WriteFile("SnapshotTree/sub/deep/d.txt", "d");
+    WriteFile("SnapshotTree/sub/r.txt", "r");
+    const rad::FileTime cTime = rad::GetLastWriteTime("SnapshotTree/sub/c.txt") - std::chrono::hours(1);
+    rad::SetLastWriteTime("SnapshotTree/sub/c.txt", cTime);
+    const rad::FileTime rTime = rad::GetLastWriteTime("SnapshotTree/sub/r.txt");
+
+    rad::DirectorySnapshot::Options options;
+    options.threadCount = 4;
+    options.hashContents = true;
+    rad::DirectorySnapshot before;
+    ASSERT_TRUE(before.Capture("SnapshotTree", options));
+    ASSERT_EQ(before.GetEntries().size(), 7);
+    EXPECT_EQ(before.GetEntries()[0].path, "a.txt");
+    EXPECT_EQ(before.GetEntries()[3].path, "sub/c.txt");
+    const rad::DirectorySnapshotEntry* entry = before.Find("sub/deep/d.txt");
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->type, rad::FileType::regular);
+    EXPECT_EQ(entry->size, 1);
+    EXPECT_NE(entry->hash, 0);
+    EXPECT_EQ(before.Find("sub/deep")->type, rad::FileType::directory);
+    EXPECT_EQ(before.Find("sub/none.txt"), nullptr);
+    EXPECT_TRUE(rad::DiffSnapshots(before, before).IsEmpty());
+
+    // Round trip through the file.
+    ASSERT_TRUE(before.Save("SnapshotTree.snap"));
+    rad::DirectorySnapshot loaded;
+    ASSERT_TRUE(loaded.Load("SnapshotTree.snap"));
+    ASSERT_EQ(loaded.GetEntries().size(), before.GetEntries().size());
+    EXPECT_TRUE(loaded.HasHashes());
+    for (size_t i = 0; i < loaded.GetEntries().size(); ++i)
+    {
+        const rad::DirectorySnapshotEntry& lhs = loaded.GetEntries()[i];
+        const rad::DirectorySnapshotEntry& rhs = before.GetEntries()[i];
+        EXPECT_EQ(lhs.path, rhs.path);
+        EXPECT_EQ(lhs.type, rhs.type);
+        EXPECT_EQ(lhs.size, rhs.size);
+        EXPECT_EQ(lhs.mtimeNs, rhs.mtimeNs);
+        EXPECT_EQ(lhs.inode, rhs.inode);
+        EXPECT_EQ(lhs.hash, rhs.hash);
+    }
+    EXPECT_EQ(loaded.GetCaptureTimeNs(), before.GetCaptureTimeNs());
+    // A corrupted or truncated file is rejected.
+    std::string content = rad::File::ReadAll("SnapshotTree.snap");
+    content[content.size() / 2] ^= 1;
+    WriteFile("SnapshotTree.snap", content);
+    EXPECT_FALSE(loaded.Load("SnapshotTree.snap"));
+    EXPECT_TRUE(loaded.GetEntries().empty());
+    WriteFile("SnapshotTree.snap", content.substr(0, 20));
+    EXPECT_FALSE(loaded.Load("SnapshotTree.snap"));
+    EXPECT_FALSE(loaded.Load("SnapshotTreeNotExist.snap"));
+
+    // Modify, touch (same content, new mtime), add and remove.
+    WriteFile("SnapshotTree/a.txt", "aa");
+    const rad::FileTime bTime = rad::GetLastWriteTime("SnapshotTree/b.txt");
+    WriteFile("SnapshotTree/b.txt", "b");
+    rad::SetLastWriteTime("SnapshotTree/b.txt", bTime + std::chrono::seconds(10));
+    WriteFile("SnapshotTree/sub/e.txt", "e");
+    rad::RemoveAll("SnapshotTree/sub/deep");
+    // Changed with the same size and mtime: an old file keeps the hash of the baseline,
+    // but a file modified around the baseline capture (racy mtime) is hashed again.
+    WriteFile("SnapshotTree/sub/c.txt", "C");
+    rad::SetLastWriteTime("SnapshotTree/sub/c.txt", cTime);
+    WriteFile("SnapshotTree/sub/r.txt", "R");
+    rad::SetLastWriteTime("SnapshotTree/sub/r.txt", rTime);
+    options.baseline = &before;
+    rad::DirectorySnapshot after;
+    ASSERT_TRUE(after.Capture("SnapshotTree", options));
+    rad::DirectoryDiff diff = rad::DiffSnapshots(before, after);
+    EXPECT_EQ(diff.added, std::vector<std::string>({ "sub/e.txt" }));
+    EXPECT_EQ(diff.removed, std::vector<std::string>({ "sub/deep", "sub/deep/d.txt" }));
+    EXPECT_EQ(diff.modified, std::vector<std::string>({ "a.txt", "sub/r.txt" }));
+    // The hash of sub/c.txt is reused from the baseline.
+    EXPECT_EQ(after.Find("sub/c.txt")->hash, before.Find("sub/c.txt")->hash);
+
+    // Without hashes, the touched file counts as modified.
+    options.hashContents = false;
+    options.baseline = nullptr;
+    rad::DirectorySnapshot withoutHashes;
+    ASSERT_TRUE(withoutHashes.Capture("SnapshotTree", options));
+    EXPECT_FALSE(withoutHashes.HasHashes());
+    WriteFile("SnapshotTree/b.txt", "b");
+    rad::SetLastWriteTime("SnapshotTree/b.txt", bTime + std::chrono::seconds(20));
+    ASSERT_TRUE(after.Capture("SnapshotTree", options));
+    diff = rad::DiffSnapshots(withoutHashes, after);
+    EXPECT_TRUE(diff.added.empty());
+    EXPECT_TRUE(diff.removed.empty());
+    EXPECT_EQ(diff.modified, std::vector<std::string>({ "b.txt" }));
+
+    EXPECT_FALSE(after.Capture("SnapshotTreeNotExist"));
+    rad::Remove("SnapshotTree.snap");
+    rad::RemoveAll("SnapshotTree");
+}
+
+// Collect the events delivered by a FileWatcher, and wait for the expected ones.
+class FileWatchRecorder
+{
+public:
+    void Record(const std::vector<rad::FileWatchEvent>& events)
+    {
+        std::lock_guard lock(m_mutex);
+        m_events.insert(m_events.end(), events.begin(), events.end());
+        m_cond.notify_all();
+    }
+
+    // Wait for an event of the path, and remove the events of the path recorded.
+    bool Wait(std::string_view path, rad::FileWatchAction action)
+    {
+        std::unique_lock lock(m_mutex);
+        auto isFound = [&]() {
+            return std::any_of(m_events.begin(), m_events.end(),
+                [&](const rad::FileWatchEvent& event) { return (event.path == path) && (event.action == action); });
+            };
+        const bool isDelivered = m_cond.wait_for(lock, std::chrono::seconds(5), isFound);
+        std::erase_if(m_events, [&](const rad::FileWatchEvent& event) { return event.path == path; });
+        return isDelivered;
+    }
+
+    bool Has(std::string_view path)
+    {
+        std::lock_guard lock(m_mutex);
+        return std::any_of(m_events.begin(), m_events.end(),
+            [&](const rad::FileWatchEvent& event) { return event.path == path; });
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::vector<rad::FileWatchEvent> m_events;
+
+}; // class FileWatchRecorder
+
+TEST(FileSystem, FileWatcher)
+{
+    rad::RemoveAll("WatchTree");
+    rad::Remove("WatchConfig.json");
+    rad::CreateDirectories("WatchTree/sub");
+
+    FileWatchRecorder recorder;
+    rad::FileWatcher watcher;
+    EXPECT_TRUE(watcher.AddPath("WatchTree"));
+    rad::FileWatcher::Options options;
+    // Well above the scheduling jitter: the changes made together always fall in one batch.
+    options.debounce = std::chrono::milliseconds(500);
+    options.maxLatency = std::chrono::seconds(10);
+    ASSERT_TRUE(watcher.Start([&](const std::vector<rad::FileWatchEvent>& events) { recorder.Record(events); }, options));
+    // The file doesn't exist yet.
+    EXPECT_TRUE(watcher.AddPath("WatchConfig.json"));
+
+    // Created and written: one added event.
+    WriteFile("WatchTree/sub/a.txt", "a");
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/a.txt", rad::FileWatchAction::Added));
+    WriteFile("WatchTree/sub/a.txt", "aa");
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/a.txt", rad::FileWatchAction::Modified));
+
+    // The entries of a new directory are reported, and the directory is watched.
+    rad::CreateDirectories("WatchTree/new/deep");
+    WriteFile("WatchTree/new/deep/b.txt", "b");
+    EXPECT_TRUE(recorder.Wait("WatchTree/new", rad::FileWatchAction::Added));
+    EXPECT_TRUE(recorder.Wait("WatchTree/new/deep/b.txt", rad::FileWatchAction::Added));
+    WriteFile("WatchTree/new/deep/c.txt", "c");
+    EXPECT_TRUE(recorder.Wait("WatchTree/new/deep/c.txt", rad::FileWatchAction::Added));
+
+    // A temporary file created and removed in the debounce time is not reported.
+    WriteFile("WatchTree/temp.txt", "temp");
+    rad::Remove("WatchTree/temp.txt");
+    rad::Remove("WatchTree/sub/a.txt");
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/a.txt", rad::FileWatchAction::Removed));
+    EXPECT_FALSE(recorder.Has("WatchTree/temp.txt"));
+
+    // An existing file replaced by a rename, then removed: still reported as removed.
+    WriteFile("WatchTree/sub/b.txt", "b");
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/b.txt", rad::FileWatchAction::Added));
+    WriteFile("WatchTree/sub/b.txt.tmp", "bb");
+    rad::Rename("WatchTree/sub/b.txt.tmp", "WatchTree/sub/b.txt");
+    rad::Remove("WatchTree/sub/b.txt");
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/b.txt", rad::FileWatchAction::Removed));
+    EXPECT_FALSE(recorder.Has("WatchTree/sub/b.txt.tmp"));
+
+    // Only the file watched in its directory; an atomic save (rename over) is seen.
+    WriteFile("WatchConfig.json", "{}");
+    EXPECT_TRUE(recorder.Wait("WatchConfig.json", rad::FileWatchAction::Added));
+    WriteFile("WatchConfig.json.tmp", "{ \"a\": 1 }");
+    rad::Rename("WatchConfig.json.tmp", "WatchConfig.json");
+    EXPECT_TRUE(recorder.Wait("WatchConfig.json", rad::FileWatchAction::Added));
+    EXPECT_FALSE(recorder.Has("WatchConfig.json.tmp"));
+
+    // A directory root removed, then recreated: watched again.
+    rad::RemoveAll("WatchTree");
+    EXPECT_TRUE(recorder.Wait("WatchTree", rad::FileWatchAction::Removed));
+    rad::CreateDirectories("WatchTree/new/deep");
+    WriteFile("WatchTree/new/deep/b.txt", "b");
+    EXPECT_TRUE(recorder.Wait("WatchTree", rad::FileWatchAction::Added));
+    EXPECT_TRUE(recorder.Wait("WatchTree/new", rad::FileWatchAction::Added));
+    EXPECT_TRUE(recorder.Wait("WatchTree/new/deep/b.txt", rad::FileWatchAction::Added));
+    rad::CreateDirectories("WatchTree/sub");
+    WriteFile("WatchTree/sub/c.txt", "c");
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/c.txt", rad::FileWatchAction::Added));
+
+    watcher.RemovePath("WatchTree");
+    WriteFile("WatchTree/removed.txt", "removed");
+    WriteFile("WatchConfig.json", "{}");
+    EXPECT_TRUE(recorder.Wait("WatchConfig.json", rad::FileWatchAction::Modified));
+    EXPECT_FALSE(recorder.Has("WatchTree/removed.txt"));
+    watcher.Stop();
+
+    // The polling fallback, delivered on the calling thread.
+    std::thread::id callbackThreadId;
+    options.usePolling = true;
+    options.deferDispatch = true;
+    options.pollInterval = std::chrono::milliseconds(50);
+    ASSERT_TRUE(watcher.Start([&](const std::vector<rad::FileWatchEvent>& events) {
+        callbackThreadId = std::this_thread::get_id();
+        recorder.Record(events);
+        }, options));
+    EXPECT_TRUE(watcher.AddPath("WatchTree"));
+    WriteFile("WatchTree/sub/polled.txt", "polled");
+    rad::RemoveAll("WatchTree/new");
+    // The batches are queued: dispatch until all the expected events arrive, or the deadline.
+    size_t eventCount = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while ((eventCount < 4) && (std::chrono::steady_clock::now() < deadline))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        eventCount += watcher.DispatchEvents();
+    }
+    EXPECT_EQ(callbackThreadId, std::this_thread::get_id());
+    EXPECT_TRUE(recorder.Wait("WatchTree/sub/polled.txt", rad::FileWatchAction::Added));
+    EXPECT_TRUE(recorder.Wait("WatchTree/new", rad::FileWatchAction::Removed));
+    EXPECT_TRUE(recorder.Wait("WatchTree/new/deep/b.txt", rad::FileWatchAction::Removed));
+    watcher.Stop();
+
+    rad::Remove("WatchConfig.json");
+    rad::RemoveAll("WatchTree");
+}
+
+TEST(FileSystem, FindDuplicateFiles)
+{
+    rad::RemoveAll("DuplicateTree");
+    rad::CreateDirectories("DuplicateTree/sub");
+    // The same prefix, different ends: only told apart by the full hashes.
+    const std::string large(100000, 'x');
+    WriteFile("DuplicateTree/large1.bin", large + "1");
+    WriteFile("DuplicateTree/large2.bin", large + "1");
+    WriteFile("DuplicateTree/sub/large3.bin", large + "1");
+    WriteFile("DuplicateTree/sub/large4.bin", large + "2");
+    WriteFile("DuplicateTree/small1.txt", "small");
+    WriteFile("DuplicateTree/sub/small2.txt", "small");
+    WriteFile("DuplicateTree/other.txt", "other");
+    WriteFile("DuplicateTree/empty1.txt", "");
+    WriteFile("DuplicateTree/empty2.txt", "");
+    // A hard link is the same file, not a duplicate.
+    rad::CreateHardLink("DuplicateTree/other.txt", "DuplicateTree/other_link.txt");
+
+    rad::FileHashResult result;
+    ASSERT_TRUE(rad::HashFile("DuplicateTree/large1.bin", &result));
+    EXPECT_EQ(result.size, large.size() + 1);
+    EXPECT_EQ(result.hash, rad::HashString128(large + "1"));
+    ASSERT_TRUE(rad::HashFile("DuplicateTree/large1.bin", &result, 10));
+    EXPECT_EQ(result.hash, rad::HashString128(std::string_view(large).substr(0, 10)));
+    ASSERT_TRUE(rad::HashFile("DuplicateTree/empty1.txt", &result));
+    EXPECT_EQ(result.hash, rad::HashString128(""));
+    EXPECT_FALSE(rad::HashFile("DuplicateTree/none.bin", &result));
+    EXPECT_FALSE(result.isValid);
+
+    std::vector<rad::FileHashResult> results = rad::HashFiles(
+        { "DuplicateTree/small1.txt", "DuplicateTree/none.bin", "DuplicateTree/sub/small2.txt" });
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_TRUE(results[0].isValid);
+    EXPECT_FALSE(results[1].isValid);
+    EXPECT_EQ(results[0].hash, results[2].hash);
+
+    rad::DuplicateFileOptions options;
+    options.threadCount = 4;
+    for (uint64_t prefixSize : { 64, 0 })
+    {
+        options.prefixSize = prefixSize;
+        std::vector<rad::DuplicateFileGroup> groups = rad::FindDuplicateFiles("DuplicateTree", options);
+        ASSERT_EQ(groups.size(), 2);
+        // The most space wasted first.
+        EXPECT_EQ(groups[0].size, large.size() + 1);
+        ASSERT_EQ(groups[0].paths.size(), 3);
+        EXPECT_EQ(rad::FilePath(groups[0].paths[0]).filename(), "large1.bin");
+        EXPECT_EQ(rad::FilePath(groups[0].paths[1]).filename(), "large2.bin");
+        EXPECT_EQ(rad::FilePath(groups[0].paths[2]).filename(), "large3.bin");
+        EXPECT_EQ(groups[1].size, 5);
+        EXPECT_EQ(groups[1].hash, rad::HashString128("small"));
+        EXPECT_EQ(groups[1].paths.size(), 2);
+    }
+
+    options.minSize = 0;
+    options.filter = [](const rad::DirectoryWalkEntry& entry) { return entry.GetName() != "sub"; };
+    std::vector<rad::DuplicateFileGroup> groups = rad::FindDuplicateFiles("DuplicateTree", options);
+    ASSERT_EQ(groups.size(), 2);
+    EXPECT_EQ(groups[0].paths.size(), 2);
+    EXPECT_EQ(groups[1].size, 0);
+    EXPECT_EQ(groups[1].paths.size(), 2);
+
+    groups = rad::FindDuplicateFiles(std::vector<rad::FilePath>{
+        "DuplicateTree/small1.txt", "DuplicateTree/other.txt", "DuplicateTree/sub/small2.txt" });
+    ASSERT_EQ(groups.size(), 1);
+    EXPECT_EQ(groups[0].paths.size(), 2);
+    rad::RemoveAll("DuplicateTree");
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "rad/Core/Hash.h"
+#include <vector>
+
+TEST(Core, Hash)
+{
+    std::vector<uint8_t> data(2048);
+    for (size_t i = 0; i < data.size(); ++i)
+    {
+        data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    // From the reference implementation: XXH3_64bits, XXH3_64bits_withSeed(0x1234), XXH3_128bits (low, high),
+    // and the low half of XXH3_128bits_withSeed(0x1234); covers all size classes.
+    struct Vector
+    {
+        size_t size;
+        uint64_t hash64;
+        uint64_t hash64Seeded;
+        uint64_t hash128Low;
+        uint64_t hash128High;
+        uint64_t hash128SeededLow;
+    };
+    const Vector vectors[] =
+    {
+        { 0, 0x2D06800538D394C2ull, 0xDA71BC4AEC3FBEF0ull, 0x6001C324468D497Full, 0x99AA06D3014798D8ull, 0xCBCE8931132B46FAull },
+        { 3, 0x15F7093B173D005Cull, 0x1CB9E11978FCE900ull, 0x15F7093B173D005Cull, 0x46F66CB935381565ull, 0x1CB9E11978FCE900ull },
+        { 8, 0xDEC6A9A43575982Eull, 0x6A16B17D1D809044ull, 0x56BB836CEB6D4BAAull, 0x803C675A846CC6C2ull, 0xFF64FDECA4043EF4ull },
+        { 16, 0x7E484C18D74895D0ull, 0x4D97C112CCE39145ull, 0xF853DD94614DFA07ull, 0x650FE308C566747Dull, 0x264AAAFD8D9816CFull },
+        { 100, 0x8C97158042FBF926ull, 0xF3FD1C1E3A2BE8C8ull, 0xD61D8DBFF22D515Full, 0x7F5A1F03462E52B4ull, 0x0B109D1A70512FEAull },
+        { 200, 0x12FDB864685F344Dull, 0x218B4CFAFEF66050ull, 0x60EA018811F9A437ull, 0x8D8629A1AEF9EF90ull, 0xACAE106D73511DD9ull },
+        { 1000, 0x989765D0EA7A5ECDull, 0x9DB7014A40A95613ull, 0x989765D0EA7A5ECDull, 0xF534F51E82A81D29ull, 0x9DB7014A40A95613ull },
+        { 2048, 0x19F6F9C987331373ull, 0x639D97F2C789651Aull, 0x19F6F9C987331373ull, 0xB318976B177A38C7ull, 0x639D97F2C789651Aull },
+    };
+    for (rad::HashKernel kernel : { rad::HashKernel::Generic, rad::HashKernel::Sse2, rad::HashKernel::Avx2, rad::HashKernel::Neon })
+    {
+        if (!rad::IsHashKernelSupported(kernel))
+        {
+            continue;
+        }
+        SCOPED_TRACE(rad::GetHashKernelName(kernel));
+        for (const Vector& v : vectors)
+        {
+            SCOPED_TRACE(v.size);
+            EXPECT_EQ(rad::HashBytes64(data.data(), v.size, 0, kernel), v.hash64);
+            EXPECT_EQ(rad::HashBytes64(data.data(), v.size, 0x1234, kernel), v.hash64Seeded);
+            const rad::Hash128 hash128 = rad::HashBytes128(data.data(), v.size, 0, kernel);
+            EXPECT_EQ(hash128.low, v.hash128Low);
+            EXPECT_EQ(hash128.high, v.hash128High);
+            EXPECT_EQ(rad::HashBytes128(data.data(), v.size, 0x1234, kernel).low, v.hash128SeededLow);
+
+            // Streaming in uneven pieces, crossing the internal buffer and the blocks.
+            rad::Hasher hasher(0x1234, kernel);
+            for (size_t offset = 0, piece = 1; offset < v.size; offset += piece, piece = piece * 3 + 1)
+            {
+                hasher.Update(data.data() + offset, std::min(piece, v.size - offset));
+            }
+            EXPECT_EQ(hasher.GetSize(), v.size);
+            EXPECT_EQ(hasher.Digest64(), v.hash64Seeded);
+            EXPECT_EQ(hasher.Digest128().low, v.hash128SeededLow);
+            hasher.Reset(0);
+            hasher.Update(data.data(), v.size);
+            EXPECT_EQ(hasher.Digest64(), v.hash64);
+            EXPECT_EQ(hasher.Digest128(), hash128);
+        }
+    }
+
+    EXPECT_EQ(rad::HashString64("abc"), rad::HashBytes64("abc", 3));
+    EXPECT_EQ(rad::HashString128("abc").ToString(), "06b05ab6733a618578af5f94892f3950");
+    EXPECT_NE(rad::HashString64("abc"), rad::HashString64("abd"));
+}
@@ -1,7 +1,48 @@
 #include <gtest/gtest.h>
 #include "rad/Core/String.h"
 #include "rad/IO/Json.h"
+#include "rad/IO/JsonStream.h"
+#include "rad/IO/JsonLines.h"
+#include "rad/IO/JsonBinding.h"
+#include "rad/IO/JsonBinary.h"
+#include "rad/IO/JsonWriter.h"
+#include "rad/IO/JsonCache.h"
+#include "rad/IO/JsonScanner.h"
+#include "rad/IO/File.h"
+#include "rad/IO/Compression.h"
 #include "rad/IO/Logging.h"
+#include "rad/System/FileSystem.h"
+
+namespace binding
+{
+
+enum class Mode
+{
+    Windowed,
+    Fullscreen,
+};
+
+struct WindowConfig
+{
+    std::string title;
+    int width = 1280;
+    int height = 720;
+    Mode mode = Mode::Windowed;
+    std::optional<float> scale;
+};
+RAD_JSON_BINDING(WindowConfig, title, width, height, mode, scale)
+
+struct AppConfig
+{
+    WindowConfig window;
+    std::vector<std::string> plugins;
+    std::map<std::string, uint16_t> ports;
+    std::array<double, 2> range = {};
+    boost::json::value extra;
+};
+RAD_JSON_BINDING(AppConfig, window, plugins, ports, range, extra)
+
+} // namespace binding
 
 void TestParsing()
 {
@@ -26,8 +67,476 @@ void TestValueConversion()
     EXPECT_EQ(v1, v2);
 }
 
+void TestArena()
+{
+    using namespace boost::json;
+    value jRoot = rad::ParseJsonFromFile("prize.json");
+
+    monotonic_resource arena;
+    value jArena = rad::ParseJsonFromFile("prize.json", &arena);
+    EXPECT_EQ(jArena, jRoot);
+    EXPECT_EQ(jArena.storage().get(), &arena);
+
+    rad::JsonParser parser;
+    for (int i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(parser.ParseFile("prize.json", make_shared_resource<monotonic_resource>()), jRoot);
+        EXPECT_EQ(serialize(parser.Parse("[1, 2, 3, ] // comment")), "[1,2,3]");
+    }
+    EXPECT_THROW(parser.Parse("[1, 2"), boost::system::system_error);
+    EXPECT_EQ(serialize(parser.Parse(R"({"a": null})")), R"({"a":null})");
+
+    // Mapped or compressed, DOM or streaming: the files are parsed the same way.
+    for (const char* fileName : { "ParseFile.json", "ParseFile.json.zst" })
+    {
+        SCOPED_TRACE(fileName);
+        auto writeFile = [&](std::string_view text) {
+            if (std::string_view(fileName).ends_with(".zst"))
+            {
+                rad::CompressedWriter writer;
+                ASSERT_TRUE(writer.Open(fileName));
+                writer.Write(text);
+                ASSERT_TRUE(writer.Close());
+            }
+            else
+            {
+                rad::File file;
+                ASSERT_TRUE(file.Open(fileName, "wb"));
+                file.Write(text.data(), text.size());
+            }
+            };
+        rad::JsonSubtreeCollector collector({ "" }, [](std::string_view, value&&) { return true; });
+
+        writeFile(R"({"a": 1} )");
+        EXPECT_EQ(serialize(rad::ParseJsonFromFile(fileName)), R"({"a":1})");
+        EXPECT_EQ(serialize(parser.ParseFile(fileName)), R"({"a":1})");
+        EXPECT_TRUE(rad::ParseJsonFromFile(fileName, &collector));
+
+        writeFile(R"({"a": 1} x)");
+        EXPECT_THROW(rad::ParseJsonFromFile(fileName), boost::system::system_error);
+        EXPECT_THROW(parser.ParseFile(fileName), boost::system::system_error);
+        EXPECT_FALSE(rad::ParseJsonFromFile(fileName, &collector));
+
+        // An existing empty file is an incomplete document, not a missing file.
+        writeFile("");
+        for (int i = 0; i < 2; ++i)
+        {
+            try
+            {
+                (i == 0) ? rad::ParseJsonFromFile(fileName) : parser.ParseFile(fileName);
+                ADD_FAILURE();
+            }
+            catch (const boost::system::system_error& e)
+            {
+                EXPECT_NE(e.code(), boost::system::errc::no_such_file_or_directory);
+            }
+        }
+        EXPECT_FALSE(rad::ParseJsonFromFile(fileName, &collector));
+    }
+}
+
+void TestStreaming()
+{
+    using namespace boost::json;
+    value jRoot = rad::ParseJsonFromFile("prize.json");
+    const array& prizes = jRoot.as_object()["prizes"].as_array();
+
+    // Visit the prizes one by one.
+    size_t prizeCount = 0;
+    rad::JsonSubtreeCollector collector({ "/prizes/*" },
+        [&](std::string_view pointer, value&& prize)
+        {
+            EXPECT_EQ(pointer, "/prizes/" + std::to_string(prizeCount));
+            EXPECT_EQ(prize, prizes[prizeCount]);
+            prizeCount++;
+            return true;
+        });
+    EXPECT_TRUE(rad::ParseJsonFromFile("prize.json", &collector));
+    EXPECT_EQ(prizeCount, prizes.size());
+
+    // Feed byte by byte, keys and strings split across chunks are joined.
+    std::string str = R"({"a~/b": [1, -2, 3.5, "long string", true, null, {"c": [ ]}], "d": {"e": "f"}})";
+    std::vector<std::pair<std::string, value>> results;
+    rad::JsonSubtreeCollector collector2({ "/a~0~1b/3", "/a~0~1b/6/c", "/d" },
+        [&](std::string_view pointer, value&& v)
+        {
+            results.emplace_back(pointer, std::move(v));
+            return true;
+        });
+    rad::JsonStreamParser parser(&collector2);
+    for (char c : str)
+    {
+        EXPECT_TRUE(parser.Write(std::string_view(&c, 1)));
+    }
+    EXPECT_TRUE(parser.Finish());
+    EXPECT_TRUE(parser.IsDone());
+    ASSERT_EQ(results.size(), 3);
+    EXPECT_EQ(results[0].first, "/a~0~1b/3");
+    EXPECT_EQ(results[0].second, value("long string"));
+    EXPECT_EQ(results[1].first, "/a~0~1b/6/c");
+    EXPECT_TRUE(results[1].second.is_array() && results[1].second.as_array().empty());
+    EXPECT_EQ(results[2].first, "/d");
+    EXPECT_EQ(serialize(results[2].second), R"({"e":"f"})");
+
+    // Stop early.
+    size_t count = 0;
+    rad::JsonSubtreeCollector collector3({ "/prizes/*" },
+        [&](std::string_view, value&&) { return (++count < 2); });
+    rad::JsonStreamParser parser3(&collector3);
+    EXPECT_FALSE(parser3.Write(R"({"prizes": [1, 2, 3, 4]})"));
+    EXPECT_TRUE(parser3.IsStopped());
+    EXPECT_EQ(count, 2);
+
+    rad::JsonHandler handler;
+    EXPECT_FALSE(rad::ParseJson("[1, 2", &handler));
+    EXPECT_FALSE(rad::ParseJson("[1, 2] 3", &handler));
+}
+
+void TestJsonLines()
+{
+    using namespace boost::json;
+    std::string text;
+    for (int i = 0; i < 10000; ++i)
+    {
+        text += rad::StrFormat(R"({{"id": {}, "name": "record {}"}})", i, i);
+        text += (i % 3) ? "\n" : "\r\n\n";
+    }
+
+    rad::TextChunkOptions options;
+    options.chunkSize = 4096;
+    options.threadCount = 4;
+    std::vector<value> records = rad::ParseJsonLines(text, options);
+    ASSERT_EQ(records.size(), 10000);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        EXPECT_EQ(records[i].as_object()["id"], value(int64_t(i)));
+    }
+
+    // Unordered batches, with an invalid line.
+    text += "{\"id\": \n{\"id\": 10000}";
+    options.ordered = false;
+    size_t recordCount = 0;
+    size_t errorCount = 0;
+    std::vector<bool> isChunkDone;
+    EXPECT_FALSE(rad::ParseJsonLines(text,
+        [&](rad::JsonLinesBatch&& batch)
+        {
+            recordCount += batch.records.size();
+            errorCount += batch.errorCount;
+            isChunkDone.resize(std::max(isChunkDone.size(), batch.chunkIndex + 1));
+            EXPECT_FALSE(isChunkDone[batch.chunkIndex]);
+            isChunkDone[batch.chunkIndex] = true;
+        }, options));
+    EXPECT_EQ(recordCount, 10001);
+    EXPECT_EQ(errorCount, 1);
+
+    // An exception thrown by the callback is rethrown once the chunks in flight are done.
+    EXPECT_THROW(rad::ParseJsonLines(text,
+        [](rad::JsonLinesBatch&&) { throw std::runtime_error("onBatch"); }, options), std::runtime_error);
+}
+
+void TestBinding()
+{
+    using namespace boost::json;
+    binding::AppConfig config;
+    EXPECT_TRUE(rad::ReadJson(rad::ParseJson(R"({
+        "window": {"title": "Hello", "height": 1080, "mode": 1, "scale": 1.5, "unknown": [1, 2]},
+        "plugins": ["a", "b"],
+        "ports": {"http": 80, "https": 443},
+        "range": [0, 0.5],
+        "extra": {"x": null}
+    })"), config));
+    EXPECT_EQ(config.window.title, "Hello");
+    EXPECT_EQ(config.window.width, 1280);
+    EXPECT_EQ(config.window.height, 1080);
+    EXPECT_EQ(config.window.mode, binding::Mode::Fullscreen);
+    EXPECT_EQ(config.window.scale, 1.5f);
+    EXPECT_EQ(config.plugins, std::vector<std::string>({ "a", "b" }));
+    EXPECT_EQ(config.ports["https"], 443);
+    EXPECT_EQ(config.range[1], 0.5);
+    EXPECT_EQ(serialize(config.extra), R"({"x":null})");
+
+    // Round trip, with value_from/value_to.
+    value jv = value_from(config);
+    EXPECT_EQ(jv, rad::WriteJson(config));
+    binding::AppConfig config2 = value_to<binding::AppConfig>(jv);
+    EXPECT_EQ(rad::WriteJson(config2), jv);
+    config2.window.scale.reset();
+    EXPECT_FALSE(rad::WriteJson(config2.window).as_object().contains("scale"));
+
+    // Mismatched types are reported and skipped.
+    binding::WindowConfig window;
+    EXPECT_FALSE(rad::ReadJson(rad::ParseJson(R"({"title": 1, "width": 100000000000, "height": 600})"), window));
+    EXPECT_EQ(window.title, "");
+    EXPECT_EQ(window.width, 1280);
+    EXPECT_EQ(window.height, 600);
+    EXPECT_FALSE(rad::ReadJson(rad::ParseJson("[]"), window));
+}
+
+void TestBinary()
+{
+    using namespace boost::json;
+    using rad::BinaryJsonFormat;
+    using namespace std::string_view_literals;
+    value jRoot = rad::ParseJsonFromFile("prize.json");
+
+    // RFC 8949 Appendix A and the MessagePack spec.
+    value jv = rad::ParseJson(R"({"a": 1, "b": [2, -3]})");
+    EXPECT_EQ(rad::EncodeBinaryJson(jv, BinaryJsonFormat::Cbor), "\xa2\x61\x61\x01\x61\x62\x82\x02\x22");
+    EXPECT_EQ(rad::EncodeBinaryJson(jv, BinaryJsonFormat::MessagePack), "\x82\xa1\x61\x01\xa1\x62\x92\x02\xfd");
+    // Indefinite-length array and string, half float, tag.
+    value decoded;
+    EXPECT_TRUE(rad::DecodeBinaryJson("\x9f\x01\x7f\x62" "ab\x61\x63\xff\xf9\x3c\x00\xc1\x1a\x51\x4b\x67\xb0\xff"sv,
+        BinaryJsonFormat::Cbor, decoded));
+    EXPECT_EQ(decoded, rad::ParseJson(R"([1, "abc", 1.0, 1363896240])"));
+
+    for (BinaryJsonFormat format : { BinaryJsonFormat::Cbor, BinaryJsonFormat::MessagePack })
+    {
+        value numbers = rad::ParseJson("[0, -1, 23, 24, -32, -33, 127, 128, 255, 256, 65535, 65536, -129, -32769, "
+            "-2147483649, 4294967296, 9223372036854775807, -9223372036854775808, 18446744073709551615, 0.5, -1e300]");
+        value numbersDecoded;
+        EXPECT_TRUE(rad::DecodeBinaryJson(rad::EncodeBinaryJson(numbers, format), format, numbersDecoded));
+        EXPECT_EQ(numbersDecoded, numbers);
+
+        std::string encoded = rad::EncodeBinaryJson(jRoot, format);
+        EXPECT_LT(encoded.size(), serialize(jRoot).size());
+        EXPECT_TRUE(rad::DecodeBinaryJson(encoded, format, decoded));
+        EXPECT_EQ(decoded, jRoot);
+
+        // Encode from the streaming parser.
+        std::string streamEncoded;
+        rad::BinaryJsonEncoder encoder(format, streamEncoded);
+        EXPECT_TRUE(rad::ParseJsonFromFile("prize.json", &encoder));
+        EXPECT_TRUE(rad::DecodeBinaryJson(streamEncoded, format, decoded));
+        EXPECT_EQ(decoded, jRoot);
+
+        // The strings point into the data.
+        struct StringChecker : public rad::JsonHandler
+        {
+            std::string_view data;
+            size_t count = 0;
+            bool OnString(std::string_view str) override
+            {
+                EXPECT_TRUE((str.data() >= data.data()) && (str.data() + str.size() <= data.data() + data.size()));
+                count++;
+                return true;
+            }
+        } checker;
+        checker.data = encoded;
+        size_t bytesRead = 0;
+        EXPECT_TRUE(rad::DecodeBinaryJson(encoded, format, &checker, &bytesRead));
+        EXPECT_GT(checker.count, 0);
+        EXPECT_EQ(bytesRead, encoded.size());
+
+        // Truncated.
+        for (size_t size : { size_t(0), size_t(1), encoded.size() / 2, encoded.size() - 1 })
+        {
+            EXPECT_FALSE(rad::DecodeBinaryJson(std::string_view(encoded).substr(0, size), format, decoded));
+        }
+    }
+}
+
+void TestPath()
+{
+    using namespace boost::json;
+    value jRoot = rad::ParseJsonFromFile("prize.json");
+    const array& prizes = jRoot.as_object()["prizes"].as_array();
+
+    rad::JsonPath path("prizes[1].laureates[0].surname");
+    EXPECT_TRUE(path.IsValid());
+    EXPECT_EQ(path.GetTokenCount(), 5);
+    rad::JsonPath pointer("/prizes/1/laureates/0/surname");
+    const value* surname = path.Find(jRoot);
+    ASSERT_NE(surname, nullptr);
+    EXPECT_EQ(surname, pointer.Find(jRoot));
+    EXPECT_EQ(*surname, prizes[1].at("laureates").at(0).at("surname"));
+    EXPECT_EQ(rad::JsonRef(jRoot).FindPath(path).GetString(), surname->as_string().c_str());
+
+    // Same shape, and different shapes (cache misses).
+    rad::JsonPath category("category");
+    for (int i = 0; i < 2; ++i)
+    {
+        for (const value& prize : prizes)
+        {
+            const value* v = category.Find(prize);
+            ASSERT_NE(v, nullptr);
+            EXPECT_EQ(*v, prize.at("category"));
+        }
+    }
+    value jv = rad::ParseJson(R"({"a~/b": {"": [10, 20]}, "x": {"y": 1}})");
+    EXPECT_EQ(*rad::JsonPath("/a~0~1b//1").Find(jv), value(20));
+    EXPECT_EQ(*rad::JsonPath("x.y").Find(jv), value(1));
+    rad::JsonPath xy("x.y");
+    EXPECT_EQ(*xy.Find(rad::ParseJson(R"({"z": 0, "x": {"w": 0, "y": 2}})")), value(2));
+    EXPECT_EQ(*xy.Find(jv), value(1));
+    EXPECT_EQ(rad::JsonPath("").Find(jv), &jv);
+    EXPECT_EQ(rad::JsonPath("x.z").Find(jv), nullptr);
+    EXPECT_EQ(rad::JsonPath("/a~0~1b//2").Find(jv), nullptr);
+    EXPECT_EQ(rad::JsonPath("x.y.z").Find(jv), nullptr);
+    for (const char* invalid : { "a..b", "a.", "a[", "a[]", "a[x]", ".a", "/a~2" })
+    {
+        EXPECT_FALSE(rad::JsonPath(invalid).IsValid()) << invalid;
+    }
+}
+
+void TestWriter()
+{
+    using namespace boost::json;
+    value jRoot = rad::ParseJsonFromFile("prize.json");
+    EXPECT_EQ(rad::ParseJson(rad::SerializeJson(jRoot)), jRoot);
+
+    value jv = rad::ParseJson(R"({"s": "a\"b\\c\n\u0001\u00e9", "n": [0, -1, 18446744073709551615, 1.5, 2.0, 1e300],)"
+        R"( "e": {}, "a": [], "b": [true, false, null]})");
+    EXPECT_EQ(rad::SerializeJson(jv),
+        R"({"s":"a\"b\\c\n\u0001é","n":[0,-1,18446744073709551615,1.5,2.0,1e+300],"e":{},"a":[],"b":[true,false,null]})");
+    rad::JsonWriter::Options options;
+    options.pretty = true;
+    options.indent = 2;
+    EXPECT_EQ(rad::SerializeJson(rad::ParseJson(R"({"a": [1, {}], "b": {"c": null}})"), options),
+        "{\n  \"a\": [\n    1,\n    {}\n  ],\n  \"b\": {\n    \"c\": null\n  }\n}");
+    EXPECT_TRUE(rad::ParseJson(rad::SerializeJson(jv, options)) == jv);
+
+    // Reformat from the streaming parser with the smallest buffer.
+    std::string output;
+    options.bufferSize = 0;
+    {
+        rad::JsonWriter writer(output, options);
+        EXPECT_TRUE(rad::ParseJsonFromFile("prize.json", &writer));
+    }
+    EXPECT_EQ(rad::ParseJson(output), jRoot);
+
+    EXPECT_TRUE(rad::WriteJsonToFile(jRoot, "JsonWriter.json"));
+    EXPECT_EQ(rad::ParseJsonFromFile("JsonWriter.json"), jRoot);
+}
+
+static void WriteTextFile(std::string_view fileName, std::string_view text)
+{
+    rad::File file;
+    ASSERT_TRUE(file.Open(fileName, "wb"));
+    file.Write(text.data(), text.size());
+}
+
+void TestCache()
+{
+    rad::JsonDocumentCache cache;
+    WriteTextFile("JsonCache.json", R"({"level": 1})");
+    bool isUpdated = false;
+    rad::JsonDocumentCache::Document doc1 = cache.Get("JsonCache.json", &isUpdated);
+    ASSERT_TRUE(doc1);
+    EXPECT_TRUE(isUpdated);
+    EXPECT_EQ(doc1->at("level").as_int64(), 1);
+    // Unchanged: the same document is shared.
+    EXPECT_EQ(cache.Get("JsonCache.json", &isUpdated), doc1);
+    EXPECT_FALSE(isUpdated);
+
+    WriteTextFile("JsonCache.json", R"({"level": 22})");
+    rad::JsonDocumentCache::Document doc2 = cache.Get("JsonCache.json", &isUpdated);
+    ASSERT_TRUE(doc2);
+    EXPECT_TRUE(isUpdated);
+    EXPECT_EQ(doc2->at("level").as_int64(), 22);
+    // The readers keep the old document.
+    EXPECT_EQ(doc1->at("level").as_int64(), 1);
+
+    // Keep the last good document if broken.
+    WriteTextFile("JsonCache.json", R"({"level": )");
+    EXPECT_EQ(cache.Get("JsonCache.json", &isUpdated), doc2);
+    EXPECT_FALSE(isUpdated);
+
+    WriteTextFile("JsonCache.json", R"({"level": 33})");
+    EXPECT_EQ(cache.Get("JsonCache.json")->at("level").as_int64(), 33);
+    EXPECT_EQ(cache.Get("NotExist.json"), nullptr);
+
+    // Rewritten with the same size and mtime (within the timestamp granularity), without Invalidate.
+    const rad::FileTime mtime = rad::GetLastWriteTime("JsonCache.json");
+    WriteTextFile("JsonCache.json", R"({"level": 44})");
+    rad::SetLastWriteTime("JsonCache.json", mtime);
+    EXPECT_EQ(cache.Get("JsonCache.json", &isUpdated)->at("level").as_int64(), 44);
+    EXPECT_TRUE(isUpdated);
+
+    // Not checked within the interval.
+    rad::JsonDocumentCache::Options options;
+    options.checkInterval = std::chrono::hours(1);
+    rad::JsonDocumentCache lazyCache(options);
+    doc1 = lazyCache.Get("JsonCache.json");
+    WriteTextFile("JsonCache.json", R"({"level": 4444})");
+    EXPECT_EQ(lazyCache.Get("JsonCache.json"), doc1);
+    lazyCache.Invalidate("JsonCache.json");
+    EXPECT_EQ(lazyCache.Get("JsonCache.json")->at("level").as_int64(), 4444);
+}
+
+void TestScanner()
+{
+    using namespace boost::json;
+    const std::string prize = rad::File::ReadAll("prize.json");
+    const value jPrize = rad::ParseJson(prize);
+    EXPECT_TRUE(rad::ValidateJson(prize));
+
+    // Strings with escapes and UTF-8 at every alignment, to cross the block boundaries.
+    array strings;
+    for (size_t i = 0; i < 200; ++i)
+    {
+        std::string str(i % 70, 'a');
+        str += (i % 3 == 0) ? "\\\"" : (i % 3 == 1) ? "\"\\" : "\xE4\xBD\xA0\n";
+        str.append(i % 5, '\\');
+        strings.push_back(value(str));
+    }
+    value jStrings = rad::ParseJson(R"({"numbers": [0, -1, 9223372036854775807, 9223372036854775808,)"
+        R"( 18446744073709551615, -9223372036854775808, 1.5, -2.5e-3], "literals": [true, false, null],)"
+        R"( "empty": {"o": {}, "a": []}})");
+    jStrings.as_object()["strings"] = strings;
+    const std::string strs = rad::SerializeJson(jStrings);
+
+    for (rad::JsonScanKernel kernel : { rad::JsonScanKernel::Generic, rad::JsonScanKernel::Sse2,
+        rad::JsonScanKernel::Avx2, rad::JsonScanKernel::Neon })
+    {
+        if (!rad::IsJsonScanKernelSupported(kernel))
+        {
+            continue;
+        }
+        SCOPED_TRACE(rad::GetJsonScanKernelName(kernel));
+        rad::JsonScanner scanner(kernel);
+        EXPECT_TRUE(scanner.Scan(R"( {"a\"":[1, "x y" ,true]} )"));
+        EXPECT_EQ(scanner.GetIndices(), (std::vector<uint32_t>{ 1, 2, 7, 8, 9, 10, 12, 18, 19, 23, 24 }));
+
+        value jv;
+        EXPECT_TRUE(scanner.Parse(prize, jv));
+        EXPECT_EQ(jv, jPrize);
+        EXPECT_TRUE(scanner.Parse(strs, jv));
+        EXPECT_EQ(jv, jStrings);
+        EXPECT_TRUE(scanner.Parse(R"(["\u00e9\ud83d\ude00\/\b\f\r\t", 1e400, -1e-400, 18446744073709551616])", jv));
+        EXPECT_EQ(jv.at(0).as_string(), "\xC3\xA9\xF0\x9F\x98\x80/\b\f\r\t");
+        EXPECT_TRUE(std::isinf(jv.at(1).as_double()));
+        EXPECT_EQ(jv.at(2).as_double(), 0.0);
+        EXPECT_EQ(jv.at(3).as_double(), 18446744073709551616.0);
+        for (std::string_view valid : { "0", " \"\" ", "[]", "{}", "[[[]]]", "-0.0e+1", "{\"\":{\"\":null}}" })
+        {
+            EXPECT_TRUE(scanner.Validate(valid)) << valid;
+        }
+        for (std::string_view invalid : { "", "  ", "[", "]", "{}}", "[1,]", "{\"a\":1,}", "[1 2]", "{\"a\" 1}",
+            "{1:2}", "01", "1.", "-", "+1", ".5", "1e", "tru", "nul", "truex", "1\"a\"", "\"a\"1", "\"abc",
+            "\"\\\"", "\"\\x\"", "\"\\u12G4\"", "\"\\ud800\"", "\"\\udc00\"", "\"\x01\"", "[\x01]",
+            "\"\xC0\x80\"", "\"\xED\xA0\x80\"", "\"\xF4\x90\x80\x80\"", "\"\xE4\xBD\"", "\"\x80\"",
+            "NaN", "[1,/*c*/2]", "\"\" \"\"" })
+        {
+            EXPECT_FALSE(scanner.Validate(invalid)) << invalid;
+        }
+        EXPECT_FALSE(scanner.Scan("\"\xFF\""));
+        EXPECT_EQ(scanner.GetError(), "invalid UTF-8");
+        EXPECT_EQ(scanner.GetErrorOffset(), 1);
+    }
+}
+
 TEST(Core, Json)
 {
     TestParsing();
     TestValueConversion();
+    TestArena();
+    TestStreaming();
+    TestJsonLines();
+    TestBinding();
+    TestBinary();
+    TestPath();
+    TestWriter();
+    TestCache();
+    TestScanner();
 }
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "rad/IO/Logging.h"
+#include "rad/IO/LogSinks.h"
+#include "rad/IO/File.h"
+#include <atomic>
+#include <thread>
+
+TEST(IO, LogSinks)
+{
+    rad::Ref<rad::RingBufferLogSink> ringSink = new rad::RingBufferLogSink(2);
+    size_t callbackCount = 0;
+    rad::Ref<rad::CallbackLogSink> callbackSink = new rad::CallbackLogSink(
+        [&](rad::LogLevel level, std::string_view message) { callbackCount++; });
+    callbackSink->SetLevel(rad::LogLevel::Warn);
+
+    rad::Logger logger("Test", { ringSink, callbackSink });
+    logger.SetOutputLevel(rad::LogLevel::Info);
+    logger.Log(rad::LogLevel::Debug, "filtered");
+    logger.Log(rad::LogLevel::Info, "message {}", 1);
+    logger.Log(rad::LogLevel::Warn, "message {}", 2);
+    logger.Log(rad::LogLevel::Error, "message {}", 3);
+
+    std::vector<std::string> messages = ringSink->GetMessages();
+    ASSERT_EQ(messages.size(), 2);
+    EXPECT_NE(messages[0].find("Test: Warn: message 2\n"), std::string::npos);
+    EXPECT_NE(messages[1].find("Test: Error: message 3\n"), std::string::npos);
+    EXPECT_EQ(callbackCount, 2);
+
+    logger.RemoveSink(callbackSink.get());
+    logger.AddSink(ringSink);
+    EXPECT_EQ(logger.GetSinks()->size(), 1);
+    logger.Log(rad::LogLevel::Critical, "message {}", 4);
+    EXPECT_EQ(callbackCount, 2);
+    EXPECT_NE(ringSink->GetMessages().back().find("message 4"), std::string::npos);
+
+    // A removed sink is released once no list refers to it.
+    std::shared_ptr<const rad::LogSinkList> snapshot = logger.GetSinks();
+    const rad::LogSink* ringSinkPtr = ringSink.get();
+    ringSink = nullptr;
+    logger.RemoveSink(ringSinkPtr);
+    EXPECT_TRUE(logger.GetSinks()->empty());
+    ASSERT_EQ(snapshot->size(), 1);
+    EXPECT_EQ(snapshot->front()->GetRefCount(), 1);
+}
+
+TEST(IO, LogSite)
+{
+    rad::Ref<rad::RingBufferLogSink> ringSink = new rad::RingBufferLogSink(16);
+    rad::Logger logger("Test", { ringSink });
+    logger.SetOutputLevel(rad::LogLevel::Info);
+
+    // Rate limiting only: burst of 3, never refills in the test.
+    rad::LogSite rateLimitSite(3, 1, std::chrono::hours(1));
+    for (int i = 0; i < 10; ++i)
+    {
+        logger.Log(rateLimitSite, rad::LogLevel::Info, "message {}", i);
+    }
+    EXPECT_EQ(ringSink->GetMessages().size(), 3);
+    // A repeated error (e.g. a failing check in a frame loop) is rate limited too.
+    rad::LogSite errorSite(3, 1, std::chrono::hours(1));
+    for (int i = 0; i < 10; ++i)
+    {
+        logger.Log(errorSite, rad::LogLevel::Error, "error {}", i);
+    }
+    EXPECT_EQ(ringSink->GetMessages().size(), 6);
+    // Critical is exempt: neither rate limited nor deduplicated.
+    logger.Log(rateLimitSite, rad::LogLevel::Critical, "critical");
+    logger.Log(rateLimitSite, rad::LogLevel::Critical, "critical");
+    EXPECT_EQ(ringSink->GetMessages().size(), 8);
+
+    ringSink->Clear();
+    rad::LogSite repeatSite(100, 0, std::chrono::hours(1));
+    for (int i = 0; i < 5; ++i)
+    {
+        logger.Log(repeatSite, rad::LogLevel::Info, "repeated");
+    }
+    logger.Log(repeatSite, rad::LogLevel::Info, "different");
+    std::vector<std::string> messages = ringSink->GetMessages();
+    ASSERT_EQ(messages.size(), 3);
+    EXPECT_NE(messages[0].find("repeated"), std::string::npos);
+    EXPECT_NE(messages[1].find("last message repeated 4 times"), std::string::npos);
+    EXPECT_NE(messages[2].find("different"), std::string::npos);
+}
+
+TEST(IO, LogFlightRecorder)
+{
+    rad::LogFlightRecorder recorder(4, "FlightRecorder.log");
+    EXPECT_EQ(recorder.GetCapacity(), 4);
+    for (int i = 0; i < 6; ++i)
+    {
+        recorder.Record("Test", rad::LogLevel::Debug, "record {} {} {:.1f}", i, std::string("str"), 0.5);
+    }
+    std::vector<std::string> messages = recorder.GetMessages();
+    ASSERT_EQ(messages.size(), 4);
+    EXPECT_NE(messages.front().find("Test: Debug: record 2 str 0.5\n"), std::string::npos);
+    EXPECT_NE(messages.back().find("Test: Debug: record 5 str 0.5\n"), std::string::npos);
+    EXPECT_EQ(recorder.Dump(), 4);
+
+    // The logger name is copied: a non-global logger may be destroyed before the dump.
+    {
+        std::string loggerName = "Temporary";
+        recorder.Record(loggerName, rad::LogLevel::Warn, "short-lived {}", 1);
+    }
+    EXPECT_NE(recorder.GetMessages().back().find("Temporary: Warn: short-lived 1\n"), std::string::npos);
+    EXPECT_EQ(recorder.DumpFromSignalHandler(), 4);
+    std::vector<std::string> lines = rad::File::ReadLines("FlightRecorder.log");
+    ASSERT_EQ(lines.size(), 4);
+    // Not formatted in the signal handlers: the format string, and the arguments in hex.
+    EXPECT_NE(lines.front().find("Test: Debug: record {} {} {:.1f} | args: 03000000"), std::string::npos);
+    EXPECT_NE(lines.back().find("Temporary: Warn: short-lived {} | args: 01000000"), std::string::npos);
+}
+
+TEST(IO, LogFlightRecorderConcurrent)
+{
+    // Writers lap the tiny ring while it is read: every record read is whole.
+    rad::LogFlightRecorder recorder(2, "FlightRecorder.log");
+    std::atomic<bool> stop = false;
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; ++t)
+    {
+        writers.emplace_back([&, t]() {
+            const std::string str(static_cast<size_t>(t) * 16 + 1, static_cast<char>('a' + t));
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                recorder.Record("Test", rad::LogLevel::Info, "{} {}", t, str);
+            }
+            });
+    }
+    for (int i = 0; i < 2000; ++i)
+    {
+        for (const std::string& message : recorder.GetMessages())
+        {
+            const size_t pos = message.find("Test: Info: ");
+            ASSERT_NE(pos, std::string::npos);
+            const int t = message[pos + 12] - '0';
+            ASSERT_TRUE((t >= 0) && (t < 4)) << message;
+            const std::string expected = std::to_string(t) + " " +
+                std::string(static_cast<size_t>(t) * 16 + 1, static_cast<char>('a' + t)) + "\n";
+            EXPECT_EQ(message.substr(pos + 12), expected);
+        }
+    }
+    stop = true;
+    for (std::thread& writer : writers)
+    {
+        writer.join();
+    }
+
+    // The decoding is bounded by the size of the arguments, and must consume all of them.
+    char args[8] = {};
+    const uint16_t size = 100;
+    std::memcpy(args, &size, sizeof(size));
+    char buffer[64];
+    size_t bufferSize = 0;
+    EXPECT_FALSE(rad::detail::FormatFlightRecord<std::string>("{}", args, sizeof(args), buffer, sizeof(buffer), &bufferSize));
+    EXPECT_FALSE(rad::detail::FormatFlightRecord<int>("{}", args, sizeof(args), buffer, sizeof(buffer), &bufferSize));
+    EXPECT_TRUE(rad::detail::FormatFlightRecord<int64_t>("{}", args, sizeof(args), buffer, sizeof(buffer), &bufferSize));
+    EXPECT_EQ(std::string_view(buffer, bufferSize), "100");
+}